@@ -107,7 +107,8 @@ Ui::Child directorEntry(Sys::DirEntry const& entry, bool odd) {
                    : Mime::iconFor(Mime::sniffSuffix(Mime::suffixOf(entry.name)).unwrapOr("file"s)),
                entry.name
            ) |
-           Kr::contextMenu(directoryContextMenu);
+           Kr::contextMenu(directoryContextMenu) |
+           Ui::key(entry.name);
 }
 
 Ui::Child directoryListing(State const& s, Sys::Dir const& dir) {
@@ -125,6 +126,7 @@ Ui::Child directoryListing(State const& s, Sys::Dir const& dir) {
 
     return Ui::vflow(children) |
            Ui::align(Math::Align::TOP | Math::Align::HFILL) |
+           Ui::tiled() |
            Ui::vscroll() | Ui::key(s.currentIndex);
 }
 
@@ -174,6 +174,7 @@ Ui::Child pangrams(Rc<Text::Fontface> fontface) {
 
     return Ui::vflow(8, children) |
            Ui::insets(16) |
+           Ui::tiled() |
            Ui::vhscroll();
 }
 
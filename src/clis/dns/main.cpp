@@ -1,4 +1,4 @@
-#include <karm-net/dns/dns.h>
+#include <karm-net/dns/resolver.h>
 #include <karm-sys/entry.h>
 
 Async::Task<> entryPointAsync(Sys::Context& ctx) {
@@ -8,8 +8,9 @@ Async::Task<> entryPointAsync(Sys::Context& ctx) {
         co_return Error::invalidInput("invalid number of arguments");
     }
 
-    auto dns = co_try$(Net::Dns::Client::connect(Net::Dns::GOOGLE));
-    auto addr = co_try$(dns.resolve(args[0]));
-    Sys::println("dns resolved domain '{}' to {}", args[0], addr);
+    auto resolver = co_try$(Net::Dns::globalResolver());
+    auto addrs = co_trya$(resolver->resolveAsync(args[0]));
+    for (auto& addr : addrs)
+        Sys::println("dns resolved domain '{}' to {}", args[0], addr);
     co_return Ok();
 }
@@ -1,7 +1,51 @@
+#include <karm-async/queue.h>
+#include <karm-io/impls.h>
 #include <karm-net/http/fetch.h>
 #include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+Async::Task<> entryPointAsync(Sys::Context& ctx) {
+    auto& args = Sys::useArgs(ctx);
+
+    if (args.len() == 0) {
+        co_trya$(Net::Http::fetch("http://www.google.com:80/"_url, Sys::out()));
+        co_return Ok();
+    }
+
+    if (args.len() == 1) {
+        co_trya$(Net::Http::fetch(Mime::Url::parse(args[0]), Sys::out()));
+        co_return Ok();
+    }
+
+    // Fetch every url at once, connections to the same origin are shared
+    // through the pool, so this is a good way to exercise it against `serv`.
+    Vec<Mime::Url> urls;
+    for (usize i = 0; i < args.len(); i++)
+        urls.pushBack(Mime::Url::parse(args[i]));
+
+    Io::Sink sink;
+    Async::Queue<Pair<usize, Res<usize>>> done;
+    auto start = Sys::instant();
+    for (usize i = 0; i < urls.len(); i++) {
+        Async::detach(Net::Http::fetch(urls[i], sink), [&, i](Res<usize> res) {
+            done.enqueue({i, res});
+        });
+    }
+
+    usize failed = 0;
+    for (usize i = 0; i < urls.len(); i++) {
+        auto [index, res] = co_await done.dequeueAsync();
+        if (not res)
+            failed++;
+        Sys::println("{}: {}", urls[index], res);
+    }
+
+    auto stats = Net::Http::poolStats();
+    Sys::println(
+        "{} urls, {} failed in {}, {} connections opened, {} reused, {} idle",
+        urls.len(), failed, Sys::instant() - start,
+        stats.opened, stats.reused, stats.idle
+    );
 
-Async::Task<> entryPointAsync(Sys::Context&) {
-    co_trya$(Net::Http::fetch("http://www.google.com:80/"_url, Sys::out()));
     co_return Ok();
 }
@@ -0,0 +1,139 @@
+#include <karm-async/queue.h>
+#include <karm-io/aton.h>
+#include <karm-io/impls.h>
+#include <karm-net/dns/resolver.h>
+#include <karm-net/http/body.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/socket.h>
+#include <karm-sys/time.h>
+
+namespace ServBench {
+
+struct Stats {
+    usize requests = 0;
+    usize bytes = 0;
+    usize errors = 0;
+    usize connections = 0;
+};
+
+static Async::Task<> _writeAllAsync(Sys::_Connection& conn, Bytes buf) {
+    while (buf.len()) {
+        auto written = co_trya$(conn.writeAsync(buf));
+        if (written == 0)
+            co_return Error::writeZero("connection closed while writing");
+        buf = next(buf, written);
+    }
+    co_return Ok();
+}
+
+// Send one request and read its response, returns whether the connection
+// can carry another one.
+static Async::Task<bool> _exchangeAsync(Sys::TcpConnection& conn, Bytes req, Stats& stats) {
+    co_trya$(_writeAllAsync(conn, req));
+
+    Array<Byte, 4096> buf;
+    Net::Http::HeadParser head;
+    Bytes rest;
+    while (true) {
+        auto len = co_trya$(conn.readAsync(mutBytes(buf)));
+        if (len == 0)
+            co_return Error::unexpectedEof("connection closed before response head");
+
+        auto chunk = sub(buf, 0, len);
+        if (auto used = co_try$(head.feed(chunk))) {
+            rest = next(chunk, *used);
+            break;
+        }
+    }
+
+    auto resp = co_try$(head.response());
+    if (resp.code != Net::Http::Code::OK)
+        co_return Error::invalidData("unexpected status");
+
+    Net::Http::Body body{conn, rest};
+    co_try$(body.setup(resp));
+    Io::Sink sink;
+    stats.bytes += co_try$(Io::copy(body, sink));
+    co_try$(body.finish());
+
+    stats.requests++;
+    co_return Ok(body.complete() and resp.keepAlive());
+}
+
+// Issue `n` requests one after the other, on a single connection as long
+// as the server keeps it open.
+static Async::Task<> _workerAsync(Sys::SocketAddr addr, Bytes req, usize n, Stats& stats) {
+    Opt<Sys::TcpConnection> conn;
+    for (usize i = 0; i < n; i++) {
+        if (not conn) {
+            conn.emplace(co_try$(Sys::TcpConnection::connect(addr)));
+            stats.connections++;
+        }
+
+        auto res = co_await _exchangeAsync(*conn, req, stats);
+        if (not res)
+            stats.errors++;
+        if (not res or not res.unwrap())
+            conn = NONE;
+    }
+    co_return Ok();
+}
+
+} // namespace ServBench
+
+Async::Task<> entryPointAsync(Sys::Context& ctx) {
+    auto& args = Sys::useArgs(ctx);
+    if (args.len() < 1 or args.len() > 3) {
+        Sys::println("usage: {} <url> [connections] [requests-per-connection]", args.self());
+        co_return Error::invalidInput("invalid number of arguments");
+    }
+
+    auto url = Mime::Url::parse(args[0]);
+    usize connections = args.len() > 1 ? co_try$(Io::atou(args[1])) : 16;
+    usize requests = args.len() > 2 ? co_try$(Io::atou(args[2])) : 1000;
+
+    auto resolver = co_try$(Net::Dns::globalResolver());
+    auto ip = co_trya$(resolver->resolveOneAsync(url.host));
+    auto port = url.port ? *url.port : 80;
+    Sys::SocketAddr addr{ip, (u16)port};
+
+    auto path = url.path;
+    path.rooted = true;
+    auto req = Io::format(
+        "GET {} HTTP/1.1\r\n"
+        "Host: {}\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n",
+        path,
+        url.host
+    );
+
+    ServBench::Stats stats;
+    Async::Queue<Res<>> done;
+    auto start = Sys::instant();
+    for (usize i = 0; i < connections; i++) {
+        Async::detach(ServBench::_workerAsync(addr, bytes(req), requests, stats), [&](Res<> res) {
+            done.enqueue(res);
+        });
+    }
+
+    for (usize i = 0; i < connections; i++) {
+        auto res = co_await done.dequeueAsync();
+        if (not res)
+            Sys::println("worker failed: {}", res);
+    }
+
+    auto elapsed = Sys::instant() - start;
+    auto secs = max(elapsed.toUSecs(), 1uz) / 1e6;
+    Sys::println(
+        "{} requests, {} errors, {} connections in {}",
+        stats.requests, stats.errors, stats.connections, elapsed
+    );
+    Sys::println(
+        "{} requests/s, {} MiB/s",
+        (usize)(stats.requests / secs),
+        (usize)(stats.bytes / secs / (1024 * 1024))
+    );
+
+    co_return Ok();
+}
@@ -1,3 +1,4 @@
+#include <karm-base/hashmap.h>
 #include <karm-io/funcs.h>
 #include <karm-logger/logger.h>
 #include <karm-mime/mime.h>
@@ -6,87 +7,331 @@
 #include <karm-sys/entry.h>
 #include <karm-sys/file.h>
 #include <karm-sys/socket.h>
+#include <karm-sys/time.h>
 
 namespace Serv {
 
-Async::Task<> respondFile(Sys::_Connection& conn, Mime::Url const& url, Net::Http::Code code = Net::Http::Code::OK) {
-    auto contentType = Mime::sniffSuffix(url.path.suffix())
-                           .unwrapOr("application/octet-stream"_mime);
-    auto file = co_try$(Sys::File::open(url));
-    auto stat = co_try$(file.stat());
+// How many requests a single connection may carry before it is closed.
+static constexpr usize MAX_REQUESTS = 1000;
 
-    Io::StringWriter header;
-    co_try$(Io::format(
-        header,
-        "HTTP/1.1 {} {}\r\n"
-        "Connection: close\r\n"
-        "Content-Type: {}\r\n"
-        "Content-Length: {}\r\n"
-        "X-Powered-By: Karm Web\r\n"
-        "\r\n",
-        (usize)code,
-        Net::Http::toStr(code),
-        contentType,
-        stat.size
-    ));
+// MARK: File Cache ------------------------------------------------------------
+
+// An open file and what's known about it. It's shared by every connection
+// serving it, which is fine since bodies are read at explicit offsets.
+struct CachedFile {
+    Rc<Sys::Fd> fd;
+    Sys::Stat stat;
+    Mime::Mime contentType;
+    String etag;
+    String lastModified;
+    Instant checked;
+};
+
+struct FileCache {
+    static constexpr usize MAX_ENTRIES = 256;
+    // How long a stat result is trusted before the file is looked at again.
+    static constexpr Duration TTL = Duration::fromSecs(1);
+
+    HashMap<String, Rc<CachedFile>> _entries;
+
+    static Res<Rc<CachedFile>> _open(Mime::Url const& url, Instant now) {
+        auto file = try$(Sys::File::open(url));
+        auto stat = try$(file.stat());
+        auto stamp = (stat.modifyTime - SystemTime::epoch()).toUSecs();
+
+        return Ok(makeRc<CachedFile>(CachedFile{
+            file.fd(),
+            stat,
+            Mime::sniffSuffix(url.path.suffix()).unwrapOr("application/octet-stream"_mime),
+            Io::format("\"{x}-{x}\"", stamp, stat.size),
+            Net::Http::formatDate(stat.modifyTime),
+            now,
+        }));
+    }
+
+    Res<Rc<CachedFile>> open(Mime::Url const& url) {
+        auto key = url.str();
+        auto now = Sys::instant();
+
+        if (auto cached = _entries.tryGet(key)) {
+            auto entry = cached.take();
+            if (now < entry->checked + TTL)
+                return Ok(entry);
+
+            // NOTE: A file that didn't change keeps its descriptor, one that
+            //       did is opened again so its new content is served.
+            auto stat = Sys::stat(url);
+            if (stat and
+                stat.unwrap().size == entry->stat.size and
+                stat.unwrap().modifyTime == entry->stat.modifyTime) {
+                entry->checked = now;
+                return Ok(entry);
+            }
+            _entries.del(key);
+        }
+
+        auto entry = try$(_open(url, now));
+
+        // Dropping everything keeps this simple, a static site rarely has
+        // more hot files than this anyway.
+        if (_entries.len() >= MAX_ENTRIES)
+            _entries.clear();
+        _entries.put(key, entry);
 
-    co_try$(conn.write(header.bytes()));
-    co_try$(Io::copy(file, conn));
+        return Ok(entry);
+    }
+};
+
+static FileCache& _fileCache() {
+    static FileCache cache;
+    return cache;
+}
+
+// MARK: Responses -------------------------------------------------------------
+
+struct Client {
+    Sys::_Connection& conn;
+    // The plain connection, when bodies can be sent straight from the file,
+    // nullptr over tls.
+    Sys::Connection* raw;
+    Sys::SocketAddr addr;
+    // Whether the request being answered is a HEAD, which gets the head of
+    // the response only.
+    bool headOnly = false;
+};
+
+static Async::Task<> _writeAllAsync(Sys::_Connection& conn, Bytes buf) {
+    while (buf.len()) {
+        auto written = co_trya$(conn.writeAsync(buf));
+        if (written == 0)
+            co_return Error::writeZero("connection closed while writing");
+        buf = next(buf, written);
+    }
     co_return Ok();
 }
 
-Async::Task<> respond404(Sys::_Connection& conn) {
-    auto res = co_await respondFile(conn, "bundle://serv/public/404.html"_url, Net::Http::Code::NOT_FOUND);
-    if (res)
+static Async::Task<> _sendBodyAsync(Client& client, CachedFile& file, Net::Http::ByteRange range) {
+    if (client.raw) {
+        usize off = range.start;
+        while (off < range.end) {
+            auto sent = co_trya$(client.raw->sendFileAsync(file.fd, off, range.end - off));
+            if (sent == 0)
+                co_return Error::unexpectedEof("file shrank while being sent");
+            off += sent;
+        }
         co_return Ok();
+    }
 
-    Io::StringWriter header;
+    // NOTE: Over tls the data is encrypted in user space anyway.
+    Array<Byte, 16 * 1024> buf;
+    usize off = range.start;
+    while (off < range.end) {
+        co_try$(file.fd->seek(Io::Seek::fromBegin(off)));
+        auto n = co_try$(file.fd->read(mutSub(buf, 0, min(range.end - off, buf.len()))));
+        if (n == 0)
+            co_return Error::unexpectedEof("file shrank while being sent");
+        co_trya$(_writeAllAsync(client.conn, sub(buf, 0, n)));
+        off += n;
+    }
+    co_return Ok();
+}
+
+static Res<> _writeHead(Io::TextWriter& out, Net::Http::Code code, bool keepAlive) {
+    return Io::format(
+        out,
+        "HTTP/1.1 {} {}\r\n"
+        "Connection: {}\r\n"
+        "Date: {}\r\n"
+        "X-Powered-By: Karm Web\r\n",
+        (usize)code,
+        Net::Http::toStr(code),
+        keepAlive ? "keep-alive" : "close",
+        Net::Http::formatDate(Sys::now())
+    );
+}
+
+Async::Task<> respondText(Client& client, Net::Http::Code code, Str body, bool keepAlive, Str extra = "") {
+    Io::StringWriter head;
+    co_try$(_writeHead(head, code, keepAlive));
     co_try$(Io::format(
-        header,
-        "HTTP/1.1 404 Not Found\r\n"
-        "Connection: close\r\n"
+        head,
         "Content-Type: text/plain; charset=UTF-8\r\n"
-        "Content-Length: 9\r\n"
-        "X-Powered-By: Karm Net\r\n"
-        "\r\n"
-        "Not Found"
+        "Content-Length: {}\r\n"
+        "{}"
+        "\r\n",
+        body.len(),
+        extra
     ));
+    if (not client.headOnly)
+        co_try$(head.writeStr(body));
+    co_return co_await _writeAllAsync(client.conn, head.bytes());
+}
 
-    co_trya$(conn.writeAsync(header.bytes()));
-    co_return Ok();
+Async::Task<> respondFile(Client& client, Net::Http::Request const& req, CachedFile& file, Net::Http::Code code, bool keepAlive) {
+    using Net::Http::Code;
+
+    auto size = file.stat.size;
+    Net::Http::ByteRange range{0, size};
+
+    if (code == Code::OK) {
+        // Conditional requests, the etag wins when both are present.
+        // https://www.rfc-editor.org/rfc/rfc9110#section-13.2.2
+        bool fresh = false;
+        if (auto inm = req.lookup("If-None-Match"))
+            fresh = *inm == "*" or contains(*inm, file.etag.str());
+        else if (auto ims = req.lookup("If-Modified-Since"))
+            // NOTE: Like most servers, only an exact match counts.
+            fresh = *ims == file.lastModified.str();
+
+        if (fresh) {
+            Io::StringWriter out;
+            co_try$(_writeHead(out, Code::NOT_MODIFIED, keepAlive));
+            co_try$(Io::format(out, "ETag: {}\r\nLast-Modified: {}\r\n\r\n", file.etag, file.lastModified));
+            co_return co_await _writeAllAsync(client.conn, out.bytes());
+        }
+
+        // A range is only honored if the client's copy is still current
+        auto ifRange = req.lookup("If-Range");
+        auto rangeHeader = req.lookup("Range");
+        if (rangeHeader and (not ifRange or *ifRange == file.etag.str() or *ifRange == file.lastModified.str())) {
+            auto resolved = Net::Http::resolveRange(*rangeHeader, size);
+            if (not resolved) {
+                auto extra = Io::format("Content-Range: bytes */{}\r\n", size);
+                co_return co_await respondText(client, Code::RANGE_NOT_SATISFIABLE, "Range Not Satisfiable", keepAlive, extra.str());
+            }
+
+            if (auto r = resolved.take()) {
+                range = *r;
+                code = Code::PARTIAL_CONTENT;
+            }
+        }
+    }
+
+    Io::StringWriter out;
+    co_try$(_writeHead(out, code, keepAlive));
+    co_try$(Io::format(
+        out,
+        "Content-Type: {}\r\n"
+        "Content-Length: {}\r\n"
+        "Accept-Ranges: bytes\r\n"
+        "ETag: {}\r\n"
+        "Last-Modified: {}\r\n",
+        file.contentType,
+        range.len(),
+        file.etag,
+        file.lastModified
+    ));
+
+    if (code == Code::PARTIAL_CONTENT)
+        co_try$(Io::format(out, "Content-Range: bytes {}-{}/{}\r\n", range.start, range.end - 1, size));
+    co_try$(out.writeStr("\r\n"s));
+
+    co_trya$(_writeAllAsync(client.conn, out.bytes()));
+
+    if (client.headOnly or range.len() == 0)
+        co_return Ok();
+    co_return co_await _sendBodyAsync(client, file, range);
+}
+
+Async::Task<> respond404(Client& client, Net::Http::Request const& req, bool keepAlive) {
+    if (auto file = _fileCache().open("bundle://serv/public/404.html"_url))
+        co_return co_await respondFile(client, req, *file.unwrap(), Net::Http::Code::NOT_FOUND, keepAlive);
+    co_return co_await respondText(client, Net::Http::Code::NOT_FOUND, "Not Found", keepAlive);
 }
 
-Async::Task<> handleRequest(Sys::_Connection& conn, Str request, Sys::SocketAddr addr) {
-    Io::SScan scan{request};
-    auto req = co_try$(Net::Http::Request::parse(scan));
+Async::Task<> handleRequest(Client& client, Net::Http::Request const& req, bool keepAlive) {
+    logInfo("{}: {} {}", client.addr, req.method, req.path);
+    client.headOnly = req.method == Net::Http::Method::HEAD;
+
+    if (req.method != Net::Http::Method::GET and req.method != Net::Http::Method::HEAD) {
+        co_return co_await respondText(
+            client,
+            Net::Http::Code::METHOD_NOT_ALLOWED,
+            "Method Not Allowed",
+            keepAlive,
+            "Allow: GET, HEAD\r\n"
+        );
+    }
+
     auto url = "bundle://serv/public/"_url / req.path;
+    auto& cache = _fileCache();
 
-    logInfo("{}: {} {}", addr, req.method, req.path);
+    auto file = cache.open(url);
+    if (file and file.unwrap()->stat.type == Sys::Type::DIR)
+        file = cache.open(url / "index.html");
 
-    Res<> firstRes = co_await respondFile(conn, url, Net::Http::Code::OK);
-    if (firstRes) {
-        co_return Ok();
+    if (not file) {
+        logWarn("{}: {} {}: {}", client.addr, req.method, url, file.none());
+        co_return co_await respond404(client, req, keepAlive);
     }
 
-    Res<> res = co_await respondFile(conn, url / "index.html", Net::Http::Code::OK);
-    if (res)
-        co_return Ok();
+    co_return co_await respondFile(client, req, *file.unwrap(), Net::Http::Code::OK, keepAlive);
+}
+
+// MARK: Connections -----------------------------------------------------------
+
+// Read the next request head, NONE once the peer closed the connection.
+// Bytes read past the head are kept in `rest`, they start the next request.
+Async::Task<Opt<Net::Http::Request>> _nextRequestAsync(Client& client, Vec<Byte>& rest) {
+    Net::Http::HeadParser head;
+    Array<Byte, 4096> buf;
+    while (true) {
+        Bytes chunk = rest;
+        if (not chunk.len()) {
+            auto len = co_trya$(client.conn.readAsync(mutBytes(buf)));
+            if (len == 0) {
+                if (head._buf.len())
+                    co_return Error::unexpectedEof("connection closed inside request head");
+                co_return Ok(NONE);
+            }
+            chunk = sub(buf, 0, len);
+        }
+
+        auto used = co_try$(head.feed(chunk));
+        Vec<Byte> leftover;
+        if (used)
+            leftover.insertMany(0, sub(chunk, *used, chunk.len()));
+        rest = std::move(leftover);
 
-    logWarn("{}: {} {}: {}", addr, req.method, url, firstRes);
-    co_return co_await respond404(conn);
+        if (used)
+            co_return Ok(co_try$(head.request()));
+    }
+}
+
+Async::Task<> serveClient(Client& client, Vec<Byte> rest) {
+    for (usize i = 0; i < MAX_REQUESTS; i++) {
+        auto req = co_trya$(_nextRequestAsync(client, rest));
+        if (not req)
+            break;
+
+        // NOTE: Request bodies aren't read, so a request carrying one
+        //       leaves the connection in an unknown state.
+        bool hasBody = req->lookup("Content-Length") or req->lookup("Transfer-Encoding");
+        bool keepAlive = req->keepAlive() and not hasBody and i + 1 < MAX_REQUESTS;
+
+        co_trya$(handleRequest(client, *req, keepAlive));
+        if (not keepAlive)
+            break;
+    }
+    co_return Ok();
 }
 
 Async::Task<> handleConnection(Sys::TcpConnection stream) {
-    Array<char, 4096> buf;
+    Array<Byte, 4096> buf;
     auto len = co_trya$(stream.readAsync(mutBytes(buf)));
-    if (not Tls::isHello(bytes(buf))) {
-        co_return co_await handleRequest(stream, Str{buf.buf(), len}, stream.addr());
-    } else {
-        logDebug("{}: wants TLS", stream.addr());
-        auto tls = co_try$(Tls::TlsConnection::accept(stream, bytes(buf)));
-        len = co_trya$(tls.readAsync(mutBytes(buf)));
-        co_return co_await handleRequest(tls, Str{buf.buf(), len}, stream.addr());
+    auto hello = sub(buf, 0, len);
+
+    if (not Tls::isHello(hello)) {
+        Client client{stream, &stream, stream.addr()};
+        Vec<Byte> rest;
+        rest.insertMany(0, hello);
+        co_return co_await serveClient(client, std::move(rest));
     }
+
+    logDebug("{}: wants TLS", stream.addr());
+    auto tls = co_try$(Tls::TlsConnection::accept(stream, hello));
+    Client client{tls, nullptr, stream.addr()};
+    co_return co_await serveClient(client, {});
 }
 
 } // namespace Serv
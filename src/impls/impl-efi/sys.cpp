@@ -377,10 +377,22 @@ Res<> memFlush(void*, usize) {
     return Ok();
 }
 
+Res<Rc<Fd>> createShm(usize) {
+    return Error::notImplemented("shared memory not supported");
+}
+
+Res<> createDir(Mime::Url const&) {
+    return Error::notImplemented("creating directories not supported");
+}
+
 Res<Stat> stat(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> renameFile(Mime::Url const&, Mime::Url const&) {
+    return Error::notImplemented("renaming files not supported");
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 SystemTime now() {
@@ -409,6 +421,12 @@ Instant instant() {
     return Instant{now()._value};
 }
 
+// MARK: Entropy ---------------------------------------------------------------
+
+Res<> fillRandom(MutBytes) {
+    return Error::notImplemented("no entropy source");
+}
+
 // MARK: System Informations ---------------------------------------------------
 
 Res<> populate(SysInfo&) {
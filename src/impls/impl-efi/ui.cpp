@@ -47,7 +47,7 @@ struct EfiHost :
     }
 };
 
-Res<Rc<Host>> makeHost(Child root) {
+Res<Rc<Host>> makeHost(Child root, HostProps) {
     auto* stip = try$(Efi::locateProtocol<Efi::SimpleTextInputProtocol>());
     auto* gop = try$(Efi::locateProtocol<Efi::GraphicsOutputProtocol>());
     auto* mode = gop->mode;
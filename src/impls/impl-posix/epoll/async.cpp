@@ -1,3 +1,5 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
 #include <karm-async/promise.h>
@@ -6,6 +8,8 @@
 #include <karm-sys/async.h>
 #include <karm-sys/time.h>
 #include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
 
@@ -26,9 +30,14 @@ struct EpollSched : public Sys::Sched {
         auto promise = Async::Promise<>();
         auto future = promise.future();
 
+        // NOTE: Waits are one-shot, the fd stays registered once it fired
+        //       and the next wait on it re-arms it.
+        ev.events |= EPOLLONESHOT;
         ev.data.u64 = id;
-        if (::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
-            panic("epoll_ctl");
+        if (::epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+            if (errno != ENOENT or ::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+                panic("epoll_ctl");
+        }
 
         _promises.put(id, std::move(promise));
         return Async::makeTask(future);
@@ -39,9 +48,42 @@ struct EpollSched : public Sys::Sched {
         co_return Ok(co_try$(fd->read(buf)));
     }
 
+    // Descriptors are blocking unless whoever opened them said otherwise,
+    // and being writable only means that some bytes fit. Writes are done
+    // non-blocking so that a full buffer re-arms the wait instead of
+    // stalling every other task on the scheduler.
+    template <typename F>
+    static auto _nonBlocking(int fd, F f) {
+        int flags = ::fcntl(fd, F_GETFL);
+        bool toggle = flags >= 0 and not(flags & O_NONBLOCK);
+        if (toggle)
+            ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+        errno = 0;
+        auto res = f();
+        int err = errno;
+
+        if (toggle)
+            ::fcntl(fd, F_SETFL, flags);
+        errno = err;
+        return res;
+    }
+
+    static bool _wouldBlock() {
+        return errno == EAGAIN or errno == EWOULDBLOCK;
+    }
+
     Async::Task<usize> writeAsync(Rc<Fd> fd, Bytes buf) override {
-        co_trya$(waitFor({.events = EPOLLOUT | EPOLLET, .data = {}}, fd->handle().value()));
-        co_return Ok(co_try$(fd->write(buf)));
+        int raw = fd->handle().value();
+        while (true) {
+            co_trya$(waitFor({.events = EPOLLOUT | EPOLLET, .data = {}}, raw));
+            auto res = _nonBlocking(raw, [&] {
+                return fd->write(buf);
+            });
+            if (not res and _wouldBlock())
+                continue;
+            co_return res;
+        }
     }
 
     Async::Task<> flushAsync(Rc<Fd> fd) override {
@@ -64,6 +106,42 @@ struct EpollSched : public Sys::Sched {
         co_return Ok(co_try$(fd->recv(buf, hnds)));
     }
 
+    Async::Task<usize> sendFileAsync(Rc<Fd> out, Rc<Fd> in, usize off, usize len) override {
+        int outFd = out->handle().value();
+        int inFd = in->handle().value();
+
+        // NOTE: Regular files are always ready and can't be watched with
+        //       epoll, between two of them copy_file_range() lets the
+        //       filesystem share or offload the data.
+        struct stat outStat{};
+        if (::fstat(outFd, &outStat) == 0 and S_ISREG(outStat.st_mode)) {
+            loff_t pos = off;
+            isize n = ::copy_file_range(inFd, &pos, outFd, nullptr, len, 0);
+            // Not every pair of filesystems supports it, sendfile() does
+            if (n < 0 and (errno == EXDEV or errno == EINVAL or errno == ENOSYS or errno == EOPNOTSUPP)) {
+                off_t sendPos = off;
+                n = ::sendfile(outFd, inFd, &sendPos, len);
+            }
+            if (n < 0)
+                co_return Posix::fromLastErrno();
+            co_return Ok((usize)n);
+        }
+
+        // NOTE: Like writeAsync(), this sends what fits after a single wake.
+        while (true) {
+            co_trya$(waitFor({.events = EPOLLOUT | EPOLLET, .data = {}}, outFd));
+            off_t pos = off;
+            isize n = _nonBlocking(outFd, [&] {
+                return ::sendfile(outFd, inFd, &pos, len);
+            });
+            if (n < 0 and _wouldBlock())
+                continue;
+            if (n < 0)
+                co_return Posix::fromLastErrno();
+            co_return Ok((usize)n);
+        }
+    }
+
     Async::Task<> sleepAsync(Instant until) override {
         Instant instant = Sys::instant();
         Duration delta = Duration::zero();
@@ -79,6 +157,10 @@ struct EpollSched : public Sys::Sched {
 
         itimerspec spec{};
         spec.it_value = Posix::toTimespec(delta);
+        // NOTE: A zero timer is a disarmed one, sleeping until a time that
+        //       already passed still has to go through the scheduler.
+        if (spec.it_value.tv_sec == 0 and spec.it_value.tv_nsec == 0)
+            spec.it_value.tv_nsec = 1;
         if (timerfd_settime(timeFd, 0, &spec, nullptr) < 0)
             co_return Posix::fromLastErrno();
 
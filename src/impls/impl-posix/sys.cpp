@@ -3,8 +3,10 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/random.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -129,9 +131,11 @@ Res<Pair<Rc<Fd>>> createPipe() {
     if (::pipe(fds) < 0)
         return Posix::fromLastErrno();
 
+    // NOTE: pipe() gives the read end first, Sys::Pipe wants the end
+    //       data goes in first.
     return Ok(Pair<Rc<Fd>>{
-        makeRc<Posix::Fd>(fds[0]),
         makeRc<Posix::Fd>(fds[1]),
+        makeRc<Posix::Fd>(fds[0]),
     });
 }
 
@@ -183,6 +187,13 @@ Res<Vec<DirEntry>> readDir(Mime::Url const& url) {
     return Ok(entries);
 }
 
+Res<> createDir(Mime::Url const& url) {
+    String str = try$(resolve(url)).str();
+    if (::mkdir(str.buf(), 0755) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 Res<Stat> stat(Mime::Url const& url) {
     String str = try$(resolve(url)).str();
     struct stat buf;
@@ -191,6 +202,14 @@ Res<Stat> stat(Mime::Url const& url) {
     return Ok(Posix::fromStat(buf));
 }
 
+Res<> renameFile(Mime::Url const& from, Mime::Url const& to) {
+    String src = try$(resolve(from)).str();
+    String dst = try$(resolve(to)).str();
+    if (::rename(src.buf(), dst.buf()) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Intent intent) {
@@ -324,6 +343,19 @@ Duration uptime() {
     return fromTimeSpec(ts);
 }
 
+// MARK: Entropy ---------------------------------------------------------------
+
+Res<> fillRandom(MutBytes bytes) {
+    // NOTE: getentropy() hands out at most 256 bytes at a time.
+    while (bytes.len()) {
+        usize n = min(bytes.len(), 256uz);
+        if (getentropy(bytes.buf(), n) < 0)
+            return Posix::fromLastErrno();
+        bytes = mutNext(bytes, n);
+    }
+    return Ok();
+}
+
 // MARK: Memory Managment ------------------------------------------------------
 
 isize mmapOptionsToProt(MmapOptions const& options) {
@@ -384,6 +416,25 @@ Res<> memFlush(void* flush, usize len) {
     return Ok();
 }
 
+Res<Rc<Fd>> createShm(usize size) {
+    static usize id = 0;
+    auto name = Io::format("/karm-shm-{}-{}", getpid(), id++);
+
+    int raw = shm_open(name.buf(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (raw < 0)
+        return Posix::fromLastErrno();
+
+    // NOTE: The memory lives as long as a fd or a mapping refers to it,
+    //       the name is only needed to create it.
+    shm_unlink(name.buf());
+
+    auto fd = makeRc<Posix::Fd>(raw);
+    if (ftruncate(raw, size) < 0)
+        return Posix::fromLastErrno();
+
+    return Ok(fd);
+}
+
 Res<> populate(SysInfo& infos) {
     struct utsname uts;
     if (uname(&uts) < 0)
@@ -1,9 +1,12 @@
 
+#include <fcntl.h>
 #include <liburing.h>
+#include <unistd.h>
 //
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
 #include <karm-async/promise.h>
+#include <karm-base/defer.h>
 #include <karm-base/map.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
@@ -79,7 +82,9 @@ struct UringSched : public Sys::Sched {
                 : _fd(fd), _buf(buf) {}
 
             void submit(io_uring_sqe* sqe) override {
-                io_uring_prep_read(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), 0);
+                // NOTE: -1 reads from the current position, like read() does,
+                //       so files are read through rather than from the start.
+                io_uring_prep_read(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), -1);
             }
 
             void complete(io_uring_cqe* cqe) override {
@@ -110,7 +115,7 @@ struct UringSched : public Sys::Sched {
                 : _fd(fd), _buf(buf) {}
 
             void submit(io_uring_sqe* sqe) override {
-                io_uring_prep_write(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), 0);
+                io_uring_prep_write(sqe, _fd->handle().value(), _buf.buf(), _buf.len(), -1);
             }
 
             void complete(io_uring_cqe* cqe) override {
@@ -282,6 +287,77 @@ struct UringSched : public Sys::Sched {
         return Async::makeTask(job->future());
     }
 
+    Async::Task<usize> _spliceAsync(int in, i64 inOff, int out, usize len) {
+        struct Job : public _Job {
+            int _in;
+            i64 _inOff;
+            int _out;
+            usize _len;
+            Async::Promise<usize> _promise;
+
+            Job(int in, i64 inOff, int out, usize len)
+                : _in(in), _inOff(inOff), _out(out), _len(len) {}
+
+            void submit(io_uring_sqe* sqe) override {
+                io_uring_prep_splice(sqe, _in, _inOff, _out, -1, _len, SPLICE_F_MOVE);
+            }
+
+            void complete(io_uring_cqe* cqe) override {
+                auto res = cqe->res;
+                if (res < 0)
+                    _promise.resolve(Posix::fromErrno(-cqe->res));
+                else
+                    _promise.resolve(Ok(cqe->res));
+            }
+
+            auto future() {
+                return _promise.future();
+            }
+        };
+
+        auto job = makeRc<Job>(in, inOff, out, len);
+        submit(job);
+        return Async::makeTask(job->future());
+    }
+
+    Async::Task<usize> sendFileAsync(Rc<Fd> out, Rc<Fd> in, usize off, usize len) override {
+        // NOTE: splice() needs a pipe on one side, the file is moved into
+        //       one and then out to the socket, the data never reaches user
+        //       space. Each transfer gets its own pipe so concurrent ones
+        //       don't interleave.
+        int pipe[2];
+        if (::pipe2(pipe, O_CLOEXEC) < 0)
+            co_return Posix::fromLastErrno();
+        Defer defer{[&] {
+            close(pipe[0]);
+            close(pipe[1]);
+        }};
+
+        // A bigger pipe means fewer round trips, keep the default if the
+        // system doesn't allow it.
+        (void)::fcntl(pipe[1], F_SETPIPE_SZ, 1024 * 1024);
+        isize chunk = ::fcntl(pipe[1], F_GETPIPE_SZ);
+        if (chunk <= 0)
+            chunk = 64 * 1024;
+
+        usize sent = 0;
+        while (sent < len) {
+            auto n = co_trya$(_spliceAsync(in->handle().value(), off + sent, pipe[1], min(len - sent, (usize)chunk)));
+            if (n == 0)
+                break;
+
+            usize drained = 0;
+            while (drained < n) {
+                auto m = co_trya$(_spliceAsync(pipe[0], -1, out->handle().value(), n - drained));
+                if (m == 0)
+                    co_return Error::writeZero("connection closed while sending file");
+                drained += m;
+            }
+            sent += n;
+        }
+        co_return Ok(sent);
+    }
+
     Async::Task<> sleepAsync(Instant until) override {
         struct Job : public _Job {
             Instant _until;
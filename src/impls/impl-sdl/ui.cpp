@@ -15,8 +15,15 @@ struct SdlHost :
     Math::Vec2i _lastMousePos{};
     Math::Vec2i _lastScreenMousePos{};
 
-    SdlHost(Child root, SDL_Window* window)
-        : Host(root), _window(window) {
+    // When headless, nothing is displayed and no events are coming, every
+    // frame is repainted to measure paint and present throughput.
+    Opt<usize> _headlessFrames;
+    usize _frames = 0;
+    usize _presentedBytes = 0;
+    Instant _headlessStart{};
+
+    SdlHost(Child root, SDL_Window* window, Opt<usize> headlessFrames)
+        : Host(root), _window(window), _headlessFrames(headlessFrames) {
     }
 
     ~SdlHost() {
@@ -31,7 +38,7 @@ struct SdlHost :
         return {w, h};
     }
 
-    f64 dpi() {
+    f64 dpi() override {
         return pixels().width() / (f64)bound().width;
     }
 
@@ -48,8 +55,40 @@ struct SdlHost :
         };
     }
 
-    void flip(Slice<Math::Recti>) override {
-        SDL_UpdateWindowSurface(_window);
+    void flip(Slice<Math::Recti> regions) override {
+        auto surfaceBound = pixels().bound();
+        f64 scale = dpi();
+
+        Vec<SDL_Rect> rects;
+        for (auto r : regions) {
+            // NOTE: Regions are in window coordinates, while the surface
+            //       might be larger on high dpi displays.
+            auto start = Math::Vec2i{
+                (isize)__builtin_floor(r.x * scale),
+                (isize)__builtin_floor(r.y * scale),
+            };
+            auto end = Math::Vec2i{
+                (isize)__builtin_ceil((r.x + r.width) * scale),
+                (isize)__builtin_ceil((r.y + r.height) * scale),
+            };
+
+            auto clipped = surfaceBound.clipTo(Math::Recti::fromTwoPoint(start, end));
+            if (clipped.width <= 0 or clipped.height <= 0)
+                continue;
+
+            rects.pushBack({
+                (int)clipped.x,
+                (int)clipped.y,
+                (int)clipped.width,
+                (int)clipped.height,
+            });
+            _presentedBytes += clipped.width * clipped.height * 4;
+        }
+
+        if (rects.len() == 0)
+            return;
+
+        SDL_UpdateWindowSurfaceRects(_window, rects.buf(), rects.len());
     }
 
     static App::Key _fromSdlKeycode(SDL_Keycode sdl) {
@@ -515,7 +554,31 @@ struct SdlHost :
         g.pop();
     }
 
+    Res<> _waitHeadless(usize frames) {
+        if (_frames == 0)
+            _headlessStart = Sys::instant();
+
+        if (_frames == frames) {
+            auto elapsed = Sys::instant() - _headlessStart;
+            f64 secs = elapsed.toUSecs() / 1e6;
+            logInfo(
+                "headless: {} frames in {} ({} fps, {} MiB/s presented)",
+                _frames, elapsed, _frames / secs,
+                _presentedBytes / (1024.0 * 1024.0) / secs
+            );
+            _res = Ok();
+            return Ok();
+        }
+
+        _frames++;
+        _dirty.pushBack(bound());
+        return Ok();
+    }
+
     Res<> wait(Instant ts) override {
+        if (_headlessFrames)
+            return _waitHeadless(*_headlessFrames);
+
         // HACK: Since we don't have a lot of control onto how SDL wait for
         //       events we can't integrate it properly with our event loop
         //       To remedi this we will just cap how long we wait, this way
@@ -618,7 +681,12 @@ static Res<> _setWindowIcon(SDL_Window* window) {
     return Ok();
 }
 
-Res<Rc<Host>> makeHost(Child root) {
+Res<Rc<Host>> makeHost(Child root, HostProps props) {
+    // NOTE: A headless host paints to an offscreen window, whatever video
+    //       driver the environment asks for.
+    if (props.headlessFrames)
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
 
     auto size = root->size({1024, 720}, Hint::MIN);
@@ -639,7 +707,7 @@ Res<Rc<Host>> makeHost(Child root) {
     if (not iconRes)
         logWarn("could not set window icon: {}", iconRes);
 
-    auto host = makeRc<SdlHost>(root, window);
+    auto host = makeRc<SdlHost>(root, window, props.headlessFrames);
 
     SDL_SetWindowHitTest(window, _hitTestCallback, (void*)&host.unwrap());
 
@@ -53,10 +53,18 @@ Res<Vec<Sys::DirEntry>> readDir(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> createDir(Mime::Url const&) {
+    return Error::notImplemented("creating directories not supported");
+}
+
 Res<Stat> stat(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> renameFile(Mime::Url const&, Mime::Url const&) {
+    return Error::notImplemented("renaming files not supported");
+}
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Intent) {
@@ -78,7 +86,7 @@ Res<Rc<Sys::Fd>> listenTcp(SocketAddr) {
 }
 
 Res<Rc<Sys::Fd>> listenUdp(SocketAddr) {
-    notImplemented();
+    return Error::notImplemented("udp sockets not supported");
 }
 
 Res<Rc<Sys::Fd>> listenIpc(Mime::Url) {
@@ -101,6 +109,12 @@ Duration uptime() {
     notImplemented();
 }
 
+// MARK: Entropy ---------------------------------------------------------------
+
+Res<> fillRandom(MutBytes) {
+    return Error::notImplemented("no entropy source");
+}
+
 // MARK: Memory Managment ------------------------------------------------------
 
 Res<Sys::MmapResult> memMap(Sys::MmapOptions const&) {
@@ -130,6 +144,12 @@ Res<> memFlush(void*, usize) {
     notImplemented();
 }
 
+Res<Rc<Sys::Fd>> createShm(usize size) {
+    auto vmo = try$(Hj::Vmo::create(Hj::ROOT, 0, size, Hj::VmoFlags::UPPER));
+    try$(vmo.label("shm"));
+    return Ok(makeRc<Skift::VmoFd>(std::move(vmo)));
+}
+
 // MARK: System Informations ---------------------------------------------------
 
 Res<> populate(Sys::SysInfo&) {
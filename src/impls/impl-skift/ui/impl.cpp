@@ -4,7 +4,7 @@
 
 namespace Karm::Ui::_Embed {
 
-Res<Rc<Host>> makeHost(Child) {
+Res<Rc<Host>> makeHost(Child, HostProps) {
     notImplemented();
 }
 
@@ -19,7 +19,7 @@ struct Host : public Ui::ProxyNode<Host> {
 
 Async::Task<> runAsync(Sys::Context& ctx, Child root) {
     auto endpoint = Rpc::Endpoint::create(ctx);
-    auto shell = co_trya$(endpoint.callAsync<Grund::Bus::Api::Locate>(Rpc::Port::BUS, "grund-shell"s));
+    auto shell = co_trya$(endpoint.callAsync<Grund::Bus::Api::Locate>(Rpc::Port::BUS, "grund-shell"s, true));
     auto size = root->size({1024, 720}, Hint::MIN);
     auto surface = co_trya$(endpoint.callAsync<Grund::Shell::Api::CreateInstance>(shell, size));
 
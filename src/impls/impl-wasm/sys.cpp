@@ -97,10 +97,18 @@ Res<Vec<DirEntry>> readDir(Mime::Url const&) {
     return Error::notImplemented("directory listing not supported");
 }
 
+Res<> createDir(Mime::Url const&) {
+    return Error::notImplemented("creating directories not supported");
+}
+
 Res<Stat> stat(Mime::Url const&) {
     return Error::notImplemented("directory listing not supported");
 }
 
+Res<> renameFile(Mime::Url const&, Mime::Url const&) {
+    return Error::notImplemented("renaming files not supported");
+}
+
 // MARK: File I/O --------------------------------------------------------------
 
 Res<Rc<Fd>> openFile(Mime::Url const&) {
@@ -133,6 +141,12 @@ Res<Rc<Fd>> listenIpc(Mime::Url) {
     return Error::notImplemented("ipc sockets not supported");
 }
 
+// MARK: Entropy ---------------------------------------------------------------
+
+Res<> fillRandom(MutBytes) {
+    return Error::notImplemented("no entropy source");
+}
+
 // MARK: Memory Managment ------------------------------------------------------
 
 Res<MmapResult> memMap(MmapOptions const&, Rc<Fd>) {
@@ -143,6 +157,10 @@ Res<> memUnmap(void const*, usize) {
     return Error::notImplemented();
 }
 
+Res<Rc<Sys::Fd>> createShm(usize) {
+    return Error::notImplemented("shared memory not supported");
+}
+
 // MARK: System Informations ---------------------------------------------------
 
 Res<> populate(Sys::SysInfo&) {
@@ -257,6 +257,37 @@ struct Channel : public Object {
         try$(_recv(_cap, buf.buf(), &bufLen, caps.buf(), &capLen));
         return Ok<SentRecv>(bufLen, capLen);
     }
+
+    Res<SentRecv> sendv(Slice<IoVec> iov, Slice<Cap> caps) {
+        try$(_sendv(_cap, iov.buf(), iov.len(), caps.buf(), caps.len()));
+
+        usize bufLen = 0;
+        for (auto& v : iov)
+            bufLen += v.len;
+        return Ok<SentRecv>(bufLen, caps.len());
+    }
+
+    Res<SentRecv> recvv(Slice<IoVec> iov, MutSlice<Cap> caps) {
+        usize bufLen = 0;
+        usize capLen = caps.len();
+        try$(_recvv(_cap, iov.buf(), iov.len(), &bufLen, caps.buf(), &capLen));
+        return Ok<SentRecv>(bufLen, capLen);
+    }
+
+    // Receive as many queued messages as fit, they are stored back to back
+    // in `buf` and `caps`, and described by `msgs`.
+    Res<usize> recvb(MutBytes buf, MutSlice<Cap> caps, MutSlice<SentRecv> msgs) {
+        RecvBatch batch = {
+            buf.buf(),
+            buf.len(),
+            caps.buf(),
+            caps.len(),
+            msgs.buf(),
+            msgs.len(),
+        };
+        try$(_recvb(_cap, &batch));
+        return Ok(batch.msgsLen);
+    }
 };
 
 struct Irq : public Object {
@@ -124,6 +124,18 @@ Res<> _recv(Cap cap, Byte* buf, usize* bufLen, Cap* caps, usize* capLen) {
     return _syscall(Syscall::RECV, cap.raw(), (Arg)buf, (Arg)bufLen, (Arg)caps, (Arg)capLen);
 }
 
+Res<> _sendv(Cap cap, IoVec const* iov, usize iovLen, Cap const* caps, usize capLen) {
+    return _syscall(Syscall::SENDV, cap.raw(), (Arg)iov, iovLen, (Arg)caps, capLen);
+}
+
+Res<> _recvv(Cap cap, IoVec const* iov, usize iovLen, usize* bufLen, Cap* caps, usize* capLen) {
+    return _syscall(Syscall::RECVV, cap.raw(), (Arg)iov, iovLen, (Arg)bufLen, (Arg)caps, (Arg)capLen);
+}
+
+Res<> _recvb(Cap cap, RecvBatch* batch) {
+    return _syscall(Syscall::RECVB, cap.raw(), (Arg)batch);
+}
+
 Res<> _close(Cap cap) {
     return _syscall(Syscall::CLOSE, cap.raw());
 }
@@ -32,6 +32,12 @@ Res<> _send(Cap cap, Byte const* buf, usize bufLen, Cap const* caps, usize capLe
 
 Res<> _recv(Cap cap, Byte* buf, usize* bufLen, Cap* caps, usize* capLen);
 
+Res<> _sendv(Cap cap, IoVec const* iov, usize iovLen, Cap const* caps, usize capLen);
+
+Res<> _recvv(Cap cap, IoVec const* iov, usize iovLen, usize* bufLen, Cap* caps, usize* capLen);
+
+Res<> _recvb(Cap cap, RecvBatch* batch);
+
 Res<> _close(Cap cap);
 
 Res<> _signal(Cap cap, Flags<Sigs> set, Flags<Sigs> unset);
@@ -59,7 +59,10 @@ static inline char const* toStr(Type type) {
     SYSCALL(CLOSE)               \
     SYSCALL(SIGNAL)              \
     SYSCALL(LISTEN)              \
-    SYSCALL(POLL)
+    SYSCALL(POLL)                \
+    SYSCALL(SENDV)               \
+    SYSCALL(RECVV)               \
+    SYSCALL(RECVB)
 
 // clang-format off
 
@@ -259,6 +262,25 @@ struct SentRecv {
     usize caps;
 };
 
+// A segment of a scattered message, see _sendv() and _recvv()
+struct IoVec {
+    Byte* buf;
+    usize len;
+};
+
+static constexpr usize IOV_MAX = 16;
+
+// Where to store the messages drained by _recvb(), the lengths are updated
+// with what was actually received.
+struct RecvBatch {
+    Byte* buf;
+    usize bufLen;
+    Cap* caps;
+    usize capsLen;
+    SentRecv* msgs;
+    usize msgsLen;
+};
+
 struct ChannelProps {
     static constexpr Type TYPE = Type::CHANNEL;
     usize bufCap;  //< The capacity of the data buffer (in bytes, must be >= 1)
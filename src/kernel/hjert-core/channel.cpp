@@ -6,6 +6,12 @@
 namespace Hjert::Core {
 
 Res<Arc<Channel>> Channel::create(usize bufCap, usize capsCap) {
+    if (bufCap == 0 or bufCap > MAX_BUF_CAP)
+        return Error::invalidInput("invalid buffer capacity");
+
+    if (capsCap > MAX_CAPS_CAP)
+        return Error::invalidInput("invalid caps capacity");
+
     return Ok(makeArc<Channel>(bufCap, capsCap));
 }
 
@@ -34,14 +40,22 @@ void Channel::_updateSignalsUnlock() {
 }
 
 Res<Hj::SentRecv> Channel::send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps) {
+    return sendv(dom, {&bytes, 1}, caps);
+}
+
+Res<Hj::SentRecv> Channel::sendv(Domain& dom, Slice<Bytes> iov, Slice<Hj::Cap> caps) {
     ObjectLockScope scope{*this};
     try$(_ensureOpen());
 
+    usize len = 0;
+    for (auto& seg : iov)
+        len += seg.len();
+
     // Make sure everything is ready for the message
     if (_sr.rem() < 1)
         return Error::invalidInput("not enough space for message");
 
-    if (_bytes.rem() < bytes.len())
+    if (_bytes.rem() < len)
         return Error::invalidInput("not enough space for bytes");
 
     if (_caps.rem() < caps.len())
@@ -59,27 +73,26 @@ Res<Hj::SentRecv> Channel::send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps) {
         _caps.pushBack(res.unwrap());
     }
 
-    for (usize i = 0; i < bytes.len(); i++)
-        _bytes.pushBack(bytes[i]);
+    for (auto& seg : iov)
+        _bytes.pushBack(seg);
 
-    _sr.pushBack({bytes.len(), caps.len()});
+    _sr.pushBack({len, caps.len()});
 
     _updateSignalsUnlock();
-    return Ok<Hj::SentRecv>(bytes.len(), caps.len());
+    return Ok<Hj::SentRecv>(len, caps.len());
 }
 
-Res<Hj::SentRecv> Channel::recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps) {
-    ObjectLockScope scope{*this};
-    try$(_ensureOpen());
-
-    ObjectLockScope domScope{dom};
-
+Res<Hj::SentRecv> Channel::_recvUnlock(Domain& dom, Slice<MutBytes> iov, MutSlice<Hj::Cap> caps) {
     // Make sure everything is ready for the message
     if (_sr.len() == 0)
         return Error::wouldBlock("no messages available");
 
-    auto& [expectedBytes, expectedCaps] = _sr.peek(0);
-    if (bytes.len() < expectedBytes)
+    usize len = 0;
+    for (auto& seg : iov)
+        len += seg.len();
+
+    auto [expectedBytes, expectedCaps] = _sr.peek(0);
+    if (len < expectedBytes)
         return Error::invalidInput("not enough space for bytes");
 
     if (caps.len() < expectedCaps)
@@ -91,17 +104,67 @@ Res<Hj::SentRecv> Channel::recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> c
     // Everything is ready, let's receive the message
     _sr.popFront();
 
-    for (usize i = 0; i < expectedBytes; i++)
-        bytes[i] = _bytes.popFront();
+    usize rem = expectedBytes;
+    for (auto seg : iov) {
+        usize n = min(rem, seg.len());
+        _bytes.popFront(MutBytes{seg.buf(), n});
+        rem -= n;
+    }
 
     for (usize i = 0; i < expectedCaps; i++)
         // NOTE: We unwrap here because we know that the domain has enough space
         caps[i] = dom.add(Hj::ROOT, _caps.popFront()).unwrap("domain full");
 
-    _updateSignalsUnlock();
     return Ok<Hj::SentRecv>(expectedBytes, expectedCaps);
 }
 
+Res<Hj::SentRecv> Channel::recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps) {
+    return recvv(dom, {&bytes, 1}, caps);
+}
+
+Res<Hj::SentRecv> Channel::recvv(Domain& dom, Slice<MutBytes> iov, MutSlice<Hj::Cap> caps) {
+    ObjectLockScope scope{*this};
+    try$(_ensureOpen());
+
+    ObjectLockScope domScope{dom};
+
+    auto res = try$(_recvUnlock(dom, iov, caps));
+    _updateSignalsUnlock();
+    return Ok(res);
+}
+
+Res<usize> Channel::recvBatch(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps, MutSlice<Hj::SentRecv> msgs) {
+    ObjectLockScope scope{*this};
+    try$(_ensureOpen());
+
+    ObjectLockScope domScope{dom};
+
+    usize n = 0;
+    while (n < msgs.len() and _sr.len() > 0) {
+        MutBytes seg = bytes;
+        auto res = _recvUnlock(dom, {&seg, 1}, caps);
+
+        // Stop at the first message that doesn't fit, it will be picked
+        // up by the next call.
+        if (not res) {
+            if (n == 0)
+                return res.none();
+            break;
+        }
+
+        auto sr = res.unwrap();
+        bytes = mutNext(bytes, sr.bytes);
+        caps = mutNext(caps, sr.caps);
+        msgs[n++] = sr;
+    }
+
+    if (n == 0)
+        return Error::wouldBlock("no messages available");
+
+    _updateSignalsUnlock();
+    return Ok(n);
+}
+
 Res<> Channel::close() {
     ObjectLockScope scope{*this};
     _closed = true;
@@ -17,6 +17,9 @@ struct Channel :
     Ring<Byte> _bytes;
     Ring<Arc<Object>> _caps;
 
+    static constexpr usize MAX_BUF_CAP = 1024 * 1024;
+    static constexpr usize MAX_CAPS_CAP = 256;
+
     static Res<Arc<Channel>> create(usize bufCap = 4096, usize capsCap = 16);
 
     Channel(usize bufCap, usize capsCap);
@@ -27,8 +30,18 @@ struct Channel :
 
     Res<Hj::SentRecv> send(Domain& dom, Bytes bytes, Slice<Hj::Cap> caps);
 
+    Res<Hj::SentRecv> sendv(Domain& dom, Slice<Bytes> iov, Slice<Hj::Cap> caps);
+
+    Res<Hj::SentRecv> _recvUnlock(Domain& dom, Slice<MutBytes> iov, MutSlice<Hj::Cap> caps);
+
     Res<Hj::SentRecv> recv(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps);
 
+    Res<Hj::SentRecv> recvv(Domain& dom, Slice<MutBytes> iov, MutSlice<Hj::Cap> caps);
+
+    // Drain as many queued messages as fit in `bytes`, `caps` and `msgs`,
+    // stored back to back, returns the number of messages received.
+    Res<usize> recvBatch(Domain& dom, MutBytes bytes, MutSlice<Hj::Cap> caps, MutSlice<Hj::SentRecv> msgs);
+
     Res<> close();
 };
 
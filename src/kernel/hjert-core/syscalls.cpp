@@ -215,6 +215,88 @@ Res<> doRecv(Task& self, Hj::Cap cap, UserSlice<MutBytes> buf, User<Hj::Arg> buf
     );
 }
 
+// NOTE: Must be called with the space locked, the segments are only valid
+//       as long as the lock is held.
+template <typename S>
+static Res<Slice<S>> _acquireIov(Space& space, Slice<Hj::IoVec> iov, MutSlice<S> out) {
+    if (iov.len() > out.len())
+        return Error::invalidInput("too many segments");
+
+    for (usize i = 0; i < iov.len(); i++) {
+        // NOTE: Copy the segment so userspace can't change it under our feet
+        Hj::IoVec seg = iov[i];
+        if (seg.len) {
+            if (seg.buf == nullptr)
+                return Error::invalidInput("null pointer");
+            try$(space._validate(Hal::VmmRange{(usize)seg.buf, seg.len}));
+        }
+        out[i] = S{seg.buf, seg.len};
+    }
+
+    return Ok(sub(out, 0, iov.len()));
+}
+
+Res<> doSendv(Task& self, Hj::Cap cap, UserSlice<Slice<Hj::IoVec>> iov, UserSlice<Slice<Hj::Cap>> caps) {
+    return with(
+        self.space(),
+        [&](auto iov, auto caps) -> Res<> {
+            Array<Bytes, Hj::IOV_MAX> segs;
+            auto acquired = try$(_acquireIov<Bytes>(self.space(), iov, segs));
+
+            auto obj = try$(self.domain().get<Channel>(cap));
+            try$(obj->sendv(self.domain(), acquired, caps));
+            return Ok();
+        },
+        iov, caps
+    );
+}
+
+Res<> doRecvv(Task& self, Hj::Cap cap, UserSlice<Slice<Hj::IoVec>> iov, User<Hj::Arg> bufLen, UserSlice<MutSlice<Hj::Cap>> caps, User<Hj::Arg> capLen) {
+    return with(
+        self.space(),
+        [&](auto iov, auto bufLen, auto caps, auto capLen) -> Res<> {
+            Array<MutBytes, Hj::IOV_MAX> segs;
+            auto acquired = try$(_acquireIov<MutBytes>(self.space(), iov, segs));
+
+            auto obj = try$(self.domain().get<Channel>(cap));
+            auto msg = try$(obj->recvv(self.domain(), acquired, caps));
+
+            *bufLen = msg.bytes;
+            *capLen = msg.caps;
+            return Ok();
+        },
+        iov, bufLen, caps, capLen
+    );
+}
+
+Res<> doRecvb(Task& self, Hj::Cap cap, User<Hj::RecvBatch> batch) {
+    auto b = try$(batch.load(self.space()));
+
+    UserSlice<MutBytes> buf{(usize)b.buf, b.bufLen};
+    UserSlice<MutSlice<Hj::Cap>> caps{(usize)b.caps, b.capsLen};
+    UserSlice<MutSlice<Hj::SentRecv>> msgs{(usize)b.msgs, b.msgsLen};
+
+    try$(with(
+        self.space(),
+        [&](auto buf, auto caps, auto msgs) -> Res<> {
+            auto obj = try$(self.domain().get<Channel>(cap));
+            auto n = try$(obj->recvBatch(self.domain(), buf, caps, msgs));
+
+            b.bufLen = 0;
+            b.capsLen = 0;
+            for (usize i = 0; i < n; i++) {
+                b.bufLen += msgs[i].bytes;
+                b.capsLen += msgs[i].caps;
+            }
+            b.msgsLen = n;
+            return Ok();
+        },
+        buf, caps, msgs
+    ));
+
+    return batch.store(self.space(), b);
+}
+
 Res<> doClose(Task& self, Hj::Cap cap) {
     auto obj = try$(self.domain().get<Channel>(cap));
     return obj->close();
@@ -320,6 +402,28 @@ Res<> dispatchSyscall(Task& self, Hj::Syscall id, Hj::Args args) {
         );
     }
 
+    case Hj::Syscall::SENDV:
+        return doSendv(
+            self,
+            Hj::Cap{args[0]},
+            {args[1], args[2]},
+            {args[3], args[4]}
+        );
+
+    case Hj::Syscall::RECVV: {
+        User<Hj::Arg> capLen = args[5];
+
+        return doRecvv(
+            self,
+            Hj::Cap{args[0]},
+            {args[1], args[2]}, args[3],
+            {args[4], try$(capLen.load(self.space()))}, args[5]
+        );
+    }
+
+    case Hj::Syscall::RECVB:
+        return doRecvb(self, Hj::Cap{args[0]}, args[1]);
+
     case Hj::Syscall::CLOSE:
         return doClose(self, Hj::Cap{args[0]});
 
@@ -0,0 +1,91 @@
+#include <karm-archive/deflate.h>
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+// Compress a mix of the kind of data the archive writers get, text, drawing
+// operators like in PDF content streams, image rows and incompressible
+// bytes, and report the ratio and speed of each level.
+
+static constexpr usize PART_SIZE = 4 * 1024 * 1024;
+static constexpr usize ROUNDS = 4;
+
+static void _text(Io::BufferWriter& out) {
+    Array<Str, 8> words = {"the "s, "quick "s, "brown "s, "fox "s, "jumps "s, "over "s, "lazy "s, "dog.\n"s};
+    u32 state = 1;
+    usize start = out.bytes().len();
+    while (out.bytes().len() - start < PART_SIZE) {
+        state = state * 1103515245 + 12345;
+        (void)out.write(bytes(words[(state >> 16) % words.len()]));
+    }
+}
+
+static void _operators(Io::BufferWriter& out) {
+    u32 state = 7;
+    usize start = out.bytes().len();
+    while (out.bytes().len() - start < PART_SIZE) {
+        state = state * 1103515245 + 12345;
+        auto x = (state >> 8) % 600;
+        auto y = (state >> 18) % 800;
+        auto line = Io::format("{} {} m {} {} l S\n", x, y, x + 12, y);
+        (void)out.write(bytes(line));
+    }
+}
+
+static void _pixels(Io::BufferWriter& out) {
+    // A smooth gradient with a bit of noise, like a photo row by row
+    u32 state = 3;
+    for (usize i = 0; i < PART_SIZE; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        Byte b = (i / 16) % 256 + (state & 3);
+        (void)out.write({&b, 1});
+    }
+}
+
+static void _noise(Io::BufferWriter& out) {
+    u32 state = 0x12345678;
+    for (usize i = 0; i < PART_SIZE; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        Byte b = state;
+        (void)out.write({&b, 1});
+    }
+}
+
+static Res<> _bench(Str name, Bytes data, Archive::DeflateLevel level) {
+    usize compressed = 0;
+    auto start = Sys::instant();
+    for (usize i = 0; i < ROUNDS; i++) {
+        Io::Sink sink;
+        Io::Count count{sink};
+        Archive::Deflate deflate{count, level};
+        try$(deflate.write(data));
+        try$(deflate.finish());
+        compressed = try$(Io::tell(count));
+    }
+    auto elapsed = Sys::instant() - start;
+
+    f64 secs = elapsed.toUSecs() / 1e6;
+    f64 throughput = (data.len() * ROUNDS / (1024.0 * 1024.0)) / secs;
+    f64 ratio = (f64)data.len() / compressed;
+    Sys::println("{}: {} -> {} bytes, ratio {}, {} MiB/s", name, data.len(), compressed, ratio, throughput);
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Io::BufferWriter corpus;
+    _text(corpus);
+    _operators(corpus);
+    _pixels(corpus);
+    _noise(corpus);
+
+    co_try$(_bench("fast"s, corpus.bytes(), Archive::DeflateLevel::FAST));
+    co_try$(_bench("default"s, corpus.bytes(), Archive::DeflateLevel::DEFAULT));
+    co_try$(_bench("best"s, corpus.bytes(), Archive::DeflateLevel::BEST));
+
+    co_return Ok();
+}
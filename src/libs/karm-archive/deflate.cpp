@@ -0,0 +1,595 @@
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+
+#include "deflate.h"
+
+namespace Karm::Archive {
+
+// MARK: Codes -----------------------------------------------------------------
+
+using _Code = Deflate::_Code;
+
+// The fixed literal/length code.
+static Array<_Code, Huffman::MAX_SYMBOLS> const& _fixedCodes() {
+    static Array<_Code, Huffman::MAX_SYMBOLS> const codes = [] {
+        Array<_Code, Huffman::MAX_SYMBOLS> codes;
+        for (u32 sym = 0; sym < codes.len(); sym++) {
+            if (sym < 144)
+                codes[sym] = {(u16)reverseBits(0x30 + sym, 8), 8};
+            else if (sym < 256)
+                codes[sym] = {(u16)reverseBits(0x190 + sym - 144, 9), 9};
+            else if (sym < 280)
+                codes[sym] = {(u16)reverseBits(sym - 256, 7), 7};
+            else
+                codes[sym] = {(u16)reverseBits(0xc0 + sym - 280, 8), 8};
+        }
+        return codes;
+    }();
+    return codes;
+}
+
+// The fixed distance code, five bits for each.
+static Array<_Code, Deflate::DIST_CODES> const& _fixedDistCodes() {
+    static Array<_Code, Deflate::DIST_CODES> const codes = [] {
+        Array<_Code, Deflate::DIST_CODES> codes;
+        for (u32 sym = 0; sym < codes.len(); sym++)
+            codes[sym] = {(u16)reverseBits(sym, 5), 5};
+        return codes;
+    }();
+    return codes;
+}
+
+// Index in LENGTH_BASE of a match length.
+static u8 _lengthSymbol(usize len) {
+    static Array<u8, Deflate::MAX_MATCH + 1> const table = [] {
+        Array<u8, Deflate::MAX_MATCH + 1> table = {};
+        for (u8 sym = 0; sym < LENGTH_BASE.len(); sym++)
+            for (usize n = LENGTH_BASE[sym]; n < LENGTH_BASE[sym] + (1u << LENGTH_EXTRA[sym]) and n <= Deflate::MAX_MATCH; n++)
+                table[n] = sym;
+        // 258 has a symbol of its own, rather than being 227 + 31
+        table[Deflate::MAX_MATCH] = LENGTH_BASE.len() - 1;
+        return table;
+    }();
+    return table[len];
+}
+
+// Index in DIST_BASE of a distance. Distances up to 256 are looked up
+// directly, longer ones by their top bits, which is enough since those
+// codes cover multiples of 128.
+static u8 _distSymbol(usize dist) {
+    static Array<u8, 512> const table = [] {
+        Array<u8, 512> table = {};
+        for (u8 sym = 0; sym < DIST_BASE.len(); sym++) {
+            for (usize d = DIST_BASE[sym]; d < DIST_BASE[sym] + (1u << DIST_EXTRA[sym]); d++) {
+                if (d <= 256)
+                    table[d - 1] = sym;
+                else
+                    table[256 + ((d - 1) >> 7)] = sym;
+            }
+        }
+        return table;
+    }();
+    return dist <= 256 ? table[dist - 1] : table[256 + ((dist - 1) >> 7)];
+}
+
+// MARK: Dynamic Codes ---------------------------------------------------------
+
+static constexpr usize CL_CODES = 19;
+static constexpr usize CL_MAX_BITS = 7;
+
+// Code lengths of a huffman code for `freqs`, none longer than `maxBits`.
+// When the optimal code is too deep the frequencies are halved, which
+// flattens the tree, until it fits.
+static void _codeLengths(Slice<u32> freqs, usize maxBits, MutSlice<u8> lengths) {
+    usize n = freqs.len();
+    Array<u32, Huffman::MAX_SYMBOLS> f = {};
+    usize used = 0;
+    for (usize sym = 0; sym < n; sym++) {
+        f[sym] = freqs[sym];
+        if (f[sym])
+            used++;
+    }
+
+    // NOTE: A code with a single symbol would be incomplete, which not
+    //       every decoder accepts.
+    for (usize sym = 0; used < 2 and sym < n; sym++) {
+        if (not f[sym]) {
+            f[sym] = 1;
+            used++;
+        }
+    }
+
+    while (true) {
+        // Symbols in use, by increasing frequency
+        Array<u16, Huffman::MAX_SYMBOLS> leaves;
+        usize count = 0;
+        for (usize sym = 0; sym < n; sym++) {
+            if (not f[sym])
+                continue;
+            usize i = count++;
+            while (i > 0 and f[leaves[i - 1]] > f[sym]) {
+                leaves[i] = leaves[i - 1];
+                i--;
+            }
+            leaves[i] = sym;
+        }
+
+        // Leaves come first, then the nodes merging them, which are made
+        // in order of increasing weight too, so the two lightest are always
+        // at the front of one or the other.
+        Array<u32, Huffman::MAX_SYMBOLS * 2> weight;
+        Array<u16, Huffman::MAX_SYMBOLS * 2> parent;
+        Array<u8, Huffman::MAX_SYMBOLS * 2> depth;
+        for (usize i = 0; i < count; i++)
+            weight[i] = f[leaves[i]];
+
+        usize leaf = 0;
+        usize node = count;
+        usize next = count;
+        auto pick = [&] {
+            if (leaf < count and (node == next or weight[leaf] <= weight[node]))
+                return leaf++;
+            return node++;
+        };
+
+        for (; next < count * 2 - 1; next++) {
+            auto a = pick();
+            auto b = pick();
+            weight[next] = weight[a] + weight[b];
+            parent[a] = next;
+            parent[b] = next;
+        }
+
+        // Parents always come after their children
+        usize root = count * 2 - 2;
+        depth[root] = 0;
+        usize deepest = 0;
+        for (usize i = root; i-- > 0;) {
+            depth[i] = depth[parent[i]] + 1;
+            deepest = max(deepest, (usize)depth[i]);
+        }
+
+        if (deepest <= maxBits) {
+            for (usize sym = 0; sym < n; sym++)
+                lengths[sym] = 0;
+            for (usize i = 0; i < count; i++)
+                lengths[leaves[i]] = depth[i];
+            return;
+        }
+
+        for (usize sym = 0; sym < n; sym++)
+            if (f[sym])
+                f[sym] = (f[sym] >> 1) | 1;
+    }
+}
+
+// Canonical codes for the given lengths, RFC 1951 3.2.2.
+static void _canonicalCodes(Slice<u8> lengths, MutSlice<_Code> codes) {
+    Array<u16, Huffman::MAX_BITS + 1> counts = {};
+    for (auto len : lengths)
+        counts[len]++;
+    counts[0] = 0;
+
+    Array<u16, Huffman::MAX_BITS + 1> nextCode = {};
+    u16 code = 0;
+    for (usize bits = 1; bits <= Huffman::MAX_BITS; bits++) {
+        code = (code + counts[bits - 1]) << 1;
+        nextCode[bits] = code;
+    }
+
+    for (usize sym = 0; sym < lengths.len(); sym++) {
+        auto len = lengths[sym];
+        codes[sym] = {len ? (u16)reverseBits(nextCode[len]++, len) : (u16)0, len};
+    }
+}
+
+// A code length, or one of the run-length codes 16 to 18 with its count.
+struct _LengthOp {
+    u8 sym;
+    u8 extra;
+};
+
+static constexpr Array<u8, CL_CODES> CL_EXTRA = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7
+};
+
+// The statistics of a block, and the code built for it.
+struct _Block {
+    Array<u32, Deflate::LIT_CODES> litFreqs = {};
+    Array<u32, Deflate::DIST_CODES> distFreqs = {};
+    // Bits taken by length and distance extras, whatever the code.
+    usize extraBits = 0;
+
+    Array<u8, Deflate::LIT_CODES + Deflate::DIST_CODES> lengths = {};
+    usize hlit = 257;
+    usize hdist = 1;
+
+    Array<_LengthOp, Deflate::LIT_CODES + Deflate::DIST_CODES> ops;
+    usize nops = 0;
+
+    Array<u8, CL_CODES> clLengths = {};
+    Array<_Code, CL_CODES> clCodes;
+    usize hclen = 4;
+
+    Array<_Code, Deflate::LIT_CODES> lit;
+    Array<_Code, Deflate::DIST_CODES> dist;
+
+    _Block(Slice<Deflate::_Token> tokens) {
+        for (auto& tok : tokens) {
+            if (tok.dist == 0) {
+                litFreqs[tok.len]++;
+                continue;
+            }
+
+            auto len = _lengthSymbol(tok.len);
+            auto dist = _distSymbol(tok.dist);
+            litFreqs[257 + len]++;
+            distFreqs[dist]++;
+            extraBits += LENGTH_EXTRA[len] + DIST_EXTRA[dist];
+        }
+        litFreqs[256] = 1;
+    }
+
+    usize fixedCost() const {
+        auto& codes = _fixedCodes();
+        usize bits = 3 + extraBits;
+        for (usize sym = 0; sym < litFreqs.len(); sym++)
+            bits += litFreqs[sym] * codes[sym].len;
+        for (auto freq : distFreqs)
+            bits += freq * 5;
+        return bits;
+    }
+
+    void build() {
+        auto litLengths = mutSub(lengths, 0, Deflate::LIT_CODES);
+        auto distLengths = mutSub(lengths, Deflate::LIT_CODES, lengths.len());
+        _codeLengths(litFreqs, Huffman::MAX_BITS, litLengths);
+        _codeLengths(distFreqs, Huffman::MAX_BITS, distLengths);
+        _canonicalCodes(litLengths, lit);
+        _canonicalCodes(distLengths, dist);
+
+        for (usize sym = hlit; sym < Deflate::LIT_CODES; sym++)
+            if (litLengths[sym])
+                hlit = sym + 1;
+        for (usize sym = 0; sym < Deflate::DIST_CODES; sym++)
+            if (distLengths[sym])
+                hdist = sym + 1;
+
+        // Both sets of lengths are sent back to back, so runs can span them
+        Array<u8, Deflate::LIT_CODES + Deflate::DIST_CODES> sent;
+        for (usize i = 0; i < hlit; i++)
+            sent[i] = litLengths[i];
+        for (usize i = 0; i < hdist; i++)
+            sent[hlit + i] = distLengths[i];
+        _runLengths(sub(sent, 0, hlit + hdist));
+
+        Array<u32, CL_CODES> clFreqs = {};
+        for (usize i = 0; i < nops; i++)
+            clFreqs[ops[i].sym]++;
+        _codeLengths(clFreqs, CL_MAX_BITS, clLengths);
+        _canonicalCodes(clLengths, clCodes);
+
+        hclen = CL_CODES;
+        while (hclen > 4 and clLengths[CODE_LENGTH_ORDER[hclen - 1]] == 0)
+            hclen--;
+    }
+
+    void _runLengths(Slice<u8> sent) {
+        usize i = 0;
+        while (i < sent.len()) {
+            u8 len = sent[i];
+            usize run = 1;
+            while (i + run < sent.len() and sent[i + run] == len)
+                run++;
+
+            if (len == 0) {
+                while (run >= 11) {
+                    usize n = min(run, 138uz);
+                    ops[nops++] = {18, (u8)(n - 11)};
+                    run -= n;
+                    i += n;
+                }
+                if (run >= 3) {
+                    ops[nops++] = {17, (u8)(run - 3)};
+                    i += run;
+                    run = 0;
+                }
+            } else {
+                ops[nops++] = {len, 0};
+                run--;
+                i++;
+                while (run >= 3) {
+                    usize n = min(run, 6uz);
+                    ops[nops++] = {16, (u8)(n - 3)};
+                    run -= n;
+                    i += n;
+                }
+            }
+
+            while (run) {
+                ops[nops++] = {len, 0};
+                run--;
+                i++;
+            }
+        }
+    }
+
+    usize dynamicCost() const {
+        usize bits = 3 + 5 + 5 + 4 + hclen * 3 + extraBits;
+        for (usize i = 0; i < nops; i++)
+            bits += clLengths[ops[i].sym] + CL_EXTRA[ops[i].sym];
+        for (usize sym = 0; sym < litFreqs.len(); sym++)
+            bits += litFreqs[sym] * lengths[sym];
+        for (usize sym = 0; sym < distFreqs.len(); sym++)
+            bits += distFreqs[sym] * lengths[Deflate::LIT_CODES + sym];
+        return bits;
+    }
+
+    void emitHeader(Deflate& d, bool final) const {
+        d._bitsOut(final, 1);
+        d._bitsOut(2, 2);
+        d._bitsOut(hlit - 257, 5);
+        d._bitsOut(hdist - 1, 5);
+        d._bitsOut(hclen - 4, 4);
+        for (usize i = 0; i < hclen; i++)
+            d._bitsOut(clLengths[CODE_LENGTH_ORDER[i]], 3);
+        for (usize i = 0; i < nops; i++) {
+            auto& op = ops[i];
+            d._bitsOut(clCodes[op.sym].bits, clCodes[op.sym].len);
+            d._bitsOut(op.extra, CL_EXTRA[op.sym]);
+        }
+    }
+};
+
+// MARK: Deflate ---------------------------------------------------------------
+
+Deflate::_Config Deflate::_configFor(DeflateLevel level) {
+    switch (level) {
+    case DeflateLevel::FAST:
+        return {1, 0, MAX_MATCH};
+    case DeflateLevel::DEFAULT:
+        return {128, 16, 128};
+    case DeflateLevel::BEST:
+        return {4096, MAX_MATCH, MAX_MATCH};
+    }
+    unreachable();
+}
+
+Deflate::Deflate(Io::Writer& out, DeflateLevel level)
+    : _out(out),
+      _config(_configFor(level)),
+      _buf(WINDOW_SIZE + BLOCK_SIZE),
+      _head(Buf<usize>::init(HASH_SIZE, 0)) {
+    if (_config.chain > 1)
+        _prev = Buf<usize>::init(WINDOW_SIZE, 0);
+}
+
+Res<usize> Deflate::write(Bytes bytes) {
+    if (_finished)
+        return Error::invalidInput("deflate stream already finished");
+
+    usize written = 0;
+    while (written < bytes.len()) {
+        usize n = min(bytes.len() - written, BLOCK_SIZE - (_buf.len() - _start));
+        _buf.insert(COPY, _buf.len(), bytes.buf() + written, n);
+        written += n;
+
+        if (_buf.len() - _start == BLOCK_SIZE)
+            try$(_compress(false));
+    }
+
+    _total += written;
+    return Ok(written);
+}
+
+Res<> Deflate::finish() {
+    if (_finished)
+        return Ok();
+    _finished = true;
+    return _compress(true);
+}
+
+Pair<usize> Deflate::_longest(usize pos, usize max) {
+    usize len = 0;
+    usize dist = 0;
+    if (max < MIN_MATCH)
+        return {len, dist};
+
+    usize seen = _insert(pos);
+    for (usize chain = _config.chain; seen and chain; chain--) {
+        // NOTE: Positions are kept relative to the whole stream, so
+        //       sliding the window doesn't have to touch the tables.
+        usize at = seen - 1;
+        if (at < _base or _base + pos - at >= WINDOW_SIZE)
+            break;
+
+        usize from = at - _base;
+        // A longer match has to differ from the best one on its last byte
+        if (_buf[from + len] == _buf[pos + len]) {
+            usize n = _matchLen(from, pos, max);
+            if (n > len) {
+                len = n;
+                dist = pos - from;
+                if (len >= _config.nice or len == max)
+                    break;
+            }
+        }
+
+        if (not _prev.len())
+            break;
+
+        // NOTE: Older entries are overwritten as the stream goes on, a
+        //       link that doesn't go back in the stream is one of those.
+        usize prev = _prev[at & (WINDOW_SIZE - 1)];
+        if (prev >= seen)
+            break;
+        seen = prev;
+    }
+
+    if (len < MIN_MATCH)
+        return {0, 0};
+    return {len, dist};
+}
+
+void Deflate::_matchGreedy() {
+    usize end = _buf.len();
+    usize pos = _start;
+    while (pos < end) {
+        auto [len, dist] = _longest(pos, min(MAX_MATCH, end - pos));
+
+        if (not len) {
+            _tokens.pushBack({_buf[pos], 0});
+            pos++;
+            continue;
+        }
+
+        _tokens.pushBack({(u16)len, (u16)dist});
+
+        // Later data may refer back to anything inside the match
+        for (usize i = 1; i < len and pos + i + MIN_MATCH <= end; i++)
+            _insert(pos + i);
+        pos += len;
+    }
+}
+
+void Deflate::_matchLazy() {
+    usize end = _buf.len();
+    usize pos = _start;
+
+    // The match found at the previous position, held back to see if this
+    // one has a longer one.
+    bool pending = false;
+    usize prevLen = 0;
+    usize prevDist = 0;
+
+    while (pos < end) {
+        usize len = 0;
+        usize dist = 0;
+        if (pending and prevLen >= _config.lazy) {
+            if (pos + MIN_MATCH <= end)
+                _insert(pos);
+        } else {
+            auto match = _longest(pos, min(MAX_MATCH, end - pos));
+            len = match.v0;
+            dist = match.v1;
+        }
+
+        if (pending and prevLen and len <= prevLen) {
+            _tokens.pushBack({(u16)prevLen, (u16)prevDist});
+
+            // The match started a byte back, `pos` is already in
+            for (usize i = 1; i + 1 < prevLen and pos + i + MIN_MATCH <= end; i++)
+                _insert(pos + i);
+            pos += prevLen - 1;
+            pending = false;
+            continue;
+        }
+
+        if (pending)
+            _tokens.pushBack({_buf[pos - 1], 0});
+
+        pending = true;
+        prevLen = len;
+        prevDist = dist;
+        pos++;
+    }
+
+    if (pending) {
+        if (prevLen)
+            _tokens.pushBack({(u16)prevLen, (u16)prevDist});
+        else
+            _tokens.pushBack({_buf[end - 1], 0});
+    }
+}
+
+void Deflate::_emitTokens(Slice<_Code> lit, Slice<_Code> dist) {
+    for (auto& tok : _tokens) {
+        if (tok.dist == 0) {
+            _bitsOut(lit[tok.len].bits, lit[tok.len].len);
+            continue;
+        }
+
+        auto len = _lengthSymbol(tok.len);
+        _bitsOut(lit[257 + len].bits, lit[257 + len].len);
+        _bitsOut(tok.len - LENGTH_BASE[len], LENGTH_EXTRA[len]);
+
+        auto d = _distSymbol(tok.dist);
+        _bitsOut(dist[d].bits, dist[d].len);
+        _bitsOut(tok.dist - DIST_BASE[d], DIST_EXTRA[d]);
+    }
+
+    _bitsOut(lit[256].bits, lit[256].len);
+}
+
+void Deflate::_emitStored(bool final) {
+    auto data = next(bytes(_buf), _start);
+
+    // A stored block holds at most 64 KiB - 1, an empty final one is fine.
+    do {
+        usize n = min(data.len(), 0xffffuz);
+        bool last = n == data.len();
+        _bitsOut(final and last, 1);
+        _bitsOut(0, 2);
+        _align();
+        _bitsOut(n, 16);
+        _bitsOut(n ^ 0xffff, 16);
+        _outBuf.insert(COPY, _outBuf.len(), data.buf(), n);
+        data = next(data, n);
+    } while (data.len());
+}
+
+Res<> Deflate::_compress(bool final) {
+    _tokens.clear();
+    if (_config.lazy)
+        _matchLazy();
+    else
+        _matchGreedy();
+
+    _Block block{_tokens};
+    block.build();
+
+    // Stored blocks start on a byte boundary, so count the padding too
+    usize storedCost = (_buf.len() - _start + 5) * 8 + 7;
+    usize fixedCost = block.fixedCost();
+    usize dynamicCost = block.dynamicCost();
+
+    if (dynamicCost < fixedCost and dynamicCost <= storedCost) {
+        block.emitHeader(*this, final);
+        _emitTokens(block.lit, block.dist);
+    } else if (fixedCost <= storedCost) {
+        _bitsOut(final, 1);
+        _bitsOut(1, 2);
+        _emitTokens(_fixedCodes(), _fixedDistCodes());
+    } else {
+        _emitStored(final);
+    }
+
+    if (final)
+        _align();
+
+    // Only the window is kept for the next block to refer back into
+    if (_buf.len() > WINDOW_SIZE) {
+        usize drop = _buf.len() - WINDOW_SIZE;
+        _buf.removeRange(0, drop);
+        _base += drop;
+    }
+    _start = _buf.len();
+
+    return _drain();
+}
+
+Res<> Deflate::_drain() {
+    try$(Io::writeAll(_out, bytes(_outBuf)));
+    _outBuf.trunc(0);
+    return Ok();
+}
+
+Res<Buf<Byte>> deflate(Bytes bytes, DeflateLevel level) {
+    Io::BufferWriter out{bytes.len() / 2 + 64};
+    Deflate deflate{out, level};
+    try$(deflate.write(bytes));
+    try$(deflate.finish());
+    return Ok(out.take());
+}
+
+} // namespace Karm::Archive
@@ -0,0 +1,158 @@
+#pragma once
+
+// https://www.rfc-editor.org/rfc/rfc1951
+
+#include <karm-base/buf.h>
+#include <karm-base/vec.h>
+
+#include "inflate.h"
+
+namespace Karm::Archive {
+
+// How hard to look for matches, each level is named after the zlib one it
+// behaves like.
+enum struct DeflateLevel : u8 {
+    // Each position is only matched against the last one sharing its hash,
+    // and a match is taken as soon as it's found (zlib 1).
+    FAST,
+    // Up to 128 earlier positions are tried, and a match is put off when
+    // the next position has a longer one (zlib 6).
+    DEFAULT,
+    // Same as DEFAULT, with much longer chains (zlib 9).
+    BEST,
+};
+
+// Compress into a raw DEFLATE stream as it's written. Input is gathered a
+// block at a time, matched against the window according to the level, and
+// coded with whichever of a huffman code built for the block, the fixed
+// one, or no compression at all, makes it the smallest.
+//
+// finish() ends the stream, nothing can be written after it.
+struct Deflate : public Io::Writer {
+    static constexpr usize WINDOW_SIZE = 32 * 1024;
+    static constexpr usize BLOCK_SIZE = 64 * 1024;
+    static constexpr usize MIN_MATCH = 3;
+    static constexpr usize MAX_MATCH = 258;
+    static constexpr usize HASH_BITS = 15;
+    static constexpr usize HASH_SIZE = 1 << HASH_BITS;
+    static constexpr usize LIT_CODES = 286;
+    static constexpr usize DIST_CODES = 30;
+
+    // A literal byte when `dist` is 0, a back reference otherwise.
+    struct _Token {
+        u16 len;
+        u16 dist;
+    };
+
+    // A huffman code, already reversed to go out as is.
+    struct _Code {
+        u16 bits;
+        u8 len;
+    };
+
+    struct _Config {
+        // Earlier positions tried for each match.
+        usize chain;
+        // Matches shorter than this are put off to see if the next
+        // position has a longer one, 0 takes them right away.
+        usize lazy;
+        // Stop looking once a match this long is found.
+        usize nice;
+    };
+
+    static _Config _configFor(DeflateLevel level);
+
+    Io::Writer& _out;
+    _Config _config;
+
+    // The window, followed by the input waiting to be compressed.
+    Buf<Byte> _buf;
+    usize _start = 0;
+    // Position in the stream of the first byte of `_buf`.
+    usize _base = 0;
+    // Last position in the stream, plus one, of each hash, 0 when unseen.
+    Buf<usize> _head;
+    // Previous position with the same hash, by position modulo the window,
+    // only kept when more than one candidate is tried.
+    Buf<usize> _prev;
+
+    Vec<_Token> _tokens;
+
+    u64 _bits = 0;
+    usize _nbits = 0;
+    Buf<Byte> _outBuf;
+
+    bool _finished = false;
+    usize _total = 0;
+
+    Deflate(Io::Writer& out, DeflateLevel level = DeflateLevel::DEFAULT);
+
+    // Total number of bytes written so far, before compression.
+    usize total() const {
+        return _total;
+    }
+
+    Res<usize> write(Bytes bytes) override;
+
+    Res<> finish();
+
+    // MARK: Internals
+
+    usize _hash(usize pos) const {
+        u32 v = _buf[pos] | _buf[pos + 1] << 8 | _buf[pos + 2] << 16;
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    usize _matchLen(usize from, usize pos, usize max) const {
+        usize len = 0;
+        while (len < max and _buf[from + len] == _buf[pos + len])
+            len++;
+        return len;
+    }
+
+    void _bitsOut(u32 value, usize n) {
+        _bits |= (u64)value << _nbits;
+        _nbits += n;
+        while (_nbits >= 8) {
+            _outBuf.insert(_outBuf.len(), (Byte)_bits);
+            _bits >>= 8;
+            _nbits -= 8;
+        }
+    }
+
+    void _align() {
+        if (_nbits)
+            _bitsOut(0, 8 - _nbits);
+    }
+
+    // Add `pos` to its hash chain, returning the last position, plus
+    // one, that had the same hash.
+    usize _insert(usize pos) {
+        auto h = _hash(pos);
+        usize seen = _head[h];
+        _head[h] = _base + pos + 1;
+        if (_prev.len())
+            _prev[(_base + pos) & (WINDOW_SIZE - 1)] = seen;
+        return seen;
+    }
+
+    // Insert `pos` and find the longest match for it, of at most `max` bytes.
+    Pair<usize> _longest(usize pos, usize max);
+
+    void _matchGreedy();
+
+    void _matchLazy();
+
+    void _emitTokens(Slice<_Code> lit, Slice<_Code> dist);
+
+    void _emitStored(bool final);
+
+    Res<> _compress(bool final);
+
+    Res<> _drain();
+};
+
+// Compress `bytes` into a raw DEFLATE stream all at once.
+Res<Buf<Byte>> deflate(Bytes bytes, DeflateLevel level = DeflateLevel::DEFAULT);
+
+} // namespace Karm::Archive
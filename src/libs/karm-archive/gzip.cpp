@@ -0,0 +1,156 @@
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+
+#include "gzip.h"
+
+namespace Karm::Archive {
+
+static Res<> _skipString(Inflate& in) {
+    Byte b;
+    do {
+        try$(in.readBytes({&b, 1}));
+    } while (b != 0);
+    return Ok();
+}
+
+Res<> GzipReader::_readHeader() {
+    Array<Byte, 10> head;
+    try$(_inflate.readBytes(mutBytes(head)));
+
+    if (head[0] != 0x1f or head[1] != 0x8b)
+        return Error::invalidData("not a gzip stream");
+
+    if (head[2] != 8)
+        return Error::unsupported("unsupported gzip compression method");
+
+    u8 flags = head[3];
+
+    if (flags & FEXTRA) {
+        Array<Byte, 2> xlen;
+        try$(_inflate.readBytes(mutBytes(xlen)));
+        usize len = xlen[0] | xlen[1] << 8;
+        for (usize i = 0; i < len; i++) {
+            Byte b;
+            try$(_inflate.readBytes({&b, 1}));
+        }
+    }
+
+    if (flags & FNAME)
+        try$(_skipString(_inflate));
+
+    if (flags & FCOMMENT)
+        try$(_skipString(_inflate));
+
+    if (flags & FHCRC) {
+        Array<Byte, 2> hcrc;
+        try$(_inflate.readBytes(mutBytes(hcrc)));
+    }
+
+    return Ok();
+}
+
+Res<> GzipReader::_readTrailer() {
+    Array<Byte, 8> trailer;
+    try$(_inflate.readBytes(mutBytes(trailer)));
+
+    u32 crc = trailer[0] | trailer[1] << 8 | trailer[2] << 16 | (u32)trailer[3] << 24;
+    u32 size = trailer[4] | trailer[5] << 8 | trailer[6] << 16 | (u32)trailer[7] << 24;
+
+    if (crc != _crc.digest())
+        return Error::invalidData("gzip crc mismatch");
+
+    if (size != (u32)_inflate.total())
+        return Error::invalidData("gzip size mismatch");
+
+    return Ok();
+}
+
+Res<usize> GzipReader::read(MutBytes bytes) {
+    // NOTE: The header and the trailer are read as a whole, or not at all
+    //       when the input would block, so they can be retried.
+    if (not _header) {
+        try$(_inflate.atomically([&] {
+            return _readHeader();
+        }));
+        _header = true;
+    }
+
+    if (_ended or bytes.len() == 0)
+        return Ok(0uz);
+
+    usize n = 0;
+    if (not _inflate.ended()) {
+        n = try$(_inflate.read(bytes));
+        _crc.update(sub(bytes, 0, n));
+    }
+
+    if (_inflate.ended() and n < bytes.len()) {
+        auto trailer = _inflate.atomically([&] {
+            return _readTrailer();
+        });
+        if (not trailer and n and trailer.none() == Error::WOULD_BLOCK)
+            return Ok(n);
+        try$(trailer);
+        _ended = true;
+    }
+
+    return Ok(n);
+}
+
+Res<> GzipWriter::_writeHeader() {
+    // No flags and no timestamp, the extra flags tell the level, and the
+    // operating system is unknown.
+    Byte xfl = 0;
+    if (_level == DeflateLevel::FAST)
+        xfl = 4;
+    else if (_level == DeflateLevel::BEST)
+        xfl = 2;
+
+    Array<Byte, 10> head = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, xfl, 255};
+    try$(Io::writeAll(_out, bytes(head)));
+    _header = true;
+    return Ok();
+}
+
+Res<usize> GzipWriter::write(Bytes bytes) {
+    if (not _header)
+        try$(_writeHeader());
+
+    auto n = try$(_deflate.write(bytes));
+    _crc.update(sub(bytes, 0, n));
+    return Ok(n);
+}
+
+Res<> GzipWriter::finish() {
+    if (not _header)
+        try$(_writeHeader());
+
+    if (_deflate._finished)
+        return Ok();
+    try$(_deflate.finish());
+
+    u32 crc = _crc.digest();
+    u32 size = _deflate.total();
+    Array<Byte, 8> trailer = {
+        (Byte)crc,
+        (Byte)(crc >> 8),
+        (Byte)(crc >> 16),
+        (Byte)(crc >> 24),
+        (Byte)size,
+        (Byte)(size >> 8),
+        (Byte)(size >> 16),
+        (Byte)(size >> 24),
+    };
+    try$(Io::writeAll(_out, bytes(trailer)));
+    return Ok();
+}
+
+Res<Buf<Byte>> gzip(Bytes bytes, DeflateLevel level) {
+    Io::BufferWriter out{bytes.len() / 2 + 64};
+    GzipWriter gzip{out, level};
+    try$(gzip.write(bytes));
+    try$(gzip.finish());
+    return Ok(out.take());
+}
+
+} // namespace Karm::Archive
@@ -0,0 +1,64 @@
+#pragma once
+
+// https://www.rfc-editor.org/rfc/rfc1952
+
+#include <karm-crypto/crc32.h>
+
+#include "deflate.h"
+#include "inflate.h"
+
+namespace Karm::Archive {
+
+// Decompress a gzip member as it's read, the header is parsed on the first
+// read and the trailer checked once the data ends.
+struct GzipReader : public Io::Reader {
+    static constexpr u8 FTEXT = 1 << 0;
+    static constexpr u8 FHCRC = 1 << 1;
+    static constexpr u8 FEXTRA = 1 << 2;
+    static constexpr u8 FNAME = 1 << 3;
+    static constexpr u8 FCOMMENT = 1 << 4;
+
+    Io::Reader& _in;
+    Inflate _inflate;
+    Crypto::Crc32 _crc;
+    bool _header = false;
+    bool _ended = false;
+
+    GzipReader(Io::Reader& in)
+        : _in(in), _inflate(in) {}
+
+    bool ended() const {
+        return _ended;
+    }
+
+    Res<usize> read(MutBytes bytes) override;
+
+    Res<> _readHeader();
+
+    Res<> _readTrailer();
+};
+
+// Compress into a gzip member as it's written, without a name or a
+// timestamp, finish() writes what's left of the data followed by the
+// trailer.
+struct GzipWriter : public Io::Writer {
+    Io::Writer& _out;
+    Deflate _deflate;
+    DeflateLevel _level;
+    Crypto::Crc32 _crc;
+    bool _header = false;
+
+    GzipWriter(Io::Writer& out, DeflateLevel level = DeflateLevel::DEFAULT)
+        : _out(out), _deflate(out, level), _level(level) {}
+
+    Res<usize> write(Bytes bytes) override;
+
+    Res<> finish();
+
+    Res<> _writeHeader();
+};
+
+// Compress `bytes` into a gzip member all at once.
+Res<Buf<Byte>> gzip(Bytes bytes, DeflateLevel level = DeflateLevel::DEFAULT);
+
+} // namespace Karm::Archive
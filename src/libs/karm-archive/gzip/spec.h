@@ -1,5 +0,0 @@
-#pragma once
-
-namespace Gzip {
-
-} // namespace Gzip
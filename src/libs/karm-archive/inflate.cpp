@@ -0,0 +1,363 @@
+#include "inflate.h"
+
+namespace Karm::Archive {
+
+Res<> readExact(Io::Reader& in, MutBytes bytes) {
+    usize n = 0;
+    while (n < bytes.len()) {
+        auto read = try$(in.read(mutNext(bytes, n)));
+        if (read == 0)
+            return Error::unexpectedEof("truncated stream");
+        n += read;
+    }
+    return Ok();
+}
+
+// MARK: Huffman ---------------------------------------------------------------
+
+Res<> Huffman::build(Slice<u8> lengths) {
+    counts = {};
+    fast = {};
+
+    for (auto len : lengths)
+        counts[len]++;
+    counts[0] = 0;
+
+    // An incomplete code is fine, it happens with a single distance code,
+    // an over-subscribed one can't be decoded.
+    isize left = 1;
+    for (usize len = 1; len <= MAX_BITS; len++) {
+        left <<= 1;
+        left -= counts[len];
+        if (left < 0)
+            return Error::invalidData("over-subscribed huffman code");
+    }
+
+    // Sort the symbols by code length, then by value, which is the order
+    // of their canonical codes.
+    Array<u16, MAX_BITS + 1> offsets = {};
+    for (usize len = 1; len < MAX_BITS; len++)
+        offsets[len + 1] = offsets[len] + counts[len];
+
+    for (usize sym = 0; sym < lengths.len(); sym++)
+        if (lengths[sym])
+            symbols[offsets[lengths[sym]]++] = sym;
+
+    // Codes are packed starting from their most significant bit, so they
+    // are reversed to index the table with the next bits of the stream.
+    u32 code = 0;
+    usize index = 0;
+    for (usize len = 1; len <= FAST_BITS; len++) {
+        for (usize i = 0; i < counts[len]; i++, code++) {
+            u16 entry = (symbols[index++] << 4) | len;
+            for (u32 j = reverseBits(code, len); j < fast.len(); j += 1u << len)
+                fast[j] = entry;
+        }
+        code <<= 1;
+    }
+
+    return Ok();
+}
+
+// MARK: Inflate ---------------------------------------------------------------
+
+Res<> Inflate::_fill(usize n) {
+    while (_nbits < n) {
+        if (_inPos == _inLen) {
+            if (_inEnded)
+                return Ok();
+
+            // NOTE: What the current step already read is moved to the
+            //       front of the buffer rather than dropped, it's read
+            //       again if the step has to be retried.
+            usize keep = _inLen - _mark.inPos;
+            if (keep == _inBuf.len()) {
+                _markLost = true;
+                keep = 0;
+            }
+            copy(sub(_inBuf, _inLen - keep, _inLen), mutBytes(_inBuf));
+            _mark.inPos = 0;
+            _inPos = keep;
+            _inLen = keep;
+
+            _inLen += try$(_in.read(mutNext(_inBuf, keep)));
+            if (_inLen == keep) {
+                _inEnded = true;
+                return Ok();
+            }
+        }
+
+        _bits |= (u64)_inBuf[_inPos++] << _nbits;
+        _nbits += 8;
+    }
+
+    return Ok();
+}
+
+Res<> Inflate::_need(usize n) {
+    try$(_fill(n));
+    if (_nbits < n)
+        return Error::unexpectedEof("truncated deflate stream");
+    return Ok();
+}
+
+Res<u16> Inflate::_decode(Huffman const& h) {
+    try$(_fill(Huffman::MAX_BITS));
+
+    auto entry = h.fast[_bits & (h.fast.len() - 1)];
+    if (entry and (usize)(entry & 15) <= _nbits) {
+        _take(entry & 15);
+        return Ok(entry >> 4);
+    }
+
+    // Slow path, walk the code one bit at a time, `first` is the first
+    // code of the current length and `index` the first symbol using it.
+    isize code = 0;
+    isize first = 0;
+    isize index = 0;
+    for (usize len = 1; len <= Huffman::MAX_BITS; len++) {
+        if (_nbits == 0)
+            return Error::unexpectedEof("truncated deflate stream");
+
+        code |= _take(1);
+        isize count = h.counts[len];
+        if (code - count < first)
+            return Ok(h.symbols[index + (code - first)]);
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    return Error::invalidData("invalid huffman code");
+}
+
+Res<> Inflate::_block() {
+    try$(_need(3));
+    _final = _take(1);
+    auto type = _take(2);
+
+    switch (type) {
+    case 0: {
+        // Stored blocks start on a byte boundary
+        _take(_nbits & 7);
+        auto len = try$(_readBits(16));
+        auto nlen = try$(_readBits(16));
+        if ((len ^ 0xffff) != nlen)
+            return Error::invalidData("stored block length mismatch");
+        _stored = len;
+        _state = _State::STORED;
+        return Ok();
+    }
+
+    case 1: {
+        Array<u8, Huffman::MAX_SYMBOLS> lengths;
+        for (usize i = 0; i < lengths.len(); i++)
+            lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        try$(_lit.build(lengths));
+
+        Array<u8, 30> distLengths;
+        for (auto& len : distLengths)
+            len = 5;
+        try$(_dist.build(distLengths));
+
+        _state = _State::HUFFMAN;
+        return Ok();
+    }
+
+    case 2:
+        return _dynamic();
+
+    default:
+        return Error::invalidData("invalid block type");
+    }
+}
+
+Res<> Inflate::_dynamic() {
+    try$(_need(14));
+    usize nlen = _take(5) + 257;
+    usize ndist = _take(5) + 1;
+    usize ncode = _take(4) + 4;
+
+    if (nlen > 286 or ndist > 30)
+        return Error::invalidData("too many length or distance codes");
+
+    Array<u8, 286 + 30> lengths = {};
+    for (usize i = 0; i < ncode; i++)
+        lengths[CODE_LENGTH_ORDER[i]] = try$(_readBits(3));
+
+    Huffman codes;
+    try$(codes.build(sub(lengths, 0, 19)));
+
+    usize i = 0;
+    while (i < nlen + ndist) {
+        auto sym = try$(_decode(codes));
+        if (sym < 16) {
+            lengths[i++] = sym;
+            continue;
+        }
+
+        u8 len = 0;
+        usize repeat = 0;
+        if (sym == 16) {
+            if (i == 0)
+                return Error::invalidData("repeat with no previous length");
+            len = lengths[i - 1];
+            repeat = 3 + try$(_readBits(2));
+        } else if (sym == 17) {
+            repeat = 3 + try$(_readBits(3));
+        } else {
+            repeat = 11 + try$(_readBits(7));
+        }
+
+        if (i + repeat > nlen + ndist)
+            return Error::invalidData("too many code lengths");
+
+        while (repeat--)
+            lengths[i++] = len;
+    }
+
+    if (lengths[256] == 0)
+        return Error::invalidData("missing end of block code");
+
+    try$(_lit.build(sub(lengths, 0, nlen)));
+    try$(_dist.build(sub(lengths, nlen, nlen + ndist)));
+
+    _state = _State::HUFFMAN;
+    return Ok();
+}
+
+void Inflate::_save() {
+    _mark = {
+        _inPos,
+        _bits,
+        _nbits,
+        _state,
+        _final,
+        _stored,
+        _copyLen,
+        _copyDist,
+    };
+    _markLost = false;
+}
+
+Res<> Inflate::_rewind() {
+    if (_markLost)
+        return Error::invalidData("deflate step too long to be retried");
+
+    _inPos = _mark.inPos;
+    _bits = _mark.bits;
+    _nbits = _mark.nbits;
+    _state = _mark.state;
+    _final = _mark.final;
+    _stored = _mark.stored;
+    _copyLen = _mark.copyLen;
+    _copyDist = _mark.copyDist;
+    return Ok();
+}
+
+Res<> Inflate::_step(MutBytes out, usize& produced) {
+    switch (_state) {
+    case _State::BLOCK:
+        if (_final) {
+            _state = _State::END;
+            return Ok();
+        }
+        return _block();
+
+    case _State::STORED:
+        if (_stored == 0) {
+            _state = _State::BLOCK;
+            return Ok();
+        }
+
+        // Once the bit buffer is drained, stored bytes are copied
+        // straight out of the input buffer.
+        if (_nbits == 0 and _inPos < _inLen) {
+            usize n = min(_stored, out.len() - produced, _inLen - _inPos);
+            for (usize i = 0; i < n; i++)
+                _emit(_inBuf[_inPos++], out, produced);
+            _stored -= n;
+            return Ok();
+        }
+
+        _emit((Byte)try$(_readBits(8)), out, produced);
+        _stored--;
+        return Ok();
+
+    case _State::HUFFMAN: {
+        auto sym = try$(_decode(_lit));
+        if (sym < 256) {
+            _emit((Byte)sym, out, produced);
+            return Ok();
+        }
+
+        if (sym == 256) {
+            _state = _State::BLOCK;
+            return Ok();
+        }
+
+        sym -= 257;
+        if (sym >= LENGTH_BASE.len())
+            return Error::invalidData("invalid length symbol");
+        _copyLen = LENGTH_BASE[sym] + try$(_readBits(LENGTH_EXTRA[sym]));
+
+        auto dist = try$(_decode(_dist));
+        if (dist >= DIST_BASE.len())
+            return Error::invalidData("invalid distance symbol");
+        _copyDist = DIST_BASE[dist] + try$(_readBits(DIST_EXTRA[dist]));
+
+        if (_copyDist > _total)
+            return Error::invalidData("distance too far back");
+        return Ok();
+    }
+
+    case _State::END:
+        return Ok();
+    }
+
+    return Ok();
+}
+
+Res<usize> Inflate::read(MutBytes out) {
+    usize produced = 0;
+
+    while (produced < out.len() and _state != _State::END) {
+        if (_copyLen) {
+            while (_copyLen and produced < out.len()) {
+                _emit(_window[(_total - _copyDist) & WINDOW_MASK], out, produced);
+                _copyLen--;
+            }
+            continue;
+        }
+
+        // NOTE: A step emits nothing before all of its input is read, so
+        //       going back to its start is enough to retry it later.
+        _save();
+        auto res = _step(out, produced);
+        if (res)
+            continue;
+
+        if (res.none() != Error::WOULD_BLOCK)
+            return res.none();
+
+        try$(_rewind());
+        if (produced)
+            return Ok(produced);
+        return res.none();
+    }
+
+    return Ok(produced);
+}
+
+Res<> Inflate::readBytes(MutBytes bytes) {
+    _take(_nbits & 7);
+    for (auto& b : bytes) {
+        try$(_need(8));
+        b = _take(8);
+    }
+    return Ok();
+}
+
+} // namespace Karm::Archive
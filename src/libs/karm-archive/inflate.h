@@ -0,0 +1,190 @@
+#pragma once
+
+// https://www.rfc-editor.org/rfc/rfc1951
+// https://github.com/madler/zlib/blob/master/contrib/puff/puff.c
+
+#include <karm-base/array.h>
+#include <karm-io/traits.h>
+
+namespace Karm::Archive {
+
+// Fill `bytes` completely, failing if the input ends first.
+Res<> readExact(Io::Reader& in, MutBytes bytes);
+
+// MARK: Tables ----------------------------------------------------------------
+
+static constexpr Array<u16, 29> LENGTH_BASE = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static constexpr Array<u8, 29> LENGTH_EXTRA = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static constexpr Array<u16, 30> DIST_BASE = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+    6145, 8193, 12289, 16385, 24577
+};
+
+static constexpr Array<u8, 30> DIST_EXTRA = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static constexpr Array<u8, 19> CODE_LENGTH_ORDER = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// MARK: Huffman ---------------------------------------------------------------
+
+// Huffman codes are packed starting from their most significant bit, the
+// rest of the stream from the least significant one.
+inline u32 reverseBits(u32 code, usize len) {
+    u32 res = 0;
+    for (usize i = 0; i < len; i++) {
+        res = (res << 1) | (code & 1);
+        code >>= 1;
+    }
+    return res;
+}
+
+// A canonical huffman code, codes up to FAST_BITS long are decoded with a
+// single table lookup, longer ones by walking the code lengths.
+struct Huffman {
+    static constexpr usize MAX_BITS = 15;
+    static constexpr usize MAX_SYMBOLS = 288;
+    static constexpr usize FAST_BITS = 9;
+
+    Array<u16, MAX_BITS + 1> counts = {};
+    Array<u16, MAX_SYMBOLS> symbols = {};
+    // (symbol << 4) | length, 0 when the code is longer than FAST_BITS.
+    Array<u16, 1 << FAST_BITS> fast = {};
+
+    // Build the code from the bit length of each symbol, 0 means unused.
+    Res<> build(Slice<u8> lengths);
+};
+
+// MARK: Inflate ---------------------------------------------------------------
+
+// Decompress a raw DEFLATE stream as it's read, memory use is bounded by
+// the 32 KiB window back references can reach into.
+struct Inflate : public Io::Reader {
+    static constexpr usize WINDOW_SIZE = 32 * 1024;
+    static constexpr usize WINDOW_MASK = WINDOW_SIZE - 1;
+
+    enum struct _State : u8 {
+        BLOCK,
+        STORED,
+        HUFFMAN,
+        END,
+    };
+
+    // Where decoding resumes from when the input would block, everything
+    // a step reads is kept in the input buffer until the next one starts.
+    struct _Mark {
+        usize inPos;
+        u64 bits;
+        usize nbits;
+        _State state;
+        bool final;
+        usize stored;
+        usize copyLen;
+        usize copyDist;
+    };
+
+    Io::Reader& _in;
+    Array<Byte, 4096> _inBuf;
+    usize _inPos = 0;
+    usize _inLen = 0;
+    bool _inEnded = false;
+    _Mark _mark = {};
+    bool _markLost = false;
+
+    u64 _bits = 0;
+    usize _nbits = 0;
+
+    _State _state = _State::BLOCK;
+    bool _final = false;
+    usize _stored = 0;
+    usize _copyLen = 0;
+    usize _copyDist = 0;
+    Huffman _lit;
+    Huffman _dist;
+
+    Array<Byte, WINDOW_SIZE> _window;
+    usize _total = 0;
+
+    Inflate(Io::Reader& in)
+        : _in(in) {}
+
+    bool ended() const {
+        return _state == _State::END;
+    }
+
+    // Total number of bytes produced so far.
+    usize total() const {
+        return _total;
+    }
+
+    // Reads that would block return what was decoded so far, or fail with
+    // WOULD_BLOCK, and can be retried once more input is available.
+    Res<usize> read(MutBytes bytes) override;
+
+    // Read whole bytes before or after the compressed stream, like a
+    // container header or trailer, through the same buffered input.
+    Res<> readBytes(MutBytes bytes);
+
+    // Run `fn`, reading through readBytes(), as a single step, which is
+    // undone if the input would block so it can be run again later.
+    Res<> atomically(auto fn) {
+        _save();
+        auto res = fn();
+        if (not res and res.none() == Error::WOULD_BLOCK)
+            try$(_rewind());
+        return res;
+    }
+
+    // MARK: Internals
+
+    // Remember where the next step starts.
+    void _save();
+
+    // Go back to the last mark, after the input would have blocked.
+    Res<> _rewind();
+
+    Res<> _step(MutBytes out, usize& produced);
+
+    // Buffer at least `n` bits, or as many as are left in the input.
+    Res<> _fill(usize n);
+
+    Res<> _need(usize n);
+
+    u32 _take(usize n) {
+        u32 v = _bits & ((1ull << n) - 1);
+        _bits >>= n;
+        _nbits -= n;
+        return v;
+    }
+
+    Res<u32> _readBits(usize n) {
+        try$(_need(n));
+        return Ok(_take(n));
+    }
+
+    Res<u16> _decode(Huffman const& h);
+
+    Res<> _block();
+
+    Res<> _dynamic();
+
+    void _emit(Byte b, MutBytes out, usize& produced) {
+        _window[_total & WINDOW_MASK] = b;
+        _total++;
+        out[produced++] = b;
+    }
+};
+
+} // namespace Karm::Archive
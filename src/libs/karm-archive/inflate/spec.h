@@ -1,7 +0,0 @@
-#pragma once
-
-// https://github.com/jibsen/tinf
-
-namespace Inflate {
-
-} // namespace Inflate
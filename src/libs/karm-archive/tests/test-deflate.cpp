@@ -0,0 +1,255 @@
+#include <karm-archive/deflate.h>
+#include <karm-archive/gzip.h>
+#include <karm-archive/zlib.h>
+#include <karm-io/bscan.h>
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Archive::Tests {
+
+// Bytes that don't repeat, which no compressor can shrink.
+static Buf<Byte> _noise(usize len) {
+    Buf<Byte> buf = Buf<Byte>::init(len);
+    u32 state = 0x12345678;
+    for (usize i = 0; i < len; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        buf[i] = (Byte)state;
+    }
+    return buf;
+}
+
+// Text made of a few words, repetitive but not periodic.
+static Buf<Byte> _text(usize len) {
+    Array<Str, 6> words = {"lorem "s, "ipsum "s, "dolor "s, "sit "s, "amet, "s, "consectetur\n"s};
+    Io::BufferWriter out;
+    u32 state = 1;
+    while (out.bytes().len() < len) {
+        state = state * 1103515245 + 12345;
+        (void)out.write(bytes(words[(state >> 16) % words.len()]));
+    }
+    return sub(out.bytes(), 0, len);
+}
+
+static constexpr Array<DeflateLevel, 3> LEVELS = {
+    DeflateLevel::FAST,
+    DeflateLevel::DEFAULT,
+    DeflateLevel::BEST,
+};
+
+static Res<Buf<Byte>> _deflate(Bytes data, usize chunk, DeflateLevel level = DeflateLevel::DEFAULT) {
+    Io::BufferWriter out;
+    Deflate deflate{out, level};
+    while (data.len()) {
+        auto n = try$(deflate.write(sub(data, 0, chunk)));
+        data = next(data, n);
+    }
+    try$(deflate.finish());
+    return Ok(out.take());
+}
+
+static Res<Buf<Byte>> _inflate(Bytes data) {
+    Io::BufReader in{data};
+    Inflate inflate{in};
+    Io::BufferWriter out;
+    try$(Io::copy(inflate, out));
+    if (not inflate.ended())
+        return Error::invalidData("stream didn't end");
+    return Ok(out.take());
+}
+
+test$("deflate-roundtrip") {
+    Array<Buf<Byte>, 5> inputs = {
+        Buf<Byte>{},
+        Buf<Byte>{bytes("a"s)},
+        Buf<Byte>{bytes("hello hello hello hello"s)},
+        _text(300000),
+        _noise(100000),
+    };
+
+    for (auto level : LEVELS) {
+        for (auto& input : inputs) {
+            // Odd chunks, so blocks don't line up with writes
+            auto compressed = try$(_deflate(input, 7777, level));
+            expectEq$(try$(_inflate(compressed)), bytes(input));
+        }
+    }
+
+    return Ok();
+}
+
+test$("deflate-levels") {
+    auto input = _text(150000);
+    auto fast = try$(_deflate(input, input.len(), DeflateLevel::FAST));
+    auto def = try$(_deflate(input, input.len(), DeflateLevel::DEFAULT));
+    auto best = try$(_deflate(input, input.len(), DeflateLevel::BEST));
+
+    expectLt$(def.len(), fast.len());
+    expectLteq$(best.len(), def.len());
+    return Ok();
+}
+
+test$("deflate-shrinks-text") {
+    auto input = _text(300000);
+    auto compressed = try$(_deflate(input, input.len()));
+    expectLt$(compressed.len(), input.len() / 2);
+    return Ok();
+}
+
+test$("deflate-stores-noise") {
+    // Coding noise would make it bigger, it's stored instead
+    auto input = _noise(200000);
+    auto compressed = try$(_deflate(input, input.len()));
+    expectLteq$(compressed.len(), input.len() + 64);
+    return Ok();
+}
+
+test$("deflate-long-runs") {
+    Buf<Byte> input = Buf<Byte>::init(100000, 'x');
+    auto compressed = try$(_deflate(input, 1000));
+    expectLt$(compressed.len(), 1000uz);
+    expectEq$(try$(_inflate(compressed)), bytes(input));
+    return Ok();
+}
+
+test$("deflate-empty") {
+    for (auto level : LEVELS) {
+        auto compressed = try$(_deflate({}, 1, level));
+        expectNe$(compressed.len(), 0uz);
+        expectEq$(try$(_inflate(compressed)).len(), 0uz);
+
+        // Empty member, crc and size both zero
+        auto gzipped = try$(gzip({}, level));
+        expectGteq$(gzipped.len(), 18uz);
+        auto trailer = next(bytes(gzipped), gzipped.len() - 8);
+        for (auto b : trailer)
+            expectEq$(b, 0);
+    }
+
+    return Ok();
+}
+
+test$("deflate-stored-blocks") {
+    // More than a stored block can hold, so it has to be split
+    auto input = _noise(200000);
+
+    for (auto level : LEVELS) {
+        auto compressed = try$(_deflate(input, 7777, level));
+
+        // BFINAL = 0, BTYPE = 00
+        expectEq$(compressed[0] & 0b111, 0);
+        expectLteq$(compressed.len(), input.len() + 64);
+        expectEq$(try$(_inflate(compressed)), bytes(input));
+    }
+
+    return Ok();
+}
+
+test$("gzip-trailer") {
+    // The usual CRC-32 check value
+    auto check = try$(gzip(bytes("123456789"s)));
+    auto trailer = next(bytes(check), check.len() - 8);
+    expectEq$(Io::BScan{trailer}.nextU32le(), 0xCBF43926u);
+    expectEq$(Io::BScan{trailer}.skip(4).nextU32le(), 9u);
+
+    auto input = _text(300000);
+    for (auto level : LEVELS) {
+        auto gzipped = try$(gzip(input, level));
+        auto trailer = next(bytes(gzipped), gzipped.len() - 8);
+        Io::BScan s{trailer};
+        expectEq$(s.nextU32le(), Crypto::crc32(input));
+        expectEq$(s.nextU32le(), (u32)input.len());
+    }
+
+    return Ok();
+}
+
+test$("zlib-writer-roundtrip") {
+    auto input = _text(100000);
+
+    Io::BufferWriter out;
+    ZlibWriter zlib{out};
+    try$(zlib.write(input));
+    try$(zlib.finish());
+
+    Io::BufReader in{out.bytes()};
+    ZlibReader reader{in};
+    Io::BufferWriter back;
+    try$(Io::copy(reader, back));
+    expect$(reader.ended());
+    expectEq$(back.bytes(), bytes(input));
+    return Ok();
+}
+
+test$("gzip-writer-roundtrip") {
+    auto input = _text(100000);
+
+    Io::BufferWriter out;
+    GzipWriter gzip{out, DeflateLevel::FAST};
+    try$(gzip.write(input));
+    try$(gzip.finish());
+
+    Io::BufReader in{out.bytes()};
+    GzipReader reader{in};
+    Io::BufferWriter back;
+    try$(Io::copy(reader, back));
+    expect$(reader.ended());
+    expectEq$(back.bytes(), bytes(input));
+    return Ok();
+}
+
+// Takes at most a few bytes per write, like a pipe or a socket would.
+struct _ShortWriter : public Io::Writer {
+    Io::BufferWriter out;
+
+    Res<usize> write(Bytes bytes) override {
+        return out.write(sub(bytes, 0, 3));
+    }
+};
+
+test$("writers-short-writes") {
+    auto input = _text(20000);
+
+    // Headers and trailers go out in full, the same as into a buffer
+    _ShortWriter zlibOut;
+    ZlibWriter zlibWriter{zlibOut};
+    try$(zlibWriter.write(input));
+    try$(zlibWriter.finish());
+    auto zlibbed = try$(zlib(input));
+    expectEq$(zlibOut.out.bytes(), bytes(zlibbed));
+
+    _ShortWriter gzipOut;
+    GzipWriter gzipWriter{gzipOut};
+    try$(gzipWriter.write(input));
+    try$(gzipWriter.finish());
+    auto gzipped = try$(gzip(input));
+    expectEq$(gzipOut.out.bytes(), bytes(gzipped));
+
+    return Ok();
+}
+
+test$("deflate-one-shot") {
+    auto input = _text(50000);
+
+    expectEq$(try$(_inflate(try$(deflate(input)))), bytes(input));
+
+    auto zlibbed = try$(zlib(input, DeflateLevel::BEST));
+    Io::BufReader zlibIn{zlibbed};
+    ZlibReader zlibReader{zlibIn};
+    Io::BufferWriter zlibBack;
+    try$(Io::copy(zlibReader, zlibBack));
+    expectEq$(zlibBack.bytes(), bytes(input));
+
+    auto gzipped = try$(gzip(input));
+    Io::BufReader gzipIn{gzipped};
+    GzipReader gzipReader{gzipIn};
+    Io::BufferWriter gzipBack;
+    try$(Io::copy(gzipReader, gzipBack));
+    expectEq$(gzipBack.bytes(), bytes(input));
+
+    return Ok();
+}
+
+} // namespace Karm::Archive::Tests
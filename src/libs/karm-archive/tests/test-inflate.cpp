@@ -0,0 +1,130 @@
+#include <karm-archive/gzip.h>
+#include <karm-archive/inflate.h>
+#include <karm-archive/zlib.h>
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Archive::Tests {
+
+// Feeds its input a few bytes at a time, so every decoder state has to
+// survive running out of input.
+struct Trickle : public Io::Reader {
+    Bytes _buf;
+    usize _step;
+
+    Trickle(Bytes buf, usize step = 3)
+        : _buf(buf), _step(step) {}
+
+    Res<usize> read(MutBytes bytes) override {
+        auto chunk = sub(_buf, 0, min(_step, bytes.len()));
+        auto n = copy(chunk, bytes);
+        _buf = next(_buf, n);
+        return Ok(n);
+    }
+};
+
+static Res<String> _readAll(Io::Reader& reader) {
+    Io::BufferWriter out;
+    try$(Io::copy(reader, out));
+    return Ok(String{(char const*)out.bytes().buf(), out.bytes().len()});
+}
+
+static constexpr Array<u8, 18> STORED = {
+    0x01, 0x0d, 0x00, 0xf2, 0xff, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20,
+    0x57, 0x6f, 0x72, 0x6c, 0x64, 0x21,
+};
+
+static constexpr Array<u8, 10> FIXED = {
+    0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0x57, 0xc8, 0x40, 0x27, 0x01,
+};
+
+// "line 0\n" to "line 29\n"
+static constexpr Array<u8, 77> DYNAMIC = {
+    0x35, 0xce, 0xb1, 0x0d, 0x80, 0x30, 0x00, 0x03, 0xc1, 0x3e, 0x53, 0x30,
+    0x02, 0x36, 0x10, 0xc8, 0x40, 0x14, 0x48, 0x51, 0xf6, 0x2f, 0x51, 0xe4,
+    0x4f, 0xf5, 0x95, 0x4f, 0xee, 0xdf, 0x78, 0xb7, 0xbd, 0xf4, 0x19, 0x25,
+    0x4e, 0x8e, 0xe4, 0x4c, 0xae, 0xa4, 0x26, 0x77, 0xf2, 0x24, 0x8d, 0xf9,
+    0x62, 0x70, 0x04, 0x24, 0x24, 0x41, 0x09, 0x4b, 0x60, 0x42, 0x13, 0x9c,
+    0xf0, 0x8c, 0xe7, 0xf5, 0x0b, 0xcf, 0x78, 0xc6, 0x33, 0x9e, 0xf1, 0x8c,
+    0x67, 0x3c, 0xb7, 0xf2, 0x03,
+};
+
+// gzip with a file name, of "The quick brown fox jumps over the lazy dog"
+static constexpr Array<u8, 70> GZIP = {
+    0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x66, 0x6f,
+    0x78, 0x2e, 0x74, 0x78, 0x74, 0x00, 0x0b, 0xc9, 0x48, 0x55, 0x28, 0x2c,
+    0xcd, 0x4c, 0xce, 0x56, 0x48, 0x2a, 0xca, 0x2f, 0xcf, 0x53, 0x48, 0xcb,
+    0xaf, 0x50, 0xc8, 0x2a, 0xcd, 0x2d, 0x28, 0x56, 0xc8, 0x2f, 0x4b, 0x2d,
+    0x52, 0x28, 0x01, 0x4a, 0xe7, 0x24, 0x56, 0x55, 0x2a, 0xa4, 0xe4, 0xa7,
+    0x03, 0x00, 0x39, 0xa3, 0x4f, 0x41, 0x2b, 0x00, 0x00, 0x00,
+};
+
+static constexpr Array<u8, 50> ZLIB = {
+    0x78, 0x9c, 0x0b, 0xc9, 0x48, 0x55, 0x28, 0x2c, 0xcd, 0x4c, 0xce, 0x56,
+    0x48, 0x2a, 0xca, 0x2f, 0xcf, 0x53, 0x48, 0xcb, 0xaf, 0x50, 0xc8, 0x2a,
+    0xcd, 0x2d, 0x28, 0x56, 0xc8, 0x2f, 0x4b, 0x2d, 0x52, 0x28, 0x01, 0x4a,
+    0xe7, 0x24, 0x56, 0x55, 0x2a, 0xa4, 0xe4, 0xa7, 0x03, 0x00, 0x5b, 0xdc,
+    0x0f, 0xda,
+};
+
+test$("inflate-stored") {
+    Io::BufReader in{bytes(STORED)};
+    Inflate inflate{in};
+    expectEq$(try$(_readAll(inflate)), "Hello, World!"s);
+    expect$(inflate.ended());
+    return Ok();
+}
+
+test$("inflate-fixed") {
+    Trickle in{bytes(FIXED)};
+    Inflate inflate{in};
+    expectEq$(try$(_readAll(inflate)), "hello hello hello hello"s);
+    return Ok();
+}
+
+test$("inflate-dynamic") {
+    Io::StringWriter expected;
+    for (usize i = 0; i < 30; i++)
+        try$(Io::format(expected, "line {}\n", i));
+
+    Trickle in{bytes(DYNAMIC), 1};
+    Inflate inflate{in};
+    expectEq$(try$(_readAll(inflate)), expected.take());
+    return Ok();
+}
+
+test$("inflate-truncated") {
+    Io::BufReader in{sub(bytes(DYNAMIC), 0, 40)};
+    Inflate inflate{in};
+    expectNot$(_readAll(inflate));
+    return Ok();
+}
+
+test$("gzip-reader") {
+    Trickle in{bytes(GZIP)};
+    GzipReader gzip{in};
+    expectEq$(try$(_readAll(gzip)), "The quick brown fox jumps over the lazy dog"s);
+    expect$(gzip.ended());
+    return Ok();
+}
+
+test$("gzip-reader-bad-crc") {
+    auto corrupted = GZIP;
+    corrupted[corrupted.len() - 8] ^= 0xff;
+
+    Io::BufReader in{bytes(corrupted)};
+    GzipReader gzip{in};
+    expectNot$(_readAll(gzip));
+    return Ok();
+}
+
+test$("zlib-reader") {
+    Trickle in{bytes(ZLIB)};
+    ZlibReader zlib{in};
+    expectEq$(try$(_readAll(zlib)), "The quick brown fox jumps over the lazy dog"s);
+    expect$(zlib.ended());
+    return Ok();
+}
+
+} // namespace Karm::Archive::Tests
@@ -0,0 +1,116 @@
+#include <karm-crypto/adler32.h>
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
+
+#include "zlib.h"
+
+namespace Karm::Archive {
+
+Res<> ZlibReader::_readHeader() {
+    Array<Byte, 2> head;
+    try$(_inflate.readBytes(mutBytes(head)));
+
+    if ((head[0] << 8 | head[1]) % 31 != 0)
+        return Error::invalidData("invalid zlib header checksum");
+
+    if ((head[0] & 0x0f) != 8 or (head[0] >> 4) > 7)
+        return Error::unsupported("unsupported zlib compression method");
+
+    if (head[1] & 0x20)
+        return Error::unsupported("zlib preset dictionaries are not supported");
+
+    return Ok();
+}
+
+Res<> ZlibReader::_readTrailer() {
+    Array<Byte, 4> trailer;
+    try$(_inflate.readBytes(mutBytes(trailer)));
+
+    u32 adler = (u32)trailer[0] << 24 | trailer[1] << 16 | trailer[2] << 8 | trailer[3];
+    if (adler != _adler)
+        return Error::invalidData("zlib checksum mismatch");
+
+    return Ok();
+}
+
+Res<usize> ZlibReader::read(MutBytes bytes) {
+    if (not _header) {
+        try$(_inflate.atomically([&] {
+            return _readHeader();
+        }));
+        _header = true;
+    }
+
+    if (_ended or bytes.len() == 0)
+        return Ok(0uz);
+
+    usize n = 0;
+    if (not _inflate.ended()) {
+        n = try$(_inflate.read(bytes));
+        _adler = Crypto::adler32(sub(bytes, 0, n), _adler);
+    }
+
+    if (_inflate.ended() and n < bytes.len()) {
+        auto trailer = _inflate.atomically([&] {
+            return _readTrailer();
+        });
+        if (not trailer and n and trailer.none() == Error::WOULD_BLOCK)
+            return Ok(n);
+        try$(trailer);
+        _ended = true;
+    }
+
+    return Ok(n);
+}
+
+Res<> ZlibWriter::_writeHeader() {
+    // Deflate with a 32 KiB window, and the level it's closest to, which
+    // is only informative, both bytes keep the header a multiple of 31.
+    Byte flags = 0x9c;
+    if (_level == DeflateLevel::FAST)
+        flags = 0x01;
+    else if (_level == DeflateLevel::BEST)
+        flags = 0xda;
+
+    Array<Byte, 2> head = {0x78, flags};
+    try$(Io::writeAll(_out, bytes(head)));
+    _header = true;
+    return Ok();
+}
+
+Res<usize> ZlibWriter::write(Bytes bytes) {
+    if (not _header)
+        try$(_writeHeader());
+
+    auto n = try$(_deflate.write(bytes));
+    _adler = Crypto::adler32(sub(bytes, 0, n), _adler);
+    return Ok(n);
+}
+
+Res<> ZlibWriter::finish() {
+    if (not _header)
+        try$(_writeHeader());
+
+    if (_deflate._finished)
+        return Ok();
+    try$(_deflate.finish());
+
+    Array<Byte, 4> trailer = {
+        (Byte)(_adler >> 24),
+        (Byte)(_adler >> 16),
+        (Byte)(_adler >> 8),
+        (Byte)_adler,
+    };
+    try$(Io::writeAll(_out, bytes(trailer)));
+    return Ok();
+}
+
+Res<Buf<Byte>> zlib(Bytes bytes, DeflateLevel level) {
+    Io::BufferWriter out{bytes.len() / 2 + 64};
+    ZlibWriter zlib{out, level};
+    try$(zlib.write(bytes));
+    try$(zlib.finish());
+    return Ok(out.take());
+}
+
+} // namespace Karm::Archive
@@ -0,0 +1,55 @@
+#pragma once
+
+// https://www.rfc-editor.org/rfc/rfc1950
+
+#include "deflate.h"
+#include "inflate.h"
+
+namespace Karm::Archive {
+
+// Decompress a zlib stream as it's read, the header is parsed on the first
+// read and the checksum verified once the data ends.
+struct ZlibReader : public Io::Reader {
+    Io::Reader& _in;
+    Inflate _inflate;
+    u32 _adler = 1;
+    bool _header = false;
+    bool _ended = false;
+
+    ZlibReader(Io::Reader& in)
+        : _in(in), _inflate(in) {}
+
+    bool ended() const {
+        return _ended;
+    }
+
+    Res<usize> read(MutBytes bytes) override;
+
+    Res<> _readHeader();
+
+    Res<> _readTrailer();
+};
+
+// Compress into a zlib stream as it's written, finish() writes what's left
+// of the data followed by the checksum.
+struct ZlibWriter : public Io::Writer {
+    Io::Writer& _out;
+    Deflate _deflate;
+    DeflateLevel _level;
+    u32 _adler = 1;
+    bool _header = false;
+
+    ZlibWriter(Io::Writer& out, DeflateLevel level = DeflateLevel::DEFAULT)
+        : _out(out), _deflate(out, level), _level(level) {}
+
+    Res<usize> write(Bytes bytes) override;
+
+    Res<> finish();
+
+    Res<> _writeHeader();
+};
+
+// Compress `bytes` into a zlib stream all at once.
+Res<Buf<Byte>> zlib(Bytes bytes, DeflateLevel level = DeflateLevel::DEFAULT);
+
+} // namespace Karm::Archive
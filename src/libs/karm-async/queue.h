@@ -81,10 +81,21 @@ struct Queue {
         return _GetSender{this};
     }
 
-    bool empty() {
+    bool empty() const {
         return ::isEmpty(_buf);
     }
 
+    // Number of items waiting to be dequeued.
+    usize len() const {
+        return _buf.len();
+    }
+
+    // Whether someone is waiting on dequeueAsync(), the next item enqueued
+    // goes straight to them.
+    bool waiting() const {
+        return not _listeners.empty();
+    }
+
     Opt<T> dequeue() {
         if (empty())
             return NONE;
@@ -49,4 +49,30 @@ test$("karm-queue-dequeue-enqueue") {
     return Ok();
 }
 
+test$("karm-queue-waiting") {
+    Queue<isize> q;
+    expect$(not q.waiting());
+    expectEq$(q.len(), 0uz);
+
+    isize res = 0;
+    Async::detach(q.dequeueAsync(), [&](isize v) {
+        res = v;
+    });
+    expect$(q.waiting());
+
+    // Handed straight to the waiting dequeue, never queued
+    q.enqueue(42);
+    expect$(not q.waiting());
+    expectEq$(res, 42);
+    expectEq$(q.len(), 0uz);
+
+    q.enqueue(69);
+    q.enqueue(96);
+    expectEq$(q.len(), 2uz);
+    expectEq$(q.dequeue(), 69);
+    expectEq$(q.len(), 1uz);
+
+    return Ok();
+}
+
 } // namespace Karm::Async::Tests
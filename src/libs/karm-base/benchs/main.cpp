@@ -0,0 +1,102 @@
+#include <karm-base/array.h>
+#include <karm-base/ring.h>
+#include <karm-base/vec.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+// Exercise the ring the same way Hjert channels do: messages are queued as
+// bytes plus a length record, and drained either one by one or in batches.
+
+static constexpr usize RING_CAP = 64 * 1024;
+static constexpr usize TOTAL = 256 * 1024 * 1024;
+
+struct Record {
+    usize bytes;
+    usize caps;
+};
+
+static Duration benchBytewise(usize msgLen) {
+    Ring<Byte> bytes(RING_CAP);
+    Ring<Record> records(RING_CAP / 16);
+    Vec<Byte> in;
+    in.resize(msgLen);
+    Vec<Byte> out;
+    out.resize(msgLen);
+
+    auto start = Sys::instant();
+    for (usize sent = 0; sent < TOTAL; sent += msgLen) {
+        for (usize i = 0; i < msgLen; i++)
+            bytes.pushBack(in[i]);
+        records.pushBack({msgLen, 0});
+
+        auto record = records.popFront();
+        for (usize i = 0; i < record.bytes; i++)
+            out[i] = bytes.popFront();
+    }
+    return Sys::instant() - start;
+}
+
+static Duration benchBulk(usize msgLen) {
+    Ring<Byte> bytes(RING_CAP);
+    Ring<Record> records(RING_CAP / 16);
+    Vec<Byte> in;
+    in.resize(msgLen);
+    Vec<Byte> out;
+    out.resize(msgLen);
+
+    auto start = Sys::instant();
+    for (usize sent = 0; sent < TOTAL; sent += msgLen) {
+        bytes.pushBack(in);
+        records.pushBack({msgLen, 0});
+
+        auto record = records.popFront();
+        bytes.popFront(mutSub(out, 0, record.bytes));
+    }
+    return Sys::instant() - start;
+}
+
+static Duration benchBatched(usize msgLen) {
+    Ring<Byte> bytes(RING_CAP);
+    Ring<Record> records(RING_CAP / 16);
+    Vec<Byte> in;
+    in.resize(msgLen);
+    Vec<Byte> out;
+    out.resize(RING_CAP);
+
+    auto start = Sys::instant();
+    usize sent = 0;
+    while (sent < TOTAL) {
+        // Fill the ring, then drain everything at once.
+        while (sent < TOTAL and bytes.rem() >= msgLen and records.rem() > 0) {
+            bytes.pushBack(in);
+            records.pushBack({msgLen, 0});
+            sent += msgLen;
+        }
+
+        usize off = 0;
+        while (records.len()) {
+            auto record = records.popFront();
+            bytes.popFront(mutSub(out, off, off + record.bytes));
+            off += record.bytes;
+        }
+    }
+    return Sys::instant() - start;
+}
+
+static void report(Str name, usize msgLen, Duration elapsed) {
+    f64 secs = elapsed.toUSecs() / 1e6;
+    f64 throughput = (TOTAL / (1024.0 * 1024.0)) / secs;
+    f64 rate = (TOTAL / msgLen) / secs;
+    Sys::println("{} {}B: {} ({} MiB/s, {} msg/s)", name, msgLen, elapsed, throughput, rate);
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Array<usize, 4> sizes = {64, 512, 4096, 16384};
+    for (usize msgLen : sizes) {
+        report("bytewise", msgLen, benchBytewise(msgLen));
+        report("bulk", msgLen, benchBulk(msgLen));
+        report("batched", msgLen, benchBatched(msgLen));
+    }
+
+    co_return Ok();
+}
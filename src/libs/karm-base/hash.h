@@ -38,12 +38,15 @@ struct Hasher<Bytes> {
     }
 };
 
+// NOTE: Elements are mixed in order, like bytes are, so that permutations
+//       of the same elements, anagrams for strings, hash differently.
 template <Sliceable T>
 struct Hasher<T> {
     static constexpr Hash hash(T const& v) {
         Hash hash{0};
         for (auto& e : v)
-            hash = hash + ::hash(e);
+            hash = (1000003 * hash) ^ ::hash(e);
+        hash ^= v.len();
         return hash;
     }
 };
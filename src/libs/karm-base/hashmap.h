@@ -0,0 +1,240 @@
+#pragma once
+
+#include "clamp.h"
+#include "cursor.h"
+#include "hash.h"
+#include "iter.h"
+#include "manual.h"
+#include "opt.h"
+#include "tuple.h"
+
+namespace Karm {
+
+// An open addressing hash map with linear probing, for when Map's linear
+// lookups become a bottleneck.
+template <typename K, typename V>
+struct HashMap {
+    struct Slot : public Manual<Pair<K, V>> {
+        enum State : u8 {
+            FREE,
+            USED,
+            DEAD,
+        };
+
+        State state = State::FREE;
+    };
+
+    Slot* _slots = nullptr;
+    usize _cap = 0;
+    usize _len = 0;
+    usize _dead = 0;
+
+    HashMap(usize cap = 0) : _cap(cap) {
+        if (cap)
+            _slots = new Slot[cap];
+    }
+
+    HashMap(HashMap const& other) {
+        ensure(other._cap);
+        for (auto const& [k, v] : other.iter())
+            put(k, v);
+    }
+
+    HashMap(HashMap&& other)
+        : _slots(std::exchange(other._slots, nullptr)),
+          _cap(std::exchange(other._cap, 0)),
+          _len(std::exchange(other._len, 0)),
+          _dead(std::exchange(other._dead, 0)) {
+    }
+
+    ~HashMap() {
+        clear();
+    }
+
+    HashMap& operator=(HashMap const& other) {
+        *this = HashMap(other);
+        return *this;
+    }
+
+    HashMap& operator=(HashMap&& other) {
+        std::swap(_slots, other._slots);
+        std::swap(_cap, other._cap);
+        std::swap(_len, other._len);
+        std::swap(_dead, other._dead);
+        return *this;
+    }
+
+    void _rehash(usize desired) {
+        auto* oldSlots = _slots;
+        usize oldCap = _cap;
+
+        _slots = new Slot[desired];
+        _cap = desired;
+        _len = 0;
+        _dead = 0;
+
+        for (usize i = 0; i < oldCap; i++) {
+            if (oldSlots[i].state != Slot::USED)
+                continue;
+            auto& [k, v] = oldSlots[i].unwrap();
+            _insert(std::move(k), std::move(v));
+            oldSlots[i].dtor();
+        }
+
+        delete[] oldSlots;
+    }
+
+    void ensure(usize desired) {
+        if (desired <= _cap)
+            return;
+        _rehash(desired);
+    }
+
+    usize _usage() const {
+        if (not _cap)
+            return 100;
+        return ((_len + _dead) * 100) / _cap;
+    }
+
+    // NOTE: The key must not be in the map.
+    void _insert(K key, V value) {
+        usize i = hash(key) % _cap;
+        while (_slots[i].state == Slot::USED)
+            i = (i + 1) % _cap;
+
+        if (_slots[i].state == Slot::DEAD)
+            _dead--;
+
+        _slots[i].ctor(Pair<K, V>{std::move(key), std::move(value)});
+        _slots[i].state = Slot::USED;
+        _len++;
+    }
+
+    Slot* _lookup(K const& key) const {
+        if (_len == 0)
+            return nullptr;
+
+        usize i = hash(key) % _cap;
+        for (usize n = 0; n < _cap and _slots[i].state != Slot::FREE; n++) {
+            auto& s = _slots[i];
+            if (s.state == Slot::USED and s.unwrap().v0 == key)
+                return &s;
+            i = (i + 1) % _cap;
+        }
+        return nullptr;
+    }
+
+    void put(K const& key, V value) {
+        if (auto* slot = _lookup(key)) {
+            slot->unwrap().v1 = std::move(value);
+            return;
+        }
+
+        if (_usage() > 80)
+            _rehash(max(_len * 2, 16uz));
+
+        _insert(key, std::move(value));
+    }
+
+    bool has(K const& key) const {
+        return _lookup(key);
+    }
+
+    V& get(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            panic("key not found");
+        return slot->unwrap().v1;
+    }
+
+    MutCursor<V> access(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return {};
+        return &slot->unwrap().v1;
+    }
+
+    Cursor<V> access(K const& key) const {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return {};
+        return &slot->unwrap().v1;
+    }
+
+    Opt<V> tryGet(K const& key) const {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return NONE;
+        return slot->unwrap().v1;
+    }
+
+    V take(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            panic("key not found");
+
+        V value = std::move(slot->unwrap().v1);
+        slot->dtor();
+        slot->state = Slot::DEAD;
+        _len--;
+        _dead++;
+        return value;
+    }
+
+    bool del(K const& key) {
+        auto* slot = _lookup(key);
+        if (not slot)
+            return false;
+
+        slot->dtor();
+        slot->state = Slot::DEAD;
+        _len--;
+        _dead++;
+        return true;
+    }
+
+    void clear() {
+        if (not _slots)
+            return;
+
+        for (usize i = 0; i < _cap; i++)
+            if (_slots[i].state == Slot::USED)
+                _slots[i].dtor();
+        delete[] _slots;
+
+        _slots = nullptr;
+        _cap = 0;
+        _len = 0;
+        _dead = 0;
+    }
+
+    auto iter() const {
+        return Iter{[&, i = 0uz] mutable -> Pair<K, V> const* {
+            while (i < _cap and _slots[i].state != Slot::USED)
+                i++;
+
+            if (i == _cap)
+                return nullptr;
+
+            return &_slots[i++].unwrap();
+        }};
+    }
+
+    auto iter() {
+        return Iter{[&, i = 0uz] mutable -> Pair<K, V>* {
+            while (i < _cap and _slots[i].state != Slot::USED)
+                i++;
+
+            if (i == _cap)
+                return nullptr;
+
+            return &_slots[i++].unwrap();
+        }};
+    }
+
+    usize len() const {
+        return _len;
+    }
+};
+
+} // namespace Karm
@@ -28,9 +28,14 @@ struct _Cell {
     virtual Meta::Type<> inspect() = 0;
 
     void collectAndRelease() {
+        // NOTE: Clearing the object can drop the last weak reference back
+        //       to its own cell, which lands here again, so the cell is
+        //       marked first and kept alive until it's done.
         if (_strong == 0 and not _clear) {
-            clear();
             _clear = true;
+            _weak++;
+            clear();
+            _weak--;
         }
 
         if (_strong == 0 and _weak == 0) {
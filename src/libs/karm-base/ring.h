@@ -1,5 +1,6 @@
 #pragma once
 
+#include "clamp.h"
 #include "manual.h"
 #include "panic.h"
 #include "slice.h"
@@ -65,6 +66,25 @@ struct Ring {
         _len++;
     }
 
+    // Copy `values` at the back of the ring, in at most two segments.
+    void pushBack(Slice<T> values)
+        requires Meta::TrivialyCopyable<T>
+    {
+        if (values.len() > rem()) [[unlikely]]
+            panic("push on full ring");
+
+        if (values.len() == 0)
+            return;
+
+        usize first = min(values.len(), _cap - _head);
+        auto* raw = reinterpret_cast<T*>(_buf);
+        memcpy(raw + _head, values.buf(), first * sizeof(T));
+        memcpy(raw, values.buf() + first, (values.len() - first) * sizeof(T));
+
+        _head = (_head + values.len()) % _cap;
+        _len += values.len();
+    }
+
     T popBack() {
         if (_len == 0) [[unlikely]]
             panic("pop on empty ring");
@@ -85,6 +105,26 @@ struct Ring {
         return value;
     }
 
+    // Move `values.len()` items from the front of the ring into `values`, in
+    // at most two segments.
+    void popFront(MutSlice<T> values)
+        requires Meta::TrivialyCopyable<T>
+    {
+        if (values.len() > _len) [[unlikely]]
+            panic("dequeue on empty ring");
+
+        if (values.len() == 0)
+            return;
+
+        usize first = min(values.len(), _cap - _tail);
+        auto const* raw = reinterpret_cast<T const*>(_buf);
+        memcpy(values.buf(), raw + _tail, first * sizeof(T));
+        memcpy(values.buf() + first, raw, (values.len() - first) * sizeof(T));
+
+        _tail = (_tail + values.len()) % _cap;
+        _len -= values.len();
+    }
+
     void clear() {
         for (usize i = 0; i < _len; i++)
             _buf[(_tail + i) % _cap].dtor();
@@ -0,0 +1,80 @@
+#include <karm-base/hashmap.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("hashmap-put") {
+    HashMap<int, int> map{};
+    map.put(420, 69);
+    expect$(map.has(420));
+    expectEq$(map.get(420), 69);
+
+    map.put(420, 42);
+    expectEq$(map.get(420), 42);
+    expectEq$(map.len(), 1uz);
+
+    return Ok();
+}
+
+test$("hashmap-del") {
+    HashMap<int, int> map{};
+    map.put(420, 69);
+    expect$(map.del(420));
+    expect$(not map.has(420));
+    expect$(not map.del(420));
+    expectEq$(map.len(), 0uz);
+
+    return Ok();
+}
+
+test$("hashmap-try-get") {
+    HashMap<int, int> map{};
+    map.put(1, 10);
+    expectEq$(map.tryGet(1), 10);
+    expectEq$(map.tryGet(2), NONE);
+
+    return Ok();
+}
+
+test$("hashmap-resize") {
+    HashMap<int, int> map{};
+    for (int i = 0; i < 1000; i++)
+        map.put(i, i * 2);
+
+    expectEq$(map.len(), 1000uz);
+    for (int i = 0; i < 1000; i++)
+        expectEq$(map.get(i), i * 2);
+
+    return Ok();
+}
+
+test$("hashmap-reuse-dead") {
+    HashMap<int, int> map{16};
+    for (int i = 0; i < 1000; i++) {
+        map.put(i, i);
+        map.del(i);
+    }
+
+    expectEq$(map.len(), 0uz);
+    expect$(map._cap <= 32uz);
+
+    map.put(420, 69);
+    expectEq$(map.get(420), 69);
+
+    return Ok();
+}
+
+test$("hashmap-iter") {
+    HashMap<int, int> map{};
+    for (int i = 0; i < 10; i++)
+        map.put(i, i);
+
+    int sum = 0;
+    for (auto const& [k, v] : map.iter())
+        sum += v;
+    expectEq$(sum, 45);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
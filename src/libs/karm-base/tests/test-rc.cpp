@@ -13,4 +13,26 @@ test$("strong-rc") {
     return Ok();
 }
 
+test$("rc-drop-weak-cycle") {
+    // The parent is only kept alive by the child, and only points back
+    // to it weakly, dropping the child drops the last weak reference to
+    // its cell while it's being cleared.
+    struct Node {
+        Opt<Weak<Node>> child = NONE;
+        Opt<Rc<Node>> parent = NONE;
+    };
+
+    auto parent = makeRc<Node>();
+    auto child = makeRc<Node>();
+    parent->child = Weak<Node>{child};
+    child->parent = std::move(parent);
+
+    Weak<Node> weak = child;
+    expect$(weak.upgrade().has());
+    { auto _ = std::move(child); }
+    expectNot$(weak.upgrade().has());
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
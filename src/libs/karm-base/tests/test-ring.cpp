@@ -1,3 +1,4 @@
+#include <karm-base/array.h>
 #include <karm-base/ring.h>
 #include <karm-test/macros.h>
 
@@ -19,4 +20,25 @@ test$("ring-avoid-pop-back-underflow") {
     return Ok();
 }
 
+test$("ring-bulk-push-pop") {
+    Ring<int> ring(5);
+
+    Array<int, 3> in = {1, 2, 3};
+    Array<int, 3> out = {};
+
+    // Go around the ring a few times, to hit both segments.
+    for (usize i = 0; i < 4; i++) {
+        ring.pushBack(in);
+        expectEq$(ring.len(), 3uz);
+        expectEq$(ring.peek(0), 1);
+        expectEq$(ring.peek(2), 3);
+
+        ring.popFront(out);
+        expectEq$(ring.len(), 0uz);
+        expectEq$(out, in);
+    }
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
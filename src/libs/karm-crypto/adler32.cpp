@@ -5,11 +5,11 @@ namespace Karm::Crypto {
 static constexpr usize ADLER32_BASE = 65521;
 static constexpr usize ADLER32_NMAX = 5552;
 
-u32 adler32(Bytes bytes) {
+u32 adler32(Bytes bytes, u32 adler) {
     auto [buf, len] = bytes;
 
-    u32 s1 = 1;
-    u32 s2 = 0;
+    u32 s1 = adler & 0xffff;
+    u32 s2 = adler >> 16;
 
     while (len > 0) {
         usize k = len < ADLER32_NMAX ? len : ADLER32_NMAX;
@@ -4,6 +4,7 @@
 
 namespace Karm::Crypto {
 
-u32 adler32(Bytes bytes);
+// Pass the previous result as `adler` to checksum data arriving in pieces.
+u32 adler32(Bytes bytes, u32 adler = 1);
 
 } // namespace Karm::Crypto
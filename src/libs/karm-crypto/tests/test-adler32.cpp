@@ -19,4 +19,12 @@ test$("crypto-adler32") {
     return Ok();
 }
 
+test$("crypto-adler32-incremental") {
+    Str data = "abcdefghijklmnopqrstuvwxyz";
+    auto adler = adler32(sub(bytes(data), 0, 10));
+    adler = adler32(next(bytes(data), 10), adler);
+    expectEq$(adler, 0x90860b20u);
+    return Ok();
+}
+
 } // namespace Karm::Crypto::Tests
@@ -1,9 +1,10 @@
 #include <karm-cli/cursor.h>
 #include <karm-gfx/cpu/canvas.h>
+#include <karm-gfx/filters.h>
 #include <karm-sys/entry.h>
 #include <karm-sys/time.h>
 
-Async::Task<> entryPointAsync(Sys::Context&) {
+static void benchStroke() {
     Vec<Duration> samples;
     auto surface = Gfx::Surface::alloc({1000, 1000});
 
@@ -57,6 +58,34 @@ Async::Task<> entryPointAsync(Sys::Context&) {
     Sys::println("average: {}", Duration::fromUSecs(sum / samples.len()));
     Sys::println("min: {}", first(samples));
     Sys::println("max: {}", last(samples));
+}
+
+static void benchBlur() {
+    auto surface = Gfx::Surface::alloc({1920, 1080});
+    Math::Rand rand{};
+    for (isize y = 0; y < 1080; y++)
+        for (isize x = 0; x < 1920; x++)
+            surface->mutPixels().store({x, y}, Gfx::randomColor(rand));
+
+    Array<f64, 3> radii = {4, 16, 64};
+    for (auto radius : radii) {
+        Vec<Duration> samples;
+        for (isize i = 0; i < 10; i++) {
+            auto start = Sys::now();
+            Gfx::BlurFilter{radius}.apply(surface->mutPixels());
+            samples.pushBack(Sys::now() - start);
+        }
 
+        sort(samples, [](auto& a, auto& b) {
+            return a.toUSecs() <=> b.toUSecs();
+        });
+
+        Sys::println("blur {} on 1920x1080: median {}, min {}", radius, samples[samples.len() / 2], first(samples));
+    }
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    benchStroke();
+    benchBlur();
     co_return Ok();
 }
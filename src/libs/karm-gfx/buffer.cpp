@@ -1,3 +1,5 @@
+#include <karm-base/simd.h>
+
 #include "buffer.h"
 
 namespace Karm::Gfx {
@@ -8,6 +10,12 @@ namespace Karm::Gfx {
 
     dst._fmt.visit([&](auto fd) {
         src._fmt.visit([&](auto fs) {
+            if constexpr (Meta::Same<decltype(fd), decltype(fs)>) {
+                for (isize y = 0; y < dst.height(); y++)
+                    memcpy(dst.pixelUnsafe({0, y}), src.pixelUnsafe({0, y}), dst.width() * fd.bpp());
+                return;
+            }
+
             for (isize y = 0; y < dst.height(); y++) {
                 for (isize x = 0; x < dst.width(); x++) {
                     auto c = fs.load(src.pixelUnsafe({x, y}));
@@ -18,4 +26,72 @@ namespace Karm::Gfx {
     });
 }
 
+// MARK: Surface --------------------------------------------------------------
+
+// NOTE: The four channels are summed as the lanes of a single vector, four
+//       pixels add up to at most 1020, which fits in 16 bits.
+static Rc<Surface> _downsample(Surface const& src) {
+    auto res = Surface::alloc(
+        {
+            max(src.width() / 2, 1),
+            max(src.height() / 2, 1),
+        },
+        src._fmt
+    );
+
+    auto s = src.pixels();
+    auto d = res->mutPixels();
+    s.fmt().visit([&](auto f) {
+        auto lanes = [&](isize x, isize y) {
+            auto c = f.load(s.pixelUnsafe({x, y}));
+            return u16x4{c.red, c.green, c.blue, c.alpha};
+        };
+
+        for (isize y = 0; y < d.height(); y++) {
+            isize y0 = min(y * 2, s.height() - 1);
+            isize y1 = min(y * 2 + 1, s.height() - 1);
+
+            for (isize x = 0; x < d.width(); x++) {
+                isize x0 = min(x * 2, s.width() - 1);
+                isize x1 = min(x * 2 + 1, s.width() - 1);
+
+                u16x4 sum = lanes(x0, y0) + lanes(x1, y0) + lanes(x0, y1) + lanes(x1, y1);
+                u16x4 avg = (sum + 2) >> 2;
+                f.store(d.pixelUnsafe({x, y}), Color(avg[0], avg[1], avg[2], avg[3]));
+            }
+        }
+    });
+
+    return res;
+}
+
+Surface const& Surface::mip(usize level) const {
+    level = min(level, MAX_MIP_LEVEL);
+
+    if (_dirty) {
+        _mips.clear();
+        _dirty = false;
+    }
+
+    while (_mips.len() < level) {
+        auto const& prev = _mips.len() ? *last(_mips) : *this;
+        if (prev.width() == 1 and prev.height() == 1)
+            break;
+        _mips.pushBack(_downsample(prev));
+    }
+
+    if (level == 0 or _mips.len() == 0)
+        return *this;
+    return *_mips[min(level, _mips.len()) - 1];
+}
+
+Surface const& Surface::mipFor(Math::Vec2i size) const {
+    usize level = 0;
+    while (level < MAX_MIP_LEVEL and
+           width() >> (level + 1) >= size.x and
+           height() >> (level + 1) >= size.y)
+        level++;
+    return mip(level);
+}
+
 } // namespace Karm::Gfx
@@ -2,6 +2,7 @@
 
 #include <karm-base/rc.h>
 #include <karm-base/union.h>
+#include <karm-base/vec.h>
 #include <karm-math/rect.h>
 
 #include "color.h"
@@ -243,11 +244,19 @@ using MutPixels = _Pixels<true>;
 // MARK: Surface --------------------------------------------------------------
 
 struct Surface {
+    static constexpr usize MAX_MIP_LEVEL = 16;
+
     Buf<u8> _buf;
     Math::Vec2i _size;
     usize _stride;
     Gfx::Fmt _fmt;
 
+    // Box filtered copies of the surface, each half the size of the previous
+    // one. They are built on demand to downscale without aliasing, and are
+    // dropped once the surface is marked dirty, see dirty().
+    mutable Vec<Rc<Surface>> _mips = {};
+    mutable bool _dirty = false;
+
     static Rc<Surface> alloc(Math::Vec2i size, Gfx::Fmt fmt = Gfx::RGBA8888) {
         return makeRc<Surface>(
             Buf<u8>::init(size.x * size.y * fmt.bpp()),
@@ -275,10 +284,19 @@ struct Surface {
         return {_buf.buf(), _size, _stride, _fmt};
     }
 
+    // NOTE: Handing out write access marks the surface dirty, whoever
+    //       keeps the pixels around to write to them later marks it again
+    //       with dirty(), as the CpuCanvas does on every drawing operation.
     always_inline Gfx::MutPixels mutPixels() {
+        _dirty = true;
         return {_buf.buf(), _size, _stride, _fmt};
     }
 
+    // Note that the pixels changed, the mip levels are rebuilt on next use.
+    always_inline void dirty() {
+        _dirty = true;
+    }
+
     always_inline isize width() const {
         return _size.x;
     }
@@ -294,6 +312,12 @@ struct Surface {
     always_inline Gfx::Color sample(Math::Vec2f pos) const {
         return pixels().sample(pos);
     }
+
+    // Get the mip level `level`, level 0 being the surface itself.
+    Surface const& mip(usize level) const;
+
+    // Get the smallest mip level that is still at least `size` large.
+    Surface const& mipFor(Math::Vec2i size) const;
 };
 
 // MARK: Blitting --------------------------------------------------------------
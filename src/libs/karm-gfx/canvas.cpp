@@ -150,6 +150,10 @@ void Canvas::blit(Math::Vec2i dest, Pixels pixels) {
     blit(pixels.bound(), Math::Recti(dest, pixels.size()), pixels);
 }
 
+void Canvas::blit(Math::Recti dest, Surface const& surface) {
+    blit(surface.bound(), dest, surface.pixels());
+}
+
 // MARK: Filter Operations -------------------------------------------------
 
 void Canvas::apply(Filter filter, Math::Rectf region, Math::Radiif radii) {
@@ -197,6 +197,10 @@ struct Canvas : Meta::NoCopy {
     // Blit the given pixels to the current pixels at the given position.
     virtual void blit(Math::Vec2i dest, Pixels pixels);
 
+    // Blit the given surface to the current pixels, implementations
+    // may use its mip levels when it's downscaled.
+    virtual void blit(Math::Recti dest, Surface const& surface);
+
     // MARK: Filter Operations -------------------------------------------------
 
     // Apply a filter on the given region.
@@ -1,8 +1,11 @@
 #include <karm-base/ring.h>
+#include <karm-base/simd.h>
 #include <karm-logger/logger.h>
 #include <karm-math/funcs.h>
+#include <karm-text/font.h>
 
 #include "canvas.h"
+#include "glyphs.h"
 
 namespace Karm::Gfx {
 
@@ -15,15 +18,23 @@ void CpuCanvas::begin(MutPixels p) {
     });
 }
 
+void CpuCanvas::begin(Surface& s) {
+    begin(s.mutPixels());
+    _surface = &s;
+}
+
 void CpuCanvas::end() {
     if (_stack.len() != 1) [[unlikely]]
         panic("save/restore mismatch");
 
     _stack.popBack();
     _pixels = NONE;
+    _surface = nullptr;
 }
 
 MutPixels CpuCanvas::mutPixels() {
+    if (_surface)
+        _surface->dirty();
     return _pixels.unwrap("no pixels");
 }
 
@@ -72,8 +83,31 @@ void CpuCanvas::transform(Math::Trans2f trans) {
 // MARK: Path Operations -------------------------------------------------------
 
 void CpuCanvas::_fillImpl(auto fill, auto format, FillRule fillRule) {
+    auto pixels = mutPixels();
+
+    if constexpr (Meta::Same<decltype(fill), Gradient::Prepared>) {
+        // Gradients are sampled a whole span at a time, in chunks small
+        // enough to stay on the stack.
+        Array<Color, 64> colors;
+        _rast.fillSpans(_poly, current().clip, fillRule, [&](CpuRast::Span const& span) {
+            for (usize off = 0; off < span.len(); off += colors.len()) {
+                usize n = min(colors.len(), span.len() - off);
+                Math::Vec2f uv = {span.uv.x + span.du * off, span.uv.y};
+                fill.sampleSpan(uv, span.du, mutSub(colors, 0, n));
+
+                auto* pixel = static_cast<u8*>(pixels.pixelUnsafe(span.xy + Math::Vec2i{(isize)off, 0}));
+                for (usize i = 0; i < n; i++) {
+                    auto c = format.load(pixel);
+                    c = colors[i].withOpacity(clamp01(span.coverage[off + i])).blendOver(c);
+                    format.store(pixel, c);
+                    pixel += format.bpp();
+                }
+            }
+        });
+        return;
+    }
+
     _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
-        auto pixels = mutPixels();
         auto* pixel = pixels.pixelUnsafe(frag.xy);
         auto color = fill.sample(frag.uv);
         auto c = format.load(pixel);
@@ -84,12 +118,13 @@ void CpuCanvas::_fillImpl(auto fill, auto format, FillRule fillRule) {
 
 void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
     Math::Vec2f last = {0, 0};
+    auto pixels = mutPixels();
     auto fillComponent = [&](auto comp, Math::Vec2f pos) {
         _poly.offset(pos - last);
         last = pos;
 
         _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
-            u8* pixel = static_cast<u8*>(mutPixels().pixelUnsafe(frag.xy));
+            u8* pixel = static_cast<u8*>(pixels.pixelUnsafe(frag.xy));
             auto color = fill.sample(frag.uv);
             auto c = format.load(pixel);
             c = color.withOpacity(frag.a).blendOverComponent(c, comp);
@@ -102,13 +137,66 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
     fillComponent(Color::BLUE_COMPONENT, _lcdLayout.blue);
 }
 
+// Bilinear sample of `src`, clamped to `bound`. `x` and `y` are in 24.8
+// fixed point, with integer values falling on pixel centers.
+//
+// The four channels are the lanes of a single vector, the weighted sums
+// are at most 255 * 256 * 256 and fit in 32 bits.
+always_inline static Color _sampleBilinear(Pixels src, auto fmt, Math::Recti bound, isize x, isize y) {
+    u32 ax = x & 0xFF;
+    u32 ay = y & 0xFF;
+
+    isize x0 = clamp(x >> 8, bound.start(), bound.end() - 1);
+    isize y0 = clamp(y >> 8, bound.top(), bound.bottom() - 1);
+    isize x1 = clamp((x >> 8) + 1, bound.start(), bound.end() - 1);
+    isize y1 = clamp((y >> 8) + 1, bound.top(), bound.bottom() - 1);
+
+    auto lanes = [&](isize x, isize y) {
+        auto c = fmt.load(src.pixelUnsafe({x, y}));
+        return u32x4{c.red, c.green, c.blue, c.alpha};
+    };
+
+    u32x4 top = lanes(x0, y0) * (256 - ax) + lanes(x1, y0) * ax;
+    u32x4 bottom = lanes(x0, y1) * (256 - ax) + lanes(x1, y1) * ax;
+    u32x4 c = (top * (256 - ay) + bottom * ay) >> 16;
+    return Color(c[0], c[1], c[2], c[3]);
+}
+
+static auto _prepareFill(auto const& fill) {
+    return fill;
+}
+
+struct _PixelsSampler {
+    Pixels pixels;
+
+    always_inline Color sample(Math::Vec2f uv) const {
+        // NOTE: `uv` is the top left corner of the fragment, which cancels
+        //       out the half pixel offset of sampling at pixel centers.
+        isize x = uv.x * pixels.width() * 256;
+        isize y = uv.y * pixels.height() * 256;
+        return pixels.fmt().visit([&](auto f) {
+            return _sampleBilinear(pixels, f, pixels.bound(), x, y);
+        });
+    }
+};
+
+static _PixelsSampler _prepareFill(Pixels const& fill) {
+    return {fill};
+}
+
+// NOTE: Gradients are prepared once per fill, rather than once per pixel.
+static Gradient::Prepared _prepareFill(Gradient const& fill) {
+    return fill.prepare();
+}
+
 void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
-    fill.visit([&](auto fill) {
+    fill.visit([&](auto const& fill) {
+        auto prepared = _prepareFill(fill);
         pixels().fmt().visit([&](auto format) {
             if (_useSpaa)
-                _FillSmoothImpl(fill, format, fillRule);
+                _FillSmoothImpl(prepared, format, fillRule);
             else
-                _fillImpl(fill, format, fillRule);
+                _fillImpl(prepared, format, fillRule);
         });
     });
 }
@@ -200,11 +288,12 @@ void CpuCanvas::clip(FillRule) {
             .clip(r)
             .clear(color);
     } else {
-        pixels().fmt().visit([&](auto f) {
+        auto pixels = mutPixels();
+        pixels.fmt().visit([&](auto f) {
             for (isize y = r.y; y < r.y + r.height; ++y) {
                 for (isize x = r.x; x < r.x + r.width; ++x) {
-                    auto blended = color.blendOver(f.load(mutPixels().pixelUnsafe({x, y})));
-                    f.store(mutPixels().pixelUnsafe({x, y}), blended);
+                    auto blended = color.blendOver(f.load(pixels.pixelUnsafe({x, y})));
+                    f.store(pixels.pixelUnsafe({x, y}), blended);
                 }
             }
         });
@@ -248,7 +337,96 @@ void CpuCanvas::fill(Math::Path const& path, FillRule rule) {
     _fill(current().fill, rule);
 }
 
+void CpuCanvas::_blitGlyph(u8 const* coverage, isize stride, Math::Recti dest, Color color) {
+    auto clipped = current().clip.clipTo(dest);
+    if (clipped.width <= 0 or clipped.height <= 0)
+        return;
+
+    coverage += (clipped.y - dest.y) * stride + (clipped.x - dest.x) * CpuGlyphs::CHANNELS;
+
+    pixels().fmt().visit([&](auto format) {
+        auto pixels = mutPixels();
+        for (isize y = 0; y < clipped.height; y++) {
+            u8 const* texel = coverage + y * stride;
+            for (isize x = 0; x < clipped.width; x++, texel += CpuGlyphs::CHANNELS) {
+                if (not(texel[0] | texel[1] | texel[2]))
+                    continue;
+
+                auto* pixel = pixels.pixelUnsafe(clipped.xy + Math::Vec2i{x, y});
+                auto c = format.load(pixel);
+                c = color.withOpacity(texel[0] / 255.0).blendOverComponent(c, Color::RED_COMPONENT);
+                c = color.withOpacity(texel[1] / 255.0).blendOverComponent(c, Color::GREEN_COMPONENT);
+                c = color.withOpacity(texel[2] / 255.0).blendOverComponent(c, Color::BLUE_COMPONENT);
+                format.store(pixel, c);
+            }
+        }
+    });
+}
+
+bool CpuCanvas::_fillCachedGlyph(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) {
+    auto trans = current().trans;
+
+    // NOTE: Only solid fills with a translation and an uniform scale can be
+    //       cached, everything else goes through the rasterizer.
+    bool isSuitableForCache =
+        current().fill.is<Color>() and
+        trans.xx == trans.yy and trans.xx > 0 and
+        trans.xy == 0 and trans.yx == 0;
+
+    if (not isSuitableForCache)
+        return false;
+
+    f64 size = font.fontsize * trans.xx;
+    auto origin = trans.apply(baseline);
+
+    // Snap the glyph vertically to the pixel grid, and horizontally to
+    // a fraction of a pixel, so glyphs can be reused along a line.
+    isize ix = __builtin_floor(origin.x);
+    isize iy = __builtin_floor(origin.y + 0.5);
+    u8 subpixel = (origin.x - ix) * CpuGlyphs::SUBPIXELS;
+
+    CpuGlyphKey key = {
+        .fontface = font.fontface->id(),
+        .glyph = glyph,
+        .size = size,
+        .subpixel = subpixel,
+        .lcd = true,
+        .layout = _lcdLayout,
+    };
+
+    auto& glyphs = globalGlyphs();
+    auto entry = glyphs.lookup(key);
+    if (not entry) {
+        push();
+        current().trans = Math::Trans2f::makeTranslate({subpixel / (f64)CpuGlyphs::SUBPIXELS, 0});
+        scale(size);
+        beginPath();
+        font.fontface->contour(*this, glyph);
+        _poly.clear();
+        createSolid(_poly, _path);
+        _poly.transform(current().trans);
+        pop();
+
+        entry = glyphs.insert(key, _poly);
+        if (not entry)
+            return false;
+    }
+
+    auto const& page = glyphs.page(entry->page);
+    _blitGlyph(
+        page.at(entry->rect.xy),
+        CpuGlyphs::PAGE_SIZE * CpuGlyphs::CHANNELS,
+        {Math::Vec2i{ix, iy} + entry->offset, entry->rect.wh},
+        current().fill.unwrap<Color>()
+    );
+
+    return true;
+}
+
 void CpuCanvas::fill(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) {
+    if (_fillCachedGlyph(font, glyph, baseline))
+        return;
+
     _useSpaa = true;
     Canvas::fill(font, glyph, baseline);
     _useSpaa = false;
@@ -314,39 +492,111 @@ void CpuCanvas::plot(Math::Recti rect, Color color) {
 
 // MARK: Blit Operations -------------------------------------------------------
 
-[[gnu::flatten]] void CpuCanvas::_blit(
+// Formats keeping every pixel in four bytes, with the alpha in the last
+// one, rows of opaque pixels are copied between them without decoding.
+template <typename F>
+static constexpr bool _isRgba32 = Meta::Same<F, Rgba8888> or Meta::Same<F, Bgra8888>;
+
+[[gnu::flatten]] void CpuCanvas::_blitCopy(
     Pixels src, Math::Recti srcRect, auto srcFmt,
     MutPixels dest, Math::Recti destRect, auto destFmt
 ) {
-    // FIXME: Properly handle offaxis rectangles
-    destRect = current().trans.apply(destRect.cast<f64>()).bound().cast<isize>();
+    using S = decltype(srcFmt);
+    using D = decltype(destFmt);
 
     auto clipDest = current().clip.clipTo(destRect);
+    auto offset = srcRect.xy - destRect.xy;
 
-    auto hratio = srcRect.height / (f64)destRect.height;
-    auto wratio = srcRect.width / (f64)destRect.width;
+    for (isize y = clipDest.top(); y < clipDest.bottom(); y++) {
+        u8 const* s = static_cast<u8 const*>(src.pixelUnsafe(Math::Vec2i{clipDest.x, y} + offset));
+        u8* d = static_cast<u8*>(dest.pixelUnsafe({clipDest.x, y}));
 
-    for (isize y = 0; y < clipDest.height; ++y) {
-        isize yy = clipDest.y - destRect.y + y;
+        if constexpr (_isRgba32<S> and _isRgba32<D>) {
+            bool opaque = true;
+            for (isize x = 0; x < clipDest.width and opaque; x++)
+                opaque = s[x * 4 + 3] == 255;
 
-        auto srcY = srcRect.y + yy * hratio;
-        auto destY = clipDest.y + y;
+            if (opaque and Meta::Same<S, D>) {
+                memcpy(d, s, clipDest.width * 4);
+                continue;
+            }
 
-        for (isize x = 0; x < clipDest.width; ++x) {
-            isize xx = clipDest.x - destRect.x + x;
+            // NOTE: RGBA and BGRA only differ by the order of their red
+            //       and blue bytes.
+            if (opaque) {
+                for (isize x = 0; x < clipDest.width * 4; x += 4) {
+                    d[x + 0] = s[x + 2];
+                    d[x + 1] = s[x + 1];
+                    d[x + 2] = s[x + 0];
+                    d[x + 3] = 255;
+                }
+                continue;
+            }
+        }
 
-            auto srcX = srcRect.x + xx * wratio;
-            auto destX = clipDest.x + x;
+        for (isize x = 0; x < clipDest.width; x++) {
+            auto c = srcFmt.load(s);
+            if (c.alpha != 255)
+                c = c.blendOver(destFmt.load(d));
+            destFmt.store(d, c);
 
-            u8 const* srcPx = static_cast<u8 const*>(src.pixelUnsafe({(isize)srcX, (isize)srcY}));
-            u8* destPx = static_cast<u8*>(dest.pixelUnsafe({destX, destY}));
-            auto srcC = srcFmt.load(srcPx);
-            auto destC = destFmt.load(destPx);
-            destFmt.store(destPx, srcC.blendOver(destC));
+            s += srcFmt.bpp();
+            d += destFmt.bpp();
         }
     }
 }
 
+[[gnu::flatten]] void CpuCanvas::_blitScaled(
+    Pixels src, Math::Recti srcRect, auto srcFmt,
+    MutPixels dest, Math::Recti destRect, auto destFmt
+) {
+    auto clipDest = current().clip.clipTo(destRect);
+
+    // Walk the source in 16.16 fixed point, sampling under the center
+    // of each destination pixel.
+    i64 stepX = ((i64)srcRect.width << 16) / destRect.width;
+    i64 stepY = ((i64)srcRect.height << 16) / destRect.height;
+    i64 startX = ((i64)srcRect.x << 16) + (clipDest.x - destRect.x) * stepX + stepX / 2 - (1 << 15);
+    i64 sy = ((i64)srcRect.y << 16) + (clipDest.y - destRect.y) * stepY + stepY / 2 - (1 << 15);
+
+    for (isize y = clipDest.top(); y < clipDest.bottom(); y++, sy += stepY) {
+        u8* d = static_cast<u8*>(dest.pixelUnsafe({clipDest.x, y}));
+        i64 sx = startX;
+
+        for (isize x = 0; x < clipDest.width; x++, sx += stepX) {
+            auto c = _sampleBilinear(src, srcFmt, srcRect, sx >> 8, sy >> 8);
+            if (c.alpha != 255)
+                c = c.blendOver(destFmt.load(d));
+            destFmt.store(d, c);
+
+            d += destFmt.bpp();
+        }
+    }
+}
+
+void CpuCanvas::_blit(
+    Pixels src, Math::Recti srcRect, auto srcFmt,
+    MutPixels dest, Math::Recti destRect, auto destFmt
+) {
+    // FIXME: Properly handle offaxis rectangles
+    // NOTE: Edges are rounded to the closest pixel, so rectangles sharing
+    //       an edge still do once transformed, and keep their size.
+    auto bound = current().trans.apply(destRect.cast<f64>()).bound();
+    destRect = Math::Recti::fromTwoPoint(
+        {(isize)__builtin_round(bound.start()), (isize)__builtin_round(bound.top())},
+        {(isize)__builtin_round(bound.end()), (isize)__builtin_round(bound.bottom())}
+    );
+
+    if (destRect.width <= 0 or destRect.height <= 0 or
+        srcRect.width <= 0 or srcRect.height <= 0)
+        return;
+
+    if (srcRect.wh == destRect.wh)
+        _blitCopy(src, srcRect, srcFmt, dest, destRect, destFmt);
+    else
+        _blitScaled(src, srcRect, srcFmt, dest, destRect, destFmt);
+}
+
 void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p) {
     auto d = mutPixels();
     d.fmt().visit([&](auto dfmt) {
@@ -356,6 +606,14 @@ void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p) {
     });
 }
 
+void CpuCanvas::blit(Math::Recti dest, Surface const& surface) {
+    // NOTE: Bilinear sampling skips most of the source pixels when
+    //       shrinking by more than half, start from the closest mip level.
+    auto size = current().trans.apply(dest.cast<f64>()).bound().size().cast<isize>();
+    auto const& mip = surface.mipFor(size);
+    blit(mip.bound(), dest, mip.pixels());
+}
+
 // MARK: Filter Operations -----------------------------------------------------
 
 void CpuCanvas::apply(Filter filter) {
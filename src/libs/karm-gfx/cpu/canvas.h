@@ -13,6 +13,8 @@ struct LcdLayout {
     Math::Vec2f red;
     Math::Vec2f green;
     Math::Vec2f blue;
+
+    bool operator==(LcdLayout const& other) const = default;
 };
 
 static LcdLayout RGB = {{+0.33, 0.0}, {0.0, 0.0}, {-0.33, 0.0}};
@@ -28,6 +30,9 @@ struct CpuCanvas : public Canvas {
     };
 
     Opt<MutPixels> _pixels{};
+    // The surface being drawn on, if any, marked dirty by every drawing
+    // operation so its mip levels follow.
+    Surface* _surface = nullptr;
     Vec<Scope> _stack{};
     Math::Path _path{};
     Math::Polyf _poly;
@@ -40,10 +45,13 @@ struct CpuCanvas : public Canvas {
     // Begin drawing operations on the given pixels.
     void begin(MutPixels p);
 
+    // Begin drawing operations on the given surface.
+    void begin(Surface& s);
+
     // End drawing operations.
     void end();
 
-    // Get the pixels being drawn on.
+    // Get the pixels being drawn on, for writing.
     MutPixels mutPixels();
 
     // Get the pixels being drawn on.
@@ -121,6 +129,12 @@ struct CpuCanvas : public Canvas {
 
     void fill(Math::Path const& path, FillRule rule = FillRule::NONZERO) override;
 
+    // Blend cached glyph coverage onto the surface, `coverage` points to
+    // the top left texel of `dest` and holds one value per LCD component.
+    void _blitGlyph(u8 const* coverage, isize stride, Math::Recti dest, Color color);
+
+    bool _fillCachedGlyph(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline);
+
     void fill(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) override;
 
     // MARK: Clear Operations --------------------------------------------------
@@ -139,6 +153,26 @@ struct CpuCanvas : public Canvas {
 
     // MARK: Blit Operations ---------------------------------------------------
 
+    void _blitCopy(
+        Pixels src,
+        Math::Recti srcRect,
+        auto srcFmt,
+
+        MutPixels dest,
+        Math::Recti destRect,
+        auto destFmt
+    );
+
+    void _blitScaled(
+        Pixels src,
+        Math::Recti srcRect,
+        auto srcFmt,
+
+        MutPixels dest,
+        Math::Recti destRect,
+        auto destFmt
+    );
+
     void _blit(
         Pixels src,
         Math::Recti srcRect,
@@ -151,6 +185,8 @@ struct CpuCanvas : public Canvas {
 
     void blit(Math::Recti src, Math::Recti dest, Pixels pixels) override;
 
+    void blit(Math::Recti dest, Surface const& surface) override;
+
     // MARK: Filter Operations -------------------------------------------------
 
     void apply(Filter filter) override;
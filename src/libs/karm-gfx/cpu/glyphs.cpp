@@ -0,0 +1,159 @@
+#include "glyphs.h"
+
+namespace Karm::Gfx {
+
+void CpuGlyphs::clear() {
+    _entries.clear();
+    _pages.clear();
+}
+
+Opt<Pair<usize, Math::Recti>> CpuGlyphs::_pack(Page& page, Math::Vec2i size) {
+    for (auto& shelf : page.shelves) {
+        if (shelf.height < size.y or shelf.x + size.x > PAGE_SIZE)
+            continue;
+
+        Math::Recti rect = {shelf.x, shelf.y, size.x, size.y};
+        shelf.x += size.x;
+        return Pair<usize, Math::Recti>{0, rect};
+    }
+
+    isize y = 0;
+    if (page.shelves.len())
+        y = last(page.shelves).y + last(page.shelves).height;
+
+    if (y + size.y > PAGE_SIZE)
+        return NONE;
+
+    page.shelves.pushBack({y, size.y, size.x});
+    return Pair<usize, Math::Recti>{0, {0, y, size.x, size.y}};
+}
+
+Opt<Pair<usize, Math::Recti>> CpuGlyphs::_alloc(Math::Vec2i size) {
+    for (usize i = 0; i < _pages.len(); i++) {
+        if (auto res = _pack(_pages[i], size)) {
+            res->v0 = i;
+            return res;
+        }
+    }
+
+    usize index = _pages.len();
+    if (usage() + _pageBytes() > _budget and _pages.len()) {
+        // Recycle the least recently used page, and forget every glyph
+        // that was stored in it.
+        index = 0;
+        for (usize i = 1; i < _pages.len(); i++)
+            if (_pages[i].lastUsed < _pages[index].lastUsed)
+                index = i;
+
+        auto& page = _pages[index];
+        for (auto& key : page.keys)
+            _entries.del(key);
+        page.keys.clear();
+        page.shelves.clear();
+        _stats.evictions++;
+    } else {
+        Page page{};
+        page.coverage.resize(_pageBytes());
+        _pages.pushBack(std::move(page));
+    }
+
+    auto res = _pack(_pages[index], size);
+    if (res)
+        res->v0 = index;
+    return res;
+}
+
+Opt<CpuGlyphs::Entry> CpuGlyphs::lookup(CpuGlyphKey const& key) {
+    _tick++;
+
+    auto entry = _entries.tryGet(key);
+    if (not entry) {
+        _stats.misses++;
+        return NONE;
+    }
+
+    _stats.hits++;
+    _pages[entry->page].lastUsed = _tick;
+    return entry;
+}
+
+Opt<CpuGlyphs::Entry> CpuGlyphs::insert(CpuGlyphKey const& key, Math::Polyf& poly) {
+    // Leave a pixel of room around the outline for the LCD offsets and
+    // for the antialiasing of the edges.
+    Math::Recti bound = {};
+    if (poly.len()) {
+        auto b = poly.bound();
+        bound = Math::Recti::fromTwoPoint(
+            {
+                (isize)__builtin_floor(b.start()) - 1,
+                (isize)__builtin_floor(b.top()) - 1,
+            },
+            {
+                (isize)__builtin_ceil(b.end()) + 1,
+                (isize)__builtin_ceil(b.bottom()) + 1,
+            }
+        );
+    }
+
+    if (bound.width > PAGE_SIZE or bound.height > PAGE_SIZE)
+        return NONE;
+
+    auto alloc = _alloc(bound.wh);
+    if (not alloc)
+        return NONE;
+
+    auto [index, rect] = *alloc;
+    auto& page = _pages[index];
+    page.keys.pushBack(key);
+    page.lastUsed = _tick;
+
+    for (isize y = 0; y < rect.height; y++)
+        zeroFill<u8>({page.at(rect.xy + Math::Vec2i{0, y}), rect.width * CHANNELS});
+
+    auto rasterize = [&](usize channel, bool all) {
+        _rast.fill(poly, {0, 0, rect.width, rect.height}, FillRule::NONZERO, [&](CpuRast::Frag frag) {
+            u8 a = clamp(frag.a, 0.0, 1.0) * 255;
+            u8* texel = page.at(rect.xy + frag.xy);
+            if (all) {
+                texel[0] = a;
+                texel[1] = a;
+                texel[2] = a;
+            } else {
+                texel[channel] = a;
+            }
+        });
+    };
+
+    poly.offset(-bound.xy.cast<f64>());
+    if (key.lcd) {
+        Math::Vec2f last = {0, 0};
+        Array<Math::Vec2f, 3> offsets = {
+            key.layout.red,
+            key.layout.green,
+            key.layout.blue,
+        };
+
+        for (usize c = 0; c < CHANNELS; c++) {
+            poly.offset(offsets[c] - last);
+            last = offsets[c];
+            rasterize(c, false);
+        }
+    } else {
+        rasterize(0, true);
+    }
+
+    Entry entry = {
+        .page = index,
+        .rect = rect,
+        .offset = bound.xy,
+    };
+    _entries.put(key, entry);
+    return entry;
+}
+
+CpuGlyphs& globalGlyphs() {
+    static CpuGlyphs glyphs;
+    return glyphs;
+}
+
+} // namespace Karm::Gfx
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <karm-base/hashmap.h>
+
+#include "canvas.h"
+
+namespace Karm::Gfx {
+
+struct CpuGlyphKey {
+    // NOTE: Fontfaces are identified by their id rather than their address,
+    //       a face allocated where a dropped one was must not pick up its
+    //       glyphs.
+    usize fontface;
+    Text::Glyph glyph;
+    f64 size;
+    u8 subpixel;
+    bool lcd;
+    LcdLayout layout;
+
+    bool operator==(CpuGlyphKey const& other) const = default;
+};
+
+} // namespace Karm::Gfx
+
+template <>
+struct Karm::Hasher<Karm::Gfx::CpuGlyphKey> {
+    static Hash hash(Karm::Gfx::CpuGlyphKey const& key) {
+        Hash h = Karm::hash(key.fontface);
+        h = h * 31 + Karm::hash(key.glyph.index);
+        h = h * 31 + Karm::hash(key.glyph.font);
+        h = h * 31 + Karm::hash(key.size);
+        h = h * 31 + Karm::hash(key.subpixel);
+        h = h * 31 + Karm::hash((u8)key.lcd);
+        return h;
+    }
+};
+
+namespace Karm::Gfx {
+
+// A cache of rasterized glyph coverage, packed into atlas pages.
+//
+// Glyphs are rasterized once per fontface, size, horizontal subpixel
+// offset and antialiasing mode, later fills only blend the cached coverage
+// onto the surface. Each texel holds one coverage value per LCD component,
+// grayscale glyphs store the same value in all three. When the memory
+// budget is exceeded, the least recently used page is recycled.
+struct CpuGlyphs {
+    static constexpr isize PAGE_SIZE = 256;
+    static constexpr usize CHANNELS = 3;
+    static constexpr usize SUBPIXELS = 4;
+    static constexpr usize DEFAULT_BUDGET = 4 * 1024 * 1024;
+
+    struct Shelf {
+        isize y;
+        isize height;
+        isize x;
+    };
+
+    struct Page {
+        Vec<u8> coverage;
+        Vec<Shelf> shelves;
+        Vec<CpuGlyphKey> keys;
+        usize lastUsed;
+
+        u8 const* at(Math::Vec2i p) const {
+            return &coverage[(p.y * PAGE_SIZE + p.x) * CHANNELS];
+        }
+
+        u8* at(Math::Vec2i p) {
+            return &coverage[(p.y * PAGE_SIZE + p.x) * CHANNELS];
+        }
+    };
+
+    struct Entry {
+        usize page;
+        // Where the coverage is stored in the page.
+        Math::Recti rect;
+        // Offset of the coverage relative to the snapped glyph origin.
+        Math::Vec2i offset;
+    };
+
+    struct Stats {
+        usize hits;
+        usize misses;
+        usize evictions;
+    };
+
+    usize _budget;
+    usize _tick = 0;
+    Vec<Page> _pages;
+    HashMap<CpuGlyphKey, Entry> _entries;
+    CpuRast _rast;
+    Stats _stats{};
+
+    CpuGlyphs(usize budget = DEFAULT_BUDGET)
+        : _budget(budget) {}
+
+    static usize _pageBytes() {
+        return PAGE_SIZE * PAGE_SIZE * CHANNELS;
+    }
+
+    usize usage() const {
+        return _pages.len() * _pageBytes();
+    }
+
+    usize budget() const {
+        return _budget;
+    }
+
+    Stats stats() const {
+        return _stats;
+    }
+
+    // Drop every cached glyph and release the atlas pages.
+    void clear();
+
+    Opt<Pair<usize, Math::Recti>> _pack(Page& page, Math::Vec2i size);
+
+    Opt<Pair<usize, Math::Recti>> _alloc(Math::Vec2i size);
+
+    // Lookup a glyph, returns NONE if it's not in the cache yet.
+    Opt<Entry> lookup(CpuGlyphKey const& key);
+
+    // Rasterize the glyph outline into the cache, `poly` must be relative
+    // to the snapped glyph origin. Returns NONE if the glyph is too large
+    // to be cached.
+    Opt<Entry> insert(CpuGlyphKey const& key, Math::Polyf& poly);
+
+    Page const& page(usize index) const {
+        return _pages[index];
+    }
+};
+
+CpuGlyphs& globalGlyphs();
+
+} // namespace Karm::Gfx
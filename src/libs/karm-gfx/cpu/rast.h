@@ -23,6 +23,19 @@ struct CpuRast {
         f64 a;
     };
 
+    // A run of fragments on the same scanline, `uv` being the one of the
+    // first fragment and `du` how far apart the next ones are.
+    struct Span {
+        Math::Vec2i xy;
+        Math::Vec2f uv;
+        f64 du;
+        Slice<f64> coverage;
+
+        usize len() const {
+            return coverage.len();
+        }
+    };
+
     Vec<Active> _active{};
     Vec<irange> _ranges;
     Vec<f64> _scanline{};
@@ -48,7 +61,7 @@ struct CpuRast {
         _ranges.pushBack(range);
     }
 
-    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+    void fillSpans(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
         auto polyBound = poly.bound().grow(UNIT);
         auto clipBound = polyBound
                              .ceil()
@@ -131,19 +144,35 @@ struct CpuRast {
             }
 
             for (auto r : _ranges) {
-                for (isize x = r.start; x < r.end(); x++) {
-                    auto xy = Math::Vec2i{x, y};
-
-                    auto uv = Math::Vec2f{
-                        (x - polyBound.start()) / polyBound.width,
+                cb(Span{
+                    .xy = {r.start, y},
+                    .uv = {
+                        (r.start - polyBound.start()) / polyBound.width,
                         (y - polyBound.top()) / polyBound.height,
-                    };
-
-                    cb(Frag{xy, uv, clamp01(_scanline[x - clipBound.x])});
-                }
+                    },
+                    .du = 1 / polyBound.width,
+                    .coverage = sub(_scanline, r.start - clipBound.x, r.end() - clipBound.x),
+                });
             }
         }
     }
+
+    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        auto polyBound = poly.bound().grow(UNIT);
+
+        fillSpans(poly, clip, fillRule, [&](Span const& span) {
+            for (usize i = 0; i < span.len(); i++) {
+                auto xy = span.xy + Math::Vec2i{(isize)i, 0};
+
+                auto uv = Math::Vec2f{
+                    (xy.x - polyBound.start()) / polyBound.width,
+                    span.uv.y,
+                };
+
+                cb(Frag{xy, uv, clamp01(span.coverage[i])});
+            }
+        });
+    }
 };
 
 } // namespace Karm::Gfx
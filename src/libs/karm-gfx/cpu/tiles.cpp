@@ -0,0 +1,103 @@
+#include "tiles.h"
+
+namespace Karm::Gfx {
+
+CpuTiles::Budget& CpuTiles::_budget() {
+    static Budget budget;
+    return budget;
+}
+
+CpuTiles::CpuTiles() {
+    _budget().caches.pushBack(this);
+}
+
+CpuTiles::~CpuTiles() {
+    clear();
+    auto& caches = _budget().caches;
+    for (usize i = 0; i < caches.len(); i++) {
+        if (caches[i] == this) {
+            caches.removeUnordered(i);
+            break;
+        }
+    }
+}
+
+void CpuTiles::invalidate(Math::Recti rect) {
+    for (auto& tile : _tiles)
+        if (tile.contentBound().colide(rect))
+            tile.dirty = true;
+}
+
+void CpuTiles::invalidate() {
+    for (auto& tile : _tiles)
+        tile.dirty = true;
+}
+
+void CpuTiles::clear() {
+    _budget().usage -= usage();
+    _tiles.clear();
+}
+
+Opt<usize> CpuTiles::_lookup(Math::Vec2i index, f64 scale) {
+    for (usize i = 0; i < _tiles.len(); i++)
+        if (_tiles[i].index == index and _tiles[i].scale == scale)
+            return i;
+    return NONE;
+}
+
+// Take the least recently used tile out of whichever cache holds it,
+// tiles that are part of the current frame are never evicted.
+Opt<Rc<Surface>> CpuTiles::_evict() {
+    auto& budget = _budget();
+
+    CpuTiles* owner = nullptr;
+    usize victim = 0;
+    for (auto* cache : budget.caches) {
+        for (usize i = 0; i < cache->_tiles.len(); i++) {
+            auto& tile = cache->_tiles[i];
+            if (tile.lastUsed == budget.frame)
+                continue;
+
+            if (not owner or tile.lastUsed < owner->_tiles[victim].lastUsed) {
+                owner = cache;
+                victim = i;
+            }
+        }
+    }
+
+    if (not owner)
+        return NONE;
+
+    owner->_stats.evictions++;
+    budget.usage -= _tileBytes();
+    return owner->_tiles.removeAt(victim).surface;
+}
+
+usize CpuTiles::_alloc(Math::Vec2i index, f64 scale) {
+    auto& budget = _budget();
+
+    // NOTE: We might go over budget when the visible area is larger than
+    //       what the budget allows, extra tiles are released as soon as
+    //       they are out of view.
+    Opt<Rc<Surface>> surface = NONE;
+    while (budget.usage + _tileBytes() > budget.limit) {
+        auto evicted = _evict();
+        if (not evicted)
+            break;
+        surface = evicted;
+    }
+
+    // NOTE: Evicting from this cache may have moved tiles around, so the
+    //       new one goes at the end.
+    budget.usage += _tileBytes();
+    _tiles.pushBack({
+        .index = index,
+        .scale = scale,
+        .surface = surface ? surface.take() : Surface::alloc({SIZE, SIZE}),
+        .dirty = true,
+        .lastUsed = budget.frame,
+    });
+    return _tiles.len() - 1;
+}
+
+} // namespace Karm::Gfx
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "canvas.h"
+
+namespace Karm::Gfx {
+
+// A retained cache of rasterized content, split into fixed size tiles.
+//
+// Content is painted once into offscreen tiles, later paints only blit
+// the tiles back, re-rasterizing the ones that are newly exposed or were
+// invalidated. Tiles are keyed by their position in content space and by
+// the scale they were rasterized at.
+//
+// All caches share a single memory budget, once it's exceeded the least
+// recently used tile of any of them is recycled. Caches register with the
+// budget for their whole life, so they can't be moved.
+struct CpuTiles : Meta::Pinned {
+    static constexpr isize SIZE = 256;
+    static constexpr usize DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+    struct Tile {
+        Math::Vec2i index;
+        f64 scale;
+        Rc<Surface> surface;
+        bool dirty;
+        usize lastUsed;
+
+        // The tile bound in device space.
+        Math::Recti bound() const {
+            return {index * SIZE, {SIZE, SIZE}};
+        }
+
+        // The tile bound in content space, rounded outward to whole pixels.
+        Math::Recti contentBound() const {
+            return _toContent(bound(), scale);
+        }
+    };
+
+    struct Stats {
+        usize hits;
+        usize misses;
+        usize evictions;
+    };
+
+    // Shared by every cache, `frame` counts paints across all of them so
+    // their tiles can be compared by age.
+    struct Budget {
+        usize limit = DEFAULT_BUDGET;
+        usize usage = 0;
+        usize frame = 0;
+        Vec<CpuTiles*> caches;
+    };
+
+    static Budget& _budget();
+
+    Vec<Tile> _tiles;
+    Stats _stats{};
+
+    CpuTiles();
+
+    ~CpuTiles();
+
+    static isize _floorDiv(isize a, isize b) {
+        return a / b - (a % b != 0 and (a < 0) != (b < 0));
+    }
+
+    static isize _ceilDiv(isize a, isize b) {
+        return -_floorDiv(-a, b);
+    }
+
+    static Math::Recti _toDevice(Math::Recti r, f64 scale) {
+        if (scale == 1)
+            return r;
+
+        return Math::Recti::fromTwoPoint(
+            {
+                (isize)__builtin_floor(r.start() * scale),
+                (isize)__builtin_floor(r.top() * scale),
+            },
+            {
+                (isize)__builtin_ceil(r.end() * scale),
+                (isize)__builtin_ceil(r.bottom() * scale),
+            }
+        );
+    }
+
+    static Math::Recti _toContent(Math::Recti r, f64 scale) {
+        return _toDevice(r, 1 / scale);
+    }
+
+    static usize _tileBytes() {
+        return SIZE * SIZE * RGBA8888.bpp();
+    }
+
+    // Memory used by the tiles of this cache.
+    usize usage() const {
+        return _tiles.len() * _tileBytes();
+    }
+
+    // Memory used by the tiles of every cache.
+    static usize totalUsage() {
+        return _budget().usage;
+    }
+
+    static usize budget() {
+        return _budget().limit;
+    }
+
+    // Change the budget shared by every cache, tiles over it are released
+    // as they stop being used.
+    static void budget(usize limit) {
+        _budget().limit = limit;
+    }
+
+    Stats stats() const {
+        return _stats;
+    }
+
+    // Mark all the tiles intersecting the given content-space rectangle as
+    // needing to be re-rasterized.
+    void invalidate(Math::Recti rect);
+
+    // Mark all the tiles as needing to be re-rasterized.
+    void invalidate();
+
+    // Drop every tile and release their memory.
+    void clear();
+
+    Opt<usize> _lookup(Math::Vec2i index, f64 scale);
+
+    Opt<Rc<Surface>> _evict();
+
+    usize _alloc(Math::Vec2i index, f64 scale);
+
+    // Paint the given content-space rectangle onto the canvas, the
+    // `paint` callback is used to rasterize the tiles that are missing or
+    // dirty. It receives a canvas set up to draw in content space and the
+    // content-space rectangle being rasterized.
+    void paint(Canvas& g, Math::Recti rect, f64 scale, auto const& paint) {
+        usize frame = ++_budget().frame;
+
+        auto device = _toDevice(rect, scale);
+        Math::Recti tiles = Math::Recti::fromTwoPoint(
+            {
+                _floorDiv(device.start(), SIZE),
+                _floorDiv(device.top(), SIZE),
+            },
+            {
+                _ceilDiv(device.end(), SIZE),
+                _ceilDiv(device.bottom(), SIZE),
+            }
+        );
+
+        // NOTE: Tiles are blitted in device units, at their exact size,
+        //       going through their content bound would round them
+        //       outward and resample them at fractional scales.
+        g.push();
+        g.scale(1 / scale);
+
+        for (isize y = tiles.top(); y < tiles.bottom(); y++) {
+            for (isize x = tiles.start(); x < tiles.end(); x++) {
+                auto& tile = _tiles[_lookup({x, y}, scale).unwrapOrElse([&] {
+                    return _alloc({x, y}, scale);
+                })];
+                tile.lastUsed = frame;
+
+                if (tile.dirty) {
+                    _stats.misses++;
+
+                    Math::Vec2i origin = tile.bound().xy;
+                    CpuCanvas tg;
+                    tg.begin(*tile.surface);
+                    tg.clear(ALPHA);
+                    tg.origin(-origin.cast<f64>());
+                    tg.scale(scale);
+                    paint(tg, tile.contentBound());
+                    tg.end();
+
+                    tile.dirty = false;
+                } else {
+                    _stats.hits++;
+                }
+
+                g.blit(tile.bound(), *tile.surface);
+            }
+        }
+
+        g.pop();
+    }
+};
+
+} // namespace Karm::Gfx
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/simd.h>
 #include <karm-base/union.h>
 #include <karm-base/vec.h>
 #include <karm-math/trans.h>
@@ -21,11 +22,104 @@ struct Gradient {
     using Buf = Array<Color, 256>;
     using Stop = Pair<Color, f64>;
 
+    // A gradient with its start and end points folded into an affine map
+    // from sample position to gradient space. It's only prepared again when
+    // the points or the type change, sampling it doesn't involve any
+    // trigonometry.
+    struct Prepared {
+        Type type;
+        Math::Vec2f origin;
+        Math::Vec2f du;
+        Math::Vec2f dv;
+        Buf const* buf;
+
+        always_inline Math::Vec2f project(Math::Vec2f pos) const {
+            return origin + du * pos.x + dv * pos.y;
+        }
+
+        always_inline f64 evalProjected(Math::Vec2f p) const {
+            switch (type) {
+            case LINEAR:
+                return p.x;
+
+            case RADIAL:
+                return p.len();
+
+            case CONICAL:
+                return (p.angle() + Math::PI) / Math::TAU;
+
+            case DIAMOND:
+                return Math::abs(p.x) + Math::abs(p.y);
+            }
+        }
+
+        always_inline f64 eval(Math::Vec2f pos) const {
+            return evalProjected(project(pos));
+        }
+
+        always_inline Color lookup(f64 t) const {
+            return (*buf)[usize(clamp(t * 255, 0.0, 255.0))];
+        }
+
+        always_inline Color sample(Math::Vec2f pos) const {
+            return lookup(eval(pos));
+        }
+
+        // Same as above, four positions at once.
+        always_inline f64x4 evalProjected(f64x4 x, f64x4 y) const {
+            switch (type) {
+            case LINEAR:
+                return x;
+
+            case DIAMOND:
+                return (x < 0 ? -x : x) + (y < 0 ? -y : y);
+
+            default:
+                f64x4 t;
+                for (usize i = 0; i < 4; i++)
+                    t[i] = evalProjected(Math::Vec2f{x[i], y[i]});
+                return t;
+            }
+        }
+
+        always_inline void lookup(f64x4 t, Color* out) const {
+            t = t * 255;
+            t = t < 0 ? 0 : t;
+            t = t > 255 ? 255 : t;
+            auto index = __builtin_convertvector(t, i32x4);
+            for (usize i = 0; i < 4; i++)
+                out[i] = (*buf)[index[i]];
+        }
+
+        // Sample a run of positions starting at `pos`, each `step` further
+        // along u than the previous one. Gradient space is an affine map of
+        // the sample space, so the positions are stepped there instead of
+        // projecting each one, and evaluated four at a time.
+        void sampleSpan(Math::Vec2f pos, f64 step, MutSlice<Color> out) const {
+            auto p = project(pos);
+            auto d = du * step;
+
+            usize i = 0;
+            for (; i + 4 <= out.len(); i += 4) {
+                f64x4 k = f64x4{0, 1, 2, 3} + (f64)i;
+                f64x4 t = evalProjected(p.x + d.x * k, p.y + d.y * k);
+                lookup(t, out.buf() + i);
+            }
+
+            for (; i < out.len(); i++)
+                out[i] = lookup(evalProjected(p + d * (f64)i));
+        }
+    };
+
     Type _type = LINEAR;
     Math::Vec2f _start = {0.5, 0.5};
     Math::Vec2f _end = {1, 1};
     Rc<Buf> _buf;
 
+    // Kept up to date by the constructor and the setters below, so sampling
+    // never has to prepare the gradient again.
+    Prepared _prepared;
+
     struct Builder {
         static constexpr isize LIMIT = 16;
 
@@ -105,53 +199,61 @@ struct Gradient {
     }
 
     Gradient(Type type, Math::Vec2f start, Math::Vec2f end, Rc<Buf> buf)
-        : _type(type), _start(start), _end(end), _buf(buf) {}
+        : _type(type), _start(start), _end(end), _buf(buf), _prepared(_prepare()) {}
 
     Gradient& withType(Type type) {
         _type = type;
+        _prepared = _prepare();
         return *this;
     }
 
     Gradient& withStart(Math::Vec2f start) {
         _start = start;
+        _prepared = _prepare();
         return *this;
     }
 
     Gradient& withEnd(Math::Vec2f end) {
         _end = end;
+        _prepared = _prepare();
         return *this;
     }
 
     Gradient& withPoints(Math::Vec2f start, Math::Vec2f end) {
         _start = start;
         _end = end;
+        _prepared = _prepare();
         return *this;
     }
 
-    always_inline f64 transform(Math::Vec2f pos) const {
-        pos = pos - _start;
-        pos = pos.rotate(-(_end - _start).angle());
-        f64 scale = (_end - _start).len();
-        pos = pos / scale;
-
-        switch (_type) {
-        case LINEAR:
-            return pos.x;
-
-        case RADIAL:
-            return pos.len();
+    Prepared _prepare() const {
+        // Rotating by the opposite of the gradient angle and dividing by
+        // its length is the same as projecting on the gradient axis and
+        // dividing by the squared length.
+        auto d = _end - _start;
+        f64 len2 = d.x * d.x + d.y * d.y;
+        Math::Vec2f du = {d.x / len2, -d.y / len2};
+        Math::Vec2f dv = {d.y / len2, d.x / len2};
+
+        return {
+            .type = _type,
+            .origin = -(du * _start.x + dv * _start.y),
+            .du = du,
+            .dv = dv,
+            .buf = &*_buf,
+        };
+    }
 
-        case CONICAL:
-            return (pos.angle() + Math::PI) / Math::TAU;
+    Prepared const& prepare() const {
+        return _prepared;
+    }
 
-        case DIAMOND:
-            return Math::abs(pos.x) + Math::abs(pos.y);
-        }
+    always_inline f64 transform(Math::Vec2f pos) const {
+        return _prepared.eval(pos);
     }
 
     always_inline Color sample(Math::Vec2f pos) const {
-        auto p = transform(pos);
-        return (*_buf)[clamp(usize(p * 255), 0uz, 255uz)];
+        return _prepared.sample(pos);
     }
 };
 
@@ -1,100 +1,155 @@
-#include <karm-base/ring.h>
+#include <karm-base/simd.h>
+#include <karm-math/funcs.h>
 #include <karm-math/rand.h>
 
 #include "filters.h"
 
 namespace Karm::Gfx {
 
+// MARK: Blur ------------------------------------------------------------------
+
+// Stack blur using running sums, so every pixel costs the same whatever the
+// radius. Pixels past the ends of the line are clamped to the edge.
+//
+// The four channels of a pixel are summed together as the lanes of a single
+// vector `V`, see karm-base/simd.h.
+template <typename V>
 struct StackBlur {
+    using Lane = Meta::RemoveConstVolatileRef<decltype(V{}[0])>;
+
     isize _radius;
-    Ring<Math::Vec4u> _queue;
-    Math::Vec4u _sum;
+    Vec<V> _stack;
 
     StackBlur(isize radius)
-        : _radius(radius), _queue(width()) {
-        clear();
-    }
-
-    Math::Vec4u outgoingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(i);
-        }
-        return sum;
-    }
-
-    Math::Vec4u incomingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(width() - i - 1);
-        }
-        return sum;
+        : _radius(radius) {
+        _stack.resize(width(), V{});
     }
 
     isize width() const {
         return _radius * 2 + 1;
     }
 
-    isize denominator() const {
-        return _radius * (_radius + 2) - 1;
+    Lane denominator() const {
+        return (_radius + 1) * (_radius + 1);
     }
 
-    void enqueue(Math::Vec4u color) {
-        _queue.pushBack(color);
-        _sum = _sum + incomingSum() - outgoingSum();
+    always_inline static V _load(Color c) {
+        return V{c.red, c.green, c.blue, c.alpha};
     }
 
-    Math::Vec4u dequeue() {
-        auto res = _sum / denominator();
-        _queue.popFront();
-        return res;
+    always_inline static Color _store(V v) {
+        return Color(v[0], v[1], v[2], v[3]);
     }
 
-    void clear() {
-        _sum = {};
-        _queue.clear();
-        for (isize i = 0; i < width(); i++) {
-            _queue.pushBack({});
+    // Blur a line of `len` pixels, the results are written every `stride`
+    // pixels, which allows passes to write their output transposed.
+    void apply(Color const* in, isize len, Color* out, isize stride) {
+        isize r = _radius;
+        isize w = width();
+        V sum = {};
+        V sumIn = {};
+        V sumOut = {};
+
+        for (isize i = -r; i <= r; i++) {
+            V p = _load(in[clamp(i, 0, len - 1)]);
+            _stack[i + r] = p;
+            sum += p * (Lane)(r + 1 - Math::abs(i));
+            if (i > 0)
+                sumIn += p;
+            else
+                sumOut += p;
+        }
+
+        isize sp = r;
+        Lane den = denominator();
+        for (isize x = 0; x < len; x++) {
+            out[x * stride] = _store(sum / den);
+            sum -= sumOut;
+
+            isize oldest = sp + r + 1;
+            if (oldest >= w)
+                oldest -= w;
+            sumOut -= _stack[oldest];
+
+            V p = _load(in[min(x + r + 1, len - 1)]);
+            _stack[oldest] = p;
+            sumIn += p;
+            sum += sumIn;
+
+            if (++sp == w)
+                sp = 0;
+            sumOut += _stack[sp];
+            sumIn -= _stack[sp];
         }
     }
 };
 
-[[gnu::flatten]] void BlurFilter::apply(MutPixels p) const {
-    if (amount == 0)
-        return;
-
-    StackBlur stack{(isize)amount};
-    auto b = p.bound();
-
-    for (isize y = b.top(); y < b.bottom(); y++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            auto x = b.start() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
+// Lines are blurred by bands of TILE, and their results are written
+// transposed, a whole band at a time, so both passes read and write
+// memory sequentially.
+static constexpr isize TILE = 8;
+
+// Blur the rows of `in` (`width` x `height`), and write them as the
+// columns of `out` (`height` x `width`).
+template <typename V>
+static void _blurTransposed(StackBlur<V>& stack, Color const* in, isize width, isize height, Color* out) {
+    Vec<Color> band;
+    band.resize(TILE * width);
+
+    for (isize y = 0; y < height; y += TILE) {
+        isize rows = min(TILE, height - y);
+        for (isize i = 0; i < rows; i++)
+            stack.apply(in + (y + i) * width, width, band.buf() + i, TILE);
+
+        for (isize x = 0; x < width; x++) {
+            Color* dst = out + x * height + y;
+            Color const* src = band.buf() + x * TILE;
+            for (isize i = 0; i < rows; i++)
+                dst[i] = src[i];
         }
+    }
+}
 
-        for (isize x = b.start(); x < b.end(); x++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x + (isize)amount + 1, y}));
-        }
+// NOTE: Blurring the rows of the transposed image is the vertical pass,
+//       and transposing again brings the image back upright.
+template <typename V>
+static void _blur(isize radius, Color* buf, Color* transposed, isize width, isize height) {
+    StackBlur<V> stack{radius};
+    _blurTransposed(stack, buf, width, height, transposed);
+    _blurTransposed(stack, transposed, height, width, buf);
+}
 
-        stack.clear();
-    }
+[[gnu::flatten]] void BlurFilter::apply(MutPixels p) const {
+    isize radius = amount;
+    isize width = p.width();
+    isize height = p.height();
 
-    for (isize x = b.start(); x < b.end(); x++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            isize const y = b.top() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
-        }
+    if (radius <= 0 or width == 0 or height == 0)
+        return;
 
-        for (isize y = b.top(); y < b.bottom(); y++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x, y + (isize)amount + 1}));
-        }
+    Vec<Color> buf;
+    buf.resize(width * height);
+    Vec<Color> transposed;
+    transposed.resize(width * height);
 
-        stack.clear();
-    }
+    p.fmt().visit([&](auto f) {
+        for (isize y = 0; y < height; y++)
+            for (isize x = 0; x < width; x++)
+                buf[y * width + x] = f.load(p.pixelUnsafe({x, y}));
+    });
+
+    // NOTE: The weighted sum of a channel is at most (radius + 1)² * 255,
+    //       32-bit lanes hold it up to a radius of 4103.
+    if ((u64)(radius + 1) * (radius + 1) * 255 <= Limits<u32>::MAX)
+        _blur<u32x4>(radius, buf.buf(), transposed.buf(), width, height);
+    else
+        _blur<u64x4>(radius, buf.buf(), transposed.buf(), width, height);
+
+    p.fmt().visit([&](auto f) {
+        for (isize y = 0; y < height; y++)
+            for (isize x = 0; x < width; x++)
+                f.store(p.pixelUnsafe({x, y}), buf[y * width + x]);
+    });
 }
 
 void SaturationFilter::apply(MutPixels p) const {
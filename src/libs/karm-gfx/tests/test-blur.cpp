@@ -0,0 +1,93 @@
+#include <karm-gfx/buffer.h>
+#include <karm-gfx/filters.h>
+#include <karm-math/rand.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+// The blur computed the slow way, every pixel is the sum of its neighbours
+// weighted by a triangle, with the edges clamped, rounded down to a color
+// after each pass, as the filter always did.
+static Vec<Color> _referenceBlur(Vec<Color> const& in, isize width, isize height, isize radius) {
+    usize den = (radius + 1) * (radius + 1);
+
+    auto pass = [&](Vec<Color> const& src, isize dx, isize dy) {
+        Vec<Color> dst;
+        dst.resize(width * height);
+        for (isize y = 0; y < height; y++) {
+            for (isize x = 0; x < width; x++) {
+                Math::Vec4u sum = {};
+                for (isize i = -radius; i <= radius; i++) {
+                    isize sx = clamp(x + i * dx, 0, width - 1);
+                    isize sy = clamp(y + i * dy, 0, height - 1);
+                    Math::Vec4u p = src[sy * width + sx];
+                    sum = sum + p * (usize)(radius + 1 - Math::abs(i));
+                }
+                dst[y * width + x] = sum / den;
+            }
+        }
+        return dst;
+    };
+
+    return pass(pass(in, 1, 0), 0, 1);
+}
+
+static bool _matchesReference(Math::Vec2i size, isize radius, u64 seed) {
+    Math::Rand rand{seed};
+    auto surface = Surface::alloc(size);
+    auto pixels = surface->mutPixels();
+
+    Vec<Color> in;
+    for (isize y = 0; y < size.y; y++) {
+        for (isize x = 0; x < size.x; x++) {
+            auto color = Color::fromRgba(rand.nextU8(), rand.nextU8(), rand.nextU8(), rand.nextU8());
+            pixels.store({x, y}, color);
+            in.pushBack(pixels.load({x, y}));
+        }
+    }
+
+    BlurFilter{(f64)radius}.apply(pixels);
+    auto expected = _referenceBlur(in, size.x, size.y, radius);
+
+    for (isize y = 0; y < size.y; y++)
+        for (isize x = 0; x < size.x; x++)
+            if (pixels.load({x, y}) != expected[y * size.x + x])
+                return false;
+
+    return true;
+}
+
+test$("blur-matches-reference") {
+    for (isize radius : {1, 2, 5, 16, 32})
+        expect$(_matchesReference({37, 23}, radius, radius));
+    return Ok();
+}
+
+test$("blur-small-surfaces") {
+    // Radii wider than the surface only ever see its edges
+    expect$(_matchesReference({1, 1}, 4, 1));
+    expect$(_matchesReference({1, 9}, 4, 2));
+    expect$(_matchesReference({9, 1}, 4, 3));
+    expect$(_matchesReference({3, 2}, 32, 4));
+
+    // Past a radius of 4103 the sums no longer fit in 32-bit lanes
+    expect$(_matchesReference({3, 2}, 5000, 5));
+    return Ok();
+}
+
+test$("blur-flat-color") {
+    auto surface = Surface::alloc({16, 16});
+    auto pixels = surface->mutPixels();
+    auto color = Color::fromRgba(12, 200, 77, 255);
+    pixels.clear(color);
+
+    // The weights add up to the denominator, nothing is lost to rounding
+    BlurFilter{8}.apply(pixels);
+    for (isize y = 0; y < 16; y++)
+        for (isize x = 0; x < 16; x++)
+            expect$(pixels.load({x, y}) == color);
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -0,0 +1,180 @@
+#include <karm-gfx/cpu/canvas.h>
+#include <karm-gfx/fill.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+// How gradients were sampled before they were prepared, rotating and
+// scaling every position on its own.
+//
+// NOTE: Math::cos() is a fast approximation, off by up to ~0.1%, which is
+//       more than the prepared map. The rotation is done with the exact
+//       builtins so both can be compared closely.
+static f64 _referenceTransform(Gradient const& g, Math::Vec2f pos) {
+    pos = pos - g._start;
+    f64 angle = -(g._end - g._start).angle();
+    f64 c = __builtin_cos(angle);
+    f64 s = __builtin_sin(angle);
+    pos = {pos.x * c - pos.y * s, pos.x * s + pos.y * c};
+    f64 scale = (g._end - g._start).len();
+    pos = pos / scale;
+
+    switch (g._type) {
+    case Gradient::LINEAR:
+        return pos.x;
+
+    case Gradient::RADIAL:
+        return pos.len();
+
+    case Gradient::CONICAL:
+        return (pos.angle() + Math::PI) / Math::TAU;
+
+    case Gradient::DIAMOND:
+        return Math::abs(pos.x) + Math::abs(pos.y);
+    }
+}
+
+// Compare against the reference on a grid covering the unit square and
+// some of its surroundings. Colors are only compared away from the edges
+// of the lookup table entries, where rounding may fall either way.
+static bool _matchesReference(Gradient const& g) {
+    for (isize y = -8; y <= 40; y++) {
+        for (isize x = -8; x <= 40; x++) {
+            Math::Vec2f pos = {x / 32.0, y / 32.0};
+
+            // The angle around the start point itself is undefined
+            if (g._type == Gradient::CONICAL and pos == g._start)
+                continue;
+
+            f64 expected = _referenceTransform(g, pos);
+            f64 t = g.transform(pos);
+
+            // The conical angle wraps around behind the start point
+            f64 diff = Math::abs(t - expected);
+            if (g._type == Gradient::CONICAL)
+                diff = min(diff, 1 - diff);
+            if (diff > 1e-9)
+                return false;
+
+            f64 index = clamp(expected * 255, 0.0, 255.0);
+            if (Math::abs(index - Math::round(index)) < 1e-6)
+                continue;
+
+            if (g.sample(pos) != (*g._buf)[usize(index)])
+                return false;
+        }
+    }
+    return true;
+}
+
+test$("gradient-matches-reference") {
+    auto g = Gradient::linear().withColors(BLACK, WHITE).bake();
+
+    Array<Math::Vec2f, 6> points = {
+        Math::Vec2f{0, 0},
+        {1, 1},
+        {0.5, 0.5},
+        {1, 0.25},
+        {0.2, 0.9},
+        {-0.3, 0.1},
+    };
+
+    for (auto type : {Gradient::LINEAR, Gradient::RADIAL, Gradient::CONICAL, Gradient::DIAMOND}) {
+        g.withType(type);
+        for (usize i = 0; i < points.len(); i++) {
+            for (usize j = 0; j < points.len(); j++) {
+                if (i == j)
+                    continue;
+                g.withPoints(points[i], points[j]);
+                expect$(_matchesReference(g));
+            }
+        }
+    }
+
+    return Ok();
+}
+
+test$("gradient-prepared-follows-setters") {
+    auto g = Gradient::hlinear().withColors(BLACK, WHITE).bake();
+    auto first = (*g._buf)[0];
+    auto last = (*g._buf)[255];
+    expect$(first != last);
+    expect$(g.sample({0, 0.5}) == first);
+    expect$(g.sample({1, 0.5}) == last);
+
+    // Flipping the points flips the gradient
+    g.withStart({1, 0.5});
+    g.withEnd({0, 0.5});
+    expect$(g.sample({0, 0.5}) == last);
+    expect$(g.sample({1, 0.5}) == first);
+
+    // A copy samples the same colors as the original
+    Fill fill = g;
+    expect$(fill.sample({0, 0.5}) == last);
+    expect$(fill.sample({1, 0.5}) == first);
+
+    g.withType(Gradient::RADIAL);
+    expect$(g.sample({1, 0.5}) == first);
+    expect$(g.sample({0, 0.5}) == last);
+    expect$(g.sample({0.5, 0.5}) != first);
+
+    return Ok();
+}
+
+// Stepping along a span lands on the same positions as projecting each of
+// them, up to rounding, which at most picks the neighbouring entry of the
+// lookup table.
+static bool _close(Color a, Color b) {
+    return Math::abs(a.red - b.red) <= 1 and
+           Math::abs(a.green - b.green) <= 1 and
+           Math::abs(a.blue - b.blue) <= 1 and
+           a.alpha == b.alpha;
+}
+
+test$("gradient-sample-span") {
+    auto g = Gradient::linear().withColors(BLACK, WHITE).bake();
+    g.withPoints({0.2, 0.1}, {0.7, 0.9});
+
+    // Long enough for both the lanes and the leftovers
+    Array<Color, 23> out;
+    f64 step = 1.0 / 17;
+
+    for (auto type : {Gradient::LINEAR, Gradient::RADIAL, Gradient::CONICAL, Gradient::DIAMOND}) {
+        g.withType(type);
+        for (isize y = -4; y <= 20; y++) {
+            Math::Vec2f pos = {-0.3, y / 16.0};
+            g.prepare().sampleSpan(pos, step, out);
+            for (usize i = 0; i < out.len(); i++)
+                expect$(_close(out[i], g.sample({pos.x + step * i, pos.y})));
+        }
+    }
+
+    return Ok();
+}
+
+test$("gradient-fill-spans") {
+    // Wider than what the canvas samples in one go
+    auto surface = Surface::alloc({200, 2});
+    auto g = Gradient::hlinear().withColors(BLACK, WHITE).bake();
+
+    CpuCanvas c;
+    c.begin(*surface);
+    c.clear(WHITE);
+    c.fillStyle(g);
+    c.fill(Math::Recti{0, 0, 200, 2}, 0);
+    c.end();
+
+    // The rasterizer grows the shape by a third of a pixel for coverage
+    f64 grow = 1.0 / 3;
+    auto pixels = surface->pixels();
+    for (isize y = 0; y < 2; y++) {
+        for (isize x = 0; x < 200; x++) {
+            Math::Vec2f uv = {(x + grow) / (200 + 2 * grow), (y + grow) / (2 + 2 * grow)};
+            expect$(_close(pixels.load({x, y}), g.sample(uv)));
+        }
+    }
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
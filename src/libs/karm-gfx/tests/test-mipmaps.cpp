@@ -0,0 +1,180 @@
+#include <karm-gfx/cpu/canvas.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+static constexpr Color RED = {255, 0, 0, 255};
+static constexpr Color GREEN = {0, 255, 0, 255};
+static constexpr Color BLUE = {0, 0, 255, 255};
+
+static Color _gray(u8 v) {
+    return Color::fromRgba(v, v, v, 255);
+}
+
+// Black and white pixels alternating in both directions.
+static Rc<Surface> _checkerboard(Math::Vec2i size) {
+    auto surface = Surface::alloc(size);
+    auto pixels = surface->mutPixels();
+    for (isize y = 0; y < size.y; y++)
+        for (isize x = 0; x < size.x; x++)
+            pixels.store({x, y}, (x + y) % 2 ? WHITE : BLACK);
+    return surface;
+}
+
+test$("mip-box-filter") {
+    auto surface = Surface::alloc({4, 2});
+    auto pixels = surface->mutPixels();
+    pixels.store({0, 0}, _gray(0));
+    pixels.store({1, 0}, _gray(10));
+    pixels.store({0, 1}, _gray(20));
+    pixels.store({1, 1}, _gray(31));
+    pixels.store({2, 0}, Color::fromRgba(255, 0, 0, 0));
+    pixels.store({3, 0}, Color::fromRgba(255, 0, 0, 255));
+    pixels.store({2, 1}, Color::fromRgba(0, 255, 0, 255));
+    pixels.store({3, 1}, Color::fromRgba(0, 255, 0, 255));
+
+    auto const& mip = surface->mip(1);
+    expectEq$(mip.width(), 2);
+    expectEq$(mip.height(), 1);
+
+    // Every channel is averaged on its own, rounding to nearest
+    expect$(mip.pixels().load({0, 0}) == _gray(15));
+    expect$(mip.pixels().load({1, 0}) == Color::fromRgba(128, 128, 0, 191));
+
+    return Ok();
+}
+
+test$("mip-chain") {
+    auto surface = _checkerboard({64, 32});
+
+    expect$(&surface->mip(0) == &*surface);
+    expectEq$(surface->mip(1).width(), 32);
+    expectEq$(surface->mip(1).height(), 16);
+
+    // Levels stop at a single pixel, the last one is handed out past it
+    auto const& last = surface->mip(Surface::MAX_MIP_LEVEL);
+    expectEq$(last.width(), 1);
+    expectEq$(last.height(), 1);
+    expect$(&surface->mip(7) == &last);
+    expect$(last.pixels().load({0, 0}) == _gray(128));
+
+    // The smallest level that is still large enough
+    expect$(&surface->mipFor({64, 32}) == &*surface);
+    expect$(&surface->mipFor({100, 100}) == &*surface);
+    expect$(&surface->mipFor({32, 16}) == &surface->mip(1));
+    expect$(&surface->mipFor({20, 10}) == &surface->mip(1));
+    expect$(&surface->mipFor({16, 1}) == &surface->mip(2));
+    expect$(&surface->mipFor({1, 1}) == &surface->mip(5));
+
+    return Ok();
+}
+
+test$("mip-invalidate-on-write") {
+    auto surface = Surface::alloc({8, 8});
+
+    // Taking write access drops the levels
+    surface->mutPixels().clear(RED);
+    expect$(surface->mip(1).pixels().load({0, 0}) == RED);
+
+    surface->mutPixels().clear(BLUE);
+    expect$(surface->mip(1).pixels().load({0, 0}) == BLUE);
+
+    // Pixels kept around to write to later need the surface marked again
+    auto pixels = surface->mutPixels();
+    expect$(surface->mip(1).pixels().load({3, 3}) == BLUE);
+    pixels.clip({4, 4, 4, 4}).clear(GREEN);
+    surface->dirty();
+    expect$(surface->mip(1).pixels().load({3, 3}) == GREEN);
+    expect$(surface->mip(1).pixels().load({0, 0}) == BLUE);
+
+    // A canvas marks its surface on every drawing operation
+    CpuCanvas g;
+    g.begin(*surface);
+    g.clear(WHITE);
+    expect$(surface->mip(1).pixels().load({0, 0}) == WHITE);
+    g.clear(BLACK);
+    expect$(surface->mip(1).pixels().load({0, 0}) == BLACK);
+    g.end();
+
+    // Reading alone keeps the levels
+    auto const* mip = &surface->mip(1);
+    expect$(surface->pixels().load({0, 0}) == BLACK);
+    expect$(&surface->mip(1) == mip);
+
+    return Ok();
+}
+
+test$("blit-copy-formats") {
+    auto translucent = Color::fromRgba(255, 0, 0, 128);
+
+    for (auto fmt : {Fmt{RGBA8888}, Fmt{BGRA8888}}) {
+        // An opaque row, copied as is or swizzled, and a translucent one,
+        // blended over what is underneath
+        auto src = Surface::alloc({3, 2}, fmt);
+        auto s = src->mutPixels();
+        s.store({0, 0}, RED);
+        s.store({1, 0}, GREEN);
+        s.store({2, 0}, BLUE);
+        s.store({0, 1}, translucent);
+        s.store({1, 1}, WHITE);
+        s.store({2, 1}, BLACK);
+
+        auto dest = Surface::alloc({3, 2}, RGBA8888);
+        CpuCanvas g;
+        g.begin(*dest);
+        g.clear(WHITE);
+        g.blit(src->bound(), dest->bound(), src->pixels());
+        g.end();
+
+        auto d = dest->pixels();
+        expect$(d.load({0, 0}) == RED);
+        expect$(d.load({1, 0}) == GREEN);
+        expect$(d.load({2, 0}) == BLUE);
+        expect$(d.load({0, 1}) == translucent.blendOver(WHITE));
+        expect$(d.load({1, 1}) == WHITE);
+        expect$(d.load({2, 1}) == BLACK);
+    }
+
+    return Ok();
+}
+
+test$("blit-bilinear") {
+    auto src = Surface::alloc({2, 1});
+    src->mutPixels().store({0, 0}, BLACK);
+    src->mutPixels().store({1, 0}, WHITE);
+
+    auto dest = Surface::alloc({4, 1});
+    CpuCanvas g;
+    g.begin(*dest);
+    g.blit(src->bound(), dest->bound(), src->pixels());
+    g.end();
+
+    // Sampled under the center of each pixel, clamped at the edges
+    auto d = dest->pixels();
+    expect$(d.load({0, 0}) == _gray(0));
+    expect$(d.load({1, 0}) == _gray(63));
+    expect$(d.load({2, 0}) == _gray(191));
+    expect$(d.load({3, 0}) == _gray(255));
+
+    return Ok();
+}
+
+test$("blit-surface-uses-mips") {
+    auto src = _checkerboard({16, 16});
+    auto dest = Surface::alloc({2, 2});
+
+    CpuCanvas g;
+    g.begin(*dest);
+    g.blit(dest->bound(), *src);
+    g.end();
+
+    // Sampling the full size checkerboard would only ever see black or
+    // white, the mip levels average them out.
+    for (isize y = 0; y < 2; y++)
+        for (isize x = 0; x < 2; x++)
+            expect$(dest->pixels().load({x, y}) == _gray(128));
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -0,0 +1,142 @@
+#include <karm-gfx/cpu/tiles.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+static constexpr isize TILE = CpuTiles::SIZE;
+
+static bool _eq(Math::Recti a, Math::Recti b) {
+    return a.x == b.x and a.y == b.y and a.width == b.width and a.height == b.height;
+}
+
+// Paints `rect` through the cache, and returns the content-space bounds
+// of the tiles that had to be rasterized.
+static Vec<Math::Recti> _paint(CpuTiles& tiles, Surface& target, Math::Recti rect, f64 scale = 1) {
+    Vec<Math::Recti> rasterized;
+    CpuCanvas g;
+    g.begin(target);
+    g.scale(scale);
+    tiles.paint(g, rect, scale, [&](Canvas& tg, Math::Recti tr) {
+        rasterized.pushBack(tr);
+        tg.clear(tr, RED);
+    });
+    g.end();
+    return rasterized;
+}
+
+test$("tiles-invalidate-on-damage") {
+    CpuTiles tiles;
+    auto target = Surface::alloc({TILE * 2, TILE * 2});
+
+    auto first = _paint(tiles, *target, {0, 0, TILE * 2, TILE * 2});
+    expectEq$(first.len(), 4uz);
+    expectEq$(tiles.stats().misses, 4uz);
+
+    // Nothing changed, everything comes from the cache
+    expectEq$(_paint(tiles, *target, {0, 0, TILE * 2, TILE * 2}).len(), 0uz);
+    expectEq$(tiles.stats().hits, 4uz);
+
+    // Only the tile under the damage is rasterized again
+    tiles.invalidate(Math::Recti{TILE + 44, 10, 5, 5});
+    auto damaged = _paint(tiles, *target, {0, 0, TILE * 2, TILE * 2});
+    expectEq$(damaged.len(), 1uz);
+    expect$(_eq(damaged[0], {TILE, 0, TILE, TILE}));
+
+    // Damage across a tile edge hits both sides of it
+    tiles.invalidate(Math::Recti{TILE - 2, TILE - 2, 4, 4});
+    expectEq$(_paint(tiles, *target, {0, 0, TILE * 2, TILE * 2}).len(), 4uz);
+
+    tiles.invalidate();
+    expectEq$(_paint(tiles, *target, {0, 0, TILE * 2, TILE * 2}).len(), 4uz);
+
+    return Ok();
+}
+
+test$("tiles-scale") {
+    CpuTiles tiles;
+    auto target = Surface::alloc({TILE, TILE});
+
+    // At twice the density a tile covers half as much content
+    auto rasterized = _paint(tiles, *target, {0, 0, TILE / 2, TILE / 2}, 2);
+    expectEq$(rasterized.len(), 1uz);
+    expect$(_eq(rasterized[0], {0, 0, TILE / 2, TILE / 2}));
+    expectEq$(target->pixels().load({TILE - 1, TILE - 1}), RED);
+
+    // Tiles from another scale aren't reused
+    expectEq$(_paint(tiles, *target, {0, 0, TILE / 2, TILE / 2}, 1).len(), 1uz);
+
+    return Ok();
+}
+
+// Some opaque content, with anti-aliased edges falling anywhere between
+// the pixels, whatever the scale.
+static void _content(Canvas& g, Math::Recti rect) {
+    g.clear(rect, WHITE);
+    for (isize i = 0; i < 24; i++) {
+        g.fillStyle(i % 2 ? BLUE : RED);
+        g.fill(Math::Rectf{i * 23.3, i * 7.1, 17.7, 31.9});
+    }
+}
+
+test$("tiles-exact-geometry") {
+    // Rasterized straight away and through the tiles, at a fractional
+    // scale, tiles are blitted back pixel for pixel, without seams or
+    // resampling across their edges.
+    f64 scale = 1.5;
+    Math::Recti rect = {0, 0, TILE * 2, TILE};
+    Math::Vec2i size = (rect.wh.cast<f64>() * scale).cast<isize>();
+
+    auto expected = Surface::alloc(size);
+    CpuCanvas eg;
+    eg.begin(*expected);
+    eg.scale(scale);
+    _content(eg, rect);
+    eg.end();
+
+    CpuTiles tiles;
+    auto actual = Surface::alloc(size);
+    CpuCanvas g;
+    g.begin(*actual);
+    g.scale(scale);
+    tiles.paint(g, rect, scale, _content);
+    g.end();
+
+    for (isize y = 0; y < size.y; y++)
+        for (isize x = 0; x < size.x; x++)
+            expect$(actual->pixels().load({x, y}) == expected->pixels().load({x, y}));
+
+    return Ok();
+}
+
+test$("tiles-budget-is-global") {
+    auto budget = CpuTiles::budget();
+    usize tileBytes = TILE * TILE * RGBA8888.bpp();
+    CpuTiles::budget(tileBytes * 2);
+
+    auto target = Surface::alloc({TILE * 2, TILE});
+    CpuTiles a;
+    CpuTiles b;
+
+    _paint(a, *target, {0, 0, TILE, TILE});
+    expectEq$(a.usage(), tileBytes);
+
+    // Two more tiles for b, a's is the oldest, it goes
+    _paint(b, *target, {0, 0, TILE * 2, TILE});
+    expectEq$(a.usage(), 0uz);
+    expectEq$(b.usage(), tileBytes * 2);
+    expectEq$(CpuTiles::totalUsage(), tileBytes * 2);
+
+    // The eviction is counted by the cache it was taken from
+    expectEq$(a.stats().evictions, 1uz);
+    expectEq$(b.stats().evictions, 0uz);
+
+    // Tiles in view are kept even over budget
+    CpuTiles::budget(tileBytes);
+    expectEq$(_paint(b, *target, {0, 0, TILE * 2, TILE}).len(), 0uz);
+    expectEq$(b.usage(), tileBytes * 2);
+
+    CpuTiles::budget(budget);
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <karm-async/promise.h>
+#include <karm-async/run.h>
+#include <karm-async/task.h>
+#include <karm-base/buf.h>
+#include <karm-base/limits.h>
+
+#include "funcs.h"
+
+namespace Karm::Io {
+
+template <typename T>
+concept AsyncWritable = requires(T& writer, Bytes bytes) {
+    { writer.writeAsync(bytes) } -> Meta::Same<Async::Task<usize>>;
+};
+
+template <typename T>
+concept AsyncReadable = requires(T& reader, MutBytes bytes) {
+    { reader.readAsync(bytes) } -> Meta::Same<Async::Task<usize>>;
+};
+
+// MARK: Write -----------------------------------------------------------------
+
+inline Async::Task<usize> writeAllAsync(AsyncWritable auto& writer, Bytes bytes) {
+    usize written = 0;
+    while (written < bytes.len()) {
+        auto n = co_trya$(writer.writeAsync(next(bytes, written)));
+        if (n == 0)
+            co_return Error::writeZero("writer closed while writing");
+        written += n;
+    }
+    co_return Ok(written);
+}
+
+// MARK: Copy ------------------------------------------------------------------
+
+// Start writing `bytes` out in the background, the returned future resolves
+// once all of it is written.
+inline Async::Future<usize> _spawnWrite(AsyncWritable auto& writer, Bytes bytes) {
+    Async::Promise<usize> promise;
+    auto future = promise.future();
+    Async::detach(writeAllAsync(writer, bytes), [promise = std::move(promise)](Res<usize> res) mutable {
+        promise.resolve(res);
+    });
+    return future;
+}
+
+// Copy up to `size` bytes from `reader` to `writer`. Two buffers take turns,
+// the next read fills one while the other is being written out, and both
+// grow like the ones of copy() when reads keep filling them.
+inline Async::Task<usize> copyAsync(AsyncReadable auto& reader, AsyncWritable auto& writer, usize size) {
+    Array<Buf<Byte>, 2> bufs;
+    usize want = min(COPY_MIN, size);
+    usize turn = 0;
+    Opt<Async::Future<usize>> pending;
+    usize result = 0;
+
+    while (size > 0) {
+        auto& buf = bufs[turn];
+        if (buf.len() < want)
+            buf = Buf<Byte>::init(want);
+
+        auto read = co_await reader.readAsync(mutSub(buf, 0, size));
+
+        // NOTE: The write in flight points into the other buffer, it must
+        //       land before that buffer is reused or this frame goes away,
+        //       even if the read failed.
+        if (pending) {
+            auto written = co_await pending.take();
+            if (not written)
+                co_return written.none();
+            result += written.unwrap();
+        }
+
+        auto n = co_try$(read);
+        if (n == 0)
+            co_return Ok(result);
+
+        pending = _spawnWrite(writer, sub(buf, 0, n));
+        size -= n;
+        turn = 1 - turn;
+
+        if (n == buf.len() and want < COPY_MAX)
+            want = min(want * 2, COPY_MAX, size);
+    }
+
+    if (pending) {
+        auto written = co_trya$(pending.take());
+        result += written;
+    }
+    co_return Ok(result);
+}
+
+inline Async::Task<usize> copyAsync(AsyncReadable auto& reader, AsyncWritable auto& writer) {
+    return copyAsync(reader, writer, Limits<usize>::MAX);
+}
+
+} // namespace Karm::Io
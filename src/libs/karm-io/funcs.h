@@ -1,6 +1,8 @@
 #pragma once
 
+#include <karm-base/buf.h>
 #include <karm-base/clamp.h>
+#include <karm-base/limits.h>
 #include <karm-base/ring.h>
 #include <karm-base/rune.h>
 #include <karm-base/string.h>
@@ -70,35 +72,41 @@ inline Res<usize> skip(Readable auto& reader, usize n) {
     return copy(reader, sink, n);
 }
 
-// MARK: Copy ------------------------------------------------------------------
+// MARK: Write -----------------------------------------------------------------
 
-inline Res<usize> copy(Readable auto& reader, MutBytes bytes) {
-    usize readed = 0;
-    while (readed < bytes.len()) {
-        readed += try$(reader.read(next(bytes, readed)));
+inline Res<usize> writeAll(Writable auto& writer, Bytes bytes) {
+    usize written = 0;
+    while (written < bytes.len()) {
+        auto n = try$(writer.write(next(bytes, written)));
+        if (n == 0)
+            return Error::writeZero("writer closed while writing");
+        written += n;
     }
-    return Ok(readed);
+    return Ok(written);
 }
 
-inline Res<usize> copy(Readable auto& reader, Writable auto& writer) {
-    Array<Byte, 4096> buffer;
-    usize result = 0;
-    while (true) {
-        auto read = try$(reader.read(mutBytes(buffer)));
-        if (read == 0)
-            return Ok(result);
+// MARK: Copy ------------------------------------------------------------------
 
-        result += read;
+// Transfers start on a small stack buffer and move to a heap buffer that
+// doubles, up to COPY_MAX, each time a read fills it.
+static constexpr usize COPY_MIN = 4096;
+static constexpr usize COPY_MAX = 256 * 1024;
 
-        auto written = try$(writer.write(sub(buffer, 0, read)));
-        if (written != read) {
-            return Ok(result);
-        }
+inline Res<usize> copy(Readable auto& reader, MutBytes bytes) {
+    usize readed = 0;
+    while (readed < bytes.len()) {
+        auto read = try$(reader.read(mutNext(bytes, readed)));
+        if (read == 0)
+            break;
+        readed += read;
     }
+    return Ok(readed);
 }
 
 inline Res<usize> copy(Readable auto& reader, Writable auto& writer, usize size) {
-    Array<Byte, 4096> buf;
+    Array<Byte, COPY_MIN> stack;
+    Buf<Byte> heap;
+    MutBytes buf = mutBytes(stack);
     usize result = 0;
     while (size > 0) {
         auto read = try$(reader.read(mutSub(buf, 0, size)));
@@ -112,10 +120,21 @@ inline Res<usize> copy(Readable auto& reader, Writable auto& writer, usize size)
             return Ok(result);
 
         size -= read;
+
+        // NOTE: Short reads mean the source can't keep up, a bigger buffer
+        //       wouldn't help, and no more than what's left is allocated.
+        if (read == buf.len() and buf.len() < COPY_MAX and size > buf.len()) {
+            heap = Buf<Byte>::init(min(buf.len() * 2, COPY_MAX, size));
+            buf = mutBytes(heap);
+        }
     }
     return Ok(result);
 }
 
+inline Res<usize> copy(Readable auto& reader, Writable auto& writer) {
+    return copy(reader, writer, Limits<usize>::MAX);
+}
+
 inline Res<Tuple<usize, bool>> readLine(Readable auto& reader, Writable auto& writer, Bytes delim) {
     if (delim.len() > 16)
         panic("delimiter string too large");
@@ -190,6 +190,46 @@ struct BufferWriter : public Writer, public Flusher {
     }
 };
 
+// Gathers small writes into larger ones before handing them to `out`,
+// what's gathered goes out once `cap` bytes are reached, or on flush().
+struct BufferedWriter : public Writer, public Flusher {
+    Writer& _out;
+    Buf<Byte> _buf;
+    usize _cap;
+
+    BufferedWriter(Writer& out, usize cap = 4096)
+        : _out(out), _buf(cap), _cap(cap) {}
+
+    Res<> _drain(Bytes bytes) {
+        while (bytes.len()) {
+            usize written = try$(_out.write(bytes));
+            if (written == 0)
+                return Error::writeZero();
+            bytes = next(bytes, written);
+        }
+        return Ok();
+    }
+
+    Res<usize> write(Bytes bytes) override {
+        if (_buf.len() + bytes.len() > _cap)
+            try$(flush());
+
+        // NOTE: Big writes don't gain anything from being copied first.
+        if (bytes.len() >= _cap)
+            try$(_drain(bytes));
+        else
+            _buf.insert(COPY, _buf.len(), bytes.buf(), bytes.len());
+
+        return Ok(bytes.len());
+    }
+
+    Res<> flush() override {
+        try$(_drain(_buf));
+        _buf.trunc(0);
+        return Ok();
+    }
+};
+
 struct BitReader {
     Reader& _reader;
     u8 _bits{};
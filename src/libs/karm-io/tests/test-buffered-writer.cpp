@@ -0,0 +1,50 @@
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Io::Tests {
+
+// Keeps what's written, and how many writes it took.
+struct Collect : public Writer {
+    BufferWriter buf;
+    usize calls = 0;
+
+    Res<usize> write(Bytes bytes) override {
+        calls++;
+        return buf.write(bytes);
+    }
+};
+
+test$("buffered-writer-gathers-small-writes") {
+    Collect out;
+    BufferedWriter w{out, 8};
+
+    auto text = bytes("abcdefghij"s);
+    for (usize i = 0; i < text.len(); i++)
+        try$(w.write(sub(text, i, i + 1)));
+    expect$(out.calls == 1);
+    expectEq$(out.buf.bytes(), bytes("abcdefgh"s));
+
+    try$(w.flush());
+    expect$(out.calls == 2);
+    expectEq$(out.buf.bytes(), bytes("abcdefghij"s));
+
+    // Nothing left to write
+    try$(w.flush());
+    expect$(out.calls == 2);
+
+    return Ok();
+}
+
+test$("buffered-writer-passes-big-writes") {
+    Collect out;
+    BufferedWriter w{out, 4};
+
+    try$(w.write(bytes("ab"s)));
+    try$(w.write(bytes("cdefghij"s)));
+    expect$(out.calls == 2);
+    expectEq$(out.buf.bytes(), bytes("abcdefghij"s));
+
+    return Ok();
+}
+
+} // namespace Karm::Io::Tests
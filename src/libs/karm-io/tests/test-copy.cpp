@@ -0,0 +1,118 @@
+#include <karm-io/async.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Io::Tests {
+
+// Remembers how writes were split up.
+struct Recorder : public Writer {
+    usize calls = 0;
+    usize largest = 0;
+    usize total = 0;
+
+    Res<usize> write(Bytes bytes) override {
+        calls++;
+        largest = max(largest, bytes.len());
+        total += bytes.len();
+        return Ok(bytes.len());
+    }
+
+    Async::Task<usize> writeAsync(Bytes bytes) {
+        co_return write(bytes);
+    }
+};
+
+// Never hands out more than `_max` bytes at once.
+struct Trickle : public Reader {
+    Reader& _inner;
+    usize _max;
+
+    Trickle(Reader& inner, usize max)
+        : _inner(inner), _max(max) {}
+
+    Res<usize> read(MutBytes bytes) override {
+        return _inner.read(mutSub(bytes, 0, _max));
+    }
+
+    Async::Task<usize> readAsync(MutBytes bytes) {
+        co_return read(bytes);
+    }
+};
+
+struct AsyncBufferWriter : public BufferWriter {
+    Async::Task<usize> writeAsync(Bytes bytes) {
+        co_return write(bytes);
+    }
+};
+
+test$("copy-to-bytes-stops-at-eof") {
+    BufReader reader{bytes("hello"s)};
+    Array<Byte, 16> buf{};
+    expectEq$(try$(copy(reader, mutBytes(buf))), 5uz);
+    return Ok();
+}
+
+test$("copy-grows-buffer") {
+    Repeat repeat{0x2a};
+    Recorder out;
+    expectEq$(try$(copy(repeat, out, 1024 * 1024)), 1024uz * 1024);
+    expectEq$(out.total, 1024uz * 1024);
+    expectEq$(out.largest, COPY_MAX);
+    // 4, 8, ... 128 KiB and then full buffers
+    expectLteq$(out.calls, 10uz);
+    return Ok();
+}
+
+test$("copy-bounded-by-size") {
+    Repeat repeat{0x2a};
+    Recorder out;
+    expectEq$(try$(copy(repeat, out, 10000)), 10000uz);
+    // Never more than what's left is asked for
+    expectEq$(out.largest, 5904uz);
+    return Ok();
+}
+
+test$("copy-trickle-keeps-buffer") {
+    Repeat repeat{0x2a};
+    Trickle trickle{repeat, 100};
+    Recorder out;
+    expectEq$(try$(copy(trickle, out, 100000)), 100000uz);
+    expectEq$(out.largest, 100uz);
+    return Ok();
+}
+
+test$("copy-preserves-content") {
+    Buf<Byte> data = Buf<Byte>::init(300000);
+    for (usize i = 0; i < data.len(); i++)
+        data[i] = (Byte)(i * 7);
+
+    BufReader reader{data};
+    BufferWriter out;
+    expectEq$(try$(copy(reader, out)), data.len());
+    expectEq$(out.bytes(), bytes(data));
+    return Ok();
+}
+
+testAsync$("copy-async") {
+    Buf<Byte> data = Buf<Byte>::init(300000);
+    for (usize i = 0; i < data.len(); i++)
+        data[i] = (Byte)(i * 7);
+
+    BufReader reader{data};
+    Trickle trickle{reader, Limits<usize>::MAX};
+    AsyncBufferWriter out;
+    co_expectEq$(co_trya$(copyAsync(trickle, out)), data.len());
+    co_expectEq$(out.bytes(), bytes(data));
+    co_return Ok();
+}
+
+testAsync$("copy-async-grows-buffer") {
+    Repeat repeat{0x2a};
+    Trickle trickle{repeat, Limits<usize>::MAX};
+    Recorder out;
+    co_expectEq$(co_trya$(copyAsync(trickle, out, 1024 * 1024)), 1024uz * 1024);
+    co_expectEq$(out.largest, COPY_MAX);
+    co_expectLteq$(out.calls, 10uz);
+    co_return Ok();
+}
+
+} // namespace Karm::Io::Tests
@@ -66,13 +66,13 @@ enum OpCode : u16 {
 
 enum RCode : u16 {
 
-#define ITER(NAME, VAL) NAME = VAL << 12,
+#define ITER(NAME, VAL) NAME = VAL,
     FOREACH_RCODE(ITER)
 #undef ITER
 
 };
 
-Str toStr(RCode code) {
+inline Str toStr(RCode code) {
     switch (code) {
 #define ITER(NAME, VAL) \
     case RCode::NAME:   \
@@ -119,7 +119,7 @@ struct Answer {
     Buf<Byte> data;
 };
 
-Res<> encodeName(Io::BEmit& e, Str name) {
+inline Res<> encodeName(Io::BEmit& e, Str name) {
     for (auto part : iterSplit(name, '.')) {
         e.writeU8be(part.len());
         e.writeStr(part);
@@ -128,7 +128,7 @@ Res<> encodeName(Io::BEmit& e, Str name) {
     return Ok();
 }
 
-Res<usize> decodeName(Cursor<Byte> const start, Cursor<Byte> curr, StringBuilder& out) {
+inline Res<usize> decodeName(Cursor<Byte> const start, Cursor<Byte> curr, StringBuilder& out) {
     usize len = 0;
     while (not curr.ended()) {
         auto b = curr.next();
@@ -169,20 +169,20 @@ Res<usize> decodeName(Cursor<Byte> const start, Cursor<Byte> curr, StringBuilder
 }
 
 struct Packet {
-    usize _id;
+    u16 _id;
     Flags _flags;
     Vec<Question> _qs;
     Vec<Answer> _ans;
 
     Packet() = default;
 
-    Packet(usize id, Flags flags)
+    Packet(u16 id, Flags flags)
         : _id(id),
           _flags(flags) {}
 
     Header header() const {
         Header hdr;
-        hdr.id = 420;
+        hdr.id = _id;
         hdr.flags = _flags;
         hdr.qdcount = _qs.len();
         hdr.ancount = _ans.len();
@@ -0,0 +1,274 @@
+#include <karm-sys/async.h>
+#include <karm-sys/random.h>
+#include <karm-sys/time.h>
+
+#include "resolver.h"
+
+namespace Karm::Net::Dns {
+
+// MARK: Exchanges -------------------------------------------------------------
+
+static bool _eqNoCase(Str a, Str b) {
+    if (a.len() != b.len())
+        return false;
+    for (usize i = 0; i < a.len(); i++)
+        if (toAsciiLower(a[i]) != toAsciiLower(b[i]))
+            return false;
+    return true;
+}
+
+bool Resolver::_Query::answeredBy(Packet const& pkt) const {
+    if (pkt._qs.len() != 1)
+        return false;
+    auto& q = pkt._qs[0];
+    // NOTE: Servers may echo the name with a different case, RFC 4343.
+    return _eqNoCase(q.name, name) and
+           q.type == type and
+           q.class_ == Class::IN;
+}
+
+// Hand out answers to the queries waiting on them, for as long as there are
+// any, a single loop serves every query of a resolver.
+static Async::Task<> _listenAsync(Rc<Resolver::_Link> link) {
+    Array<Byte, 4096> buf;
+    while (link->pending.len()) {
+        auto res = co_await link->conn.recvAsync(mutBytes(buf));
+        if (not res) {
+            logError("dns receive failed: {}", res.none());
+            // NOTE: Resolving a query resumes whoever waits on it, which
+            //       may send another one, so the map is emptied first.
+            Vec<Rc<Resolver::_Query>> failed;
+            for (auto const& [_, query] : link->pending.iter())
+                failed.pushBack(query);
+            link->pending.clear();
+            link->listening = false;
+            for (auto& query : failed)
+                query->resolve(res.none());
+            co_return Ok();
+        }
+
+        auto [len, _, addr] = res.take();
+        if (addr != link->server)
+            continue;
+
+        auto pkt = Packet::decode(sub(buf, 0, len));
+        if (not pkt) {
+            logWarn("dropping malformed dns packet: {}", pkt.none());
+            continue;
+        }
+
+        // NOTE: Late answers to queries that timed out are dropped here.
+        auto query = link->pending.tryGet(pkt.unwrap()._id);
+        if (not query)
+            continue;
+
+        if (not(*query)->answeredBy(pkt.unwrap())) {
+            logWarn("dropping dns answer to another question");
+            continue;
+        }
+
+        link->pending.del(pkt.unwrap()._id);
+        (*query)->resolve(Ok(pkt.take()));
+    }
+
+    link->listening = false;
+    co_return Ok();
+}
+
+// Ids are random so that answers can't be forged without seeing the
+// question, RFC 5452.
+static u16 _nextId(Resolver::_Link& link) {
+    while (true) {
+        u16 id = link.nextId++;
+        if (link.randomIds) {
+            if (auto random = Sys::random<u16>())
+                id = random.take();
+            else
+                link.randomIds = false;
+        }
+        if (not link.pending.has(id))
+            return id;
+    }
+}
+
+static Res<Rc<Resolver::_Query>> _sendQuery(Rc<Resolver::_Link> link, String name, Type type, Duration timeout) {
+    auto query = makeRc<Resolver::_Query>(_nextId(*link), name, type);
+
+    Packet req{query->id, Flags::RD};
+    req._qs.pushBack(Question{name, type, Class::IN});
+    try$(link->conn.send(try$(Packet::encode(req)), link->server));
+    link->pending.put(query->id, query);
+
+    if (not link->listening) {
+        link->listening = true;
+        Async::detach(_listenAsync(link));
+    }
+
+    Async::detach(
+        Sys::globalSched().sleepAsync(Sys::instant() + timeout),
+        [link, query](auto) mutable {
+            if (query->done)
+                return;
+            link->pending.del(query->id);
+            query->resolve(Error::timedOut("dns query timed out"));
+        }
+    );
+
+    return Ok(query);
+}
+
+// MARK: Resolver --------------------------------------------------------------
+
+// Like the id, a random source port is one more thing to guess for someone
+// forging answers, RFC 5452. Ports already in use are skipped, and the system
+// picks one if none could be found, or if there is no entropy source.
+static Res<Sys::UdpConnection> _listen() {
+    static constexpr usize ATTEMPTS = 8;
+    static constexpr u16 FIRST_PORT = 49152;
+
+    for (usize i = 0; i < ATTEMPTS; i++) {
+        auto random = Sys::random<u16>();
+        if (not random)
+            break;
+        u16 port = FIRST_PORT + random.unwrap() % (Limits<u16>::MAX - FIRST_PORT + 1);
+        auto conn = Sys::UdpConnection::listen({Sys::Ip4::unspecified(), port});
+        if (conn)
+            return conn;
+    }
+
+    return Sys::UdpConnection::listen({Sys::Ip4::unspecified(), 0});
+}
+
+Res<Rc<Resolver>> Resolver::create(ResolverOptions options) {
+    auto link = makeRc<_Link>(options.server, try$(_listen()));
+    if (not Sys::random<u16>()) {
+        logWarn("no entropy source, dns queries use sequential ids");
+        link->randomIds = false;
+    }
+    return Ok(makeRc<Resolver>(options, link));
+}
+
+Async::Task<Packet> Resolver::_answerAsync(Rc<_Query> query, String name, Type type) {
+    for (usize attempt = 1;; attempt++) {
+        auto res = co_await query->future;
+        if (res or res.none().code() != Error::TIMED_OUT)
+            co_return res;
+
+        _stats.timeouts++;
+        if (attempt >= _options.attempts)
+            co_return res;
+
+        query = co_try$(_sendQuery(_link, name, type, _options.timeout));
+    }
+}
+
+Async::Task<Vec<Sys::Ip>> Resolver::_lookupAsync(String name) {
+    _stats.queries++;
+
+    // Both questions are sent before waiting on either, so they are in
+    // flight together.
+    auto a = co_try$(_sendQuery(_link, name, Type::A, _options.timeout));
+    auto aaaa = co_try$(_sendQuery(_link, name, Type::AAAA, _options.timeout));
+
+    auto answerA = co_await _answerAsync(a, name, Type::A);
+    auto answerAaaa = co_await _answerAsync(aaaa, name, Type::AAAA);
+    Array<Res<Packet>, 2> answers = {std::move(answerA), std::move(answerAaaa)};
+
+    Vec<Sys::Ip> ips;
+    Duration ttl = _options.maxTtl;
+    bool missing = false;
+    Opt<Error> failure;
+
+    for (auto& res : answers) {
+        if (not res) {
+            failure = res.none();
+            continue;
+        }
+
+        auto& pkt = res.unwrap();
+        auto rcode = pkt.header().rcode();
+        if (rcode == RCode::NAME_ERROR) {
+            missing = true;
+            continue;
+        }
+
+        if (rcode != RCode::NO_ERROR) {
+            logWarn("dns server answered {} for {}", toStr(rcode), name);
+            failure = Error::other("dns server failure");
+            continue;
+        }
+
+        // NOTE: Records are taken whatever their owner, which follows any
+        //       CNAME chain the server resolved along the way.
+        for (auto& ans : pkt._ans) {
+            if (ans.type == Type::A and ans.data.len() == 4) {
+                ips.pushBack(Sys::Ip4{ans.data[0], ans.data[1], ans.data[2], ans.data[3]});
+            } else if (ans.type == Type::AAAA and ans.data.len() == 16) {
+                Array<u16, 8> words;
+                for (usize i = 0; i < words.len(); i++)
+                    words[i] = ans.data[i * 2] << 8 | ans.data[i * 2 + 1];
+                ips.pushBack(Sys::Ip6{words});
+            } else {
+                continue;
+            }
+            ttl = min(ttl, ans.ttl);
+        }
+    }
+
+    auto now = Sys::instant();
+    if (ips.len()) {
+        _cache.put(name, Ok(ips), now, ttl);
+        co_return Ok(ips);
+    }
+
+    // A timeout or a server failure says nothing about the name, it's
+    // worth asking again next time.
+    if (failure and not missing)
+        co_return failure.take();
+
+    Lookup lookup = Error::notFound("no address for host");
+    _cache.put(name, lookup, now, _options.negativeTtl);
+    co_return lookup;
+}
+
+Async::Task<Vec<Sys::Ip>> Resolver::resolveAsync(Str host) {
+    if (auto ip = Sys::Ip::parse(host))
+        co_return Ok(Vec<Sys::Ip>{ip.take()});
+
+    if (host == "localhost")
+        co_return Ok(Vec<Sys::Ip>{Sys::Ip4::localhost()});
+
+    String name = host;
+    if (auto cached = _cache.get(name, Sys::instant())) {
+        _stats.hits++;
+        co_return cached.take();
+    }
+
+    if (auto inflight = _inflight.tryGet(name)) {
+        _stats.coalesced++;
+        co_return co_await inflight.take();
+    }
+
+    Async::Promise<Vec<Sys::Ip>> promise;
+    _inflight.put(name, promise.future());
+    auto lookup = co_await _lookupAsync(name);
+    _inflight.del(name);
+    promise.resolve(lookup);
+    co_return lookup;
+}
+
+Async::Task<Sys::Ip> Resolver::resolveOneAsync(Str host) {
+    auto ips = co_trya$(resolveAsync(host));
+    if (ips.len() == 0)
+        co_return Error::notFound("no address for host");
+    co_return Ok(ips[0]);
+}
+
+Res<Rc<Resolver>> globalResolver() {
+    static Opt<Rc<Resolver>> resolver;
+    if (not resolver)
+        resolver = try$(Resolver::create());
+    return Ok(*resolver);
+}
+
+} // namespace Karm::Net::Dns
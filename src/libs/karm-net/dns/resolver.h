@@ -0,0 +1,177 @@
+#pragma once
+
+#include <karm-async/promise.h>
+#include <karm-base/hashmap.h>
+
+#include "dns.h"
+
+namespace Karm::Net::Dns {
+
+// MARK: Cache -----------------------------------------------------------------
+
+// The outcome of a lookup, either the addresses of a name or the reason
+// there are none, both are cached.
+using Lookup = Res<Vec<Sys::Ip>>;
+
+struct Cache {
+    struct Entry {
+        Lookup lookup;
+        Instant expires;
+    };
+
+    usize _cap;
+    HashMap<String, Entry> _entries;
+
+    Cache(usize cap)
+        : _cap(cap) {}
+
+    Opt<Lookup> get(String const& name, Instant now) {
+        auto entry = _entries.access(name);
+        if (not entry)
+            return NONE;
+
+        if (entry->expires <= now) {
+            _entries.del(name);
+            return NONE;
+        }
+
+        return entry->lookup;
+    }
+
+    // Make room for one more entry, expired ones go first, then those
+    // closest to expiring.
+    void _evict(Instant now) {
+        Vec<String> expired;
+        Opt<String> soonest;
+        Instant soonestExpires = Instant::endOfTime();
+        for (auto const& [name, entry] : _entries.iter()) {
+            if (entry.expires <= now) {
+                expired.pushBack(name);
+            } else if (entry.expires < soonestExpires) {
+                soonest = name;
+                soonestExpires = entry.expires;
+            }
+        }
+
+        for (auto& name : expired)
+            _entries.del(name);
+
+        if (_entries.len() >= _cap and soonest)
+            _entries.del(*soonest);
+    }
+
+    void put(String const& name, Lookup lookup, Instant now, Duration ttl) {
+        if (_cap == 0)
+            return;
+        if (not _entries.has(name) and _entries.len() >= _cap)
+            _evict(now);
+        _entries.put(name, {std::move(lookup), now + ttl});
+    }
+
+    usize len() const {
+        return _entries.len();
+    }
+
+    void clear() {
+        _entries.clear();
+    }
+};
+
+// MARK: Resolver --------------------------------------------------------------
+
+struct ResolverOptions {
+    Sys::SocketAddr server = GOOGLE;
+    // How long to wait for an answer before asking again.
+    Duration timeout = Duration::fromSecs(2);
+    usize attempts = 2;
+    // How long a name that doesn't exist is remembered, the SOA record
+    // that would tell is not parsed.
+    Duration negativeTtl = Duration::fromSecs(30);
+    // Upper bound on how long an answer is cached, whatever its ttl.
+    Duration maxTtl = Duration::fromSecs(24 * 60 * 60);
+    // How many names are cached at most.
+    usize cacheSize = 256;
+};
+
+struct ResolverStats {
+    usize queries = 0;
+    usize hits = 0;
+    usize coalesced = 0;
+    usize timeouts = 0;
+};
+
+struct Resolver : Meta::Pinned {
+    // A question sent to the server, waiting for its answer.
+    struct _Query {
+        u16 id;
+        String name;
+        Type type;
+        Async::Promise<Packet> promise;
+        // NOTE: Taken right away, the query may time out before anyone
+        //       waits on it, which drops the promise's state.
+        Async::Future<Packet> future = promise.future();
+        bool done = false;
+
+        _Query(u16 id, String name, Type type)
+            : id(id), name(name), type(type) {}
+
+        // Only answers echoing the question are taken, like the id it's
+        // one more thing someone forging answers has to get right.
+        bool answeredBy(Packet const& pkt) const;
+
+        void resolve(Res<Packet> res) {
+            if (done)
+                return;
+            done = true;
+            promise.resolve(std::move(res));
+        }
+    };
+
+    // NOTE: The receive loop and the timeouts only hold on to this, so the
+    //       socket and the queries they resolve stay alive as long as they
+    //       run, even past the resolver itself.
+    struct _Link {
+        Sys::SocketAddr server;
+        Sys::UdpConnection conn;
+        HashMap<u16, Rc<_Query>> pending;
+        bool listening = false;
+        // NOTE: Without an entropy source, ids are handed out in sequence,
+        //       which leaves answers easier to forge.
+        bool randomIds = true;
+        u16 nextId = 0;
+
+        _Link(Sys::SocketAddr server, Sys::UdpConnection conn)
+            : server(server), conn(std::move(conn)) {}
+    };
+
+    ResolverOptions _options;
+    Rc<_Link> _link;
+    Cache _cache;
+    HashMap<String, Async::Future<Vec<Sys::Ip>>> _inflight;
+    ResolverStats _stats;
+
+    Resolver(ResolverOptions options, Rc<_Link> link)
+        : _options(options), _link(std::move(link)), _cache(options.cacheSize) {}
+
+    static Res<Rc<Resolver>> create(ResolverOptions options = {});
+
+    ResolverStats stats() const {
+        return _stats;
+    }
+
+    // Resolve a host name to all its addresses, IPv4 ones first. Concurrent
+    // lookups of the same name share a single exchange with the server.
+    Async::Task<Vec<Sys::Ip>> resolveAsync(Str host);
+
+    // Like resolveAsync() but for a single address, preferring IPv4.
+    Async::Task<Sys::Ip> resolveOneAsync(Str host);
+
+    Async::Task<Packet> _answerAsync(Rc<_Query> query, String name, Type type);
+
+    Async::Task<Vec<Sys::Ip>> _lookupAsync(String name);
+};
+
+// The resolver shared by the whole process, asking the default server.
+Res<Rc<Resolver>> globalResolver();
+
+} // namespace Karm::Net::Dns
@@ -0,0 +1,220 @@
+#include <karm-net/dns/resolver.h>
+#include <karm-sys/async.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Net::Dns::Tests {
+
+// MARK: Stand-in Server -------------------------------------------------------
+
+// A server on localhost answering from a fixed zone:
+//  - "example.test" has an IPv4 and an IPv6 address, for a minute
+//  - "short.test" has an IPv4 address that expires right away
+//  - anything else doesn't exist
+struct StandIn {
+    Sys::UdpConnection conn;
+    usize questions = 0;
+    // Send a forged answer, to another question, before each real one.
+    bool forge = false;
+
+    StandIn(Sys::UdpConnection conn)
+        : conn(std::move(conn)) {}
+};
+
+static Answer _answer(Str name, Type type, Duration ttl, Bytes data) {
+    return {name, type, Class::IN, ttl, data};
+}
+
+// Answer `n` questions then close.
+static Async::Task<> _serveAsync(Rc<StandIn> server, usize n) {
+    static constexpr Array<u8, 4> V4 = {10, 0, 0, 1};
+    static constexpr Array<u8, 16> V6 = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+    Array<Byte, 512> buf;
+    for (usize i = 0; i < n; i++) {
+        auto [len, _, from] = co_trya$(server->conn.recvAsync(mutBytes(buf)));
+        auto req = co_try$(Packet::decode(sub(buf, 0, len)));
+        server->questions++;
+
+        auto& q = req._qs[0];
+        u16 flags = Flags::QR | Flags::RD | Flags::RA;
+
+        if (server->forge) {
+            static constexpr Array<u8, 4> FORGED = {6, 6, 6, 6};
+            Packet forged{req._id, (Flags)flags};
+            forged._qs.pushBack(Question{"forged.test"s, q.type, Class::IN});
+            forged._ans.pushBack(_answer(q.name, Type::A, Duration::fromSecs(60), bytes(FORGED)));
+            auto out = co_try$(Packet::encode(forged));
+            co_trya$(server->conn.sendAsync(out, from));
+        }
+
+        Packet resp{req._id, (Flags)flags};
+        resp._qs = req._qs;
+
+        if (q.name == "example.test" and q.type == Type::A)
+            resp._ans.pushBack(_answer(q.name, Type::A, Duration::fromSecs(60), bytes(V4)));
+        else if (q.name == "example.test" and q.type == Type::AAAA)
+            resp._ans.pushBack(_answer(q.name, Type::AAAA, Duration::fromSecs(60), bytes(V6)));
+        else if (q.name == "short.test" and q.type == Type::A)
+            resp._ans.pushBack(_answer(q.name, Type::A, Duration::fromSecs(0), bytes(V4)));
+        else if (q.name != "example.test" and q.name != "short.test")
+            resp._flags = (Flags)(flags | RCode::NAME_ERROR);
+
+        auto out = co_try$(Packet::encode(resp));
+        co_trya$(server->conn.sendAsync(out, from));
+    }
+    co_return Ok();
+}
+
+// NOTE: Each test gets its own port, a server from a previous test may still
+//       be around waiting for a question that never comes.
+static Res<Rc<StandIn>> _standIn(u16 port, usize n, bool forge = false) {
+    auto conn = try$(Sys::UdpConnection::listen(Sys::Ip4::localhost(port)));
+    auto server = makeRc<StandIn>(std::move(conn));
+    server->forge = forge;
+    Async::detach(_serveAsync(server, n));
+    return Ok(server);
+}
+
+static Res<Rc<Resolver>> _resolver(u16 port) {
+    return Resolver::create({
+        .server = Sys::Ip4::localhost(port),
+        .timeout = Duration::fromMSecs(50),
+    });
+}
+
+// MARK: Tests -----------------------------------------------------------------
+
+testAsync$("dns-resolver-cache") {
+    auto server = co_try$(_standIn(53531, 2));
+    auto resolver = co_try$(_resolver(53531));
+
+    auto ips = co_trya$(resolver->resolveAsync("example.test"));
+    co_expectEq$(ips.len(), 2uz);
+    co_expect$((ips[0] == Sys::Ip{Sys::Ip4{10, 0, 0, 1}}));
+    co_expect$((ips[1] == Sys::Ip{Sys::Ip6{0x2001, 0xdb8, 0, 0, 0, 0, 0, 1}}));
+
+    // The second lookup never reaches the server
+    auto again = co_trya$(resolver->resolveAsync("example.test"));
+    co_expectEq$(again.len(), 2uz);
+    co_expectEq$(server->questions, 2uz);
+    co_expectEq$(resolver->stats().hits, 1uz);
+
+    co_return Ok();
+}
+
+testAsync$("dns-resolver-ttl") {
+    auto server = co_try$(_standIn(53532, 4));
+    auto resolver = co_try$(_resolver(53532));
+
+    co_trya$(resolver->resolveAsync("short.test"));
+    co_trya$(resolver->resolveAsync("short.test"));
+    co_expectEq$(server->questions, 4uz);
+    co_expectEq$(resolver->stats().hits, 0uz);
+
+    co_return Ok();
+}
+
+testAsync$("dns-resolver-negative") {
+    auto server = co_try$(_standIn(53533, 2));
+    auto resolver = co_try$(_resolver(53533));
+
+    auto res = co_await resolver->resolveAsync("missing.test");
+    co_expectNot$(res);
+    co_expectEq$(res.none().code(), Error::NOT_FOUND);
+
+    // The answer that the name doesn't exist is cached too
+    auto again = co_await resolver->resolveAsync("missing.test");
+    co_expectNot$(again);
+    co_expectEq$(server->questions, 2uz);
+    co_expectEq$(resolver->stats().hits, 1uz);
+
+    co_return Ok();
+}
+
+testAsync$("dns-resolver-coalesce") {
+    auto server = co_try$(_standIn(53534, 2));
+    auto resolver = co_try$(_resolver(53534));
+
+    usize done = 0;
+    usize found = 0;
+    Async::Promise<> both;
+    for (usize i = 0; i < 2; i++) {
+        Async::detach(resolver->resolveAsync("example.test"), [&](Res<Vec<Sys::Ip>> res) {
+            if (res)
+                found++;
+            if (++done == 2)
+                both.resolve(Ok());
+        });
+    }
+
+    co_trya$(both.future());
+    co_expectEq$(found, 2uz);
+    co_expectEq$(server->questions, 2uz);
+    co_expectEq$(resolver->stats().coalesced, 1uz);
+
+    co_return Ok();
+}
+
+testAsync$("dns-resolver-timeout") {
+    // Nobody listens on this port
+    auto resolver = co_try$(_resolver(53535));
+
+    auto res = co_await resolver->resolveAsync("example.test");
+    co_expectNot$(res);
+    co_expectEq$(res.none().code(), Error::TIMED_OUT);
+
+    // Both questions were asked twice, and the failure isn't cached
+    co_expectEq$(resolver->stats().timeouts, 4uz);
+    co_expectEq$(resolver->_cache._entries.len(), 0uz);
+
+    co_return Ok();
+}
+
+testAsync$("dns-resolver-forged") {
+    auto server = co_try$(_standIn(53536, 2, true));
+    auto resolver = co_try$(_resolver(53536));
+
+    // Answers with the right id but to another question are dropped
+    auto ips = co_trya$(resolver->resolveAsync("example.test"));
+    co_expectEq$(ips.len(), 2uz);
+    co_expect$((ips[0] == Sys::Ip{Sys::Ip4{10, 0, 0, 1}}));
+    co_expectEq$(server->questions, 2uz);
+
+    co_return Ok();
+}
+
+test$("dns-cache-evict") {
+    Cache cache{2};
+    auto now = Instant::epoch() + Duration::fromSecs(100);
+    Lookup found = Ok(Vec<Sys::Ip>{Sys::Ip4::localhost()});
+
+    cache.put("a"s, found, now, Duration::fromSecs(10));
+    cache.put("b"s, found, now, Duration::fromSecs(20));
+
+    // Full, the entry closest to expiring makes room
+    cache.put("c"s, found, now, Duration::fromSecs(30));
+    expectEq$(cache.len(), 2uz);
+    expectNot$(cache.get("a"s, now).has());
+    expect$(cache.get("b"s, now).has());
+
+    // Updating an entry doesn't evict anything
+    cache.put("c"s, found, now, Duration::fromSecs(5));
+    expectEq$(cache.len(), 2uz);
+
+    // Expired entries go first, whatever their order
+    auto later = now + Duration::fromSecs(25);
+    cache.put("d"s, found, later, Duration::fromSecs(1));
+    cache.put("e"s, found, later, Duration::fromSecs(1));
+    expectEq$(cache.len(), 2uz);
+    expect$(cache.get("d"s, later).has());
+    expect$(cache.get("e"s, later).has());
+
+    // A cache without room keeps nothing
+    Cache none{0};
+    none.put("a"s, found, now, Duration::fromSecs(10));
+    expectEq$(none.len(), 0uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Net::Dns::Tests
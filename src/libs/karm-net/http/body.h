@@ -0,0 +1,340 @@
+#pragma once
+
+#include <karm-archive/gzip.h>
+#include <karm-archive/zlib.h>
+#include <karm-io/impls.h>
+#include <karm-sys/socket.h>
+
+#include "http.h"
+
+namespace Karm::Net::Http {
+
+// MARK: Source ----------------------------------------------------------------
+
+// Buffers the connection a body is read from, starting with the bytes that
+// were read past the head. Large reads go straight to the connection once
+// the buffer is drained.
+//
+// Over an asynchronous connection reads never touch the connection, they
+// fail with WOULD_BLOCK once the buffer is drained, until fillAsync()
+// refills it.
+struct Source : public Io::Reader {
+    Io::Reader& _in;
+    Sys::_Connection* _conn = nullptr;
+    Array<Byte, 4096> _buf;
+    usize _pos = 0;
+    usize _len = 0;
+    bool _ended = false;
+
+    Source(Io::Reader& in, Bytes prefix = {})
+        : _in(in) {
+        _len = copy(prefix, mutBytes(_buf));
+    }
+
+    Source(Sys::_Connection& conn, Bytes prefix = {})
+        : _in(conn), _conn(&conn) {
+        _len = copy(prefix, mutBytes(_buf));
+    }
+
+    usize buffered() const {
+        return _len - _pos;
+    }
+
+    Res<> _refill() {
+        if (_conn) {
+            if (_ended)
+                return Ok();
+            return Error::wouldBlock("body source drained");
+        }
+
+        _pos = 0;
+        _len = try$(_in.read(mutBytes(_buf)));
+        return Ok();
+    }
+
+    Async::Task<> fillAsync() {
+        if (not _conn)
+            co_return Error::invalidInput("body source is not asynchronous");
+
+        if (buffered() or _ended)
+            co_return Ok();
+
+        _pos = 0;
+        _len = co_trya$(_conn->readAsync(mutBytes(_buf)));
+        _ended = _len == 0;
+        co_return Ok();
+    }
+
+    Res<usize> read(MutBytes bytes) override {
+        if (buffered() == 0) {
+            if (not _conn and bytes.len() >= _buf.len())
+                return _in.read(bytes);
+            try$(_refill());
+        }
+
+        auto n = copy(sub(_buf, _pos, _len), bytes);
+        _pos += n;
+        return Ok(n);
+    }
+
+    Res<Opt<Byte>> nextByte() {
+        if (buffered() == 0) {
+            try$(_refill());
+            if (buffered() == 0)
+                return Ok(NONE);
+        }
+        return Ok(_buf[_pos++]);
+    }
+};
+
+// MARK: Framing ---------------------------------------------------------------
+
+// A body delimited by its Content-Length.
+struct LengthReader : public Io::Reader {
+    Io::Reader& _in;
+    usize _left;
+
+    LengthReader(Io::Reader& in, usize len)
+        : _in(in), _left(len) {}
+
+    bool ended() const {
+        return _left == 0;
+    }
+
+    Res<usize> read(MutBytes bytes) override {
+        if (_left == 0 or bytes.len() == 0)
+            return Ok(0uz);
+
+        auto n = try$(_in.read(mutSub(bytes, 0, min(bytes.len(), _left))));
+        if (n == 0)
+            return Error::unexpectedEof("connection closed before end of body");
+
+        _left -= n;
+        return Ok(n);
+    }
+};
+
+// A body sent with "Transfer-Encoding: chunked".
+// https://www.rfc-editor.org/rfc/rfc9112#section-7.1
+struct ChunkedReader : public Io::Reader {
+    static constexpr usize MAX_LINE = 4096;
+
+    enum struct _State : u8 {
+        SIZE,
+        DATA,
+        DATA_END,
+        TRAILER,
+        END,
+    };
+
+    Source& _in;
+    _State _state = _State::SIZE;
+    usize _left = 0;
+
+    // The line being read, kept across reads that would block.
+    bool _inLine = false;
+    usize _lineLen = 0;
+    usize _size = 0;
+    bool _digits = false;
+    bool _any = false;
+
+    ChunkedReader(Source& in)
+        : _in(in) {}
+
+    bool ended() const {
+        return _state == _State::END;
+    }
+
+    // Read a line up to its CRLF, returns its length, the line itself is
+    // only kept for the chunk size, which ends up in `_size`.
+    Res<usize> _line(bool parseSize) {
+        if (not _inLine) {
+            _inLine = true;
+            _lineLen = 0;
+            _size = 0;
+            _digits = parseSize;
+            _any = false;
+        }
+
+        while (true) {
+            auto b = try$(_in.nextByte());
+            if (not b)
+                return Error::unexpectedEof("connection closed inside chunk framing");
+
+            if (*b == '\r')
+                continue;
+
+            if (*b == '\n')
+                break;
+
+            if (++_lineLen > MAX_LINE)
+                return Error::invalidData("chunk line too long");
+
+            // NOTE: Anything past the size, like chunk extensions, is ignored.
+            if (not _digits)
+                continue;
+
+            Rune r = *b;
+            if (isAsciiHexDigit(r)) {
+                if (_size >> (sizeof(usize) * 8 - 4))
+                    return Error::invalidData("chunk size too large");
+                _size = _size << 4 | (isAsciiDigit(r) ? r - '0' : toAsciiLower(r) - 'a' + 10);
+                _any = true;
+            } else {
+                _digits = false;
+            }
+        }
+
+        _inLine = false;
+        if (parseSize and not _any)
+            return Error::invalidData("expected chunk size");
+
+        return Ok(_lineLen);
+    }
+
+    Res<usize> read(MutBytes bytes) override {
+        while (bytes.len()) {
+            switch (_state) {
+            case _State::SIZE: {
+                try$(_line(true));
+                _left = _size;
+                _state = _size ? _State::DATA : _State::TRAILER;
+                break;
+            }
+
+            case _State::DATA: {
+                auto n = try$(_in.read(mutSub(bytes, 0, min(bytes.len(), _left))));
+                if (n == 0)
+                    return Error::unexpectedEof("connection closed inside chunk");
+                _left -= n;
+                if (_left == 0)
+                    _state = _State::DATA_END;
+                return Ok(n);
+            }
+
+            case _State::DATA_END: {
+                if (try$(_line(false)) != 0)
+                    return Error::invalidData("expected CRLF after chunk");
+                _state = _State::SIZE;
+                break;
+            }
+
+            case _State::TRAILER: {
+                // Trailer fields are read and dropped, up to the empty line.
+                if (try$(_line(false)) == 0)
+                    _state = _State::END;
+                break;
+            }
+
+            case _State::END:
+                return Ok(0uz);
+            }
+        }
+
+        return Ok(0uz);
+    }
+};
+
+// MARK: Body ------------------------------------------------------------------
+
+// A response body, decoded as it's read. The transfer coding is removed
+// first, then the content coding, nothing is buffered past a few KiB.
+struct Body : public Io::Reader, Meta::Pinned {
+    Source _source;
+    Opt<LengthReader> _length;
+    Opt<ChunkedReader> _chunked;
+    Opt<Archive::GzipReader> _gzip;
+    Opt<Archive::ZlibReader> _zlib;
+
+    Io::Reader* _framed = &_source;
+    Io::Reader* _decoded = &_source;
+
+    Body(Io::Reader& in, Bytes prefix = {})
+        : _source(in, prefix) {}
+
+    // A body read with readAsync(), which waits on the connection instead
+    // of blocking on it.
+    Body(Sys::_Connection& conn, Bytes prefix = {})
+        : _source(conn, prefix) {}
+
+    // Pick the decoders for a response, fails on codings we don't support.
+    Res<> setup(Response const& resp) {
+        if (auto te = resp.lookup("Transfer-Encoding")) {
+            // NOTE: A length is ignored when a transfer coding is present.
+            if (not eqCi(*te, "chunked"s))
+                return Error::unsupported("unsupported transfer encoding");
+            _framed = &_chunked.emplace(_source);
+        } else if (auto cl = resp.lookup("Content-Length")) {
+            _framed = &_length.emplace(_source, try$(Io::atou(*cl)));
+        }
+
+        _decoded = _framed;
+        if (auto ce = resp.lookup("Content-Encoding")) {
+            if (eqCi(*ce, "gzip"s) or eqCi(*ce, "x-gzip"s))
+                _decoded = &_gzip.emplace(*_framed);
+            else if (eqCi(*ce, "deflate"s))
+                _decoded = &_zlib.emplace(*_framed);
+            else if (not eqCi(*ce, "identity"s))
+                return Error::unsupported("unsupported content encoding");
+        }
+
+        return Ok();
+    }
+
+    // Whether the end of the body is known without closing the connection.
+    bool delimited() const {
+        return _length or _chunked;
+    }
+
+    // Whether the body was read to its end, and nothing was sent past it,
+    // which leaves the connection ready for another request.
+    bool complete() const {
+        bool framed = (_length and _length->ended()) or
+                      (_chunked and _chunked->ended());
+        return framed and _source.buffered() == 0;
+    }
+
+    Res<usize> read(MutBytes bytes) override {
+        return _decoded->read(bytes);
+    }
+
+    // Every decoder picks up where it stopped when the source would block,
+    // so the read is simply retried once the source is refilled.
+    Async::Task<usize> readAsync(MutBytes bytes) {
+        while (true) {
+            auto res = read(bytes);
+            if (res or res.none() != Error::WOULD_BLOCK)
+                co_return res;
+            co_trya$(_source.fillAsync());
+        }
+    }
+
+    // Consume what is left of the framing once the content is decoded,
+    // like the last chunk after a gzip trailer.
+    Res<> finish() {
+        if (not delimited())
+            return Ok();
+        Io::Sink sink;
+        try$(Io::copy(*_framed, sink));
+        return Ok();
+    }
+
+    Async::Task<> finishAsync() {
+        if (not delimited())
+            co_return Ok();
+
+        Array<Byte, 512> buf;
+        while (true) {
+            auto res = _framed->read(mutBytes(buf));
+            if (res and res.unwrap() == 0)
+                co_return Ok();
+            if (res)
+                continue;
+            if (res.none() != Error::WOULD_BLOCK)
+                co_return res.none();
+            co_trya$(_source.fillAsync());
+        }
+    }
+};
+
+} // namespace Karm::Net::Http
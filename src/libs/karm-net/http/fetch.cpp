@@ -1,7 +1,10 @@
+#include <karm-async/queue.h>
+#include <karm-io/async.h>
 #include <karm-io/funcs.h>
 #include <karm-json/parse.h>
 #include <karm-logger/logger.h>
-#include <karm-net/dns/dns.h>
+#include <karm-net/dns/resolver.h>
+#include <karm-net/http/body.h>
 #include <karm-net/http/http.h>
 #include <karm-net/tls/tls.h>
 #include <karm-sys/file.h>
@@ -12,18 +15,155 @@
 namespace Karm::Net::Http {
 
 Async::Task<Sys::Ip> resolve(Str host) {
-    auto res = Sys::Ip::parse(host);
-    if (res)
-        co_return res;
+    auto resolver = co_try$(Dns::globalResolver());
+    co_return co_await resolver->resolveOneAsync(host);
+}
+
+// MARK: Connection Pool -------------------------------------------------------
+
+// A connection to an origin, pinned since the tls layer refers to the
+// underlying tcp connection.
+struct Stream : Meta::Pinned {
+    Sys::TcpConnection tcp;
+    Opt<Tls::TlsConnection> tls;
+
+    // Whether the last exchange left the connection ready for another one.
+    bool reusable = false;
+    // Whether the peer closed the connection before sending anything, this
+    // is how an idle connection timed out by the server shows up.
+    bool stale = false;
+
+    Stream(Sys::TcpConnection tcp)
+        : tcp(std::move(tcp)) {}
+
+    Sys::_Connection& conn() {
+        if (tls)
+            return *tls;
+        return tcp;
+    }
+};
+
+// NOTE: A slot is either an idle connection, or NONE when a connection was
+//       dropped and its permit is handed over to a waiting fetch, which
+//       then opens its own.
+using Slot = Opt<Rc<Stream>>;
+
+struct Origin {
+    // Permits handed out, both in use and idle.
+    usize open = 0;
+    Async::Queue<Slot> idle;
+};
+
+struct Pool {
+    Map<String, Rc<Origin>> _origins;
+    PoolStats _stats;
+
+    Rc<Origin> origin(String const& key) {
+        if (auto origin = _origins.tryGet(key))
+            return *origin;
+        auto origin = makeRc<Origin>();
+        _origins.put(key, origin);
+        return origin;
+    }
+
+    Async::Task<Slot> acquire(Origin& origin) {
+        if (auto slot = origin.idle.dequeue()) {
+            if (*slot)
+                _stats.reused++;
+            co_return Ok(slot.take());
+        }
+
+        if (origin.open < MAX_CONNECTIONS_PER_ORIGIN) {
+            origin.open++;
+            co_return Ok(NONE);
+        }
+
+        auto slot = co_await origin.idle.dequeueAsync();
+        if (slot)
+            _stats.reused++;
+        co_return Ok(std::move(slot));
+    }
+
+    void release(Origin& origin, Slot slot) {
+        if (slot and (*slot)->reusable) {
+            origin.idle.enqueue(std::move(slot));
+            return;
+        }
+
+        // The connection is gone, hand its permit over to whoever is
+        // waiting, or give it back.
+        if (origin.idle.waiting())
+            origin.idle.enqueue(NONE);
+        else
+            origin.open--;
+    }
+};
+
+static Pool& _pool() {
+    static Pool pool;
+    return pool;
+}
+
+PoolStats poolStats() {
+    auto stats = _pool()._stats;
+    for (auto const& [_, origin] : _pool()._origins.iter())
+        stats.idle += origin->idle.len();
+    return stats;
+}
+
+void flushPool() {
+    // NOTE: Map::iter() hands out const entries, the origins are taken by
+    //       index to get a handle they can be changed through.
+    auto& origins = _pool()._origins;
+    for (usize i = 0; i < origins.len(); i++) {
+        auto origin = origins.at(i);
+        while (origin->idle.dequeue())
+            origin->open--;
+    }
+}
 
-    if (host == "localhost")
-        co_return Ok(Sys::Ip4::localhost());
+static Async::Task<Rc<Stream>> _connect(Mime::Url const& url) {
+    auto ip = co_trya$(resolve(url.host));
+    auto port = url.port ? *url.port : 80;
+    if (port > 65535)
+        co_return Error::invalidData("port out of range");
+
+    Sys::SocketAddr addr{ip, (u16)port};
+    auto stream = makeRc<Stream>(co_try$(Sys::TcpConnection::connect(addr)));
+    if (url.scheme == "https")
+        stream->tls.emplace(co_try$(Tls::TlsConnection::connect(stream->tcp)));
+
+    _pool()._stats.opened++;
+    co_return Ok(stream);
+}
+
+// MARK: Fetch -----------------------------------------------------------------
 
-    auto dns = co_try$(Dns::Client::connect(Dns::GOOGLE));
-    co_return Ok(co_try$(dns.resolve(host)));
+static Async::Task<> _writeAll(Sys::_Connection& conn, Bytes buf) {
+    while (buf.len()) {
+        auto written = co_trya$(conn.writeAsync(buf));
+        if (written == 0)
+            co_return Error::writeZero("connection closed while writing");
+        buf = next(buf, written);
+    }
+    co_return Ok();
 }
 
-Async::Task<usize> _fetch(Mime::Url const& url, Sys::_Connection& conn, Io::Writer& out) {
+// The caller's writer, like a buffer or a file, as the target of
+// Io::copyAsync(), writes to it complete right away.
+struct _Out {
+    Io::Writer& _out;
+
+    Async::Task<usize> writeAsync(Bytes bytes) {
+        co_return _out.write(bytes);
+    }
+};
+
+Async::Task<usize> _fetch(Mime::Url const& url, Stream& stream, Io::Writer& out) {
+    auto& conn = stream.conn();
+    stream.reusable = false;
+    stream.stale = false;
+
     // Send request
     logDebug("GET {} HTTP/1.1", url.path);
     Io::StringWriter req;
@@ -31,60 +171,95 @@ Async::Task<usize> _fetch(Mime::Url const& url, Sys::_Connection& conn, Io::Writ
         req,
         "GET {} HTTP/1.1\r\n"
         "Host: {}\r\n"
-        "Connection: close\r\n"
+        "Connection: keep-alive\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
         "User-Agent: Karm Web Fetch/" stringify$(__ck_version_value) "\r\n"
                                                                      "\r\n",
         url.path,
         url.host
     ));
 
-    co_try$(conn.write(req.bytes()));
+    co_trya$(_writeAll(conn, req.bytes()));
 
-    // Read response
-    Array<char, 4096> buf;
-    auto len = co_try$(conn.read(mutBytes(buf)));
-    logDebug("Response: {}", Str{buf.buf(), len});
+    // Read the response head, it may span any number of reads
+    Array<Byte, 4096> buf;
+    HeadParser head;
+    Bytes rest;
+    while (true) {
+        auto len = co_trya$(conn.readAsync(mutBytes(buf)));
+        if (len == 0) {
+            stream.stale = head._buf.len() == 0;
+            co_return Error::unexpectedEof("connection closed before response head");
+        }
 
-    Str respStr{buf.buf(), len};
+        auto chunk = sub(buf, 0, len);
+        if (auto used = co_try$(head.feed(chunk))) {
+            rest = next(chunk, *used);
+            break;
+        }
+    }
 
-    auto s = Io::SScan({buf.buf(), len});
-    auto resp = co_try$(Http::Response::parse(s));
+    logDebug("Response: {}", head.str());
+    auto resp = co_try$(head.response());
 
     if (resp.code != Http::Code::OK)
         co_return Error::invalidData("http error");
 
-    auto contentLength = co_try$(Io::atou(co_try$(resp.headers.tryGet("Content-Length"s)).str()));
-    auto remData = bytes(s.remStr());
-    auto written = co_try$(out.write(sub(remData, 0, contentLength)));
-    if (written < contentLength)
-        co_try$(Io::copy(conn, out, contentLength - written));
-    co_return Ok(contentLength);
+    Body body{conn, rest};
+    co_try$(body.setup(resp));
+    _Out sink{out};
+    auto written = co_trya$(Io::copyAsync(body, sink));
+    co_trya$(body.finishAsync());
+
+    // Requests are not pipelined, anything past the body is a protocol
+    // error and makes the connection unusable.
+    stream.reusable = body.complete() and resp.keepAlive();
+    co_return Ok(written);
 }
 
 Async::Task<usize> fetch(Mime::Url const& url, Io::Writer& out) {
-    auto ip = co_trya$(resolve(url.host));
+    if (url.scheme != "http" and url.scheme != "https")
+        co_return Error::invalidData("unsupported scheme");
+
+    auto& pool = _pool();
     auto port = url.port ? *url.port : 80;
-    if (port > 65535)
-        co_return Error::invalidData("port out of range");
+    auto origin = pool.origin(Io::format("{}://{}:{}", url.scheme, url.host, port));
 
-    Sys::SocketAddr addr{ip, (u16)port};
+    // NOTE: A connection taken from the pool may have been closed by the
+    //       server while it was idle, in which case the request is retried
+    //       once on a fresh connection.
+    for (usize attempt = 0;; attempt++) {
+        auto slot = co_trya$(pool.acquire(*origin));
+        bool reused = slot.has();
 
-    if (url.scheme == "http") {
-        auto conn = co_try$(Sys::TcpConnection::connect(addr));
-        co_return co_await _fetch(url, conn, out);
-    } else if (url.scheme == "https") {
-        auto conn = co_try$(Sys::TcpConnection::connect(addr));
-        auto tls = co_try$(Tls::TlsConnection::connect(conn));
-        co_return co_await _fetch(url, tls, out);
-    } else {
-        co_return Error::invalidData("unsupported scheme");
+        if (not slot) {
+            auto stream = co_await _connect(url);
+            if (not stream) {
+                pool.release(*origin, NONE);
+                co_return stream.none();
+            }
+            slot = stream.take();
+        }
+
+        auto& stream = **slot;
+        auto res = co_await _fetch(url, stream, out);
+        bool retry = not res and reused and stream.stale and attempt == 0;
+        pool.release(*origin, std::move(slot));
+
+        if (retry) {
+            logDebug("{}: stale connection, retrying", url);
+            continue;
+        }
+
+        co_return res;
     }
 }
 
 Async::Task<String> fetchString(Mime::Url const& url) {
-    Io::StringWriter out;
+    // NOTE: StringWriter only takes text, the body is collected as bytes.
+    Io::BufferWriter out;
     co_trya$(fetch(url, out));
-    co_return Ok(out.take());
+    co_return Ok(String{(char const*)out.bytes().buf(), out.bytes().len()});
 }
 
 Async::Task<Json::Value> fetchJson(Mime::Url const& url) {
@@ -6,6 +6,26 @@
 
 namespace Karm::Net::Http {
 
+// MARK: Connection Pool -------------------------------------------------------
+
+// Connections are kept alive and reused between fetches to the same origin,
+// at most this many are open to an origin at once, further fetches wait for
+// one to be released.
+static constexpr usize MAX_CONNECTIONS_PER_ORIGIN = 6;
+
+struct PoolStats {
+    usize opened = 0;
+    usize reused = 0;
+    usize idle = 0;
+};
+
+PoolStats poolStats();
+
+// Close every idle connection.
+void flushPool();
+
+// MARK: Fetch -----------------------------------------------------------------
+
 Async::Task<usize> fetch(Mime::Url const& url, Io::Writer& out);
 
 Async::Task<String> fetchString(Mime::Url const& url);
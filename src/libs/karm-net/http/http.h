@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/array.h>
 #include <karm-base/distinct.h>
 #include <karm-base/map.h>
 #include <karm-io/aton.h>
@@ -185,6 +186,24 @@ struct Header {
         headers.put(key, std::move(value));
     }
 
+    // Header names are case-insensitive, look one up regardless of how the
+    // peer spelled it.
+    Opt<Str> lookup(Str key) const {
+        for (auto const& [k, v] : headers.iter())
+            if (eqCi(k.str(), key))
+                return v.str();
+        return NONE;
+    }
+
+    // Connections are persistent by default since HTTP/1.1, before that
+    // only when asked for.
+    bool _keepAlive(Version version) const {
+        auto conn = lookup("Connection");
+        if (version.major < 1 or (version.major == 1 and version.minor == 0))
+            return conn and eqCi(*conn, "keep-alive"s);
+        return not conn or not eqCi(*conn, "close"s);
+    }
+
     Res<> _parse(Io::SScan& s) {
         while (not s.ended()) {
             Str key, value;
@@ -261,6 +280,12 @@ struct Request : public Header {
         return Ok(req);
     }
 
+    // Whether the client expects the connection to stay open once this
+    // request is answered.
+    bool keepAlive() const {
+        return _keepAlive(version);
+    }
+
     Res<> unparse(Io::TextWriter& w) {
         // Start line
 
@@ -335,8 +360,156 @@ struct Response : public Header {
 
         return Ok(bodyBytes.take());
     }
+
+    // Whether the connection can carry another request once this response
+    // is consumed.
+    bool keepAlive() const {
+        return _keepAlive(version);
+    }
 };
 
+// MARK: Head Parser -----------------------------------------------------------
+
+// Accumulates a message head that may arrive split across any number of
+// reads, the head ends at the first empty line. Bytes past it are not
+// consumed, they are the start of the body or of the next message.
+struct HeadParser {
+    static constexpr usize MAX_LEN = 64 * 1024;
+
+    Vec<Byte> _buf;
+    // How much of "\r\n\r\n" was matched at the end of the buffer.
+    usize _match = 0;
+
+    // Feed a chunk of input, returns how many of its bytes belong to the
+    // head once it is complete, NONE if more input is needed.
+    Res<Opt<usize>> feed(Bytes chunk) {
+        if (done())
+            return Ok(0uz);
+
+        static constexpr Array<Byte, 4> END = {'\r', '\n', '\r', '\n'};
+
+        usize i = 0;
+        while (i < chunk.len() and _match < END.len()) {
+            if (chunk[i] == END[_match])
+                _match++;
+            else
+                _match = chunk[i] == END[0] ? 1 : 0;
+            i++;
+        }
+
+        if (_buf.len() + i > MAX_LEN)
+            return Error::invalidData("http head too large");
+
+        _buf.insertMany(_buf.len(), sub(chunk, 0, i));
+
+        if (not done())
+            return Ok(NONE);
+        return Ok(i);
+    }
+
+    bool done() const {
+        return _match == 4;
+    }
+
+    Str str() const {
+        return {(char const*)_buf.buf(), _buf.len()};
+    }
+
+    Res<Response> response() const {
+        if (not done())
+            return Error::invalidInput("incomplete http head");
+        Io::SScan s{str()};
+        return Response::parse(s);
+    }
+
+    Res<Request> request() const {
+        if (not done())
+            return Error::invalidInput("incomplete http head");
+        Io::SScan s{str()};
+        return Request::parse(s);
+    }
+
+    void reset() {
+        _buf.clear();
+        _match = 0;
+    }
+};
+
+// MARK: Ranges ----------------------------------------------------------------
+
+// A single range of bytes of a representation, `end` is exclusive.
+struct ByteRange {
+    usize start;
+    usize end;
+
+    usize len() const {
+        return end - start;
+    }
+};
+
+// Resolve the value of a Range header against a representation of `size`
+// bytes. NONE means the header is ignored and the whole representation is
+// sent, which is what happens to anything but a single well-formed byte
+// range. Fails when the range can't be satisfied.
+// https://www.rfc-editor.org/rfc/rfc9110#section-14.2
+static inline Res<Opt<ByteRange>> resolveRange(Str value, usize size) {
+    Io::SScan s{value};
+    if (not s.skip("bytes="))
+        return Ok(NONE);
+
+    if (s.skip('-')) {
+        auto suffix = atou(s);
+        if (not suffix or not s.ended())
+            return Ok(NONE);
+        if (*suffix == 0 or size == 0)
+            return Error::invalidInput("unsatisfiable range");
+        return Ok(ByteRange{size - min(*suffix, size), size});
+    }
+
+    auto first = atou(s);
+    if (not first or not s.skip('-'))
+        return Ok(NONE);
+
+    Opt<usize> last = NONE;
+    if (not s.ended()) {
+        last = atou(s);
+        if (not last or not s.ended() or *last < *first)
+            return Ok(NONE);
+    }
+
+    if (*first >= size)
+        return Error::invalidInput("unsatisfiable range");
+
+    usize end = last ? min(*last + 1, size) : size;
+    return Ok(ByteRange{*first, end});
+}
+
+// MARK: Dates -----------------------------------------------------------------
+
+// Format a timestamp the way header fields carry it, as an IMF-fixdate.
+// https://www.rfc-editor.org/rfc/rfc9110#section-5.6.7
+static inline String formatDate(SystemTime stamp) {
+    // NOTE: The epoch fell on a thursday.
+    static constexpr Array<Str, 7> DAYS = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+    static constexpr Array<Str, 12> MONTHS = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+
+    auto dt = DateTime::fromInstant(stamp);
+    auto days = (stamp - SystemTime::epoch()).toDays();
+    return Io::format(
+        "{}, {02} {} {04} {02}:{02}:{02} GMT",
+        DAYS[days % 7],
+        (usize)dt.date.day + 1,
+        MONTHS[dt.date.month.val()],
+        (isize)dt.date.year,
+        dt.time.hour,
+        dt.time.minute,
+        dt.time.second
+    );
+}
+
 } // namespace Karm::Net::Http
 
 template <>
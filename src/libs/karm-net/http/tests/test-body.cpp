@@ -0,0 +1,330 @@
+#include <karm-archive/gzip.h>
+#include <karm-archive/zlib.h>
+#include <karm-async/run.h>
+#include <karm-net/http/body.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Net::Http::Tests {
+
+// Stands in for a server connection, it answers reads with at most a few
+// bytes at a time, so every decoder has to cope with short reads.
+struct Trickle : public Io::Reader {
+    Bytes _buf;
+    usize _step;
+
+    Trickle(Bytes buf, usize step = 5)
+        : _buf(buf), _step(step) {}
+
+    Res<usize> read(MutBytes bytes) override {
+        auto n = copy(sub(_buf, 0, min(_step, bytes.len())), bytes);
+        _buf = next(_buf, n);
+        return Ok(n);
+    }
+};
+
+// Read a response the way fetch does, the head first then the body from
+// whatever was left over.
+static Res<Tuple<Response, String>> _exchange(Io::Reader& conn, bool& complete) {
+    Array<Byte, 64> buf;
+    HeadParser head;
+    Bytes rest;
+    while (true) {
+        auto len = try$(conn.read(mutBytes(buf)));
+        if (len == 0)
+            return Error::unexpectedEof("no head");
+
+        auto chunk = sub(buf, 0, len);
+        if (auto used = try$(head.feed(chunk))) {
+            rest = next(chunk, *used);
+            break;
+        }
+    }
+
+    auto resp = try$(head.response());
+    Body body{conn, rest};
+    try$(body.setup(resp));
+
+    Io::BufferWriter out;
+    try$(Io::copy(body, out));
+    try$(body.finish());
+    complete = body.complete();
+
+    String str{(char const*)out.bytes().buf(), out.bytes().len()};
+    return Ok(Tuple<Response, String>{resp, str});
+}
+
+test$("http-body-content-length") {
+    auto raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 11\r\n"
+        "\r\n"
+        "hello world"s;
+
+    Trickle conn{bytes(raw)};
+    bool complete = false;
+    auto [resp, body] = try$(_exchange(conn, complete));
+    expectEq$(body, "hello world"s);
+    expect$(complete);
+
+    return Ok();
+}
+
+test$("http-body-content-length-overrun") {
+    auto raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "hello world"s;
+
+    // Everything arrives in one read, the extra bytes stay buffered and
+    // mark the connection as unusable.
+    Io::BufReader conn{bytes(raw)};
+    bool complete = true;
+    auto [resp, body] = try$(_exchange(conn, complete));
+    expectEq$(body, "hello"s);
+    expectNot$(complete);
+
+    return Ok();
+}
+
+test$("http-body-chunked") {
+    auto raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\n"
+        "hello\r\n"
+        "1;ext=value\r\n"
+        " \r\n"
+        "A\r\n"
+        "chunked!!!\r\n"
+        "0\r\n"
+        "Trailer: dropped\r\n"
+        "\r\n"s;
+
+    Trickle conn{bytes(raw), 3};
+    bool complete = false;
+    auto [resp, body] = try$(_exchange(conn, complete));
+    expectEq$(body, "hello chunked!!!"s);
+    expect$(complete);
+
+    return Ok();
+}
+
+test$("http-body-chunked-bad-size") {
+    auto raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "zz\r\n"
+        "hello\r\n"s;
+
+    Io::BufReader conn{bytes(raw)};
+    bool complete = false;
+    expectNot$(_exchange(conn, complete).has());
+
+    return Ok();
+}
+
+test$("http-body-chunked-gzip") {
+    static constexpr Array<u8, 51> GZIP = {
+        0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xf3, 0x48,
+        0xcd, 0xc9, 0xc9, 0x57, 0x48, 0x2b, 0xca, 0xcf, 0x55, 0x48, 0x54, 0x48,
+        0xce, 0x28, 0xcd, 0xcb, 0x4e, 0x4d, 0x51, 0x48, 0xaf, 0xca, 0x2c, 0x50,
+        0x48, 0xca, 0x4f, 0xa9, 0x54, 0x04, 0x00, 0xbb, 0xda, 0xce, 0x69, 0x1f,
+        0x00, 0x00, 0x00
+    };
+
+    Io::BufferWriter raw;
+    try$(raw.write(bytes(
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Content-Encoding: gzip\r\n"
+        "\r\n"s
+    )));
+
+    // Split the compressed data in chunks that don't line up with anything
+    for (usize i = 0; i < GZIP.len(); i += 16) {
+        auto chunk = sub(GZIP, i, min(i + 16, GZIP.len()));
+        try$(raw.write(bytes(Io::format("{x}\r\n", chunk.len()))));
+        try$(raw.write(chunk));
+        try$(raw.write(bytes("\r\n"s)));
+    }
+    try$(raw.write(bytes("0\r\n\r\n"s)));
+
+    Trickle conn{raw.bytes(), 7};
+    bool complete = false;
+    auto [resp, body] = try$(_exchange(conn, complete));
+    expectEq$(body, "Hello from a chunked gzip body!"s);
+    expect$(complete);
+
+    return Ok();
+}
+
+// An asynchronous connection answering a few bytes per read, blocking reads
+// fail so the body can only be read through readAsync().
+struct AsyncTrickle : public Sys::_Connection {
+    Trickle _trickle;
+    usize _reads = 0;
+
+    AsyncTrickle(Bytes buf, usize step)
+        : _trickle(buf, step) {}
+
+    Res<usize> read(MutBytes) override {
+        return Error::other("blocking read");
+    }
+
+    Res<usize> write(Bytes) override {
+        return Error::other("unexpected write");
+    }
+
+    Res<> flush() override {
+        return Ok();
+    }
+
+    Async::Task<usize> readAsync(MutBytes buf) override {
+        _reads++;
+        co_return _trickle.read(buf);
+    }
+
+    Async::Task<usize> writeAsync(Bytes) override {
+        co_return Error::other("unexpected write");
+    }
+
+    Async::Task<> flushAsync() override {
+        co_return Ok();
+    }
+};
+
+static Async::Task<> _readBodyAsync(Body& body, Io::BufferWriter& out) {
+    Array<Byte, 100> buf;
+    while (true) {
+        auto n = co_trya$(body.readAsync(mutBytes(buf)));
+        if (n == 0)
+            break;
+        co_try$(out.write(sub(buf, 0, n)));
+    }
+    co_return co_await body.finishAsync();
+}
+
+static Res<Tuple<String, bool>> _exchangeAsync(Str head, Bytes content, bool chunked, usize step) {
+    Io::BufferWriter raw;
+    try$(raw.write(bytes(head)));
+    if (chunked) {
+        for (usize i = 0; i < content.len(); i += 1000) {
+            auto chunk = sub(content, i, min(i + 1000, content.len()));
+            try$(raw.write(bytes(Io::format("{x}\r\n", chunk.len()))));
+            try$(raw.write(chunk));
+            try$(raw.write(bytes("\r\n"s)));
+        }
+        try$(raw.write(bytes("0\r\n\r\n"s)));
+    } else {
+        try$(raw.write(content));
+    }
+
+    HeadParser parser;
+    auto rest = next(raw.bytes(), try$(parser.feed(raw.bytes())).unwrap());
+    auto resp = try$(parser.response());
+
+    // Hold back the part of the body that came with the head, the
+    // connection hands out the rest.
+    AsyncTrickle conn{next(rest, min(rest.len(), 3uz)), step};
+    Body body{conn, sub(rest, 0, min(rest.len(), 3uz))};
+    try$(body.setup(resp));
+
+    Io::BufferWriter out;
+    try$(Async::run(_readBodyAsync(body, out)));
+    if (conn._reads == 0)
+        return Error::other("the connection was not read asynchronously");
+
+    String str{(char const*)out.bytes().buf(), out.bytes().len()};
+    return Ok(Tuple<String, bool>{str, body.complete()});
+}
+
+static String _lorem() {
+    Io::StringWriter w;
+    for (usize i = 0; i < 400; i++)
+        (void)Io::format(w, "{} Lorem ipsum dolor sit amet, {} consectetur adipiscing elit. ", i, i * 7);
+    return w.take();
+}
+
+test$("http-body-async-chunked-gzip") {
+    auto text = _lorem();
+    auto gzip = try$(Archive::gzip(bytes(text)));
+
+    // Every step size makes reads stop somewhere else, in the middle of a
+    // chunk line, a gzip header, a huffman table or the trailer.
+    for (usize step : {1uz, 2uz, 7uz, 64uz, 4096uz}) {
+        auto [body, complete] = try$(_exchangeAsync(
+            "HTTP/1.1 200 OK\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "Content-Encoding: gzip\r\n"
+            "\r\n"s,
+            gzip,
+            true,
+            step
+        ));
+        expectEq$(body, text);
+        expect$(complete);
+    }
+
+    return Ok();
+}
+
+test$("http-body-async-deflate") {
+    auto text = _lorem();
+    auto zlib = try$(Archive::zlib(bytes(text)));
+
+    for (usize step : {1uz, 3uz, 512uz}) {
+        auto [body, complete] = try$(_exchangeAsync(
+            Io::format(
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: {}\r\n"
+                "Content-Encoding: deflate\r\n"
+                "\r\n",
+                zlib.len()
+            ),
+            zlib,
+            false,
+            step
+        ));
+        expectEq$(body, text);
+        expect$(complete);
+    }
+
+    return Ok();
+}
+
+test$("http-body-async-truncated") {
+    auto gzip = try$(Archive::gzip(bytes(_lorem())));
+
+    // The connection closes before the gzip trailer.
+    auto truncated = sub(gzip, 0, gzip.len() - 4);
+    auto res = _exchangeAsync(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Encoding: gzip\r\n"
+        "\r\n"s,
+        truncated,
+        false,
+        5
+    );
+    expectNot$(res.has());
+
+    return Ok();
+}
+
+test$("http-body-unsupported-encoding") {
+    auto raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Encoding: br\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"s;
+
+    Io::BufReader conn{bytes(raw)};
+    bool complete = false;
+    expectNot$(_exchange(conn, complete).has());
+
+    return Ok();
+}
+
+} // namespace Karm::Net::Http::Tests
@@ -0,0 +1,77 @@
+#include <karm-net/http/http.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Net::Http::Tests {
+
+test$("http-head-parser-single-chunk") {
+    auto raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 3\r\n"
+        "\r\n"
+        "foo"s;
+
+    HeadParser head;
+    auto used = try$(head.feed(bytes(raw)));
+    expect$(used.has());
+    expectEq$(*used, raw.len() - 3);
+
+    auto resp = try$(head.response());
+    expectEq$(resp.code, Code::OK);
+    expectEq$(resp.lookup("content-length"), "3"s);
+
+    return Ok();
+}
+
+test$("http-head-parser-split-terminator") {
+    auto raw =
+        "HTTP/1.1 404 Not Found\r\n"
+        "Server: Karm\r\n"
+        "\r\n"s;
+
+    // Feed the head one byte at a time, so the terminator is split across
+    // every possible boundary.
+    HeadParser head;
+    for (usize i = 0; i < raw.len() - 1; i++) {
+        auto used = try$(head.feed(sub(bytes(raw), i, i + 1)));
+        expectNot$(used.has());
+    }
+
+    auto used = try$(head.feed(sub(bytes(raw), raw.len() - 1, raw.len())));
+    expectEq$(used, 1uz);
+
+    auto resp = try$(head.response());
+    expectEq$(resp.code, Code::NOT_FOUND);
+    expectEq$(resp.lookup("Server"), "Karm"s);
+
+    return Ok();
+}
+
+test$("http-head-parser-too-large") {
+    HeadParser head;
+    Array<Byte, 1024> junk;
+    for (auto& b : junk)
+        b = 'a';
+
+    for (usize i = 0; i < HeadParser::MAX_LEN / junk.len(); i++)
+        try$(head.feed(bytes(junk)));
+
+    expectNot$(head.feed(bytes(junk)));
+
+    return Ok();
+}
+
+test$("http-response-keep-alive") {
+    auto parse = [](Str raw) -> Res<Response> {
+        Io::SScan s{raw};
+        return Response::parse(s);
+    };
+
+    expect$(try$(parse("HTTP/1.1 200 OK\r\n\r\n")).keepAlive());
+    expectNot$(try$(parse("HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n")).keepAlive());
+    expectNot$(try$(parse("HTTP/1.0 200 OK\r\n\r\n")).keepAlive());
+    expect$(try$(parse("HTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\n\r\n")).keepAlive());
+
+    return Ok();
+}
+
+} // namespace Karm::Net::Http::Tests
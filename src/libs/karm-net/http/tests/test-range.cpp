@@ -0,0 +1,59 @@
+#include <karm-net/http/http.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Net::Http::Tests {
+
+test$("http-range-resolve") {
+    auto range = [](Str value) {
+        return resolveRange(value, 100).unwrap();
+    };
+
+    auto r = range("bytes=0-9");
+    expect$(r.has());
+    expectEq$(r->start, 0uz);
+    expectEq$(r->end, 10uz);
+
+    r = range("bytes=90-");
+    expectEq$(r->start, 90uz);
+    expectEq$(r->end, 100uz);
+
+    r = range("bytes=-10");
+    expectEq$(r->start, 90uz);
+    expectEq$(r->end, 100uz);
+
+    // Ranges past the end are clamped
+    r = range("bytes=50-500");
+    expectEq$(r->end, 100uz);
+
+    r = range("bytes=-500");
+    expectEq$(r->start, 0uz);
+
+    return Ok();
+}
+
+test$("http-range-ignored") {
+    // Anything but a single well-formed byte range means the whole thing
+    expectNot$(try$(resolveRange("items=0-9", 100)).has());
+    expectNot$(try$(resolveRange("bytes=0-9,20-29", 100)).has());
+    expectNot$(try$(resolveRange("bytes=9-0", 100)).has());
+    expectNot$(try$(resolveRange("bytes=abc", 100)).has());
+
+    return Ok();
+}
+
+test$("http-range-unsatisfiable") {
+    expectNot$(resolveRange("bytes=100-", 100));
+    expectNot$(resolveRange("bytes=-0", 100));
+    expectNot$(resolveRange("bytes=0-", 0));
+
+    return Ok();
+}
+
+test$("http-format-date") {
+    auto stamp = SystemTime::epoch() + Duration::fromSecs(784111777);
+    expectEq$(formatDate(stamp), "Sun, 06 Nov 1994 08:49:37 GMT"s);
+
+    return Ok();
+}
+
+} // namespace Karm::Net::Http::Tests
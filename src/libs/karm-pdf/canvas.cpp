@@ -112,11 +112,8 @@ void Canvas::fill(Gfx::FillRule rule) {
 void Canvas::fill(Text::Prose& prose) {
     push();
     _e.ln("BT");
-    _e.ln(
-        "/F{} {} Tf",
-        _fontManager->getFontId(prose._style.font.fontface),
-        prose._style.font.fontSize()
-    );
+    auto fontId = _fontManager->getFontId(prose._style.font.fontface);
+    _e.ln("/F{} {} Tf", fontId, prose._style.font.fontSize());
 
     if (prose._style.color)
         fillStyle(*prose._style.color);
@@ -146,6 +143,7 @@ void Canvas::fill(Text::Prose& prose) {
                     _e(">{}<", kern);
 
                 for (auto rune : cell.runes()) {
+                    _fontManager->useRune(fontId, rune);
                     _e("{04x}", rune);
                 }
                 prevEndPos = prevEndPos + glyphAdvance - kern;
@@ -7,19 +7,69 @@
 
 namespace Karm::Pdf {
 
+// Runes drawn with a font. With Identity-H they are also the CIDs, so
+// they fit in two bytes.
+struct FontUsage {
+    static constexpr usize CODESPACE = 1 << 16;
+
+    Buf<u64> _bits = Buf<u64>::init(CODESPACE / 64, 0);
+
+    void use(Rune rune) {
+        if (rune < CODESPACE)
+            _bits[rune / 64] |= 1ull << (rune % 64);
+    }
+
+    bool used(Rune rune) const {
+        return rune < CODESPACE and (_bits[rune / 64] >> (rune % 64)) & 1;
+    }
+
+    // Every rune drawn, in increasing order.
+    Vec<Rune> runes() const {
+        Vec<Rune> runes;
+        for (usize i = 0; i < _bits.len(); i++) {
+            for (u64 word = _bits[i]; word; word &= word - 1)
+                runes.pushBack(i * 64 + __builtin_ctzll(word));
+        }
+        return runes;
+    }
+};
+
 struct FontManager {
     // FIXME: using the address of the fontface since there is not comparison for the fontface obj
     Map<_Cell<NoLock>*, Tuple<usize, Rc<Text::Fontface>>> mapping;
 
+    // What each font was used for, by id, so only those glyphs get embedded.
+    Map<usize, FontUsage> usage;
+
+    // Fonts used since the last call to takePageFonts().
+    Map<usize, Rc<Text::Fontface>> _pageFonts;
+
     usize getFontId(Rc<Text::Fontface> font) {
         auto addr = font._cell;
-        if (auto id = mapping.tryGet(addr))
-            return id.unwrap().v0;
-
-        auto id = mapping.len() + 1;
-        mapping.put(addr, {id, font});
+        usize id;
+        if (auto entry = mapping.tryGet(addr)) {
+            id = entry.unwrap().v0;
+        } else {
+            id = mapping.len() + 1;
+            mapping.put(addr, {id, font});
+            usage.put(id, {});
+        }
+
+        if (not _pageFonts.has(id))
+            _pageFonts.put(id, font);
         return id;
     }
+
+    void useRune(usize id, Rune rune) {
+        if (auto fontUsage = usage.access(id))
+            fontUsage->use(rune);
+    }
+
+    Map<usize, Rc<Text::Fontface>> takePageFonts() {
+        auto fonts = std::move(_pageFonts);
+        _pageFonts = {};
+        return fonts;
+    }
 };
 
 struct Canvas : public Gfx::Canvas {
@@ -1,3 +1,5 @@
+#include <karm-archive/zlib.h>
+
 #include "values.h"
 
 namespace Karm::Pdf {
@@ -29,6 +31,14 @@ void Dict::write(Io::Emit& e) const {
     e(">>");
 }
 
+Res<Stream> Stream::flate(Dict dict, Bytes data) {
+    auto compressed = try$(Archive::zlib(data));
+
+    dict.put("Filter"s, Name{"FlateDecode"s});
+    dict.put("Length"s, compressed.len());
+    return Ok(Stream{std::move(dict), std::move(compressed)});
+}
+
 void Stream::write(Io::Emit& e) const {
     dict.write(e);
     e("stream\n");
@@ -67,45 +77,63 @@ void Value::write(Io::Emit& e) const {
 }
 
 Res<> File::write(Io::Writer& w) const {
-    Io::Count count{w};
-    Io::TextEncoder<> enc{w};
+    Writer writer{w};
+    try$(writer.begin(header));
+    for (auto const& [k, v] : body.iter())
+        try$(writer.add(k, v));
+    return writer.end(trailer);
+}
+
+void XRef::write(Io::Emit& e) const {
+    e("1 {}\n", entries.len());
+    for (usize i = 0; i < entries.len(); ++i) {
+        auto const& entry = entries[i];
+        if (entry.used) {
+            e("{:010} {:05} n \n", entry.offset, entry.gen);
+        } else {
+            e("0000000000 00000 f \n");
+        }
+    }
+}
+
+// MARK: Writer ----------------------------------------------------------------
+
+Res<> Writer::begin(Str header) {
+    Io::TextEncoder<> enc{_out};
     Io::Emit e{enc};
     e("%{}\n", header);
-    e("%Powered By Karm PDF 🐢🏳️‍⚧️🦔\n", header);
+    e("%Powered By Karm PDF 🐢🏳️‍⚧️🦔\n");
+    return e.flush();
+}
 
-    XRef xref;
+Res<> Writer::add(Ref ref, Value const& value) {
+    _xref.set(ref, try$(Io::tell(_out)));
 
-    for (auto const& [k, v] : body.iter()) {
-        try$(e.flush());
-        xref.add(try$(Io::tell(count)), k.gen);
-        e("{} {} obj\n", k.num, k.gen);
-        v.write(e);
-        e("\nendobj\n");
-    }
+    Io::TextEncoder<> enc{_out};
+    Io::Emit e{enc};
+    e("{} {} obj\n", ref.num, ref.gen);
+    value.write(e);
+    e("\nendobj\n");
+    return e.flush();
+}
+
+Res<> Writer::end(Dict trailer) {
+    auto startxref = try$(Io::tell(_out));
+    trailer.put("Size"s, _xref.entries.len() + 1);
 
-    try$(e.flush());
-    auto startxref = try$(Io::tell(count));
+    Io::TextEncoder<> enc{_out};
+    Io::Emit e{enc};
     e("xref\n");
-    xref.write(e);
+    _xref.write(e);
 
     e("trailer\n");
     trailer.write(e);
 
-    e("startxref\n");
+    e("\nstartxref\n");
     e("{}\n", startxref);
     e("%%EOF");
 
-    return Ok();
-}
-
-void XRef::write(Io::Emit& e) const {
-    e("1 {}\n", entries.len());
-    for (usize i = 0; i < entries.len(); ++i) {
-        auto const& entry = entries[i];
-        if (entry.used) {
-            e("{:010} {:05} n\n", entry.offset, entry.gen);
-        }
-    }
+    return e.flush();
 }
 
 } // namespace Karm::Pdf
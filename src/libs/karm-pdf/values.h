@@ -41,6 +41,10 @@ struct Stream {
     Dict dict;
     Buf<Byte> data;
 
+    // Compress `data` with the Flate filter, `dict` gets the entries
+    // describing the result.
+    static Res<Stream> flate(Dict dict, Bytes data);
+
     void write(Io::Emit& e) const;
 };
 
@@ -83,13 +87,38 @@ struct XRef {
         bool used;
     };
 
+    // One entry per object, starting from object 1.
     Vec<Entry> entries;
 
     void add(usize offset, usize gen) {
         entries.pushBack({offset, gen, true});
     }
 
+    void set(Ref ref, usize offset) {
+        while (entries.len() < ref.num)
+            entries.pushBack({0, 0, false});
+        entries[ref.num - 1] = {offset, ref.gen, true};
+    }
+
     void write(Io::Emit& e) const;
 };
 
+// Write a file one object at a time, in any order, so only the object being
+// written has to be in memory. Offsets are noted as objects go out and end()
+// writes the cross-reference table and the trailer.
+struct Writer {
+    Io::Count _out;
+    XRef _xref;
+
+    Writer(Io::Writer& out)
+        : _out(out) {}
+
+    Res<> begin(Str header);
+
+    Res<> add(Ref ref, Value const& value);
+
+    // `Size` is filled in from the objects that were written.
+    Res<> end(Dict trailer);
+};
+
 } // namespace Karm::Pdf
@@ -1,12 +1,12 @@
 #include <karm-print/page.h>
-#include <karm-print/pdf-printer.h>
+#include <karm-print/file-printer.h>
 #include <karm-sys/entry.h>
 #include <karm-sys/file.h>
 #include <karm-text/loader.h>
 #include <karm-text/prose.h>
 
 Async::Task<> entryPointAsync(Sys::Context&) {
-    auto printer = co_try$(Print::PdfPrinter::create(Mime::Uti::PUBLIC_PDF));
+    auto printer = co_try$(Print::FilePrinter::create(Mime::Uti::PUBLIC_PDF, "file:test.pdf"_url));
 
     auto& ctx = printer->beginPage(Print::A4);
     ctx.fillStyle(Gfx::RED);
@@ -33,7 +33,7 @@ Async::Task<> entryPointAsync(Sys::Context&) {
     prose.layout(Au{999});
     ctx.fill(prose);
 
-    co_try$(printer->save("file:test.pdf"_url));
+    co_try$(printer->finish());
 
     co_return Ok();
 }
@@ -1,3 +1,4 @@
+#include <karm-io/impls.h>
 #include <karm-sys/file.h>
 
 #include "file-printer.h"
@@ -6,24 +7,50 @@
 
 namespace Karm::Print {
 
-Res<Rc<FilePrinter>> FilePrinter::create(Mime::Uti uti, FilePrinterProps props) {
+static bool _isImage(Mime::Uti uti) {
+    return uti == Mime::Uti::PUBLIC_BMP or
+           uti == Mime::Uti::PUBLIC_TGA or
+           uti == Mime::Uti::PUBLIC_QOI;
+}
+
+Res<Rc<FilePrinter>> FilePrinter::create(Mime::Uti uti, Io::Writer& out, FilePrinterProps props) {
     if (uti == Mime::Uti::PUBLIC_PDF) {
-        return Ok(makeRc<PdfPrinter>());
-    } else if (uti == Mime::Uti::PUBLIC_BMP or
-               uti == Mime::Uti::PUBLIC_TGA or
-               uti == Mime::Uti::PUBLIC_QOI) {
-        return Ok(makeRc<ImagePrinter>(props.density, Image::Saver{uti}));
+        return Ok(makeRc<PdfPrinter>(out));
+    } else if (_isImage(uti)) {
+        return Ok(makeRc<ImagePrinter>(out, props.density, Image::Saver{uti}));
     }
 
     return Error::invalidData("cannot create printer");
 }
 
-Res<> FilePrinter::save(Mime::Url url) {
-    auto outFile = try$(Sys::File::create(url));
-    Io::TextEncoder<> outEncoder{outFile};
-    try$(write(outEncoder));
-    try$(outFile.flush());
-    return Ok();
+// Owns the file the printer writes to. Printers write in small pieces, so
+// they go through a buffer rather than straight to the file.
+struct _FilePrinter : public FilePrinter {
+    Sys::FileWriter _file;
+    Io::BufferedWriter _out{_file};
+    Opt<Rc<FilePrinter>> _printer;
+
+    _FilePrinter(Sys::FileWriter file)
+        : _file(std::move(file)) {}
+
+    Gfx::Canvas& beginPage(PaperStock paper) override {
+        return (*_printer)->beginPage(paper);
+    }
+
+    Res<> finish() override {
+        try$((*_printer)->finish());
+        try$(_out.flush());
+        return _file.flush();
+    }
+};
+
+Res<Rc<FilePrinter>> FilePrinter::create(Mime::Uti uti, Mime::Url url, FilePrinterProps props) {
+    if (uti != Mime::Uti::PUBLIC_PDF and not _isImage(uti))
+        return Error::invalidData("cannot create printer");
+
+    auto printer = makeRc<_FilePrinter>(try$(Sys::File::create(url)));
+    printer->_printer = try$(create(uti, printer->_out, props));
+    return Ok(printer);
 }
 
 } // namespace Karm::Print
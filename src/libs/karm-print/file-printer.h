@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-io/traits.h>
 #include <karm-mime/url.h>
 #include <karm-mime/uti.h>
 #include <karm-print/printer.h>
@@ -12,11 +13,15 @@ struct FilePrinterProps {
 };
 
 struct FilePrinter : public Printer {
-    static Res<Rc<FilePrinter>> create(Mime::Uti uti, FilePrinterProps props = {});
+    // A printer writing into `out`, which must outlive it. Formats that
+    // allow it are written out as pages are printed.
+    static Res<Rc<FilePrinter>> create(Mime::Uti uti, Io::Writer& out, FilePrinterProps props = {});
 
-    virtual Res<> write(Io::Writer& w) = 0;
+    // Same, into the file at `url`.
+    static Res<Rc<FilePrinter>> create(Mime::Uti uti, Mime::Url url, FilePrinterProps props = {});
 
-    Res<> save(Mime::Url url);
+    // Write what's left of the file, pages can't be added after this.
+    virtual Res<> finish() = 0;
 };
 
 } // namespace Karm::Print
@@ -9,13 +9,16 @@ namespace Karm::Print {
 struct ImagePrinter : public FilePrinter {
     static constexpr isize GAPS = 16;
 
+    Io::Writer& _out;
     Vec<Rc<Gfx::Surface>> _pages;
     Opt<Gfx::CpuCanvas> _canvas;
     f64 _density;
     Image::Saver _saver;
+    bool _ended = false;
 
-    ImagePrinter(f64 density = 1, Image::Saver saver = {})
-        : _density(density),
+    ImagePrinter(Io::Writer& out, f64 density = 1, Image::Saver saver = {})
+        : _out(out),
+          _density(density),
           _saver(saver) {}
 
     Gfx::Canvas& beginPage(PaperStock paper) override {
@@ -77,10 +80,20 @@ struct ImagePrinter : public FilePrinter {
         return finalImage;
     }
 
-    Res<> write(Io::Writer& w) override {
+    // NOTE: Pages are laid out in a single image, it can only be written
+    //       once they are all printed.
+    Res<> finish() override {
+        if (_ended)
+            return Ok();
+        _ended = true;
+
+        if (_canvas)
+            _canvas->end();
+        _canvas = NONE;
+
         return Image::save(
             _mergedImages()->pixels(),
-            w,
+            _out,
             _saver
         );
     }
@@ -3,78 +3,25 @@
 #include <karm-pdf/canvas.h>
 #include <karm-pdf/values.h>
 #include <karm-text/ttf.h>
+#include <karm-text/ttf/subset.h>
 
 namespace Karm::Print {
 
+// Metrics and mappings of the glyphs kept in a subset, CIDs being the
+// runes drawn, see Pdf::FontUsage.
 struct TtfGlyphInfoAdapter {
-
-    usize const CODESPACE = 1 << 16;
-
     Rc<Text::TtfFontface> _font;
+    Vec<Rune> _runes;
+    Ttf::Subset _subset;
 
-    Map<u16, u16> codeMappings;
-
-    TtfGlyphInfoAdapter(Rc<Text::TtfFontface> font, Map<u16, u16> mappings)
-        : _font{font}, codeMappings{mappings} {}
-
-    Map<u16, u16> static extractMappingForType12(Rc<Text::TtfFontface> font) {
-        Map<u16, u16> codeMappings;
-
-        auto s = font->_parser._cmapTable.begin().skip(12);
-        u32 nGroups = s.nextU32be();
-
-        for (u32 i = 0; i < nGroups; i++) {
-            u32 startCode = s.nextU32be();
-            u32 endCode = s.nextU32be();
-
-            u32 glyphOffset = s.nextU32be();
-
-            for (u32 r = startCode; r <= endCode; ++r) {
-                codeMappings.put(r, (r - startCode) + glyphOffset);
-            }
-        }
-        return codeMappings;
-    }
-
-    Map<u16, u16> static extractMappingForType4(Rc<Text::TtfFontface> font) {
-        Map<u16, u16> codeMappings;
-
-        u16 segCountX2 = font->_parser._cmapTable.begin().skip(6).nextU16be();
-        u16 segCount = segCountX2 / 2;
-
-        for (u16 i = 0; i < segCount; i++) {
-            auto s = font->_parser._cmapTable.begin().skip(14);
-
-            u16 endCode = s.skip(i * 2).peekU16be();
-
-            // + 2 for reserved padding
-            u16 startCode = s.skip(segCountX2 + 2).peekU16be();
-
-            u16 idDelta = s.skip(segCountX2).peekI16be();
-            u16 idRangeOffset = s.skip(segCountX2).peekU16be();
-
-            if (idRangeOffset == 0) {
-                for (u16 code = startCode; code <= endCode; ++code) {
-                    codeMappings.put(code, (u16)((code + idDelta) & 0xFFFF));
-                }
-            } else {
-                for (u16 code = startCode; code <= endCode; ++code) {
-                    auto offset = idRangeOffset + (code - startCode) * 2;
-                    codeMappings.put(code, s.skip(offset).nextU16be());
-                }
-            }
-        }
-
-        return codeMappings;
+    static Res<TtfGlyphInfoAdapter> build(Rc<Text::TtfFontface> font, Pdf::FontUsage const& usage) {
+        auto runes = usage.runes();
+        auto subset = try$(Ttf::Subset::build(font->_parser, runes));
+        return Ok(TtfGlyphInfoAdapter{font, std::move(runes), std::move(subset)});
     }
 
-    static TtfGlyphInfoAdapter build(Rc<Text::TtfFontface> font) {
-        Map<u16, u16> codeMappings;
-        if (font->_parser._cmapTable.type == 4)
-            codeMappings = extractMappingForType4(font);
-        else if (font->_parser._cmapTable.type == 12)
-            codeMappings = extractMappingForType12(font);
-        return TtfGlyphInfoAdapter{font, codeMappings};
+    u16 gidFor(Rune cid) {
+        return _subset.newId(_font->glyph(cid).index);
     }
 
     Pdf::Array fontBBox() {
@@ -84,7 +31,7 @@ struct TtfGlyphInfoAdapter {
         f64 yMin = 0;
         f64 yMax = 0;
 
-        for (auto [_, GID] : codeMappings.iter()) {
+        for (auto GID : _subset.glyphs) {
             Text::Glyph glyph{.index = GID, .font = 0};
             auto metrics = _font->_parser.glyphMetrics(glyph);
 
@@ -102,32 +49,28 @@ struct TtfGlyphInfoAdapter {
 
         Pdf::Array allWidths;
 
-        u16 currGroupStart;
+        Rune currGroupStart = 0;
         Pdf::Array currGroupW;
 
         auto flushCollectedWidths = [&]() {
             if (currGroupW.len() == 0)
                 return;
             allWidths.pushBack(usize{currGroupStart});
-            allWidths.pushBack(Pdf::Array{currGroupW});
+            allWidths.pushBack(std::move(currGroupW));
             currGroupW = {};
         };
 
-        Opt<u16> prevCid;
-        for (auto const& [cid, gid] : codeMappings.iter()) {
-
-            if (prevCid and prevCid.unwrap() + 1 != cid) {
+        Opt<Rune> prevCid;
+        for (auto cid : _runes) {
+            if (prevCid and prevCid.unwrap() + 1 != cid)
                 flushCollectedWidths();
-                continue;
-            }
 
             if (currGroupW.len() == 0)
                 currGroupStart = cid;
 
-            Text::Glyph glyph{.index = gid, .font = 0};
             // We are using the Em unit to relate font design units and width pdf units
             // The unit in widths array is (Em/1000) (9.2.4 Glyph positioning and metrics)
-            auto gliyphAdvInEm = _font->advance(glyph);
+            auto gliyphAdvInEm = _font->advance(_font->glyph(cid));
             currGroupW.pushBack(gliyphAdvInEm * 1000);
 
             prevCid = cid;
@@ -139,31 +82,36 @@ struct TtfGlyphInfoAdapter {
     }
 
     Buf<Byte> CIDToGIDMap() {
-        Buf<Byte> buf;
-
-        u16 const BYTE_MASK = 255;
-
-        usize consecutiveUnmappedCIDs = 0;
-        for (usize i = 0; i < CODESPACE; ++i) {
-            auto glyph = codeMappings.tryGet(i);
+        // Runes past the last one drawn are mapped to 0 without being listed
+        usize len = _runes.len() ? (last(_runes) + 1) * 2 : 0;
+        Buf<Byte> buf = Buf<Byte>::init(len, 0);
+
+        for (auto cid : _runes) {
+            auto gid = gidFor(cid);
+            buf[cid * 2] = gid >> 8;
+            buf[cid * 2 + 1] = gid & 0xff;
+        }
 
-            if (not glyph) {
-                consecutiveUnmappedCIDs++;
-                continue;
-            }
+        return buf;
+    }
 
-            for (usize j = 0; j < consecutiveUnmappedCIDs; ++j) {
-                buf.insert(buf.len(), 0);
-                buf.insert(buf.len(), 0);
-            }
-            consecutiveUnmappedCIDs = 0;
+    Res<Buf<Byte>> fontFile() {
+        return _subset.write(_font->_parser);
+    }
 
-            auto gid = glyph.unwrap();
-            buf.insert(buf.len(), (gid >> 8) & BYTE_MASK);
-            buf.insert(buf.len(), gid & BYTE_MASK);
+    // 9.9.2 Font subsets, six uppercase letters, which only have to differ
+    // between subsets of the same font.
+    String tag() {
+        u32 h = 2166136261u;
+        for (auto gid : _subset.glyphs)
+            h = (h ^ gid) * 16777619u;
+
+        StringBuilder sb;
+        for (usize i = 0; i < 6; i++) {
+            sb.append((Rune)('A' + h % 26));
+            h /= 26;
         }
-
-        return buf;
+        return sb.take();
     }
 };
 
@@ -181,7 +129,7 @@ struct TrueTypeFontAdapter {
     Pdf::Ref fontDescriptorRef;
     Pdf::Ref fontRef;
 
-    TtfGlyphInfoAdapter ttfGlyphInfoAdapter;
+    Opt<TtfGlyphInfoAdapter> ttfGlyphInfoAdapter;
 
     Pdf::Name CIDFontName;
 
@@ -193,9 +141,6 @@ struct TrueTypeFontAdapter {
           fontFileRef(alloc.alloc()),
           fontDescriptorRef(alloc.alloc()),
           fontRef(alloc.alloc()),
-          ttfGlyphInfoAdapter{
-              TtfGlyphInfoAdapter::build(font)
-          },
           CIDFontName{
               font->_parser._name.string(font->_parser._name.lookupRecord(Ttf::Name::POSTSCRIPT)).str()
           } {
@@ -217,15 +162,15 @@ struct TrueTypeFontAdapter {
         return flag;
     }
 
-    Pdf::Stream fontFile() {
+    Res<Pdf::Stream> fontFile() {
         // 9.9 Embedded font programs
-        return Pdf::Stream{
-            .dict = Pdf::Dict{
-                {"Length"s, _font->_mmap.bytes().len()},
-                {"Length1"s, _font->_mmap.bytes().len()},
+        auto data = try$(ttfGlyphInfoAdapter->fontFile());
+        return Pdf::Stream::flate(
+            Pdf::Dict{
+                {"Length1"s, data.len()},
             },
-            .data = _font->_mmap.bytes(),
-        };
+            data
+        );
     }
 
     Pdf::Dict CIDSystemInfo() {
@@ -258,7 +203,7 @@ struct TrueTypeFontAdapter {
             {"Type"s, Pdf::Name{"FontDescriptor"s}},
             {"FontName"s, CIDFontName},
             {"Flags"s, fontDescriptorFlags()},
-            {"FontBBox"s, ttfGlyphInfoAdapter.fontBBox()},
+            {"FontBBox"s, ttfGlyphInfoAdapter->fontBBox()},
             {"FontFile2"s, fontFileRef},
             {"ItalicAngle"s, _font->_parser._post.italicAngle()},
             {"Ascent"s, metrics.ascend * 1000},
@@ -268,14 +213,8 @@ struct TrueTypeFontAdapter {
         };
     }
 
-    Pdf::Stream CIDToGIDMap() {
-        auto stream = ttfGlyphInfoAdapter.CIDToGIDMap();
-        return Pdf::Stream{
-            .dict = Pdf::Dict{
-                {"Length"s, stream.len()},
-            },
-            .data = std::move(stream)
-        };
+    Res<Pdf::Stream> CIDToGIDMap() {
+        return Pdf::Stream::flate({}, ttfGlyphInfoAdapter->CIDToGIDMap());
     }
 
     Pdf::Dict CIDFont() {
@@ -285,21 +224,26 @@ struct TrueTypeFontAdapter {
             {"Subtype"s, Pdf::Name{"CIDFontType2"s}},
             {"BaseFont"s, CIDFontName},
             {"CIDSystemInfo"s, CIDSystemInfoRef},
-            {"W"s, ttfGlyphInfoAdapter.widths()},
+            {"W"s, ttfGlyphInfoAdapter->widths()},
             {"FontDescriptor"s, fontDescriptorRef},
             {"CIDToGIDMap"s, CIDToGIDMapRef},
         };
     }
 
-    Pdf::Ref addToFile(Pdf::File& file) {
-        file.add(CIDToGIDMapRef, CIDToGIDMap());
-        file.add(CIDSystemInfoRef, CIDSystemInfo());
-        file.add(fontFileRef, fontFile());
-        file.add(CIDFontRef, CIDFont());
-        file.add(fontDescriptorRef, fontDescriptors());
+    // Embeds the glyphs for the runes in `usage`, which has to be complete
+    // by then, as the subset can't grow once it's written.
+    Res<Pdf::Ref> write(Pdf::Writer& writer, Pdf::FontUsage const& usage) {
+        ttfGlyphInfoAdapter = try$(TtfGlyphInfoAdapter::build(_font, usage));
+        CIDFontName = Pdf::Name{Io::format("{}+{}", ttfGlyphInfoAdapter->tag(), CIDFontName.str()).str()};
+
+        try$(writer.add(CIDToGIDMapRef, try$(CIDToGIDMap())));
+        try$(writer.add(CIDSystemInfoRef, CIDSystemInfo()));
+        try$(writer.add(fontFileRef, try$(fontFile())));
+        try$(writer.add(CIDFontRef, CIDFont()));
+        try$(writer.add(fontDescriptorRef, fontDescriptors()));
 
-        file.add(fontRef, font());
-        return fontRef;
+        try$(writer.add(fontRef, font()));
+        return Ok(fontRef);
     }
 };
 
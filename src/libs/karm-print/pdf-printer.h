@@ -8,19 +8,40 @@
 
 namespace Karm::Print {
 
-struct PdfPage {
-    PaperStock paper;
-    Io::StringWriter data;
-};
-
+// Writes each page out as soon as the next one begins, so only the page
+// being printed is held in memory, with its content stream compressed.
+// Fonts are written once every page is done, they are shared by all pages
+// and only embed the glyphs that were drawn.
 struct PdfPrinter : public FilePrinter {
-    Vec<PdfPage> _pages;
+    Pdf::Writer _writer;
+    Res<> _error = Ok();
+    bool _begun = false;
+    bool _ended = false;
+
+    Pdf::Ref _alloc;
+    Pdf::Ref _pagesRef = _alloc.alloc();
+    Pdf::Array _pagesKids;
+
+    Opt<PaperStock> _paper;
+    Opt<Io::StringWriter> _data;
     Opt<Pdf::Canvas> _canvas;
+
     Pdf::FontManager fontManager;
+    Map<usize, TrueTypeFontAdapter> _fonts;
+
+    PdfPrinter(Io::Writer& out)
+        : _writer(out) {}
 
     Gfx::Canvas& beginPage(PaperStock paper) override {
-        auto& page = _pages.emplaceBack(paper);
-        _canvas = Pdf::Canvas{page.data, paper.size(), &fontManager};
+        // NOTE: Like Io::Emit, a failure is kept until the end, the
+        //       canvas has to be handed out anyway.
+        auto flushed = _flushPage();
+        if (not flushed and _error)
+            _error = flushed.none();
+
+        _paper = paper;
+        _data.emplace();
+        _canvas = Pdf::Canvas{*_data, paper.size(), &fontManager};
 
         // NOTE: PDF has the coordinate system origin at the bottom left corner.
         //       But we want to have it at the top left corner.
@@ -31,116 +52,116 @@ struct PdfPrinter : public FilePrinter {
         return *_canvas;
     }
 
-    Pdf::File pdf() {
-        Pdf::Ref alloc;
+    Res<> _begin() {
+        if (_begun)
+            return Ok();
+        _begun = true;
+        return _writer.begin("PDF-2.0"s);
+    }
 
-        Pdf::File file;
-        file.header = "PDF-2.0"s;
+    Res<Pdf::Ref> _fontRef(usize id, Rc<Text::Fontface> fontFace) {
+        if (auto font = _fonts.access(id))
+            return Ok(font->fontRef);
 
-        Pdf::Array pagesKids;
-        Pdf::Ref pagesRef = alloc.alloc();
+        auto ttf = fontFace.cast<Text::TtfFontface>();
+        if (not ttf)
+            return Error::unsupported("only truetype fonts can be embedded");
 
-        // Fonts
-        Map<usize, Pdf::Ref> fontManagerId2FontObjRef;
-        for (auto& [_, value] : fontManager.mapping._els) {
-            auto& [id, fontFace] = value;
+        TrueTypeFontAdapter font{ttf.unwrap(), _alloc};
+        auto ref = font.fontRef;
+        _fonts.put(id, std::move(font));
+        return Ok(ref);
+    }
 
-            TrueTypeFontAdapter ttfAdapter{
-                fontFace.cast<Text::TtfFontface>().unwrap(),
-                alloc
-            };
+    Res<> _flushPage() {
+        if (not _paper)
+            return Ok();
+        auto paper = _paper.take();
 
-            auto fontRef = ttfAdapter.addToFile(file);
-            fontManagerId2FontObjRef.put(id, fontRef);
-        }
+        try$(_canvas->_e.flush());
+        _canvas = NONE;
+        try$(_begin());
 
-        // Page
-        for (auto& p : _pages) {
-            Pdf::Ref pageRef = alloc.alloc();
-            Pdf::Ref contentsRef = alloc.alloc();
+        Pdf::Ref pageRef = _alloc.alloc();
+        Pdf::Ref contentsRef = _alloc.alloc();
 
-            // FIXME: adding all fonts for now on each page; later, we will need to filter by page
-            Pdf::Dict pageFontsDict;
-            for (auto& [managerId, objRef] : fontManagerId2FontObjRef._els) {
-                auto formattedName = Io::format("F{}", managerId);
-                pageFontsDict.put(formattedName.str(), objRef);
-            }
+        Pdf::Dict pageFontsDict;
+        auto pageFonts = fontManager.takePageFonts();
+        for (auto& [id, fontFace] : pageFonts._els) {
+            auto formattedName = Io::format("F{}", id);
+            pageFontsDict.put(formattedName.str(), try$(_fontRef(id, fontFace)));
+        }
 
-            file.add(
-                pageRef,
-                Pdf::Dict{
-                    {"Type"s, Pdf::Name{"Page"s}},
-                    {"Parent"s, pagesRef},
-                    {"MediaBox"s,
-                     Pdf::Array{
-                         usize{0},
-                         usize{0},
-                         p.paper.width,
-                         p.paper.height,
-                     }},
-                    {
-                        "Contents"s,
-                        contentsRef,
-                    },
-                    {
-                        "Resources"s,
-                        Pdf::Dict{
-                            {"Font"s,
-                             pageFontsDict
-                            },
+        try$(_writer.add(
+            pageRef,
+            Pdf::Dict{
+                {"Type"s, Pdf::Name{"Page"s}},
+                {"Parent"s, _pagesRef},
+                {"MediaBox"s,
+                 Pdf::Array{
+                     usize{0},
+                     usize{0},
+                     paper.width,
+                     paper.height,
+                 }},
+                {
+                    "Contents"s,
+                    contentsRef,
+                },
+                {
+                    "Resources"s,
+                    Pdf::Dict{
+                        {"Font"s,
+                         pageFontsDict
                         },
-                    }
-                }
-            );
-
-            file.add(
-                contentsRef,
-                Pdf::Stream{
-                    .dict = Pdf::Dict{
-                        {"Length"s, p.data.bytes().len()},
                     },
-                    .data = p.data.bytes(),
                 }
-            );
+            }
+        ));
 
-            pagesKids.pushBack(pageRef);
-        }
+        try$(_writer.add(contentsRef, try$(Pdf::Stream::flate({}, _data->bytes()))));
+        _data = NONE;
+
+        _pagesKids.pushBack(pageRef);
+        return Ok();
+    }
+
+    Res<> finish() override {
+        if (_ended)
+            return Ok();
+        try$(_error);
+        try$(_flushPage());
+        try$(_begin());
+        _ended = true;
+
+        // Fonts
+        for (auto& [id, font] : _fonts._els)
+            try$(font.write(_writer, fontManager.usage.get(id)));
 
         // Pages
-        file.add(
-            pagesRef,
+        try$(_writer.add(
+            _pagesRef,
             Pdf::Dict{
                 {"Type"s, Pdf::Name{"Pages"s}},
-                {"Count"s, _pages.len()},
-                {"Kids"s, std::move(pagesKids)},
+                {"Count"s, _pagesKids.len()},
+                {"Kids"s, std::move(_pagesKids)},
             }
-        );
+        ));
 
         // Catalog
-        auto catalogRef = file.add(
-            alloc.alloc(),
+        auto catalogRef = _alloc.alloc();
+        try$(_writer.add(
+            catalogRef,
             Pdf::Dict{
                 {"Type"s, Pdf::Name{"Catalog"s}},
-                {"Pages"s, pagesRef},
+                {"Pages"s, _pagesRef},
             }
-        );
+        ));
 
         // Trailer
-        file.trailer = Pdf::Dict{
-            {"Size"s, file.body.len() + 1},
+        return _writer.end(Pdf::Dict{
             {"Root"s, catalogRef},
-        };
-
-        // Sorting object by their refs, so they are printed in order
-        sort(file.body._els, [](auto& a, auto& b) {
-            return a.v0.num <=> b.v0.num;
         });
-
-        return file;
-    }
-
-    Res<> write(Io::Writer& w) override {
-        return pdf().write(w);
     }
 };
 
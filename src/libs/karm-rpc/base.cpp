@@ -14,6 +14,22 @@ Endpoint::Endpoint(Sys::IpcConnection con)
     });
 }
 
+void Endpoint::attach(Port port, Sys::IpcConnection con) {
+    // NOTE: The task of a replaced peer stops at its next message, it
+    //       can't be woken up any sooner.
+    if (auto old = _peers.access(port))
+        (*old)->replaced = true;
+
+    auto peer = makeRc<_Peer>(std::move(con));
+    _peers.put(port, peer);
+    Async::detach(_peerTask(*this, peer, port), [this, port, peer](Res<> res) {
+        if (peer->replaced)
+            return;
+        logError("peer {} receiver task exited: {}", port, res);
+        _peers.del(port);
+    });
+}
+
 Endpoint Endpoint::create(Sys::Context& ctx) {
     auto& channel = useChannel(ctx);
     return {std::move(channel.con)};
@@ -2,11 +2,14 @@
 
 #include <karm-async/promise.h>
 #include <karm-async/queue.h>
+#include <karm-base/hash.h>
+#include <karm-base/hashmap.h>
 #include <karm-base/map.h>
 #include <karm-base/tuple.h>
 #include <karm-io/pack.h>
 #include <karm-logger/logger.h>
 
+#include "bulk.h"
 #include "hooks.h"
 
 namespace Karm::Rpc {
@@ -36,6 +39,17 @@ constexpr Port Port::INVALID{0};
 constexpr Port Port::BUS{Limits<u64>::MAX};
 constexpr Port Port::BROADCAST{Limits<u64>::MAX - 1};
 
+} // namespace Karm::Rpc
+
+template <>
+struct Karm::Hasher<Karm::Rpc::Port> {
+    static constexpr Hash hash(Karm::Rpc::Port const& port) {
+        return Karm::hash(port.value());
+    }
+};
+
+namespace Karm::Rpc {
+
 struct Header {
     u64 seq;
     Port from;
@@ -49,6 +63,32 @@ struct Header {
 
 static_assert(Meta::TrivialyCopyable<Header>);
 
+// Hands over a direct connection to another endpoint, messages for `port`
+// are then exchanged over `fd` instead of going through the bus.
+struct Peer {
+    Port port;
+    Rc<Sys::Fd> fd;
+};
+
+} // namespace Karm::Rpc
+
+template <>
+struct Karm::Io::Packer<Karm::Rpc::Peer> {
+    static Res<> pack(PackEmit& e, Karm::Rpc::Peer const& val) {
+        try$(Io::pack(e, val.port));
+        auto fd = val.fd;
+        return fd->pack(e);
+    }
+
+    static Res<Karm::Rpc::Peer> unpack(PackScan& s) {
+        auto port = try$(Io::unpack<Karm::Rpc::Port>(s));
+        auto fd = try$(Sys::Fd::unpack(s));
+        return Ok(Karm::Rpc::Peer{port, fd});
+    }
+};
+
+namespace Karm::Rpc {
+
 struct Message {
     static constexpr usize CAP = 4096;
 
@@ -86,6 +126,14 @@ struct Message {
         return sub(_hnds, 0, _hndsLen);
     }
 
+    Res<> _give(Slice<Sys::Handle> hnds) {
+        if (hnds.len() > _hnds.len())
+            return Error::invalidInput("too many handles");
+        copy(hnds, mutSub(_hnds, 0, hnds.len()));
+        _hndsLen = hnds.len();
+        return Ok();
+    }
+
     template <typename T>
     bool is() const {
         return _header.mid == Meta::idOf<T>();
@@ -108,6 +156,7 @@ struct Message {
         try$(Io::pack(reqPack, payload));
 
         msg._len = try$(Io::tell(reqBuf)) + sizeof(Header);
+        try$(msg._give(reqPack.handles()));
 
         return Ok(std::move(msg));
     }
@@ -130,6 +179,7 @@ struct Message {
         try$(Io::pack(respPack, payload));
 
         resp._len = try$(Io::tell(respBuf)) + sizeof(Header);
+        try$(resp._give(respPack.handles()));
 
         return Ok(std::move(resp));
     }
@@ -168,32 +218,161 @@ static inline Async::Task<Message> rpcRecvAsync(Sys::IpcConnection& con) {
 // MARK: Rpc -------------------------------------------------------------------
 
 struct Endpoint : Meta::Pinned {
+    // A direct connection to another endpoint, see attach().
+    struct _Peer {
+        Sys::IpcConnection con;
+        // Set once another connection took over the port, the task reading
+        // from this one then stops.
+        bool replaced = false;
+
+        _Peer(Sys::IpcConnection con)
+            : con(std::move(con)) {}
+    };
+
     Sys::IpcConnection _con;
+    HashMap<Port, Rc<_Peer>> _peers{};
     Map<u64, Async::_Promise<Message>> _pending{};
     Async::Queue<Message> _incoming{};
+    HashMap<Port, Bulk> _bulkOut{};
+    HashMap<Port, Bulk> _bulkIn{};
+    Map<Port, Async::Promise<>> _bulkWaiting{};
     u64 _seq = 1;
 
     Endpoint(Sys::IpcConnection con);
 
     static Endpoint create(Sys::Context& ctx);
 
+    void _handle(Message msg) {
+        auto header = msg._header;
+
+        if (msg.is<Peer>()) {
+            // NOTE: Only the bus hands out connections, anyone else could
+            //       use it to impersonate another port.
+            if (header.from != Port::BUS) {
+                logWarn("dropping peer from {}", header.from);
+                return;
+            }
+
+            auto peer = msg.unpack<Peer>();
+            if (not peer) {
+                logError("invalid peer: {}", peer.none());
+                return;
+            }
+            auto [port, fd] = peer.take();
+            attach(port, {fd, NONE});
+            return;
+        }
+
+        if (msg.is<BulkOpen>()) {
+            auto open = msg.unpack<BulkOpen>();
+            if (not open) {
+                logError("invalid bulk open: {}", open.none());
+                return;
+            }
+            auto bulk = Bulk::open(open.take().fd);
+            if (not bulk) {
+                logError("cannot open bulk ring from {}: {}", header.from, bulk.none());
+                return;
+            }
+            _bulkIn.put(header.from, bulk.take());
+            _wakeBulk(header.from);
+            return;
+        }
+
+        if (msg.is<BulkDoorbell>()) {
+            _wakeBulk(header.from);
+            return;
+        }
+
+        if (_pending.has(header.seq)) {
+            auto promise = _pending.take(header.seq);
+            promise.resolve(std::move(msg));
+        } else {
+            _incoming.enqueue(std::move(msg));
+        }
+    }
+
     static Async::Task<> _receiverTask(Endpoint& self) {
         while (true) {
             Message msg = co_trya$(rpcRecvAsync(self._con));
-            auto header = msg._header;
+            self._handle(std::move(msg));
+        }
+    }
+
+    static Async::Task<> _peerTask(Endpoint& self, Rc<_Peer> peer, Port port) {
+        while (true) {
+            Message msg = co_trya$(rpcRecvAsync(peer->con));
+            if (peer->replaced)
+                co_return Ok();
+            // NOTE: The bus is not there to stamp the sender, but the
+            //       connection can only come from the peer.
+            msg.header().from = port;
+            self._handle(std::move(msg));
+        }
+    }
+
+    // Talk directly to `port` over `con` from now on, bypassing the bus.
+    void attach(Port port, Sys::IpcConnection con);
 
-            if (self._pending.has(header.seq)) {
-                auto promise = self._pending.take(header.seq);
-                promise.resolve(std::move(msg));
-            } else {
-                self._incoming.enqueue(std::move(msg));
+    // MARK: Bulk --------------------------------------------------------------
+
+    void _wakeBulk(Port port) {
+        if (_bulkWaiting.has(port))
+            _bulkWaiting.take(port).resolve(Ok());
+    }
+
+    // Hand a new bulk ring over to `port`, records sent with `sendBulk()`
+    // then go through shared memory instead of the connection.
+    Res<> openBulk(Port port, usize cap) {
+        auto bulk = try$(Bulk::create(cap));
+        try$(send<BulkOpen>(port, bulk.fd()));
+        _bulkOut.put(port, std::move(bulk));
+        return Ok();
+    }
+
+    Res<> sendBulk(Port port, Bytes bytes) {
+        auto bulk = _bulkOut.access(port);
+        if (not bulk)
+            return Error::invalidInput("no bulk ring open");
+        if (try$(bulk->push(bytes)))
+            try$(send<BulkDoorbell>(port));
+        return Ok();
+    }
+
+    // Wait for the next record sent by `port` over its bulk ring, the bytes
+    // stay valid until `popBulk()`.
+    Async::Task<Bytes> peekBulkAsync(Port port) {
+        while (true) {
+            if (auto bulk = _bulkIn.access(port)) {
+                auto record = bulk->peek();
+                if (record or record.none() != Error::WOULD_BLOCK)
+                    co_return record;
             }
+
+            if (_bulkWaiting.has(port))
+                co_return Error::invalidInput("already waiting on this bulk ring");
+
+            Async::Promise<> promise;
+            auto future = promise.future();
+            _bulkWaiting.put(port, std::move(promise));
+            co_trya$(future);
         }
     }
 
+    void popBulk(Port port) {
+        if (auto bulk = _bulkIn.access(port))
+            bulk->pop();
+    }
+
+    Sys::IpcConnection& _route(Port port) {
+        if (auto peer = _peers.access(port))
+            return (*peer)->con;
+        return _con;
+    }
+
     template <typename T, typename... Args>
     Res<> send(Port port, Args&&... args) {
-        return rpcSend<T>(_con, port, _seq++, std::forward<Args>(args)...);
+        return rpcSend<T>(_route(port), port, _seq++, std::forward<Args>(args)...);
     }
 
     Async::Task<Message> recvAsync() {
@@ -203,9 +382,10 @@ struct Endpoint : Meta::Pinned {
     template <typename T>
     Res<> resp(Message& msg, Res<typename T::Response> message) {
         auto header = msg._header;
+        auto& con = _route(header.from);
         if (not message)
-            return rpcSend<Error>(_con, header.from, header.seq, message.none());
-        return rpcSend<typename T::Response>(_con, header.from, header.seq, message.take());
+            return rpcSend<Error>(con, header.from, header.seq, message.none());
+        return rpcSend<typename T::Response>(con, header.from, header.seq, message.take());
     }
 
     template <typename T, typename... Args>
@@ -215,7 +395,7 @@ struct Endpoint : Meta::Pinned {
         auto future = promise.future();
         _pending.put(seq, std::move(promise));
 
-        co_try$(rpcSend<T>(_con, port, seq, std::forward<Args>(args)...));
+        co_try$(rpcSend<T>(_route(port), port, seq, std::forward<Args>(args)...));
 
         Message msg = co_await future;
 
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <karm-base/atomic.h>
+#include <karm-io/pack.h>
+#include <karm-sys/shm.h>
+
+namespace Karm::Rpc {
+
+// MARK: Bulk ------------------------------------------------------------------
+
+// A single producer, single consumer ring of variable length records living
+// in shared memory. Payloads are written in place by the producer and read
+// in place by the consumer, only a doorbell goes through the ipc connection,
+// and only when the consumer is waiting for more data.
+//
+// Records are a u32 length followed by the payload, padded to 8 bytes, a
+// record that would straddle the end of the ring is preceded by a WRAP
+// marker and starts over at the beginning.
+struct Bulk {
+    static constexpr u32 MAGIC = 0x6b6c7562; // "bulk"
+    static constexpr u32 WRAP = Limits<u32>::MAX;
+    static constexpr usize ALIGN = 8;
+
+    struct Header {
+        u32 magic;
+        u32 _pad;
+        usize cap;
+
+        // Monotonic byte counters, `head` is only written by the producer
+        // and `tail` only by the consumer.
+        alignas(64) Atomic<usize> head;
+        alignas(64) Atomic<usize> tail;
+
+        // Set by the consumer before it goes to sleep waiting for a doorbell.
+        alignas(64) Atomic<u32> waiting;
+    };
+
+    Sys::Shm _shm;
+    // Capacity of the ring, as validated when it was mapped, the copy in
+    // the header can be changed by the other side at any time.
+    usize _cap;
+    usize _pending = 0;
+    usize _popping = 0;
+
+    // Create a new ring with room for `cap` bytes of records, this is the
+    // producer side.
+    static Res<Bulk> create(usize cap) {
+        cap = alignUp(cap, ALIGN);
+        auto shm = try$(Sys::Shm::create(sizeof(Header) + cap));
+
+        auto& header = *reinterpret_cast<Header*>(shm.mutBytes().buf());
+        header.magic = MAGIC;
+        header.cap = cap;
+        header.head.store(0);
+        header.tail.store(0);
+        header.waiting.store(0);
+
+        return Ok(Bulk{std::move(shm), cap});
+    }
+
+    // Map a ring created by the other side, this is the consumer side.
+    static Res<Bulk> open(Rc<Sys::Fd> fd) {
+        // NOTE: Mapping past the end of the memory faults on the first
+        //       access, and the size comes from the other side, so check it
+        //       against what is actually there. Fds that don't know their
+        //       size are bounds checked by the kernel when mapped.
+        auto stat = try$(fd->stat());
+        if (stat.size and stat.size < sizeof(Header))
+            return Error::invalidData("bulk ring too small");
+
+        usize cap = 0;
+        {
+            auto peek = try$(Sys::Shm::open(fd, sizeof(Header)));
+            auto const& header = *reinterpret_cast<Header const*>(peek.bytes().buf());
+            if (header.magic != MAGIC)
+                return Error::invalidData("invalid bulk ring");
+            cap = header.cap;
+        }
+
+        if (cap == 0 or cap % ALIGN or cap > Limits<u32>::MAX)
+            return Error::invalidData("invalid bulk ring capacity");
+
+        if (stat.size and stat.size < sizeof(Header) + cap)
+            return Error::invalidData("bulk ring capacity larger than its memory");
+
+        auto shm = try$(Sys::Shm::open(fd, sizeof(Header) + cap));
+        return Ok(Bulk{std::move(shm), cap});
+    }
+
+    Rc<Sys::Fd> fd() {
+        return _shm.fd();
+    }
+
+    Header& _header() {
+        return *reinterpret_cast<Header*>(_shm.mutBytes().buf());
+    }
+
+    Byte* _data() {
+        return _shm.mutBytes().buf() + sizeof(Header);
+    }
+
+    u32 _lenAt(usize off) {
+        u32 len;
+        memcpy(&len, _data() + off, sizeof(u32));
+        return len;
+    }
+
+    void _setLenAt(usize off, u32 len) {
+        memcpy(_data() + off, &len, sizeof(u32));
+    }
+
+    static usize _recordSize(usize len) {
+        return alignUp(sizeof(u32) + len, ALIGN);
+    }
+
+    usize cap() const {
+        return _cap;
+    }
+
+    // MARK: Producer ----------------------------------------------------------
+
+    // Reserve room for a record of `len` bytes, the returned bytes can be
+    // written directly and are published by `commit()`. Returns NONE if
+    // the ring doesn't have enough free space.
+    Opt<MutBytes> reserve(usize len) {
+        auto& h = _header();
+        usize size = _recordSize(len);
+        if (len >= WRAP or size > _cap)
+            return NONE;
+
+        usize head = h.head.load(RELAXED);
+        usize tail = h.tail.load(ACQUIRE);
+        usize off = head % _cap;
+        usize pad = off + size > _cap ? _cap - off : 0;
+
+        if (head + pad + size - tail > _cap)
+            return NONE;
+
+        if (pad) {
+            _setLenAt(off, WRAP);
+            off = 0;
+        }
+
+        _setLenAt(off, len);
+        _pending = head + pad + size;
+        return MutBytes{_data() + off + sizeof(u32), len};
+    }
+
+    // Publish the last reserved record, returns true if the consumer is
+    // waiting and needs to be woken up with a doorbell.
+    bool commit() {
+        auto& h = _header();
+        h.head.store(_pending, SEQ_CST);
+        return h.waiting.xchg(0, SEQ_CST);
+    }
+
+    // Copy a record into the ring, see `reserve()` and `commit()`.
+    Res<bool> push(Bytes bytes) {
+        auto dest = reserve(bytes.len());
+        if (not dest)
+            return Error::wouldBlock("bulk ring is full");
+        copy(bytes, *dest);
+        return Ok(commit());
+    }
+
+    // MARK: Consumer ----------------------------------------------------------
+
+    // Return the next record without consuming it, the bytes stay valid until
+    // `pop()`. If the ring is empty, the consumer is marked as waiting, and
+    // the next commit will ask for a doorbell.
+    //
+    // The producer is not trusted, a record that doesn't fit in what it
+    // published is reported as invalid data.
+    Res<Bytes> peek() {
+        auto& h = _header();
+        usize tail = h.tail.load(RELAXED);
+        usize head = h.head.load(ACQUIRE);
+
+        if (tail == head) {
+            h.waiting.store(1, SEQ_CST);
+            // NOTE: The producer might have committed between the
+            //       load and the store, check again.
+            head = h.head.load(SEQ_CST);
+            if (tail == head)
+                return Error::wouldBlock("bulk ring is empty");
+            h.waiting.store(0, RELAXED);
+        }
+
+        if (head - tail > _cap or tail % ALIGN)
+            return Error::invalidData("bulk ring counters out of bounds");
+
+        usize off = tail % _cap;
+        if (_lenAt(off) == WRAP) {
+            if (head - tail < _cap - off)
+                return Error::invalidData("bulk ring wraps past its head");
+            tail += _cap - off;
+            h.tail.store(tail, RELEASE);
+            off = 0;
+        }
+
+        u32 len = _lenAt(off);
+        usize size = _recordSize(len);
+        if (len == WRAP or off + size > _cap or size > head - tail)
+            return Error::invalidData("bulk record out of bounds");
+
+        _popping = size;
+        return Ok(Bytes{_data() + off + sizeof(u32), len});
+    }
+
+    // Consume the record returned by the last `peek()`.
+    void pop() {
+        auto& h = _header();
+        usize tail = h.tail.load(RELAXED);
+        h.tail.store(tail + _popping, RELEASE);
+        _popping = 0;
+    }
+};
+
+// MARK: Messages --------------------------------------------------------------
+
+// Sent by the producer to hand over a bulk ring to the consumer.
+struct BulkOpen {
+    Rc<Sys::Fd> fd;
+};
+
+// Sent by the producer when `Bulk::commit()` asks for it.
+struct BulkDoorbell {};
+
+} // namespace Karm::Rpc
+
+template <>
+struct Karm::Io::Packer<Karm::Rpc::BulkOpen> {
+    static Res<> pack(PackEmit& e, Karm::Rpc::BulkOpen const& val) {
+        auto fd = val.fd;
+        return fd->pack(e);
+    }
+
+    static Res<Karm::Rpc::BulkOpen> unpack(PackScan& s) {
+        return Ok(Karm::Rpc::BulkOpen{try$(Sys::Fd::unpack(s))});
+    }
+};
@@ -0,0 +1,132 @@
+#include <karm-rpc/base.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Rpc::Tests {
+
+test$("rpc-bulk-push-peek") {
+    auto producer = try$(Bulk::create(256));
+    auto consumer = try$(Bulk::open(producer.fd()));
+
+    expect$(not consumer.peek());
+    expect$(try$(producer.push(bytes("hello"s))));
+
+    auto record = try$(consumer.peek());
+    expectEq$((Str{(char const*)record.buf(), record.len()}), "hello"s);
+    consumer.pop();
+
+    expect$(not consumer.peek());
+
+    return Ok();
+}
+
+test$("rpc-bulk-doorbell") {
+    auto producer = try$(Bulk::create(256));
+    auto consumer = try$(Bulk::open(producer.fd()));
+
+    // Nobody is waiting yet, so no doorbell is needed.
+    expect$(not try$(producer.push(bytes("a"s))));
+    expect$(not try$(producer.push(bytes("b"s))));
+
+    expect$(consumer.peek());
+    consumer.pop();
+    expect$(consumer.peek());
+    consumer.pop();
+
+    // The consumer found the ring empty, the next push rings the doorbell.
+    expect$(not consumer.peek());
+    expect$(try$(producer.push(bytes("c"s))));
+    expect$(not try$(producer.push(bytes("d"s))));
+
+    return Ok();
+}
+
+test$("rpc-bulk-full") {
+    auto producer = try$(Bulk::create(64));
+    auto consumer = try$(Bulk::open(producer.fd()));
+
+    Array<u8, 28> payload{};
+    expect$(producer.push(payload));
+    expect$(producer.push(payload));
+    expect$(not producer.push(payload));
+
+    expect$(consumer.peek());
+    consumer.pop();
+    expect$(producer.push(payload));
+
+    return Ok();
+}
+
+test$("rpc-bulk-wrap") {
+    auto producer = try$(Bulk::create(64));
+    auto consumer = try$(Bulk::open(producer.fd()));
+
+    for (u8 i = 0; i < 32; i++) {
+        Array<u8, 20> payload{};
+        payload[0] = i;
+        try$(producer.push(payload));
+
+        auto record = try$(consumer.peek());
+        expectEq$(record.len(), 20uz);
+        expectEq$(record[0], i);
+        consumer.pop();
+    }
+
+    return Ok();
+}
+
+test$("rpc-bulk-invalid-cap") {
+    auto producer = try$(Bulk::create(64));
+
+    producer._header().cap = 1 << 20;
+    expect$(not Bulk::open(producer.fd()));
+
+    producer._header().cap = 60;
+    expect$(not Bulk::open(producer.fd()));
+
+    producer._header().cap = 64;
+    try$(Bulk::open(producer.fd()));
+
+    return Ok();
+}
+
+test$("rpc-bulk-invalid-record") {
+    auto producer = try$(Bulk::create(64));
+    auto consumer = try$(Bulk::open(producer.fd()));
+
+    try$(producer.push(bytes("hello"s)));
+    producer._setLenAt(0, 1000);
+    expectEq$(consumer.peek().none(), Error::INVALID_DATA);
+
+    // A length that fits in the ring, but not in what was published
+    producer._setLenAt(0, 20);
+    expectEq$(consumer.peek().none(), Error::INVALID_DATA);
+
+    producer._setLenAt(0, 5);
+    expect$(consumer.peek());
+
+    return Ok();
+}
+
+test$("rpc-bulk-message-roundtrip") {
+    auto producer = try$(Bulk::create(256));
+
+    // NOTE: Handles are only duplicated when crossing processes, here
+    //       both sides end up with the same fd.
+    auto open = try$(Message::packReq<BulkOpen>(Port{1}, 1, producer.fd()));
+    expect$(open.is<BulkOpen>());
+    auto consumer = try$(Bulk::open(try$(open.unpack<BulkOpen>()).fd));
+
+    expectEq$(consumer.peek().none(), Error::WOULD_BLOCK);
+    expect$(try$(producer.push(bytes("hello"s))));
+    auto doorbell = try$(Message::packReq<BulkDoorbell>(Port{1}, 2));
+    expect$(doorbell.is<BulkDoorbell>());
+
+    auto record = try$(consumer.peek());
+    expectEq$((Str{(char const*)record.buf(), record.len()}), "hello"s);
+    consumer.pop();
+    expectEq$(consumer.peek().none(), Error::WOULD_BLOCK);
+
+    return Ok();
+}
+
+} // namespace Karm::Rpc::Tests
@@ -41,8 +41,12 @@ Res<Rc<Sys::Fd>> createErr();
 
 Res<Vec<Sys::DirEntry>> readDir(Mime::Url const& url);
 
+Res<> createDir(Mime::Url const& url);
+
 Res<Stat> stat(Mime::Url const& url);
 
+Res<> renameFile(Mime::Url const& from, Mime::Url const& to);
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Intent intent);
@@ -67,6 +71,10 @@ Instant instant();
 
 Duration uptime();
 
+// MARK: Entropy ---------------------------------------------------------------
+
+Res<> fillRandom(MutBytes bytes);
+
 // MARK: Memory Managment ------------------------------------------------------
 
 Res<Sys::MmapResult> memMap(Sys::MmapOptions const& options);
@@ -77,6 +85,8 @@ Res<> memUnmap(void const* buf, usize len);
 
 Res<> memFlush(void* flush, usize len);
 
+Res<Rc<Sys::Fd>> createShm(usize size);
+
 // MARK: System Informations ---------------------------------------------------
 
 Res<> populate(Sys::SysInfo&);
@@ -1,12 +1,76 @@
+#include <karm-base/array.h>
+#include <karm-io/async.h>
 #include <karm-logger/logger.h>
 
 #include "_embed.h"
 #include "async.h"
+#include "time.h"
 
 namespace Karm::Sys {
 
+Async::Task<usize> Sched::sendFileAsync(Rc<Fd> out, Rc<Fd> in, usize off, usize len) {
+    // NOTE: This is the fallback for platforms that can't move data between
+    //       descriptors in the kernel, it goes through a buffer.
+    Array<Byte, 16 * 1024> buf;
+    co_try$(in->seek(Io::Seek::fromBegin(off)));
+    auto n = co_try$(in->read(mutSub(buf, 0, min(len, buf.len()))));
+    if (n == 0)
+        co_return Ok(0uz);
+
+    auto written = co_trya$(writeAsync(out, sub(buf, 0, n)));
+    if (written == 0)
+        co_return Error::writeZero("connection closed while sending file");
+    co_return Ok(written);
+}
+
 Sched& globalSched() {
     return _Embed::globalSched();
 }
 
+// MARK: Copy ------------------------------------------------------------------
+
+// Lets a pair of descriptors go through Io::copyAsync().
+struct _FdStream {
+    Rc<Fd> _fd;
+
+    Async::Task<usize> readAsync(MutBytes buf) {
+        return globalSched().readAsync(_fd, buf);
+    }
+
+    Async::Task<usize> writeAsync(Bytes buf) {
+        return globalSched().writeAsync(_fd, buf);
+    }
+};
+
+Async::Task<usize> copyAsync(Rc<Fd> from, Rc<Fd> to) {
+    // NOTE: Pipes and sockets can't seek, which is how they are told apart
+    //       from files without asking the platform. Files that claim to be
+    //       empty are read like streams too, it's how procfs and the like
+    //       look from here.
+    auto pos = from->seek(Io::Seek::fromCurrent(0));
+    auto stat = from->stat();
+    if (not pos or not stat or stat.unwrap().type != Type::FILE or stat.unwrap().size == 0) {
+        _FdStream reader{from}, writer{to};
+        co_return co_await Io::copyAsync(reader, writer);
+    }
+
+    // The size is only a hint, the file may grow while it's being copied,
+    // so this keeps going until the file ends. Chunks are bounded and the
+    // scheduler gets a turn between them, between two files the kernel
+    // never makes us wait, and a large copy would hold up every other task.
+    usize start = pos.unwrap();
+    usize sent = 0;
+    while (true) {
+        auto n = co_trya$(globalSched().sendFileAsync(to, from, start + sent, Io::COPY_MAX));
+        if (n == 0)
+            break;
+        sent += n;
+        co_trya$(globalSched().sleepAsync(instant()));
+    }
+
+    // Like a read() would, leave the file past what was copied
+    co_try$(from->seek(Io::Seek::fromBegin(start + sent)));
+    co_return Ok(sent);
+}
+
 } // namespace Karm::Sys
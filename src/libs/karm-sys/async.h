@@ -33,10 +33,19 @@ struct Sched :
     virtual Async::Task<_Received> recvAsync(Rc<Fd>, MutBytes, MutSlice<Handle>) = 0;
 
     virtual Async::Task<> sleepAsync(Instant until) = 0;
+
+    // Send up to `len` bytes of the file `in`, starting at `off`, to `out`.
+    // The file's own position is left alone where the platform allows it.
+    // Like writeAsync(), the count can be short, zero means the file ended.
+    virtual Async::Task<usize> sendFileAsync(Rc<Fd> out, Rc<Fd> in, usize off, usize len);
 };
 
 Sched& globalSched();
 
+// Copy what's left of `from` to `to`. A file is handed to the kernel with
+// sendFileAsync(), anything else goes through Io::copyAsync().
+Async::Task<usize> copyAsync(Rc<Fd> from, Rc<Fd> to);
+
 template <Async::Sender S>
 auto run(S s, Sched& sched = globalSched()) {
     return Async::run(std::move(s), [&] {
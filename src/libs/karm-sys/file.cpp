@@ -23,4 +23,9 @@ Res<File> File::openOrCreate(Mime::Url url) {
     return Ok(File{fd, url});
 }
 
+Res<> rename(Mime::Url const& from, Mime::Url const& to) {
+    try$(ensureUnrestricted());
+    return _Embed::renameFile(from, to);
+}
+
 } // namespace Karm::Sys
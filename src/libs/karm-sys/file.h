@@ -86,6 +86,10 @@ struct File :
     static Res<File> openOrCreate(Mime::Url url);
 };
 
+/// Move a file to `to`, replacing whatever was there in a single step
+/// where the system allows it.
+Res<> rename(Mime::Url const& from, Mime::Url const& to);
+
 /// Read the entire file as a UTF-8 string.
 static inline Res<String> readAllUtf8(Mime::Url const& url) {
     auto file = try$(Sys::File::open(url));
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+// Fill `bytes` from the system's cryptographically secure random source,
+// for when the values must not be guessed. Use Math::Rand otherwise.
+inline Res<> fillRandom(MutBytes bytes) {
+    return _Embed::fillRandom(bytes);
+}
+
+template <typename T>
+    requires Meta::TrivialyCopyable<T>
+inline Res<T> random() {
+    T value;
+    try$(fillRandom({reinterpret_cast<Byte*>(&value), sizeof(T)}));
+    return Ok(value);
+}
+
+} // namespace Karm::Sys
@@ -0,0 +1,17 @@
+#include "shm.h"
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+Res<Shm> Shm::create(usize size) {
+    auto fd = try$(_Embed::createShm(size));
+    return open(fd, size);
+}
+
+Res<Shm> Shm::open(Rc<Fd> fd, usize size) {
+    auto mmap = try$(Sys::mmap().read().size(size).mapMut(fd));
+    return Ok(Shm{fd, std::move(mmap)});
+}
+
+} // namespace Karm::Sys
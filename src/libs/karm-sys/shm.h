@@ -0,0 +1,34 @@
+#pragma once
+
+#include "mmap.h"
+
+namespace Karm::Sys {
+
+// A block of memory that can be mapped by several processes at once, it's
+// shared by sending its fd over an ipc connection.
+struct Shm {
+    Rc<Fd> _fd;
+    MutMmap _mmap;
+
+    static Res<Shm> create(usize size);
+
+    static Res<Shm> open(Rc<Fd> fd, usize size);
+
+    Rc<Fd> fd() {
+        return _fd;
+    }
+
+    usize size() const {
+        return _mmap._size;
+    }
+
+    Bytes bytes() const {
+        return _mmap.bytes();
+    }
+
+    MutBytes mutBytes() {
+        return _mmap.mutBytes();
+    }
+};
+
+} // namespace Karm::Sys
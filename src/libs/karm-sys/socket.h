@@ -57,6 +57,13 @@ struct Connection :
         return globalSched().flushAsync(_fd);
     }
 
+    // Send part of a file over the connection without copying it through
+    // user space, where the platform allows it. Like writeAsync(), the
+    // count can be short.
+    Async::Task<usize> sendFileAsync(Rc<Fd> file, usize off, usize len) {
+        return globalSched().sendFileAsync(_fd, file, off, len);
+    }
+
     Rc<Fd> fd() { return _fd; }
 };
 
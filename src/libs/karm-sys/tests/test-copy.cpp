@@ -0,0 +1,170 @@
+#include <karm-async/promise.h>
+#include <karm-io/funcs.h>
+#include <karm-logger/logger.h>
+#include <karm-sys/async.h>
+#include <karm-sys/file.h>
+#include <karm-sys/pipe.h>
+#include <karm-sys/time.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+static constexpr usize COPY_SIZE = 16 * 1024 * 1024;
+
+static Byte _pattern(usize off) {
+    return (Byte)(off * 7 + off / 4096);
+}
+
+static void _fill(MutBytes buf, usize off) {
+    for (usize i = 0; i < buf.len(); i++)
+        buf[i] = _pattern(off + i);
+}
+
+static bool _check(Bytes buf, usize off) {
+    for (usize i = 0; i < buf.len(); i++)
+        if (buf[i] != _pattern(off + i))
+            return false;
+    return true;
+}
+
+static void _report(Str what, usize size, Instant start) {
+    auto elapsed = Sys::instant() - start;
+    auto secs = max(elapsed.toUSecs(), 1uz) / 1e6;
+    logInfo("{}: {} MiB in {}, {} MiB/s", what, size / (1024 * 1024), elapsed, (usize)(size / secs / (1024 * 1024)));
+}
+
+// Write `size` bytes of the pattern, then close the pipe.
+static Async::Task<> _produceAsync(Rc<Fd> fd, usize size) {
+    Array<Byte, 64 * 1024> buf;
+    usize off = 0;
+    while (off < size) {
+        auto chunk = mutSub(buf, 0, size - off);
+        _fill(chunk, off);
+
+        Bytes rest = chunk;
+        while (rest.len()) {
+            auto n = co_trya$(globalSched().writeAsync(fd, rest));
+            rest = next(rest, n);
+        }
+        off += chunk.len();
+    }
+    co_return Ok();
+}
+
+// Read the pattern back until the pipe is closed.
+static Async::Task<usize> _consumeAsync(Rc<Fd> fd) {
+    Array<Byte, 64 * 1024> buf;
+    usize off = 0;
+    while (true) {
+        auto n = co_trya$(globalSched().readAsync(fd, mutBytes(buf)));
+        if (n == 0)
+            co_return Ok(off);
+        if (not _check(sub(buf, 0, n), off))
+            co_return Error::invalidData("copied data doesn't match");
+        off += n;
+    }
+}
+
+static Res<Tuple<Rc<Fd>, Rc<Fd>>> _pipe() {
+    auto pipe = try$(Pipe::create());
+    return Ok(Tuple<Rc<Fd>, Rc<Fd>>{pipe.in.fd(), pipe.out.fd()});
+}
+
+static Res<> _createFile(Mime::Url const& url, usize size) {
+    auto file = try$(File::create(url));
+    Buf<Byte> buf = Buf<Byte>::init(size);
+    _fill(mutBytes(buf), 0);
+    Io::BufReader reader{buf};
+    try$(Io::copy(reader, file));
+    return Ok();
+}
+
+testAsync$("copy-async-pipe") {
+#ifdef __ck_sys_darwin__
+    logInfo("Skipping test on macOS");
+    co_return Error::skipped();
+#endif
+
+    auto [srcIn, srcOut] = co_try$(_pipe());
+    auto [dstIn, dstOut] = co_try$(_pipe());
+
+    auto start = Sys::instant();
+    Async::detach(_produceAsync(std::move(srcIn), COPY_SIZE));
+
+    Async::Promise<usize> consumed;
+    Async::detach(_consumeAsync(std::move(dstOut)), [&](Res<usize> res) {
+        consumed.resolve(res);
+    });
+
+    // NOTE: The consumer only sees the end once the last reference to the
+    //       write side of its pipe is gone.
+    auto copied = co_trya$(copyAsync(std::move(srcOut), std::move(dstIn)));
+    co_expectEq$(copied, COPY_SIZE);
+    co_expectEq$(co_trya$(consumed.future()), COPY_SIZE);
+    _report("pipe to pipe", COPY_SIZE, start);
+
+    co_return Ok();
+}
+
+testAsync$("copy-async-file") {
+#ifdef __ck_sys_darwin__
+    logInfo("Skipping test on macOS");
+    co_return Error::skipped();
+#endif
+
+    auto srcUrl = "file:/tmp/karm-sys-copy-src"_url;
+    auto dstUrl = "file:/tmp/karm-sys-copy-dst"_url;
+
+    co_try$(_createFile(srcUrl, COPY_SIZE));
+    auto src = co_try$(File::open(srcUrl));
+    auto dst = co_try$(File::create(dstUrl));
+
+    // Part of the file was already read, only the rest is copied
+    Array<Byte, 100> head;
+    co_try$(src.read(mutBytes(head)));
+
+    auto start = Sys::instant();
+    auto copied = co_trya$(copyAsync(src.fd(), dst.fd()));
+    co_expectEq$(copied, COPY_SIZE - head.len());
+    co_expectEq$(co_try$(src.seek(Io::Seek::fromCurrent(0))), COPY_SIZE);
+    _report("file to file", copied, start);
+
+    auto out = co_try$(File::open(dstUrl));
+    co_expectEq$(co_try$(out.stat()).size, copied);
+
+    Buf<Byte> back = Buf<Byte>::init(copied);
+    co_expectEq$(co_try$(Io::copy(out, mutBytes(back))), copied);
+    co_expect$(_check(bytes(back), head.len()));
+
+    co_return Ok();
+}
+
+testAsync$("copy-async-file-to-pipe") {
+#ifdef __ck_sys_darwin__
+    logInfo("Skipping test on macOS");
+    co_return Error::skipped();
+#endif
+
+    auto srcUrl = "file:/tmp/karm-sys-copy-pipe-src"_url;
+    co_try$(_createFile(srcUrl, COPY_SIZE));
+
+    auto src = co_try$(File::open(srcUrl));
+    auto [dstIn, dstOut] = co_try$(_pipe());
+
+    // The consumer runs on the same scheduler, it only gets to drain the
+    // pipe if the copy doesn't block while the pipe is full.
+    Async::Promise<usize> consumed;
+    Async::detach(_consumeAsync(std::move(dstOut)), [&](Res<usize> res) {
+        consumed.resolve(res);
+    });
+
+    auto start = Sys::instant();
+    auto copied = co_trya$(copyAsync(src.fd(), std::move(dstIn)));
+    co_expectEq$(copied, COPY_SIZE);
+    co_expectEq$(co_trya$(consumed.future()), COPY_SIZE);
+    _report("file to pipe", COPY_SIZE, start);
+
+    co_return Ok();
+}
+
+} // namespace Karm::Sys::Tests
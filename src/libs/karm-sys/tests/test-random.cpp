@@ -0,0 +1,22 @@
+#include <karm-sys/random.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+test$("fill-random") {
+    // More than a single getentropy() call can hand out
+    Array<Byte, 1024> a = {};
+    Array<Byte, 1024> b = {};
+    try$(fillRandom(mutBytes(a)));
+    try$(fillRandom(mutBytes(b)));
+
+    usize zeros = 0;
+    for (auto v : sub(a, 768, 1024))
+        zeros += v == 0;
+    expect$(zeros < 32);
+    expect$(a != b);
+
+    return Ok();
+}
+
+} // namespace Karm::Sys::Tests
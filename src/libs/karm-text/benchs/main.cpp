@@ -0,0 +1,74 @@
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
+#include <karm-text/ttf/subset.h>
+
+// Subset a font the way the PDF printer does before embedding it, for a
+// line of text, a paragraph and all of printable ASCII, and report the
+// size and write time of each next to the whole font, which is what was
+// embedded before fonts were subset.
+//
+// Usage: karm-text.benchs [font.ttf]
+
+static constexpr usize ROUNDS = 256;
+
+static Vec<Rune> _runes(Str text) {
+    Vec<Rune> runes;
+    for (auto r : iterRunes(text))
+        if (not contains(runes, r))
+            runes.pushBack(r);
+    sort(runes);
+    return runes;
+}
+
+static Res<> _bench(Str name, Ttf::Parser& font, Bytes whole, Str text) {
+    auto runes = _runes(text);
+
+    usize size = 0;
+    usize glyphs = 0;
+    auto start = Sys::instant();
+    for (usize i = 0; i < ROUNDS; i++) {
+        auto subset = try$(Ttf::Subset::build(font, runes));
+        auto out = try$(subset.write(font));
+        size = out.len();
+        glyphs = subset.glyphs.len();
+    }
+    auto elapsed = Sys::instant() - start;
+
+    f64 usecs = elapsed.toUSecs() / (f64)ROUNDS;
+    Sys::println("{}: {} runes, {} glyphs, {} -> {} bytes ({}%), {}us", name, runes.len(), glyphs, whole.len(), size, size * 100.0 / whole.len(), usecs);
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context& ctx) {
+    auto& args = Sys::useArgs(ctx);
+    auto url = "bundle://fonts-inter/fonts/Inter-Regular.ttf"_url;
+    if (args.len())
+        url = co_try$(Mime::parseUrlOrPath(args[0]));
+
+    auto file = co_try$(Sys::File::open(url));
+    auto map = co_try$(Sys::mmap().map(file));
+    auto font = co_try$(Ttf::Parser::init(map.bytes()));
+
+    // Embedding the whole font meant copying it as it is
+    auto start = Sys::instant();
+    for (usize i = 0; i < ROUNDS; i++) {
+        Buf<Byte> copy;
+        copy.insert(COPY, 0, map.bytes().buf(), map.bytes().len());
+    }
+    auto elapsed = Sys::instant() - start;
+    Sys::println("whole: {} bytes, {}us", map.bytes().len(), elapsed.toUSecs() / (f64)ROUNDS);
+
+    co_try$(_bench("line"s, font, map.bytes(), "Hello, world!"s));
+    co_try$(_bench(
+        "paragraph"s, font, map.bytes(),
+        "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs, then 1234567890 more!"s
+    ));
+    co_try$(_bench(
+        "ascii"s, font, map.bytes(),
+        " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~"s
+    ));
+
+    co_return Ok();
+}
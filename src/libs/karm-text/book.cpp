@@ -1,5 +1,10 @@
+#include <karm-io/funcs.h>
+#include <karm-io/impls.h>
 #include <karm-logger/logger.h>
 #include <karm-pkg/bundle.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
 #include <karm-sys/time.h>
 
 #include "book.h"
@@ -7,13 +12,133 @@
 
 namespace Karm::Text {
 
+// MARK: Font Index ------------------------------------------------------------
+
+// The index remembers the attributes and the coverage of every installed
+// font, keyed by url, size and modification time, so that later starts
+// don't have to open and parse each font file.
+
+static constexpr u32 INDEX_MAGIC = 0x78646e69; // "indx"
+static constexpr u32 INDEX_VERSION = 1;
+
+static Mime::Url _indexUrl() {
+    return "location://cache/fonts.index"_url;
+}
+
+Res<Vec<_IndexEntry>> _readIndex(Mime::Url const& url) {
+    auto file = try$(Sys::File::open(url));
+    auto map = try$(Sys::mmap().map(file));
+    Io::BScan s{map.bytes()};
+
+    if (s.rem() < 12 or
+        s.nextU32le() != INDEX_MAGIC or
+        s.nextU32le() != INDEX_VERSION)
+        return Error::invalidData("invalid font index");
+
+    u32 count = s.nextU32le();
+    Vec<_IndexEntry> entries;
+    for (u32 i = 0; i < count; i++) {
+        if (s.rem() < 4)
+            return Error::invalidData("truncated font index");
+        String url = s.nextStr(s.nextU32le());
+
+        if (s.rem() < 20)
+            return Error::invalidData("truncated font index");
+        usize size = s.nextU64le();
+        u64 mtime = s.nextU64le();
+        String family = s.nextStr(s.nextU32le());
+
+        if (s.rem() < 6 + sizeof(FontCoverage::bits))
+            return Error::invalidData("truncated font index");
+
+        FontAttrs attrs;
+        attrs.family = family;
+        attrs.weight = FontWeight{s.nextU16le()};
+        attrs.stretch = FontStretch{s.nextU16le()};
+        attrs.style = static_cast<FontStyle>(s.nextU8le());
+        attrs.monospace = static_cast<Monospace>(s.nextU8le());
+
+        FontCoverage coverage;
+        s.readTo(&coverage.bits);
+
+        entries.pushBack({url, size, mtime, attrs, coverage});
+    }
+
+    return Ok(entries);
+}
+
+Res<> _writeIndex(Mime::Url const& url, Vec<_IndexEntry> const& entries) {
+    Io::BufferWriter buf;
+    Io::BEmit e{buf};
+
+    e.writeU32le(INDEX_MAGIC);
+    e.writeU32le(INDEX_VERSION);
+    e.writeU32le(entries.len());
+
+    for (auto const& entry : entries) {
+        e.writeU32le(entry.url.len());
+        e.writeStr(entry.url);
+        e.writeU64le(entry.size);
+        e.writeU64le(entry.mtime);
+        e.writeU32le(entry.attrs.family.len());
+        e.writeStr(entry.attrs.family);
+        e.writeU16le(entry.attrs.weight.value());
+        e.writeU16le(entry.attrs.stretch.value());
+        e.writeU8le(toUnderlyingType(entry.attrs.style));
+        e.writeU8le(toUnderlyingType(entry.attrs.monospace));
+        e.writeBytes({entry.coverage.bits.buf(), entry.coverage.bits.len()});
+    }
+
+    // NOTE: The index is written aside and moved over the old one once
+    //       complete, so it's never seen half written.
+    try$(Sys::Dir::openOrCreate(url.parent(1)));
+    auto tmpUrl = url.parent(1) / Io::format("{}.tmp", url.basename());
+    {
+        auto file = try$(Sys::File::create(tmpUrl));
+        try$(Io::writeAll(file, buf.bytes()));
+        try$(file.flush());
+    }
+    return Sys::rename(tmpUrl, url);
+}
+
+static Res<_IndexEntry> _indexFont(Mime::Url const& url, Sys::Stat stat) {
+    auto face = try$(loadFontface(url));
+
+    return Ok(_IndexEntry{
+        .url = url.str(),
+        .size = stat.size,
+        .mtime = stat.modifyTime.val(),
+        .attrs = face->attrs(),
+        .coverage = face->coverage(),
+    });
+}
+
 // MARK: Font loading ----------------------------------------------------------
 
+Rc<Fontface> FontInfo::load() const {
+    if (face)
+        return *face;
+
+    auto maybeFace = loadFontface(url);
+    if (not maybeFace) {
+        logWarn("could not load font {}: {}", url, maybeFace.none());
+        face = Fontface::fallback();
+    } else {
+        face = maybeFace.take();
+    }
+
+    return *face;
+}
+
 Res<> FontBook::loadAll() {
     auto start = Sys::now();
 
+    auto indexUrl = _indexUrl();
+    auto index = _readIndex(indexUrl).unwrapOrDefault({});
+    Vec<_IndexEntry> fresh;
+    usize parsed = 0;
+
     auto bundles = try$(Pkg::installedBundles());
-    usize count = 0;
     for (auto& bundle : bundles) {
         auto maybeDir = Sys::Dir::open(bundle.url() / "fonts");
         if (not maybeDir)
@@ -26,32 +151,57 @@ Res<> FontBook::loadAll() {
                 continue;
 
             auto fontUrl = dir.path() / diren.name;
-
-            auto maybeFace = loadFontface(fontUrl);
-            if (not maybeFace)
+            auto maybeStat = Sys::stat(fontUrl);
+            if (not maybeStat)
                 continue;
+            auto stat = maybeStat.take();
+
+            auto url = fontUrl.str();
+            Opt<_IndexEntry> entry;
+            for (auto& e : index) {
+                if (e.url == url and
+                    e.size == stat.size and
+                    e.mtime == stat.modifyTime.val()) {
+                    entry = e;
+                    break;
+                }
+            }
 
-            auto face = maybeFace.take();
+            if (not entry) {
+                auto maybeEntry = _indexFont(fontUrl, stat);
+                if (not maybeEntry)
+                    continue;
+                entry = maybeEntry.take();
+                parsed++;
+            }
 
             add({
                 .url = fontUrl,
-                .attrs = face->attrs(),
-                .face = face,
+                .attrs = entry->attrs,
+                .coverage = entry->coverage,
             });
-            count++;
+            fresh.pushBack(entry.take());
         }
     }
 
+    // NOTE: Rewrite the index if a font was added, changed or removed.
+    if (parsed or fresh.len() != index.len()) {
+        auto res = _writeIndex(indexUrl, fresh);
+        if (not res)
+            logWarn("could not write font index: {}", res.none());
+    }
+
     auto ibmVga = Fontface::fallback();
 
     add({
         .url = ""_url,
         .attrs = ibmVga->attrs(),
+        .coverage = ibmVga->coverage(),
         .face = ibmVga,
     });
 
     auto elapsed = Sys::now() - start;
-    logDebug("Loaded {} fonts in {}", count, elapsed);
+    logDebug("Loaded {} fonts ({} parsed) in {}", fresh.len(), parsed, elapsed);
 
     return Ok();
 }
@@ -224,22 +374,24 @@ Opt<Rc<Fontface>> FontBook::queryExact(FontQuery query) const {
             attrs.weight == query.weight and
             attrs.stretch == query.stretch and
             attrs.style == query.style)
-            return info.face;
+            return info.load();
     }
 
     return NONE;
 }
 
-Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
-    Str desiredfamily = _resolveFamily(query.family);
-
-    Opt<Rc<Fontface>> matchingFace;
+// Run the matching algorithm over the fonts `accept` lets through.
+static FontInfo const* _queryClosest(Slice<FontInfo> faces, Str desiredfamily, FontQuery query, auto accept) {
+    FontInfo const* matchingInfo = nullptr;
     auto matchingFamily = ""s;
     auto matchingStretch = FontStretch::NO_MATCH;
     auto matchingStyle = FontStyle::NO_MATCH;
     auto matchingWeight = FontWeight::NO_MATCH;
 
-    for (auto& info : _faces) {
+    for (auto& info : faces) {
+        if (not accept(info))
+            continue;
+
         auto const& attrs = info.attrs;
 
         auto currFamily = matchingFamily;
@@ -278,25 +430,56 @@ Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
         if (attrs.weight != currWeight)
             continue;
 
-        matchingFace = info.face;
+        matchingInfo = &info;
         matchingFamily = currFamily;
         matchingStretch = currStretch;
         matchingStyle = currStyle;
         matchingWeight = currWeight;
     }
 
-    return matchingFace;
+    return matchingInfo;
+}
+
+Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
+    auto* info = _queryClosest(_faces, _resolveFamily(query.family), query, [](FontInfo const&) {
+        return true;
+    });
+
+    // NOTE: Only the best match gets parsed.
+    if (not info)
+        return NONE;
+    return info->load();
+}
+
+Opt<Rc<Fontface>> FontBook::queryCovering(Rune rune, FontQuery query) const {
+    auto* info = _queryClosest(_faces, _resolveFamily(query.family), query, [&](FontInfo const& info) {
+        return info.coverage.covers(rune);
+    });
+
+    if (info)
+        return info->load();
+
+    // NOTE: Any font having the glyph beats none at all.
+    for (auto& info : _faces)
+        if (info.coverage.covers(rune))
+            return info.load();
+
+    return NONE;
 }
 
 Vec<Rc<Fontface>> FontBook::queryFamily(String family) const {
-    Vec<Rc<Fontface>> res;
+    Vec<FontInfo const*> infos;
     for (auto& info : _faces)
         if (commonFamily(info.attrs.family, family) == family)
-            res.pushBack(info.face);
+            infos.pushBack(&info);
 
-    sort(res, [](auto& lhs, auto& rhs) {
-        return lhs->attrs() <=> rhs->attrs();
+    sort(infos, [](auto* lhs, auto* rhs) {
+        return lhs->attrs <=> rhs->attrs;
     });
+
+    Vec<Rc<Fontface>> res;
+    for (auto* info : infos)
+        res.pushBack(info->load());
     return res;
 }
 
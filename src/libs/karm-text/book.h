@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/array.h>
 #include <karm-base/set.h>
 #include <karm-mime/url.h>
 #include <karm-sys/mmap.h>
@@ -26,11 +27,32 @@ struct FontQuery {
 struct FontInfo {
     Mime::Url url;
     FontAttrs attrs;
-    Rc<Fontface> face;
+    FontCoverage coverage = {};
+
+    // NOTE: Fontfaces are parsed on first use, see `load()`.
+    mutable Opt<Rc<Fontface>> face = NONE;
+
+    Rc<Fontface> load() const;
 };
 
 Str commonFamily(Str lhs, Str rhs);
 
+// MARK: Font Index ------------------------------------------------------------
+
+struct _IndexEntry {
+    String url;
+    usize size;
+    u64 mtime;
+    FontAttrs attrs;
+    FontCoverage coverage;
+};
+
+Res<Vec<_IndexEntry>> _readIndex(Mime::Url const& url);
+
+Res<> _writeIndex(Mime::Url const& url, Vec<_IndexEntry> const& entries);
+
+// MARK: Font Book -------------------------------------------------------------
+
 struct FontBook {
     Vec<FontInfo> _faces;
     Array<String, toUnderlyingType(GenericFamily::_LEN)> _genericFamily;
@@ -41,6 +63,9 @@ struct FontBook {
 
     Rc<Fontface> load(Mime::Url url, Opt<FontAttrs> attrs = NONE);
 
+    // Register every font installed in a bundle. Attributes are read from
+    // the font index when it is up to date, so the fonts themselves are
+    // only parsed when they are first queried.
     Res<> loadAll();
 
     Vec<String> families() const;
@@ -51,6 +76,11 @@ struct FontBook {
 
     Opt<Rc<Fontface>> queryClosest(FontQuery query) const;
 
+    // The closest match among the fonts having glyphs for `rune`, to fall
+    // back on when the font at hand doesn't. Only the coverage recorded in
+    // the index is looked at, no font gets parsed but the one returned.
+    Opt<Rc<Fontface>> queryCovering(Rune rune, FontQuery query) const;
+
     Vec<Rc<Fontface>> queryFamily(String family) const;
 };
 
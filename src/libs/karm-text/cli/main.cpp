@@ -1,6 +1,7 @@
 #include <karm-sys/entry.h>
 #include <karm-sys/file.h>
 #include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
 #include <karm-text/book.h>
 #include <karm-text/loader.h>
 #include <karm-text/ttf.h>
@@ -53,6 +54,64 @@ static void _dumpName(Ttf::Name const& name) {
     }
 }
 
+// A sample of runes from many scripts, similar to what a multilingual
+// document would ask for on its first paint.
+static Vec<Rune> _mixedScriptRunes() {
+    Array<Pair<Rune>, 10> ranges = {
+        Pair<Rune>{0x0020, 0x007E}, // Latin
+        Pair<Rune>{0x0391, 0x03C9}, // Greek
+        Pair<Rune>{0x0410, 0x044F}, // Cyrillic
+        Pair<Rune>{0x05D0, 0x05EA}, // Hebrew
+        Pair<Rune>{0x0621, 0x064A}, // Arabic
+        Pair<Rune>{0x0905, 0x0939}, // Devanagari
+        Pair<Rune>{0x0E01, 0x0E2E}, // Thai
+        Pair<Rune>{0x4E00, 0x4FFF}, // CJK
+        Pair<Rune>{0xAC00, 0xADFF}, // Hangul
+        Pair<Rune>{0x1F600, 0x1F64F}, // Emoji
+    };
+
+    Vec<Rune> runes;
+    for (auto [start, end] : ranges)
+        for (Rune r = start; r <= end; r++)
+            runes.pushBack(r);
+    return runes;
+}
+
+static Res<> _benchCmap(Mime::Url const& url) {
+    static constexpr usize ROUNDS = 100;
+
+    auto runes = _mixedScriptRunes();
+    auto file = try$(Sys::File::open(url));
+    auto map = try$(Sys::mmap().map(file));
+    auto ttf = try$(Ttf::Parser::init(map.bytes()));
+
+    auto start = Sys::instant();
+    usize found = 0;
+    for (auto r : runes)
+        if (ttf.tryGlyph(r))
+            found++;
+    auto cmap = Sys::instant() - start;
+
+    // First paint: a fresh fontface resolving every rune once.
+    start = Sys::instant();
+    auto font = try$(Text::loadFontface(url));
+    for (auto r : runes)
+        font->glyph(r);
+    auto cold = Sys::instant() - start;
+
+    start = Sys::instant();
+    for (usize i = 0; i < ROUNDS; i++)
+        for (auto r : runes)
+            font->glyph(r);
+    auto warm = Sys::instant() - start;
+
+    Sys::println("runes: {} ({} mapped)", runes.len(), found);
+    Sys::println("cmap lookups: {}", cmap);
+    Sys::println("first paint: {}", cold);
+    Sys::println("cached lookups: {} ({} rounds)", warm, ROUNDS);
+    return Ok();
+}
+
 Async::Task<> entryPointAsync(Sys::Context& ctx) {
     auto& args = useArgs(ctx);
 
@@ -88,8 +147,15 @@ Async::Task<> entryPointAsync(Sys::Context& ctx) {
 
         Sys::println("{}", font->attrs());
         co_return Ok();
+    } else if (verb == "bench-cmap") {
+        if (args.len() != 2)
+            co_return Error::invalidInput("Usage: karm-text.cli bench-cmap <url>");
+
+        auto url = co_try$(Mime::parseUrlOrPath(args[1]));
+        co_try$(_benchCmap(url));
+        co_return Ok();
     } else {
-        Sys::errln("unknown verb: {} (expected: dump-ttf, dump-db, dump-attr)", verb);
+        Sys::errln("unknown verb: {} (expected: dump-ttf, dump-db, dump-attr, bench-cmap)", verb);
         co_return Error::invalidInput();
     }
 }
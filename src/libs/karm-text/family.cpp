@@ -128,4 +128,14 @@ void FontFamily::contour(Gfx::Canvas& g, Glyph glyph) const {
     g.scale(_adjust.sizeAdjust * member.adjust.sizeAdjust);
     member.face->contour(g, glyph);
 }
+
+FontCoverage FontFamily::coverage() const {
+    // NOTE: Coverage only goes down to pages, the ranges of the members
+    //       are too fine grained to be worth taking into account.
+    FontCoverage coverage;
+    for (auto& member : _members)
+        coverage.add(member.face->coverage());
+    return coverage;
+}
+
 } // namespace Karm::Text
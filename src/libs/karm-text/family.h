@@ -60,6 +60,8 @@ struct FontFamily : public Fontface {
     f64 kern(Glyph prev, Glyph curr) override;
 
     void contour(Gfx::Canvas& g, Glyph glyph) const override;
+
+    FontCoverage coverage() const override;
 };
 
 } // namespace Karm::Text
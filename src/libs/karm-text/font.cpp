@@ -1,3 +1,4 @@
+#include <karm-base/atomic.h>
 #include <karm-gfx/canvas.h>
 #include <karm-logger/logger.h>
 
@@ -10,6 +11,11 @@ Rc<Fontface> Fontface::fallback() {
     return makeRc<VgaFontface>();
 }
 
+usize Fontface::_nextId() {
+    static Atomic<usize> next{1};
+    return next.fetchInc();
+}
+
 Font Font::fallback() {
     return {
         .fontface = Fontface::fallback(),
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/array.h>
 #include <karm-gfx/canvas.h>
 #include <karm-math/rect.h>
 
@@ -52,11 +53,47 @@ struct FontMeasure {
     Math::Vec2f baseline;
 };
 
+// Which pages of 256 runes a font has glyphs for, one bit per page.
+struct FontCoverage {
+    static constexpr usize PAGE_SIZE = 256;
+    static constexpr usize PAGES = 0x110000 / PAGE_SIZE;
+
+    Array<u8, PAGES / 8> bits{};
+
+    void add(Rune start, Rune end) {
+        end = min(end, (Rune)(PAGES * PAGE_SIZE - 1));
+        for (usize page = start / PAGE_SIZE; page <= end / PAGE_SIZE; page++)
+            bits[page / 8] |= 1 << (page % 8);
+    }
+
+    void add(FontCoverage const& other) {
+        for (usize i = 0; i < bits.len(); i++)
+            bits[i] |= other.bits[i];
+    }
+
+    bool covers(Rune rune) const {
+        usize page = rune / PAGE_SIZE;
+        if (page >= PAGES)
+            return false;
+        return bits[page / 8] & (1 << (page % 8));
+    }
+};
+
 struct Fontface {
     static Rc<Fontface> fallback();
 
+    static usize _nextId();
+
+    // Tells fontfaces apart for as long as the app runs, unlike their
+    // addresses, ids are never handed out twice.
+    usize _id = _nextId();
+
     virtual ~Fontface() = default;
 
+    usize id() const {
+        return _id;
+    }
+
     virtual FontMetrics metrics() const = 0;
 
     virtual FontAttrs attrs() const = 0;
@@ -68,6 +105,8 @@ struct Fontface {
     virtual f64 kern(Glyph prev, Glyph curr) = 0;
 
     virtual void contour(Gfx::Canvas& g, Glyph glyph) const = 0;
+
+    virtual FontCoverage coverage() const = 0;
 };
 
 struct Font {
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <karm-base/buf.h>
+#include <karm-base/vec.h>
+
+// A tiny TrueType font built from scratch, small enough for tests to know
+// every byte of it.
+//
+//  Glyph  Runes               Outline
+//  0                          .notdef, a square
+//  1      'A' 'a'             a triangle
+//  2      'B' 'b' U+1F600     a square
+//  3                          a dot, only drawn as part of 4
+//  4      'C'                 composite of 1 and 3
+//  5      'D'                 a triangle
+//
+// The cmap has a format 4 subtable for the BMP, with 'E' in a segment but
+// mapped to no glyph, and a format 12 one for every rune.
+
+namespace Ttf::Tests {
+
+static constexpr usize FIXTURE_GLYPHS = 6;
+
+inline void _fixtureU16(Buf<Byte>& buf, u16 v) {
+    buf.insert(buf.len(), v >> 8);
+    buf.insert(buf.len(), v);
+}
+
+inline void _fixtureU32(Buf<Byte>& buf, u32 v) {
+    _fixtureU16(buf, v >> 16);
+    _fixtureU16(buf, v);
+}
+
+// A single contour, all points on the curve.
+inline Buf<Byte> _fixtureSimple(Slice<Array<i16, 2>> points) {
+    i16 xMin = Limits<i16>::MAX, yMin = Limits<i16>::MAX;
+    i16 xMax = Limits<i16>::MIN, yMax = Limits<i16>::MIN;
+    for (auto& point : points) {
+        xMin = min(xMin, point[0]);
+        yMin = min(yMin, point[1]);
+        xMax = max(xMax, point[0]);
+        yMax = max(yMax, point[1]);
+    }
+
+    Buf<Byte> glyph;
+    _fixtureU16(glyph, 1);
+    for (auto v : {xMin, yMin, xMax, yMax})
+        _fixtureU16(glyph, v);
+    _fixtureU16(glyph, points.len() - 1);
+    _fixtureU16(glyph, 0);
+
+    for (usize i = 0; i < points.len(); i++)
+        glyph.insert(glyph.len(), 0x01);
+
+    for (usize axis = 0; axis < 2; axis++) {
+        i16 prev = 0;
+        for (auto& point : points) {
+            _fixtureU16(glyph, point[axis] - prev);
+            prev = point[axis];
+        }
+    }
+
+    if (glyph.len() % 2)
+        glyph.insert(glyph.len(), 0);
+    return glyph;
+}
+
+// 'C', the triangle with the dot scaled down over it.
+inline Buf<Byte> _fixtureComposite() {
+    Buf<Byte> glyph;
+    _fixtureU16(glyph, -1);
+    for (i16 v : {0, 0, 600, 700})
+        _fixtureU16(glyph, v);
+
+    // MORE_COMPONENTS | ARGS_ARE_XY_VALUES | ARG_1_AND_2_ARE_WORDS
+    _fixtureU16(glyph, 0x0023);
+    _fixtureU16(glyph, 1);
+    _fixtureU16(glyph, 0);
+    _fixtureU16(glyph, 0);
+
+    // ARGS_ARE_XY_VALUES | WE_HAVE_A_SCALE
+    _fixtureU16(glyph, 0x000A);
+    _fixtureU16(glyph, 3);
+    glyph.insert(glyph.len(), 100);
+    glyph.insert(glyph.len(), 50);
+    _fixtureU16(glyph, 0x2000);
+
+    return glyph;
+}
+
+inline Buf<Byte> _fixtureCmap() {
+    Buf<Byte> cmap;
+    _fixtureU16(cmap, 0);
+    _fixtureU16(cmap, 2);
+
+    _fixtureU16(cmap, 3);
+    _fixtureU16(cmap, 1);
+    _fixtureU32(cmap, 20);
+
+    _fixtureU16(cmap, 3);
+    _fixtureU16(cmap, 10);
+    _fixtureU32(cmap, 20 + 50);
+
+    // Format 4, 'A' to 'E' through the glyph id array, 'a' and 'b' by
+    // delta, and the closing segment
+    _fixtureU16(cmap, 4);
+    _fixtureU16(cmap, 50);
+    _fixtureU16(cmap, 0);
+    _fixtureU16(cmap, 6);
+    _fixtureU16(cmap, 4);
+    _fixtureU16(cmap, 1);
+    _fixtureU16(cmap, 2);
+    for (auto v : Array<u16, 3>{'E', 'b', 0xFFFF})
+        _fixtureU16(cmap, v);
+    _fixtureU16(cmap, 0);
+    for (auto v : Array<u16, 3>{'A', 'a', 0xFFFF})
+        _fixtureU16(cmap, v);
+    for (auto v : Array<u16, 3>{0, (u16)(1 - 'a'), 1})
+        _fixtureU16(cmap, v);
+    for (auto v : Array<u16, 3>{6, 0, 0})
+        _fixtureU16(cmap, v);
+    for (auto v : Array<u16, 5>{1, 2, 4, 5, 0})
+        _fixtureU16(cmap, v);
+
+    // Format 12
+    Array<Array<u32, 3>, 5> groups = {
+        Array<u32, 3>{'A', 'B', 1},
+        Array<u32, 3>{'C', 'C', 4},
+        Array<u32, 3>{'D', 'D', 5},
+        Array<u32, 3>{'a', 'b', 1},
+        Array<u32, 3>{0x1F600, 0x1F600, 2},
+    };
+    _fixtureU16(cmap, 12);
+    _fixtureU16(cmap, 0);
+    _fixtureU32(cmap, 16 + groups.len() * 12);
+    _fixtureU32(cmap, 0);
+    _fixtureU32(cmap, groups.len());
+    for (auto& group : groups)
+        for (auto v : group)
+            _fixtureU32(cmap, v);
+
+    return cmap;
+}
+
+inline Buf<Byte> fixtureFont() {
+    Array<Buf<Byte>, FIXTURE_GLYPHS> glyphs = {
+        _fixtureSimple(Array<Array<i16, 2>, 4>{{{50, 0}, {50, 700}, {550, 700}, {550, 0}}}),
+        _fixtureSimple(Array<Array<i16, 2>, 3>{{{0, 0}, {300, 700}, {600, 0}}}),
+        _fixtureSimple(Array<Array<i16, 2>, 4>{{{100, 0}, {100, 700}, {500, 700}, {500, 0}}}),
+        _fixtureSimple(Array<Array<i16, 2>, 4>{{{0, 0}, {0, 100}, {100, 100}, {100, 0}}}),
+        _fixtureComposite(),
+        _fixtureSimple(Array<Array<i16, 2>, 3>{{{0, 700}, {300, 0}, {600, 700}}}),
+    };
+
+    // Short offsets, glyphs are all of an even length
+    Buf<Byte> glyf;
+    Buf<Byte> loca;
+    for (auto& glyph : glyphs) {
+        _fixtureU16(loca, glyf.len() / 2);
+        glyf.insert(COPY, glyf.len(), glyph.buf(), glyph.len());
+    }
+    _fixtureU16(loca, glyf.len() / 2);
+
+    Buf<Byte> head;
+    _fixtureU32(head, 0x00010000);
+    _fixtureU32(head, 0x00010000);
+    _fixtureU32(head, 0);
+    _fixtureU32(head, 0x5F0F3CF5);
+    _fixtureU16(head, 0);
+    _fixtureU16(head, 1000);
+    for (usize i = 0; i < 4; i++)
+        _fixtureU32(head, 0);
+    for (i16 v : {0, 0, 600, 700})
+        _fixtureU16(head, v);
+    _fixtureU16(head, 0);
+    _fixtureU16(head, 8);
+    _fixtureU16(head, 2);
+    _fixtureU16(head, 0);
+    _fixtureU16(head, 0);
+
+    Buf<Byte> hhea;
+    _fixtureU32(hhea, 0x00010000);
+    for (i16 v : {800, -200, 0, 600})
+        _fixtureU16(hhea, v);
+    for (usize i = 0; i < 11; i++)
+        _fixtureU16(hhea, 0);
+    _fixtureU16(hhea, FIXTURE_GLYPHS);
+
+    Buf<Byte> hmtx;
+    for (auto& glyph : glyphs) {
+        _fixtureU16(hmtx, 600);
+        _fixtureU16(hmtx, (glyph[2] << 8) | glyph[3]);
+    }
+
+    Buf<Byte> maxp;
+    _fixtureU32(maxp, 0x00005000);
+    _fixtureU16(maxp, FIXTURE_GLYPHS);
+
+    Array<Pair<Str, Buf<Byte>>, 7> tables = {
+        Pair<Str, Buf<Byte>>{"cmap"s, _fixtureCmap()},
+        Pair<Str, Buf<Byte>>{"glyf"s, std::move(glyf)},
+        Pair<Str, Buf<Byte>>{"head"s, std::move(head)},
+        Pair<Str, Buf<Byte>>{"hhea"s, std::move(hhea)},
+        Pair<Str, Buf<Byte>>{"hmtx"s, std::move(hmtx)},
+        Pair<Str, Buf<Byte>>{"loca"s, std::move(loca)},
+        Pair<Str, Buf<Byte>>{"maxp"s, std::move(maxp)},
+    };
+
+    Buf<Byte> font;
+    _fixtureU32(font, 0x00010000);
+    _fixtureU16(font, tables.len());
+    _fixtureU16(font, 64);
+    _fixtureU16(font, 2);
+    _fixtureU16(font, tables.len() * 16 - 64);
+
+    usize offset = 12 + tables.len() * 16;
+    for (auto& [tag, data] : tables) {
+        for (auto c : tag)
+            font.insert(font.len(), c);
+        _fixtureU32(font, 0);
+        _fixtureU32(font, offset);
+        _fixtureU32(font, data.len());
+        offset += alignUp(data.len(), 4uz);
+    }
+
+    for (auto& [tag, data] : tables) {
+        font.insert(COPY, font.len(), data.buf(), data.len());
+        while (font.len() % 4)
+            font.insert(font.len(), 0);
+    }
+
+    return font;
+}
+
+} // namespace Ttf::Tests
@@ -1,3 +1,4 @@
+#include <karm-sys/stat.h>
 #include <karm-test/macros.h>
 #include <karm-text/book.h>
 
@@ -14,4 +15,116 @@ test$("karm-text-common-family") {
     return Ok();
 }
 
+test$("karm-text-fontface-id") {
+    auto a = Fontface::fallback();
+    auto b = Fontface::fallback();
+    expectNe$(a->id(), b->id());
+
+    // Even where the allocator hands out the same address again
+    usize old = a->id();
+    a = Fontface::fallback();
+    expectNe$(a->id(), old);
+    expectNe$(a->id(), b->id());
+
+    return Ok();
+}
+
+test$("karm-text-font-coverage") {
+    FontCoverage coverage;
+    coverage.add(0x20, 0x7E);
+    coverage.add(0x4E00, 0x4FFF);
+
+    expect$(coverage.covers('A'));
+    expect$(not coverage.covers(0x0400));
+    expect$(coverage.covers(0x4E42));
+    expect$(not coverage.covers(0x5000));
+    expect$(not coverage.covers(0x110000));
+
+    return Ok();
+}
+
+test$("karm-text-font-index-roundtrip") {
+    auto url = "file:/tmp/karm-text-fonts.index"_url;
+
+    Vec<_IndexEntry> entries;
+    for (usize i = 0; i < 3; i++) {
+        _IndexEntry entry = {
+            .url = Io::format("file:/fonts/font-{}.ttf", i),
+            .size = 1000 + i,
+            .mtime = 1700000000 + i,
+            .attrs = {
+                .family = Io::format("Family {}", i),
+                .weight = FontWeight{(u16)(100 + i * 300)},
+                .stretch = FontStretch::CONDENSED,
+                .style = i == 1 ? FontStyle::ITALIC : FontStyle::NORMAL,
+                .monospace = i == 2 ? Monospace::YES : Monospace::NO,
+            },
+        };
+        entry.coverage.add(0x20 + i * 0x1000, 0x7E + i * 0x1000);
+        entries.pushBack(entry);
+    }
+
+    try$(_writeIndex(url, entries));
+
+    // The index was moved over into place, nothing is left aside
+    expect$(not Sys::stat("file:/tmp/karm-text-fonts.index.tmp"_url));
+
+    auto read = try$(_readIndex(url));
+    expectEq$(read.len(), entries.len());
+    for (usize i = 0; i < read.len(); i++) {
+        expectEq$(read[i].url, entries[i].url);
+        expectEq$(read[i].size, entries[i].size);
+        expectEq$(read[i].mtime, entries[i].mtime);
+        expectEq$(read[i].attrs.family, entries[i].attrs.family);
+        expect$(read[i].attrs.weight == entries[i].attrs.weight);
+        expect$(read[i].attrs.stretch == entries[i].attrs.stretch);
+        expect$(read[i].attrs.style == entries[i].attrs.style);
+        expect$(read[i].attrs.monospace == entries[i].attrs.monospace);
+        expect$(read[i].coverage.bits == entries[i].coverage.bits);
+    }
+
+    // Writing again replaces the previous index
+    entries.popBack();
+    try$(_writeIndex(url, entries));
+    expectEq$(try$(_readIndex(url)).len(), 2uz);
+
+    return Ok();
+}
+
+static Opt<usize> _covering(FontBook const& book, Rune rune, FontQuery query) {
+    auto face = book.queryCovering(rune, query);
+    if (not face)
+        return NONE;
+    return (*face)->id();
+}
+
+test$("karm-text-query-covering") {
+    auto latin = Fontface::fallback();
+    auto latinBold = Fontface::fallback();
+    auto cjk = Fontface::fallback();
+
+    FontCoverage latinCoverage;
+    latinCoverage.add(0x20, 0x24F);
+    FontCoverage cjkCoverage;
+    cjkCoverage.add(0x4E00, 0x9FFF);
+
+    FontBook book;
+    book.add({.url = ""_url, .attrs = {.family = "Sans"s}, .coverage = latinCoverage, .face = latin});
+    book.add({.url = ""_url, .attrs = {.family = "Sans"s, .weight = FontWeight::BOLD}, .coverage = latinCoverage, .face = latinBold});
+    book.add({.url = ""_url, .attrs = {.family = "Sans CJK"s}, .coverage = cjkCoverage, .face = cjk});
+
+    // The best match that has the rune, whatever the best match overall is
+    expect$(_covering(book, 'A', {.family = "Sans"s}) == latin->id());
+    expect$(_covering(book, 'A', {.family = "Sans"s, .weight = FontWeight::BOLD}) == latinBold->id());
+    expect$(_covering(book, 0x4E2D, {.family = "Sans"s}) == cjk->id());
+
+    // Another family entirely still beats no font at all
+    expect$(_covering(book, 0x4E2D, {.family = "Serif"s}) == cjk->id());
+
+    // Nothing has it
+    expect$(_covering(book, 0x0400, {.family = "Sans"s}) == NONE);
+
+    return Ok();
+}
+
 } // namespace Karm::Text::Tests
@@ -0,0 +1,174 @@
+#include <karm-test/macros.h>
+#include <karm-text/ttf/parser.h>
+
+#include "fixture-font.h"
+
+namespace Ttf::Tests {
+
+static constexpr isize MISSING = -1;
+
+static isize _lookup(Cmap::Table const& table, Rune r) {
+    auto glyph = table.lookup(r);
+    if (not glyph)
+        return MISSING;
+    return glyph->index;
+}
+
+// What the fixture maps, the same through either subtable.
+static isize _fixtureGlyph(Rune r) {
+    switch (r) {
+    case 'A':
+    case 'a':
+        return 1;
+    case 'B':
+    case 'b':
+        return 2;
+    case 'C':
+        return 4;
+    case 'D':
+        return 5;
+    default:
+        return MISSING;
+    }
+}
+
+test$("ttf-cmap-fixture-tables") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+
+    usize tables = 0;
+    for (auto table : font._cmap.iterTables()) {
+        tables++;
+        expectEq$(table.platformId, 3);
+        expect$(table.type == 4 or table.type == 12);
+        expectEq$(table.encodingId, table.type == 4 ? 1 : 10);
+
+        for (Rune r = 0; r < 0x300; r++)
+            expectEq$(_lookup(table, r), _fixtureGlyph(r));
+
+        // Only the format 12 subtable reaches past the BMP
+        expectEq$(_lookup(table, 0x1F600), table.type == 12 ? 2 : MISSING);
+        expectEq$(_lookup(table, 0x1F601), MISSING);
+        expectEq$(_lookup(table, 0x10FFFF), MISSING);
+    }
+    expectEq$(tables, 2uz);
+
+    // The parser picks the subtable covering every rune
+    expectEq$(font._cmapTable.type, 12);
+    expectEq$(font.tryGlyph(0x1F600)->index, 2);
+
+    return Ok();
+}
+
+test$("ttf-cmap-fixture-ranges") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+
+    for (auto table : font._cmap.iterTables()) {
+        Vec<Rune> ranges;
+        table.iterRanges([&](Rune start, Rune end) {
+            ranges.pushBack(start);
+            ranges.pushBack(end);
+        });
+
+        if (table.type == 4) {
+            // 'E' is in a segment even though it maps to nothing, and the
+            // closing 0xFFFF segment is left out
+            expectEq$(ranges, (Vec<Rune>{'A', 'E', 'a', 'b'}));
+        } else {
+            expectEq$(ranges, (Vec<Rune>{'A', 'B', 'C', 'C', 'D', 'D', 'a', 'b', 0x1F600, 0x1F600}));
+        }
+    }
+
+    return Ok();
+}
+
+// MARK: Larger Tables ---------------------------------------------------------
+
+// Enough segments and groups for the binary searches to take a few steps,
+// each range is compared against a plain linear scan.
+static constexpr usize RANGES = 100;
+
+static Rune _rangeStart(usize i) {
+    return 0x100 + i * 8;
+}
+
+static u16 _rangeGlyph(usize i) {
+    return 1000 + i * 3;
+}
+
+static isize _linearLookup(Rune r) {
+    for (usize i = 0; i < RANGES; i++)
+        if (r >= _rangeStart(i) and r <= _rangeStart(i) + 2)
+            return _rangeGlyph(i) + (r - _rangeStart(i));
+    return MISSING;
+}
+
+static Buf<Byte> _format4() {
+    usize segCount = RANGES + 1;
+
+    Buf<Byte> buf;
+    _fixtureU16(buf, 4);
+    _fixtureU16(buf, 16 + segCount * 8);
+    _fixtureU16(buf, 0);
+    _fixtureU16(buf, segCount * 2);
+    _fixtureU16(buf, 0);
+    _fixtureU16(buf, 0);
+    _fixtureU16(buf, 0);
+
+    for (usize i = 0; i < RANGES; i++)
+        _fixtureU16(buf, _rangeStart(i) + 2);
+    _fixtureU16(buf, 0xFFFF);
+    _fixtureU16(buf, 0);
+    for (usize i = 0; i < RANGES; i++)
+        _fixtureU16(buf, _rangeStart(i));
+    _fixtureU16(buf, 0xFFFF);
+    for (usize i = 0; i < RANGES; i++)
+        _fixtureU16(buf, _rangeGlyph(i) - _rangeStart(i));
+    _fixtureU16(buf, 1);
+    for (usize i = 0; i < segCount; i++)
+        _fixtureU16(buf, 0);
+
+    return buf;
+}
+
+static Buf<Byte> _format12(Rune offset) {
+    Buf<Byte> buf;
+    _fixtureU16(buf, 12);
+    _fixtureU16(buf, 0);
+    _fixtureU32(buf, 16 + RANGES * 12);
+    _fixtureU32(buf, 0);
+    _fixtureU32(buf, RANGES);
+    for (usize i = 0; i < RANGES; i++) {
+        _fixtureU32(buf, _rangeStart(i) + offset);
+        _fixtureU32(buf, _rangeStart(i) + offset + 2);
+        _fixtureU32(buf, _rangeGlyph(i));
+    }
+    return buf;
+}
+
+test$("ttf-cmap-format4-search") {
+    auto buf = _format4();
+    Cmap::Table table{3, 1, 4, sub(buf)};
+
+    for (Rune r = 0; r < _rangeStart(RANGES) + 16; r++)
+        expectEq$(_lookup(table, r), _linearLookup(r));
+
+    return Ok();
+}
+
+test$("ttf-cmap-format12-search") {
+    // Shifted past the BMP, where only format 12 can go
+    static constexpr Rune OFFSET = 0x20000;
+    auto buf = _format12(OFFSET);
+    Cmap::Table table{3, 10, 12, sub(buf)};
+
+    for (Rune r = 0; r < _rangeStart(RANGES) + 16; r++) {
+        expectEq$(_lookup(table, r), MISSING);
+        expectEq$(_lookup(table, r + OFFSET), _linearLookup(r));
+    }
+
+    return Ok();
+}
+
+} // namespace Ttf::Tests
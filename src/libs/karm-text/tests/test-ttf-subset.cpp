@@ -0,0 +1,168 @@
+#include <karm-test/macros.h>
+#include <karm-text/ttf/subset.h>
+
+#include "fixture-font.h"
+
+namespace Ttf::Tests {
+
+static Vec<u16> _componentIds(Bytes glyph) {
+    Vec<u16> ids;
+    Glyf::components(glyph, [&](usize at) {
+        ids.pushBack(Io::BScan{glyph}.skip(at).nextU16be());
+    });
+    return ids;
+}
+
+static Bytes _glyphBytes(Parser& font, u16 id) {
+    auto start = font._loca.glyfOffset(id, font._head);
+    auto end = font._loca.glyfOffset(id + 1, font._head);
+    return sub(font._glyf.bytes(), start, end);
+}
+
+test$("ttf-subset-glyph-count") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+
+    Array<Rune, 2> runes = {'A', 'C'};
+    auto subset = try$(Subset::build(font, runes));
+
+    // .notdef, 'A', the dot 'C' is made of, and 'C'
+    expectEq$(subset.glyphs.len(), 4uz);
+    expectEq$(subset.glyphs[0], 0);
+    expectEq$(subset.glyphs[1], 1);
+    expectEq$(subset.glyphs[2], 3);
+    expectEq$(subset.glyphs[3], 4);
+    expectEq$(subset.newId(2), 0);
+    expectEq$(subset.newId(5), 0);
+
+    auto out = try$(subset.write(font));
+    auto parsed = try$(Parser::init(out));
+    expectEq$(try$(parsed.requireTable<Maxp>()).numGlyphs(), 4);
+    expectEq$(parsed._hhea.numberOfHMetrics(), 4);
+    expectEq$(parsed._hmtx.bytes().len(), 4uz * 4);
+
+    return Ok();
+}
+
+test$("ttf-subset-loca-glyf") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+
+    Array<Rune, 3> runes = {'A', 'C', 'D'};
+    auto subset = try$(Subset::build(font, runes));
+    auto out = try$(subset.write(font));
+    auto parsed = try$(Parser::init(out));
+
+    // The fixture uses short offsets, the subset always long ones
+    expectEq$(font._head.locaFormat(), 0);
+    expectEq$(parsed._head.locaFormat(), 1);
+    expectEq$(parsed._loca.bytes().len(), (subset.glyphs.len() + 1) * 4);
+
+    for (u16 id = 0; id < subset.glyphs.len(); id++) {
+        auto start = parsed._loca.glyfOffset(id, parsed._head);
+        auto end = parsed._loca.glyfOffset(id + 1, parsed._head);
+        expectEq$(start % 4, 0uz);
+        expectLteq$(start, end);
+
+        auto original = _glyphBytes(font, subset.glyphs[id]);
+        auto glyph = _glyphBytes(parsed, id);
+        expectEq$(glyph.len(), alignUp(original.len(), 4uz));
+
+        // Composites are compared once their ids are remapped
+        if (_componentIds(original).len() == 0)
+            expectEq$(sub(glyph, 0, original.len()), original);
+
+        auto metrics = parsed.glyphMetrics(Text::Glyph(id));
+        auto originalMetrics = font.glyphMetrics(Text::Glyph(subset.glyphs[id]));
+        expectEq$(metrics.advance, originalMetrics.advance);
+        expectEq$(metrics.lsb, originalMetrics.lsb);
+        expectEq$(metrics.width, originalMetrics.width);
+    }
+
+    auto end = parsed._loca.glyfOffset(subset.glyphs.len(), parsed._head);
+    expectEq$(end, parsed._glyf.bytes().len());
+
+    return Ok();
+}
+
+test$("ttf-subset-composite-remap") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+
+    Array<Rune, 2> runes = {'B', 'C'};
+    auto subset = try$(Subset::build(font, runes));
+    auto out = try$(subset.write(font));
+    auto parsed = try$(Parser::init(out));
+
+    // 0 .notdef, 1 'A', 2 'B', 3 dot, 4 'C'
+    expectEq$(subset.glyphs.len(), 5uz);
+    auto c = parsed.tryGlyph('C');
+    expect$(c.has());
+    expectEq$(c->index, 4);
+
+    auto ids = _componentIds(_glyphBytes(parsed, c->index));
+    expectEq$(ids.len(), 2uz);
+    expectEq$(ids[0], subset.newId(1));
+    expectEq$(ids[1], subset.newId(3));
+    expectEq$(ids[1], 3);
+
+    // Everything past the ids is left as it was
+    auto original = _glyphBytes(font, 4);
+    auto glyph = _glyphBytes(parsed, c->index);
+    expectEq$(sub(glyph, 0, 12), sub(original, 0, 12));
+    expectEq$(sub(glyph, 14, 20), sub(original, 14, 20));
+    expectEq$(sub(glyph, 22, original.len()), sub(original, 22, original.len()));
+
+    // Runes map to the new ids, and runes not asked for to nothing
+    expectEq$(parsed.tryGlyph('B')->index, 2);
+    expect$(not parsed.tryGlyph('A'));
+    expect$(not parsed.tryGlyph('D'));
+
+    return Ok();
+}
+
+test$("ttf-subset-checksums") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+
+    Array<Rune, 2> runes = {'A', 'C'};
+    auto subset = try$(Subset::build(font, runes));
+    auto out = try$(subset.write(font));
+    auto parsed = try$(Parser::init(out));
+
+    // The head adjustment makes the whole file sum to the magic number
+    expectEq$(Subset::_checksum(out), 0xB1B0AFBAu);
+
+    for (auto table : parsed.iterTables()) {
+        expectEq$(table.offset % 4, 0u);
+        auto bytes = Subset::_copy(sub(out, table.offset, table.offset + table.length));
+
+        // NOTE: The head checksum is taken with the adjustment zeroed.
+        if (table.tag == "head")
+            Subset::_put32(bytes, 8, 0);
+
+        expectEq$(table.checkSum, Subset::_checksum(bytes));
+    }
+
+    return Ok();
+}
+
+test$("ttf-glyf-components-truncated") {
+    auto data = fixtureFont();
+    auto font = try$(Parser::init(data));
+    auto glyph = _glyphBytes(font, 4);
+    expectEq$(glyph.len(), 26uz);
+
+    for (usize len = 0; len <= glyph.len(); len++) {
+        // Only whole components are reported
+        usize expected = len >= 26 ? 2 : (len >= 18 ? 1 : 0);
+        expectEq$(_componentIds(sub(glyph, 0, len)).len(), expected);
+    }
+
+    // A simple glyph has no components
+    expectEq$(_componentIds(_glyphBytes(font, 1)).len(), 0uz);
+
+    return Ok();
+}
+
+} // namespace Ttf::Tests
@@ -49,12 +49,23 @@ FontAttrs TtfFontface::attrs() const {
 }
 
 Glyph TtfFontface::glyph(Rune rune) {
-    auto glyph = _cachedEntries.tryGet(rune);
-    if (glyph.has())
-        return glyph.unwrap();
-    auto g = _parser.glyph(rune);
-    _cachedEntries.put(rune, g);
-    return g;
+    if (rune > 0x10FFFF)
+        return Glyph::TOFU;
+
+    usize index = rune / GLYPH_PAGE_SIZE;
+    if (index >= _glyphPages.len())
+        _glyphPages.resize(index + 1);
+
+    auto& page = _glyphPages[index];
+    if (not page) {
+        GlyphPage glyphs{};
+        Rune start = index * GLYPH_PAGE_SIZE;
+        for (usize i = 0; i < GLYPH_PAGE_SIZE; i++)
+            glyphs[i] = _parser.tryGlyph(start + i).unwrapOr(Glyph::TOFU);
+        page = makeBox<GlyphPage>(glyphs);
+    }
+
+    return (**page)[rune % GLYPH_PAGE_SIZE];
 }
 
 f64 TtfFontface::advance(Glyph glyph) {
@@ -80,4 +91,13 @@ void TtfFontface::contour(Gfx::Canvas& g, Glyph glyph) const {
     g.scale(1.0 / _unitPerEm);
     _parser.glyphContour(g, glyph);
 }
+
+FontCoverage TtfFontface::coverage() const {
+    FontCoverage coverage;
+    _parser._cmapTable.iterRanges([&](Rune start, Rune end) {
+        coverage.add(start, end);
+    });
+    return coverage;
+}
+
 } // namespace Karm::Text
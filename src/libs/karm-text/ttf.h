@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-base/array.h>
+#include <karm-base/box.h>
 #include <karm-base/map.h>
 #include <karm-sys/mmap.h>
 
@@ -11,7 +13,12 @@ namespace Karm::Text {
 struct TtfFontface : public Fontface {
     Sys::Mmap _mmap;
     Ttf::Parser _parser;
-    Map<Rune, Glyph> _cachedEntries;
+    static constexpr usize GLYPH_PAGE_SIZE = 256;
+    using GlyphPage = Array<Glyph, GLYPH_PAGE_SIZE>;
+
+    // Rune to glyph table, indexed by page then by rune, pages are resolved
+    // all at once the first time one of their runes is looked up.
+    Vec<Opt<Box<GlyphPage>>> _glyphPages;
     Map<Glyph, f64> _cachedAdvances;
     Map<Pair<Glyph>, f64> _cachedKerns;
     f64 _unitPerEm = 0;
@@ -31,6 +38,8 @@ struct TtfFontface : public Fontface {
     f64 kern(Glyph prev, Glyph curr) override;
 
     void contour(Gfx::Canvas& g, Glyph glyph) const override;
+
+    FontCoverage coverage() const override;
 };
 
 } // namespace Karm::Text
@@ -175,6 +175,17 @@ struct Parser {
         }};
     }
 
+    // Raw bytes of a table, empty when the font doesn't have it.
+    Bytes tableBytes(Str tag) {
+        for (auto table : iterTables()) {
+            if (table.tag == tag) {
+                return sub(_slice, table.offset, table.offset + table.length);
+            }
+        }
+
+        return {};
+    }
+
     template <typename T>
     T lookupTable() {
         for (auto table : iterTables()) {
@@ -203,6 +214,10 @@ struct Parser {
         return _cmapTable.glyphIdFor(rune);
     }
 
+    Opt<Text::Glyph> tryGlyph(Rune rune) const {
+        return _cmapTable.lookup(rune);
+    }
+
     GlyphMetrics glyphMetrics(Text::Glyph glyph) const {
         auto glyfOffset = _loca.glyfOffset(glyph.index, _head);
         auto glyf = _glyf.metrics(glyfOffset);
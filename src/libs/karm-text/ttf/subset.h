@@ -0,0 +1,275 @@
+#pragma once
+
+#include <karm-base/buf.h>
+#include <karm-base/vec.h>
+
+#include "parser.h"
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/otff#table-directory
+// https://learn.microsoft.com/en-us/typography/opentype/spec/glyf#composite-glyph-description
+
+namespace Ttf {
+
+// A copy of a font with only some of its glyphs, to be embedded in a
+// document. Glyphs are renumbered, .notdef stays first, and those
+// making up composite glyphs are kept along with them.
+//
+// Only the tables needed to draw glyphs are written, with a cmap for
+// the runes the subset was built from. Layout tables are dropped, text
+// was already shaped by the time a font gets embedded.
+struct Subset {
+    // Old id of each glyph, by new id.
+    Vec<u16> glyphs;
+    // New id of each old glyph, 0 when it isn't in the subset.
+    Buf<u16> _newIds;
+    // Runes, and their new glyph, in increasing order.
+    Vec<Pair<Rune, u16>> _runes;
+
+    // The subset drawing `runes`, which have to be in increasing order.
+    static Res<Subset> build(Parser& font, Slice<Rune> runes) {
+        auto maxp = try$(font.requireTable<Maxp>());
+        usize numGlyphs = maxp.numGlyphs();
+
+        Subset subset;
+        subset._newIds = Buf<u16>::init(numGlyphs, 0);
+
+        Buf<bool> used = Buf<bool>::init(numGlyphs, false);
+        Vec<u16> pending;
+        auto use = [&](u16 id) {
+            if (id >= numGlyphs or used[id])
+                return;
+            used[id] = true;
+            pending.pushBack(id);
+        };
+
+        use(0);
+        for (auto rune : runes)
+            if (auto glyph = font.tryGlyph(rune))
+                use(glyph->index);
+
+        while (pending.len()) {
+            auto glyph = subset._glyphBytes(font, pending.popBack());
+            Glyf::components(glyph, [&](usize at) {
+                use(Io::BScan{glyph}.skip(at).nextU16be());
+            });
+        }
+
+        for (usize id = 0; id < numGlyphs; id++) {
+            if (not used[id])
+                continue;
+            subset._newIds[id] = subset.glyphs.len();
+            subset.glyphs.pushBack(id);
+        }
+
+        for (auto rune : runes)
+            if (auto glyph = font.tryGlyph(rune))
+                subset._runes.pushBack({rune, subset.newId(glyph->index)});
+
+        return Ok(std::move(subset));
+    }
+
+    // New id of a glyph of the original font, 0 when it was dropped.
+    u16 newId(u16 id) const {
+        return id < _newIds.len() ? _newIds[id] : 0;
+    }
+
+    Bytes _glyphBytes(Parser& font, u16 id) const {
+        auto start = font._loca.glyfOffset(id, font._head);
+        auto end = font._loca.glyfOffset(id + 1, font._head);
+        if (end < start)
+            return {};
+        return sub(font._glyf.bytes(), start, end);
+    }
+
+    // MARK: Writing -----------------------------------------------------------
+
+    struct _Table {
+        Str tag;
+        Buf<Byte> data;
+    };
+
+    static void _u16(Buf<Byte>& buf, u16 v) {
+        buf.insert(buf.len(), v >> 8);
+        buf.insert(buf.len(), v);
+    }
+
+    static void _u32(Buf<Byte>& buf, u32 v) {
+        _u16(buf, v >> 16);
+        _u16(buf, v);
+    }
+
+    static void _put16(Buf<Byte>& buf, usize at, u16 v) {
+        if (at + 2 > buf.len())
+            return;
+        buf[at] = v >> 8;
+        buf[at + 1] = v;
+    }
+
+    static void _put32(Buf<Byte>& buf, usize at, u32 v) {
+        _put16(buf, at, v >> 16);
+        _put16(buf, at + 2, v);
+    }
+
+    static void _pad(Buf<Byte>& buf) {
+        while (buf.len() % 4)
+            buf.insert(buf.len(), 0);
+    }
+
+    static u32 _checksum(Bytes data) {
+        u32 sum = 0;
+        for (usize i = 0; i < data.len(); i += 4) {
+            u32 word = 0;
+            for (usize j = 0; j < 4; j++)
+                word = word << 8 | (i + j < data.len() ? data[i + j] : 0);
+            sum += word;
+        }
+        return sum;
+    }
+
+    static Buf<Byte> _copy(Bytes bytes) {
+        Buf<Byte> buf;
+        buf.insert(COPY, 0, bytes.buf(), bytes.len());
+        return buf;
+    }
+
+    // Glyphs are padded to four bytes, so offsets are always written in
+    // the long loca format.
+    void _writeGlyphs(Parser& font, Buf<Byte>& glyf, Buf<Byte>& loca) const {
+        for (auto id : glyphs) {
+            _u32(loca, glyf.len());
+            usize start = glyf.len();
+            auto glyph = _glyphBytes(font, id);
+            glyf.insert(COPY, start, glyph.buf(), glyph.len());
+            Glyf::components(glyph, [&](usize at) {
+                _put16(glyf, start + at, newId(Io::BScan{glyph}.skip(at).nextU16be()));
+            });
+            _pad(glyf);
+        }
+        _u32(loca, glyf.len());
+    }
+
+    Buf<Byte> _writeHmtx(Parser& font) const {
+        Buf<Byte> hmtx;
+        for (auto id : glyphs) {
+            auto metrics = font._hmtx.metrics(id, font._hhea);
+            _u16(hmtx, metrics.advanceWidth);
+            _u16(hmtx, metrics.lsb);
+        }
+        return hmtx;
+    }
+
+    // A single format 12 subtable, with a group for each run of
+    // consecutive runes mapped to consecutive glyphs.
+    Buf<Byte> _writeCmap() const {
+        Vec<Array<u32, 3>> groups;
+        for (auto& [rune, id] : _runes) {
+            if (groups.len()) {
+                auto& last = ::last(groups);
+                if (last[1] + 1 == rune and last[2] + (rune - last[0]) == id) {
+                    last[1] = rune;
+                    continue;
+                }
+            }
+            groups.pushBack({rune, rune, id});
+        }
+
+        Buf<Byte> cmap;
+        _u16(cmap, 0);
+        _u16(cmap, 1);
+
+        _u16(cmap, 3);
+        _u16(cmap, 10);
+        _u32(cmap, 12);
+
+        _u16(cmap, 12);
+        _u16(cmap, 0);
+        _u32(cmap, 16 + groups.len() * 12);
+        _u32(cmap, 0);
+        _u32(cmap, groups.len());
+        for (auto& group : groups)
+            for (auto v : group)
+                _u32(cmap, v);
+        return cmap;
+    }
+
+    Res<Buf<Byte>> write(Parser& font) const {
+        Vec<_Table> tables;
+
+        Buf<Byte> glyf;
+        Buf<Byte> loca;
+        _writeGlyphs(font, glyf, loca);
+
+        auto head = _copy(font._head.bytes());
+        _put32(head, 8, 0);
+        _put16(head, 50, 1);
+
+        auto hhea = _copy(font._hhea.bytes());
+        _put16(hhea, 34, glyphs.len());
+
+        auto maxp = _copy(try$(font.requireTable<Maxp>()).bytes());
+        _put16(maxp, 4, glyphs.len());
+
+        // Tables that don't depend on glyph ids are copied as they are
+        auto keep = [&](Str tag) {
+            if (auto bytes = font.tableBytes(tag); bytes.len())
+                tables.pushBack({tag, _copy(bytes)});
+        };
+
+        // NOTE: The directory has to be sorted by tag.
+        keep("OS/2"s);
+        tables.pushBack({"cmap"s, _writeCmap()});
+        keep("cvt "s);
+        keep("fpgm"s);
+        tables.pushBack({"glyf"s, std::move(glyf)});
+        tables.pushBack({"head"s, std::move(head)});
+        tables.pushBack({"hhea"s, std::move(hhea)});
+        tables.pushBack({"hmtx"s, _writeHmtx(font)});
+        tables.pushBack({"loca"s, std::move(loca)});
+        tables.pushBack({"maxp"s, std::move(maxp)});
+        keep("name"s);
+
+        // NOTE: Glyph names are indexed by glyph id, version 3 has none.
+        if (font._post.present() and font._post.bytes().len() >= 32) {
+            auto post = _copy(sub(font._post.bytes(), 0, 32));
+            _put32(post, 0, 0x00030000);
+            tables.pushBack({"post"s, std::move(post)});
+        }
+
+        keep("prep"s);
+
+        usize entrySelector = 0;
+        while ((2uz << entrySelector) <= tables.len())
+            entrySelector++;
+        usize searchRange = (1uz << entrySelector) * 16;
+
+        Buf<Byte> out;
+        _u32(out, 0x00010000);
+        _u16(out, tables.len());
+        _u16(out, searchRange);
+        _u16(out, entrySelector);
+        _u16(out, tables.len() * 16 - searchRange);
+
+        usize offset = 12 + tables.len() * 16;
+        usize headOffset = 0;
+        for (auto& table : tables) {
+            for (auto c : table.tag)
+                out.insert(out.len(), c);
+            _u32(out, _checksum(table.data));
+            _u32(out, offset);
+            _u32(out, table.data.len());
+            if (table.tag == "head")
+                headOffset = offset;
+            offset += alignUp(table.data.len(), 4uz);
+        }
+
+        for (auto& table : tables) {
+            out.insert(COPY, out.len(), table.data.buf(), table.data.len());
+            _pad(out);
+        }
+
+        _put32(out, headOffset + 8, 0xB1B0AFBA - _checksum(out));
+        return Ok(std::move(out));
+    }
+};
+
+} // namespace Ttf
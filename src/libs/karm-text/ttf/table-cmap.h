@@ -21,71 +21,135 @@ struct Cmap : public Io::BChunk {
             return slice;
         }
 
-        Text::Glyph _glyphIdForType4(Rune r) const {
+        // Segments are sorted by end code, look for the first one that
+        // ends at or after the rune.
+        Opt<Text::Glyph> _lookupType4(Rune r) const {
+            if (r > 0xFFFF)
+                return NONE;
+
             u16 segCountX2 = begin().skip(6).nextU16be();
             u16 segCount = segCountX2 / 2;
 
-            for (usize i = 0; i < segCount; i++) {
-                auto s = begin().skip(14);
+            usize endCodes = 14;
+            // + 2 for reserved padding
+            usize startCodes = endCodes + segCountX2 + 2;
+            usize idDeltas = startCodes + segCountX2;
+            usize idRangeOffsets = idDeltas + segCountX2;
+
+            usize lo = 0;
+            usize hi = segCount;
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                u16 endCode = begin().skip(endCodes + mid * 2).peekU16be();
+                if (endCode < r)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
 
-                u16 endCode = s.skip(i * 2).peekU16be();
+            if (lo == segCount)
+                return NONE;
 
-                if (r > endCode)
-                    continue;
+            usize i = lo;
+            u16 startCode = begin().skip(startCodes + i * 2).peekU16be();
+            if (r < startCode)
+                return NONE;
 
-                // + 2 for reserved padding
-                u16 startCode = s.skip(segCountX2 + 2).peekU16be();
+            u16 idDelta = begin().skip(idDeltas + i * 2).peekI16be();
+            u16 idRangeOffset = begin().skip(idRangeOffsets + i * 2).peekU16be();
 
-                if (r < startCode)
-                    break;
+            if (idRangeOffset == 0)
+                return Text::Glyph((r + idDelta) & 0xFFFF);
 
-                u16 idDelta = s.skip(segCountX2).peekI16be();
-                u16 idRangeOffset = s.skip(segCountX2).peekU16be();
+            // NOTE: The offset is relative to the idRangeOffset entry itself.
+            auto offset = idRangeOffsets + i * 2 + idRangeOffset + (r - startCode) * 2;
+            u16 glyph = begin().skip(offset).peekU16be();
+            if (glyph == 0)
+                return NONE;
 
-                if (idRangeOffset == 0) {
-                    return Text::Glyph((r + idDelta) & 0xFFFF);
-                }
+            return Text::Glyph((glyph + idDelta) & 0xFFFF);
+        }
 
-                auto offset = idRangeOffset + (r - startCode) * 2;
-                return Text::Glyph(s.skip(offset).nextU16be());
+        // Groups are sorted by start code, look for the last one that
+        // starts at or before the rune.
+        Opt<Text::Glyph> _lookupType12(Rune r) const {
+            static constexpr usize GROUP_SIZE = 12;
+
+            u32 nGroups = begin().skip(12).nextU32be();
+            usize groups = 16;
+
+            usize lo = 0;
+            usize hi = nGroups;
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                u32 startCode = begin().skip(groups + mid * GROUP_SIZE).peekU32be();
+                if (startCode <= r)
+                    lo = mid + 1;
+                else
+                    hi = mid;
             }
 
-            logWarn("ttf: glyph not found for rune {x}", r);
-            return Text::Glyph(0);
+            if (lo == 0)
+                return NONE;
+
+            auto s = begin().skip(groups + (lo - 1) * GROUP_SIZE);
+            u32 startCode = s.nextU32be();
+            u32 endCode = s.nextU32be();
+            u32 glyphOffset = s.nextU32be();
+
+            if (r > endCode)
+                return NONE;
+
+            return Text::Glyph((r - startCode) + glyphOffset);
         }
 
-        Text::Glyph _glyphForType12(Rune r) const {
-            auto s = begin().skip(12);
-            u32 nGroups = s.nextU32be();
+        Opt<Text::Glyph> lookup(Rune r) const {
+            if (type == 4) {
+                return _lookupType4(r);
+            } else if (type == 12) {
+                return _lookupType12(r);
+            } else {
+                return NONE;
+            }
+        }
 
-            for (u32 i = 0; i < nGroups; i++) {
-                u32 startCode = s.nextU32be();
-                u32 endCode = s.nextU32be();
-                u32 glyphOffset = s.nextU32be();
+        // Call `cb(start, end)` for every range of runes mapped by the table.
+        void iterRanges(auto cb) const {
+            if (type == 4) {
+                u16 segCountX2 = begin().skip(6).nextU16be();
+                usize endCodes = 14;
+                usize startCodes = endCodes + segCountX2 + 2;
 
-                if (r < startCode)
-                    break;
+                for (usize i = 0; i < segCountX2 / 2u; i++) {
+                    u16 endCode = begin().skip(endCodes + i * 2).peekU16be();
+                    u16 startCode = begin().skip(startCodes + i * 2).peekU16be();
 
-                if (r > endCode)
-                    continue;
+                    // NOTE: The last segment only maps 0xFFFF to the missing glyph.
+                    if (startCode == 0xFFFF)
+                        continue;
 
-                if (r >= startCode and r <= endCode) {
-                    return Text::Glyph((r - startCode) + glyphOffset);
+                    cb((Rune)startCode, (Rune)endCode);
+                }
+            } else if (type == 12) {
+                auto s = begin().skip(12);
+                u32 nGroups = s.nextU32be();
+
+                for (u32 i = 0; i < nGroups; i++) {
+                    u32 startCode = s.nextU32be();
+                    u32 endCode = s.nextU32be();
+                    s.skip(4);
+                    cb((Rune)startCode, (Rune)endCode);
                 }
             }
-
-            logWarn("ttf: glyph not found for rune {c}", r);
-            return Text::Glyph(0);
         }
 
         Text::Glyph glyphIdFor(Rune r) const {
-            if (type == 4) {
-                return _glyphIdForType4(r);
-            } else if (type == 12) {
-                return _glyphForType12(r);
-            } else {
+            auto glyph = lookup(r);
+            if (not glyph) {
+                logWarn("ttf: glyph not found for rune {x}", r);
                 return Text::Glyph(0);
             }
+            return *glyph;
         }
     };
 
@@ -17,6 +17,12 @@ struct Glyf : public Io::BChunk {
     static constexpr u8 SAME_OR_POSITIVE_Y = 0x20;
     static constexpr u8 OVERLAY_SIMPLE = 0x40;
 
+    static constexpr u16 ARG_1_AND_2_ARE_WORDS = 0x0001;
+    static constexpr u16 WE_HAVE_A_SCALE = 0x0008;
+    static constexpr u16 MORE_COMPONENTS = 0x0020;
+    static constexpr u16 WE_HAVE_AN_X_AND_Y_SCALE = 0x0040;
+    static constexpr u16 WE_HAVE_A_TWO_BY_TWO = 0x0080;
+
     struct Metrics {
         i16 numContours;
         i16 xMin;
@@ -153,6 +159,37 @@ struct Glyf : public Io::BChunk {
         }
     }
 
+    // Calls `cb` with the offset, from the start of `glyph`, of the glyph
+    // index of each of its components. A truncated component ends the
+    // glyph, it's left out along with anything after it.
+    static void components(Bytes glyph, auto cb) {
+        Io::BScan s{glyph};
+        if (s.rem() < 10 or s.peekI16be() >= 0)
+            return;
+        s.skip(10);
+
+        u16 flags = MORE_COMPONENTS;
+        while (flags & MORE_COMPONENTS) {
+            if (s.rem() < 2)
+                return;
+            flags = s.nextU16be();
+
+            // Glyph index, arguments and transform
+            usize len = 2 + (flags & ARG_1_AND_2_ARE_WORDS ? 4 : 2);
+            if (flags & WE_HAVE_A_SCALE)
+                len += 2;
+            else if (flags & WE_HAVE_AN_X_AND_Y_SCALE)
+                len += 4;
+            else if (flags & WE_HAVE_A_TWO_BY_TWO)
+                len += 8;
+
+            if (s.rem() < len)
+                return;
+            cb(s.tell());
+            s.skip(len);
+        }
+    }
+
     void contourComposite(Gfx::Canvas&, Metrics, Io::BScan&) const {
         logDebug("composite glyph not implemented");
     }
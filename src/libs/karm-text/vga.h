@@ -58,6 +58,14 @@ struct VgaFontface : public Fontface {
             }
         }
     }
+
+    FontCoverage coverage() const override {
+        FontCoverage coverage;
+        Ibm437Mapper mapper;
+        for (usize c = 0; c < 256; c++)
+            coverage.add(mapper(c), mapper(c));
+        return coverage;
+    }
 };
 
 } // namespace Karm::Text
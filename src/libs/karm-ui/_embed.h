@@ -5,7 +5,7 @@
 
 namespace Karm::Ui::_Embed {
 
-Res<Rc<Host>> makeHost(Child root);
+Res<Rc<Host>> makeHost(Child root, HostProps props = {});
 
 Async::Task<> runAsync(Sys::Context& ctx, Child root);
 
@@ -21,11 +21,22 @@ Async::Task<> runAsync(Sys::Context& ctx, Child root) {
 
 void mountApp(Cli::Command& cmd, Slot rootSlot) {
     Cli::Flag mobileArg = Cli::flag(NONE, "mobile"s, "Show mobile layout."s);
+    Cli::Flag headlessArg = Cli::flag(NONE, "headless"s, "Paint offscreen, then report the frame rate and exit."s);
+    Cli::Option<isize> framesArg = Cli::option<isize>(NONE, "headless-frames"s, "Number of frames painted in headless mode."s, 600);
 
     cmd.option(mobileArg);
-    cmd.callbackAsync = [rootSlot = std::move(rootSlot)](Sys::Context&) -> Async::Task<> {
+    cmd.option(headlessArg);
+    cmd.option(framesArg);
+    cmd.callbackAsync = [rootSlot = std::move(rootSlot), headlessArg, framesArg](Sys::Context&) -> Async::Task<> {
+        HostProps props;
+        if (headlessArg) {
+            if (framesArg.unwrap() <= 0)
+                co_return Error::invalidInput("headless frames must be positive");
+            props.headlessFrames = framesArg.unwrap();
+        }
+
         auto root = rootSlot();
-        co_return co_try$(_Embed::makeHost(root))->run();
+        co_return co_try$(_Embed::makeHost(root, props))->run();
     };
 }
 
@@ -143,7 +143,7 @@ struct DialogLayer : public LeafNode<DialogLayer> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return _child->size(s, hint);
+        return _child->measure(s, hint);
     }
 
     Math::Recti bound() override {
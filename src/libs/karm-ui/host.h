@@ -13,6 +13,12 @@ namespace Karm::Ui {
 static constexpr auto FRAME_RATE = 60;
 static constexpr auto FRAME_TIME = 1.0 / FRAME_RATE;
 
+struct HostProps {
+    /// Paint this many frames offscreen as fast as possible, then report
+    /// the frame rate and exit, to benchmark painting and presenting.
+    Opt<usize> headlessFrames = NONE;
+};
+
 struct Host : public Node {
     Child _root;
     Opt<Res<>> _res;
@@ -21,6 +27,7 @@ struct Host : public Node {
 
     bool _shouldLayout{};
     bool _shouldAnimate{};
+    MeasureStats _lastMeasures{};
 
     Host(Child root) : _root(root) {
         _root->attach(this);
@@ -42,6 +49,12 @@ struct Host : public Node {
         return not _res;
     }
 
+    // Measurements made by the last layout pass, and how many of them
+    // were served from the cache.
+    MeasureStats lastMeasures() const {
+        return _lastMeasures;
+    }
+
     Math::Recti bound() override {
         return pixels().bound();
     }
@@ -78,9 +91,21 @@ struct Host : public Node {
         _root->event(event);
     }
 
+    // Overlapping regions are merged, so they are painted and presented once.
+    void _damage(Math::Recti r) {
+        for (auto& d : _dirty) {
+            if (d.colide(r)) {
+                d = d.mergeWith(r);
+                return;
+            }
+        }
+
+        _dirty.pushBack(r);
+    }
+
     void bubble(App::Event& event) override {
         if (auto e = event.is<Node::PaintEvent>()) {
-            _dirty.pushBack(e->bound);
+            _damage(e->bound);
             event.accept();
         } else if (auto e = event.is<Node::LayoutEvent>()) {
             _shouldLayout = true;
@@ -128,7 +153,9 @@ struct Host : public Node {
             }
 
             if (_shouldLayout) {
+                measureStats() = {};
                 layout(bound());
+                _lastMeasures = measureStats();
                 _shouldLayout = false;
                 _shouldAnimate = true;
                 _dirty.pushBack(bound());
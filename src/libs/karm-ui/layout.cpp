@@ -84,7 +84,7 @@ struct Bound : public ProxyNode<Bound> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s, hint);
+        return child().measure(s, hint);
     }
 };
 
@@ -151,7 +151,7 @@ struct Align : public ProxyNode<Align> {
     Align(Math::Align align, Child child) : ProxyNode(child), _align(align) {}
 
     void layout(Math::Recti bound) override {
-        auto childSize = child().size(
+        auto childSize = child().measure(
             bound.size(), _child.is<Grow>()
                               ? Hint::MAX
                               : Hint::MIN
@@ -167,8 +167,8 @@ struct Align : public ProxyNode<Align> {
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
         if (hint == Hint::MAX)
-            return _align.maxSize(child().size(s, hint), s);
-        return _align.minSize(child().size(s, hint));
+            return _align.maxSize(child().measure(s, hint), s);
+        return _align.minSize(child().measure(s, hint));
     }
 };
 
@@ -246,7 +246,7 @@ struct Sizing : public ProxyNode<Sizing> {
             s.y = min(s.y, _max.y);
         }
 
-        auto result = child().size(s, hint);
+        auto result = child().measure(s, hint);
 
         if (_min.x != UNCONSTRAINED) {
             result.x = max(result.x, _min.x);
@@ -310,7 +310,7 @@ struct Insets : public ProxyNode<Insets> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s - _insets.all(), hint) + _insets.all();
+        return child().measure(s - _insets.all(), hint) + _insets.all();
     }
 
     Math::Recti bound() override {
@@ -376,7 +376,7 @@ struct StackLayout : public GroupNode<StackLayout> {
         isize h{};
 
         for (auto& child : children()) {
-            auto childSize = child->size(s, hint);
+            auto childSize = child->measure(s, hint);
             w = max(w, childSize.x);
             h = max(h, childSize.y);
         }
@@ -412,7 +412,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
             if (child.is<Grow>()) {
                 grows += child.unwrap<Grow>().grow();
             } else {
-                total += _style.flow.getX(child->size(r.size(), Hint::MIN));
+                total += _style.flow.getX(child->measure(r.size(), Hint::MIN));
             }
         }
 
@@ -429,7 +429,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
 
         for (auto& child : children()) {
             Math::Recti inner = {};
-            auto childSize = child->size(r.size(), Hint::MIN);
+            auto childSize = child->measure(r.size(), Hint::MIN);
 
             inner = _style.flow.setStart(inner, (isize)start);
             if (child.is<Grow>()) {
@@ -455,7 +455,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
             if (child.is<Grow>())
                 grow = true;
 
-            auto childSize = child->size(s, Hint::MIN);
+            auto childSize = child->measure(s, Hint::MIN);
             w += _style.flow.getX(childSize);
             h = max(h, _style.flow.getY(childSize));
         }
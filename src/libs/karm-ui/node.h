@@ -1,9 +1,11 @@
 #pragma once
 
 #include <karm-app/event.h>
+#include <karm-base/array.h>
 #include <karm-base/checked.h>
 #include <karm-base/func.h>
 #include <karm-base/hash.h>
+#include <karm-base/hashmap.h>
 #include <karm-gfx/canvas.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/async.h>
@@ -28,9 +30,31 @@ using Visitor = Func<void(Node&)>;
 
 using Key = Opt<Hash>;
 
+// Counts measurements since the last frame, see `Node::measure()`.
+struct MeasureStats {
+    usize calls;
+    usize hits;
+};
+
+inline MeasureStats& measureStats() {
+    static MeasureStats stats{};
+    return stats;
+}
+
 struct Node : public App::Dispatch {
+    static constexpr usize MEASURE_WAYS = 4;
+
+    struct _Measure {
+        Math::Vec2i s;
+        Hint hint;
+        Math::Vec2i result;
+    };
+
     Key _key = NONE;
     bool _consumed = false;
+    Array<_Measure, MEASURE_WAYS> _measures{};
+    u8 _measureLen = 0;
+    u8 _measureNext = 0;
 
     struct PaintEvent {
         Math::Recti bound;
@@ -55,10 +79,44 @@ struct Node : public App::Dispatch {
 
     virtual Math::Vec2i size(Math::Vec2i s, Hint) { return s; }
 
+    // Memoized `size()`, containers query their children several times per
+    // layout pass, with different constraints and hints. The results stay
+    // valid until the node is reconciled or a LayoutEvent bubbles through
+    // it, which is how nodes announce that their size changed.
+    Math::Vec2i measure(Math::Vec2i s, Hint hint) {
+        auto& stats = measureStats();
+        stats.calls++;
+
+        for (usize i = 0; i < _measureLen; i++) {
+            if (_measures[i].s == s and _measures[i].hint == hint) {
+                stats.hits++;
+                return _measures[i].result;
+            }
+        }
+
+        auto result = size(s, hint);
+        _measures[_measureNext] = {s, hint, result};
+        _measureNext = (u8)((_measureNext + 1) % MEASURE_WAYS);
+        _measureLen = (u8)min<usize>(_measureLen + 1, MEASURE_WAYS);
+        return result;
+    }
+
+    void invalidateMeasures() {
+        _measureLen = 0;
+        _measureNext = 0;
+    }
+
     virtual Math::Recti bound() { panic("bound() not implemented"); }
 
     virtual Node* parent() { return nullptr; }
 
+    // Device pixels per unit, as set by the host the node is mounted in.
+    virtual f64 dpi() {
+        if (auto* p = parent())
+            return p->dpi();
+        return 1;
+    }
+
     virtual void attach(Node*) {}
 
     virtual void detach(Node*) {}
@@ -113,11 +171,15 @@ struct LeafNode : public Node {
 
         reconcile(other.unwrap<Crtp>());
         other->_consumed = true;
+        this->invalidateMeasures();
 
         return NONE;
     }
 
     void bubble(App::Event& e) override {
+        if (e.is<LayoutEvent>())
+            this->invalidateMeasures();
+
         if (_parent and not e.accepted())
             _parent->bubble(e);
     }
@@ -168,9 +230,15 @@ struct GroupNode : public LeafNode<Crtp> {
         return _children;
     }
 
-    void reconcile(Crtp& o) override {
+    static bool _hasKeys(Children const& children) {
+        for (auto& c : children)
+            if (c->key())
+                return true;
+        return false;
+    }
+
+    void _reconcileByIndex(Children& them) {
         auto& us = children();
-        auto& them = o.children();
 
         for (usize i = 0; i < them.len(); i++) {
             if (i < us.len()) {
@@ -184,6 +252,71 @@ struct GroupNode : public LeafNode<Crtp> {
         us.trunc(them.len());
     }
 
+    // Match children by key rather than by position, so inserting, removing
+    // or moving an item only touches that item, every other child is reused
+    // with its state. Children without a key are matched, in order, with the
+    // old children without a key.
+    void _reconcileByKey(Children& them) {
+        auto& us = children();
+
+        HashMap<Hash, usize> keyed{us.len() * 2};
+        Vec<usize> unkeyed;
+        for (usize i = 0; i < us.len(); i++) {
+            if (auto k = us[i]->key())
+                keyed.put(*k, i);
+            else
+                unkeyed.pushBack(i);
+        }
+
+        Vec<bool> reused;
+        reused.resize(us.len(), false);
+        Vec<bool> matched;
+        matched.resize(us.len(), false);
+        usize nextUnkeyed = 0;
+
+        Children next;
+        next.ensure(them.len());
+        for (auto& child : them) {
+            Opt<usize> match = NONE;
+            if (auto k = child->key())
+                match = keyed.tryGet(*k);
+            else if (nextUnkeyed < unkeyed.len())
+                match = unkeyed[nextUnkeyed++];
+
+            // NOTE: With duplicated keys, only the first child gets the
+            //       old node, the others are new.
+            if (match and not matched[*match]) {
+                matched[*match] = true;
+                auto& old = us[*match];
+                if (auto replacement = old->reconcile(child)) {
+                    next.pushBack(*replacement);
+                } else {
+                    reused[*match] = true;
+                    next.pushBack(old);
+                }
+            } else {
+                next.pushBack(child);
+            }
+
+            last(next)->attach(this);
+        }
+
+        for (usize i = 0; i < us.len(); i++)
+            if (not reused[i])
+                us[i]->detach(this);
+
+        _children = std::move(next);
+    }
+
+    void reconcile(Crtp& o) override {
+        auto& them = o.children();
+
+        if (_hasKeys(children()) or _hasKeys(them))
+            _reconcileByKey(them);
+        else
+            _reconcileByIndex(them);
+    }
+
     void paint(Gfx::Canvas& g, Math::Recti r) override {
         for (auto& child : children()) {
             if (not child->bound().colide(r))
@@ -260,7 +393,7 @@ struct ProxyNode : public LeafNode<Crtp> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        return child().size(s, hint);
+        return child().measure(s, hint);
     }
 
     Math::Recti bound() override {
@@ -50,7 +50,7 @@ struct PopoverLayer : public ProxyNode<PopoverLayer> {
 
     Math::Recti _positionPopover(Math::Recti r) {
         // Position the popover at the given point, but make sure it fits in the screen
-        auto size = (*_popover)->size(r.size(), Hint::MIN);
+        auto size = (*_popover)->measure(r.size(), Hint::MIN);
         auto pos = _popoverAt;
         pos.y = clamp(pos.y, 0, r.size().y - size.y);
         if (pos.x + size.x > r.end())
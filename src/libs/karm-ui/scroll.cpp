@@ -1,3 +1,5 @@
+#include <karm-gfx/cpu/tiles.h>
+
 #include "scroll.h"
 
 #include "anim.h"
@@ -141,7 +143,7 @@ struct Scroll : public ProxyNode<Scroll> {
 
     void layout(Math::Recti r) override {
         _bound = r;
-        auto childSize = child().size(_bound.size(), Hint::MAX);
+        auto childSize = child().measure(_bound.size(), Hint::MAX);
         if (_orient == Math::Orien::HORIZONTAL) {
             childSize.height = r.height;
         } else if (_orient == Math::Orien::VERTICAL) {
@@ -158,7 +160,7 @@ struct Scroll : public ProxyNode<Scroll> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        auto childSize = child().size(s, hint);
+        auto childSize = child().measure(s, hint);
 
         if (hint == Hint::MIN) {
             if (_orient == Math::Orien::HORIZONTAL) {
@@ -210,7 +212,7 @@ struct Clip : public ProxyNode<Clip> {
 
     void layout(Math::Recti r) override {
         _bound = r;
-        auto childSize = child().size(_bound.size(), Hint::MAX);
+        auto childSize = child().measure(_bound.size(), Hint::MAX);
         if (_orient == Math::Orien::HORIZONTAL) {
             childSize.height = r.height;
         } else if (_orient == Math::Orien::VERTICAL) {
@@ -221,7 +223,7 @@ struct Clip : public ProxyNode<Clip> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        auto childSize = child().size(s, hint);
+        auto childSize = child().measure(s, hint);
 
         if (hint == Hint::MIN) {
             if (_orient == Math::Orien::HORIZONTAL) {
@@ -253,4 +255,40 @@ Child vclip(Child child) {
     return makeRc<Clip>(child, Math::Orien::VERTICAL);
 }
 
+// MARK: Tiled -----------------------------------------------------------------
+
+struct Tiled : public ProxyNode<Tiled> {
+    Gfx::CpuTiles _tiles;
+
+    Tiled(Child child)
+        : ProxyNode(child) {}
+
+    void reconcile(Tiled& o) override {
+        ProxyNode<Tiled>::reconcile(o);
+        _tiles.invalidate();
+    }
+
+    void paint(Gfx::Canvas& g, Math::Recti r) override {
+        _tiles.paint(g, r.clipTo(bound()), dpi(), [&](Gfx::Canvas& tg, Math::Recti tr) {
+            child().paint(tg, tr);
+        });
+    }
+
+    void bubble(App::Event& e) override {
+        if (auto pe = e.is<Node::PaintEvent>())
+            _tiles.invalidate(pe->bound);
+
+        ProxyNode::bubble(e);
+    }
+
+    void layout(Math::Recti r) override {
+        _tiles.invalidate();
+        ProxyNode::layout(r);
+    }
+};
+
+Child tiled(Child child) {
+    return makeRc<Tiled>(child);
+}
+
 } // namespace Karm::Ui
@@ -59,4 +59,22 @@ inline auto vclip() {
     };
 }
 
+// MARK: Tiled -----------------------------------------------------------------
+
+// Retain the rasterized content of the child in a tile cache, at the pixel
+// density of the host, so that scrolling or partial repaints only blit the
+// tiles back instead of re-rendering the whole child. Tiles are invalidated
+// when the child requests a repaint, and on layout and reconcile.
+//
+// NOTE: The child is rendered on a transparent background, so this is only
+//       suitable for content that doesn't read back what is underneath it
+//       (eg. backdrop filters).
+Child tiled(Child child);
+
+inline auto tiled() {
+    return [](Child child) {
+        return tiled(child);
+    };
+}
+
 } // namespace Karm::Ui
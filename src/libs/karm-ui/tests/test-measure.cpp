@@ -0,0 +1,103 @@
+#include <karm-test/macros.h>
+#include <karm-ui/funcs.h>
+
+namespace Karm::Ui::Tests {
+
+// A leaf counting how many times its size was actually computed.
+struct Sized : public LeafNode<Sized> {
+    Math::Vec2i value;
+    usize computed = 0;
+
+    Sized(Math::Vec2i value) : value(value) {}
+
+    void reconcile(Sized& o) override {
+        value = o.value;
+    }
+
+    Math::Vec2i size(Math::Vec2i s, Hint hint) override {
+        computed++;
+        if (hint == Hint::MAX)
+            return s;
+        return value;
+    }
+};
+
+struct Proxy : public ProxyNode<Proxy> {
+    using ProxyNode::ProxyNode;
+};
+
+test$("measure-cache-hit") {
+    Sized node{{10, 20}};
+    auto before = measureStats();
+
+    expectEq$(node.measure({100, 100}, Hint::MIN), (Math::Vec2i{10, 20}));
+    expectEq$(node.measure({100, 100}, Hint::MIN), (Math::Vec2i{10, 20}));
+    expectEq$(node.computed, 1uz);
+
+    auto after = measureStats();
+    expectEq$(after.calls - before.calls, 2uz);
+    expectEq$(after.hits - before.hits, 1uz);
+
+    // Another constraint or hint is another entry
+    expectEq$(node.measure({50, 50}, Hint::MAX), (Math::Vec2i{50, 50}));
+    expectEq$(node.measure({100, 100}, Hint::MAX), (Math::Vec2i{100, 100}));
+    expectEq$(node.computed, 3uz);
+
+    return Ok();
+}
+
+test$("measure-cache-eviction") {
+    Sized node{{10, 20}};
+
+    // Filling every way, then one more, pushes out the oldest entry only
+    for (isize i = 0; i <= (isize)Node::MEASURE_WAYS; i++)
+        node.measure({i, i}, Hint::MIN);
+    expectEq$(node.computed, Node::MEASURE_WAYS + 1);
+
+    node.measure({(isize)Node::MEASURE_WAYS, (isize)Node::MEASURE_WAYS}, Hint::MIN);
+    node.measure({1, 1}, Hint::MIN);
+    expectEq$(node.computed, Node::MEASURE_WAYS + 1);
+
+    node.measure({0, 0}, Hint::MIN);
+    expectEq$(node.computed, Node::MEASURE_WAYS + 2);
+
+    return Ok();
+}
+
+test$("measure-invalidate-on-reconcile") {
+    Child node = makeRc<Sized>(Math::Vec2i{10, 20});
+    auto& sized = node.unwrap<Sized>();
+
+    expectEq$(node->measure({100, 100}, Hint::MIN), (Math::Vec2i{10, 20}));
+
+    // The new tree has another size, the old measure must not stick
+    expect$(not node->reconcile(makeRc<Sized>(Math::Vec2i{30, 40})));
+    expectEq$(node->measure({100, 100}, Hint::MIN), (Math::Vec2i{30, 40}));
+    expectEq$(sized.computed, 2uz);
+
+    return Ok();
+}
+
+test$("measure-invalidate-on-layout") {
+    auto leaf = makeRc<Sized>(Math::Vec2i{10, 20});
+    auto& sized = leaf.unwrap<Sized>();
+    Proxy proxy{leaf};
+
+    expectEq$(proxy.measure({100, 100}, Hint::MIN), (Math::Vec2i{10, 20}));
+    expectEq$(proxy.measure({100, 100}, Hint::MIN), (Math::Vec2i{10, 20}));
+    expectEq$(sized.computed, 1uz);
+
+    // Changing the size behind the cache's back goes unnoticed...
+    sized.value = {30, 40};
+    expectEq$(proxy.measure({100, 100}, Hint::MIN), (Math::Vec2i{10, 20}));
+
+    // ...until the leaf asks for a layout, which clears every measure on
+    // the way up
+    shouldLayout(sized);
+    expectEq$(proxy.measure({100, 100}, Hint::MIN), (Math::Vec2i{30, 40}));
+    expectEq$(sized.computed, 2uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Ui::Tests
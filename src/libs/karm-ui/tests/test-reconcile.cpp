@@ -0,0 +1,201 @@
+#include <karm-test/macros.h>
+#include <karm-ui/node.h>
+
+namespace Karm::Ui::Tests {
+
+// A leaf with some state of its own, which survives reconciliation, and a
+// value, which is taken from the new tree.
+struct Item : public LeafNode<Item> {
+    isize value;
+    isize state = 0;
+
+    Item(isize value) : value(value) {}
+
+    void reconcile(Item& o) override {
+        value = o.value;
+    }
+};
+
+struct Other : public LeafNode<Other> {};
+
+struct Group : public GroupNode<Group> {
+    using GroupNode::GroupNode;
+};
+
+static Child _item(isize value) {
+    return makeRc<Item>(value);
+}
+
+static Child _keyed(isize k, isize value) {
+    return _item(value) | key(k);
+}
+
+static Item& _as(Child child) {
+    return child.unwrap<Item>();
+}
+
+// Give every child of `group` a distinct state, to tell them apart once
+// they have been reconciled.
+static void _mark(Group& group) {
+    for (usize i = 0; i < group.children().len(); i++)
+        _as(group.children()[i]).state = 100 + i;
+}
+
+static Res<> _reconcile(Group& group, Children children) {
+    Child next = makeRc<Group>(children);
+    Node& node = group;
+    if (node.reconcile(next))
+        return Error::other("group was replaced");
+    return Ok();
+}
+
+test$("group-reconcile-keyed-reorder") {
+    Group group{{_keyed(1, 10), _keyed(2, 20), _keyed(3, 30)}};
+    _mark(group);
+    Array<Node*, 3> old = {
+        &group.children()[0].unwrap(),
+        &group.children()[1].unwrap(),
+        &group.children()[2].unwrap(),
+    };
+
+    try$(_reconcile(group, {_keyed(3, 31), _keyed(1, 11), _keyed(2, 21)}));
+
+    // Every node is kept, with its state, and follows its key
+    auto& us = group.children();
+    expectEq$(us.len(), 3uz);
+    expect$(&us[0].unwrap() == old[2]);
+    expect$(&us[1].unwrap() == old[0]);
+    expect$(&us[2].unwrap() == old[1]);
+
+    expectEq$(_as(us[0]).state, 102);
+    expectEq$(_as(us[1]).state, 100);
+    expectEq$(_as(us[2]).state, 101);
+
+    // Values come from the new tree
+    expectEq$(_as(us[0]).value, 31);
+    expectEq$(_as(us[1]).value, 11);
+    expectEq$(_as(us[2]).value, 21);
+
+    for (auto& c : us)
+        expect$(c->parent() == &group);
+
+    return Ok();
+}
+
+test$("group-reconcile-keyed-insert-remove") {
+    Group group{{_keyed(1, 10), _keyed(2, 20), _keyed(3, 30)}};
+    _mark(group);
+    auto removed = group.children()[1];
+
+    auto inserted = _keyed(4, 40);
+    try$(_reconcile(group, {_keyed(1, 10), inserted, _keyed(3, 30), _keyed(5, 50)}));
+
+    auto& us = group.children();
+    expectEq$(us.len(), 4uz);
+    expectEq$(_as(us[0]).state, 100);
+    expectEq$(_as(us[2]).state, 102);
+
+    // New keys take the new nodes as they are
+    expect$(&us[1].unwrap() == &inserted.unwrap());
+    expectEq$(_as(us[1]).state, 0);
+    expectEq$(_as(us[3]).value, 50);
+    expect$(us[3]->parent() == &group);
+
+    // Dropped keys are detached
+    expect$(removed->parent() == nullptr);
+
+    return Ok();
+}
+
+test$("group-reconcile-keyed-mismatch") {
+    Group group{{_keyed(1, 10), _keyed(2, 20)}};
+    _mark(group);
+    auto old = group.children()[1];
+
+    // Same key, another type, the old node can't be reused
+    auto other = makeRc<Other>() | key(2);
+    try$(_reconcile(group, {_keyed(1, 11), other}));
+
+    auto& us = group.children();
+    expectEq$(_as(us[0]).state, 100);
+    expect$(&us[1].unwrap() == &other.unwrap());
+    expect$(us[1]->parent() == &group);
+    expect$(old->parent() == nullptr);
+
+    return Ok();
+}
+
+test$("group-reconcile-keyed-duplicates") {
+    Group group{{_keyed(1, 10), _keyed(2, 20)}};
+    _mark(group);
+
+    // Only the first child with a key gets the old node
+    try$(_reconcile(group, {_keyed(2, 21), _keyed(2, 22), _keyed(1, 11)}));
+
+    auto& us = group.children();
+    expectEq$(us.len(), 3uz);
+    expectEq$(_as(us[0]).state, 101);
+    expectEq$(_as(us[0]).value, 21);
+    expectEq$(_as(us[1]).state, 0);
+    expectEq$(_as(us[1]).value, 22);
+    expectEq$(_as(us[2]).state, 100);
+
+    return Ok();
+}
+
+test$("group-reconcile-keyed-anagrams") {
+    // Keys made of the same runes in another order are still different keys
+    Group group{{_item(10) | key("ab"s), _item(20) | key("ba"s)}};
+    _mark(group);
+
+    try$(_reconcile(group, {_item(21) | key("ba"s), _item(11) | key("ab"s)}));
+
+    auto& us = group.children();
+    expectEq$(us.len(), 2uz);
+    expectEq$(_as(us[0]).state, 101);
+    expectEq$(_as(us[0]).value, 21);
+    expectEq$(_as(us[1]).state, 100);
+    expectEq$(_as(us[1]).value, 11);
+
+    return Ok();
+}
+
+test$("group-reconcile-mixed") {
+    Group group{{_item(10), _keyed(1, 20), _item(30)}};
+    _mark(group);
+
+    // Children without a key are matched in order with the old ones
+    // without a key, whatever the keyed ones around them do
+    try$(_reconcile(group, {_keyed(1, 21), _item(11), _keyed(2, 40), _item(31), _item(50)}));
+
+    auto& us = group.children();
+    expectEq$(us.len(), 5uz);
+    expectEq$(_as(us[0]).state, 101);
+    expectEq$(_as(us[1]).state, 100);
+    expectEq$(_as(us[1]).value, 11);
+    expectEq$(_as(us[2]).state, 0);
+    expectEq$(_as(us[3]).state, 102);
+    expectEq$(_as(us[3]).value, 31);
+    expectEq$(_as(us[4]).state, 0);
+
+    return Ok();
+}
+
+test$("group-reconcile-unkeyed") {
+    Group group{{_item(10), _item(20), _item(30)}};
+    _mark(group);
+
+    // Without keys, children are matched by position
+    try$(_reconcile(group, {_item(30), _item(10)}));
+
+    auto& us = group.children();
+    expectEq$(us.len(), 2uz);
+    expectEq$(_as(us[0]).state, 100);
+    expectEq$(_as(us[0]).value, 30);
+    expectEq$(_as(us[1]).state, 101);
+    expectEq$(_as(us[1]).value, 10);
+
+    return Ok();
+}
+
+} // namespace Karm::Ui::Tests
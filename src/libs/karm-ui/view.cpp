@@ -314,7 +314,7 @@ struct Image : public View<Image> {
             g.fillStyle(_image.pixels());
             g.fill(bound(), *_radii);
         } else {
-            g.blit(bound(), _image);
+            g.blit(bound(), _image.surface());
         }
 
         g.pop();
@@ -8,6 +8,10 @@ namespace Grund::Bus::Api {
 struct Locate {
     using Response = Rpc::Port;
     String id;
+
+    // Also request a direct connection to the service, it's handed over
+    // as an Rpc::Peer message ahead of the response.
+    bool direct = false;
 };
 
 struct Listen {
@@ -121,7 +121,7 @@ Async::Task<> Service::runAsync() {
 
         if (msg.is<Api::Listen>()) {
             auto listen = co_try$(msg.unpack<Api::Listen>());
-            _listen.pushBack(listen.mid);
+            _bus->listen(port(), listen.mid);
         } else {
             auto res = dispatch(msg);
             if (not res) {
@@ -139,10 +139,6 @@ Res<> Service::send(Rpc::Message& msg) {
     );
 }
 
-bool Service::accept(Rpc::Message const& msg) {
-    return contains(_listen, msg.header().mid);
-}
-
 // MARK: System ----------------------------------------------------------------
 
 System::System() {
@@ -156,15 +152,12 @@ Str System::id() const {
 Res<> System::send(Rpc::Message& msg) {
     if (msg.is<Api::Locate>()) {
         auto locate = try$(msg.unpack<Api::Locate>());
-        for (auto& endpoint : _bus->_endpoints) {
-            if (endpoint->id() == locate.id) {
-                auto resp = try$(msg.packResp<Api::Locate>(endpoint->port()));
-                try$(dispatch(resp));
-                return Ok();
-            }
-        }
-
-        return Error::notFound("service not found");
+        auto endpoint = try$(_bus->locate(locate.id));
+        if (locate.direct)
+            try$(_bus->link(msg.header().from, endpoint->port()));
+        auto resp = try$(msg.packResp<Api::Locate>(endpoint->port()));
+        try$(dispatch(resp));
+        return Ok();
     } else if (msg.is<Api::Start>()) {
         auto start = try$(msg.unpack<Api::Start>());
         logDebug("starting service '{}'", start.id);
@@ -197,17 +190,100 @@ Res<> Bus::prepareActivateService(Str id) {
 Res<> Bus::attach(Rc<Endpoint> endpoint) {
     endpoint->attach(*this);
     _endpoints.pushBack(endpoint);
+    _ports.put(endpoint->port(), endpoint);
+    if (not endpoint->filtersBroadcasts())
+        _unfiltered.pushBack(endpoint->port());
+    return Ok();
+}
+
+Res<Rc<Endpoint>> Bus::locate(Str id) {
+    for (auto& endpoint : _endpoints)
+        if (endpoint->id() == id)
+            return Ok(endpoint);
+    return Error::notFound("service not found");
+}
+
+void Bus::listen(Rpc::Port port, Meta::Id mid) {
+    if (not _subscribers.has(mid))
+        _subscribers.put(mid, {});
+
+    auto& subscribers = _subscribers.get(mid);
+    if (not contains(subscribers, port))
+        subscribers.pushBack(port);
+}
+
+static Res<> _sendPeer(Endpoint& endpoint, Rpc::Port port, Rc<Sys::Fd> fd) {
+    auto msg = try$(Rpc::Message::packReq<Rpc::Peer>(endpoint.port(), 0, port, fd));
+    msg.header().from = Rpc::Port::BUS;
+    return endpoint.send(msg);
+}
+
+Res<> Bus::link(Rpc::Port a, Rpc::Port b) {
+    auto ea = _ports.tryGet(a);
+    auto eb = _ports.tryGet(b);
+    if (not ea or not eb)
+        return Error::notFound("service not found");
+
+    if (a == Rpc::Port::BUS or b == Rpc::Port::BUS or a == b)
+        return Error::invalidInput("cannot link endpoint");
+
+    // NOTE: Linking again would leave both sides with a connection they
+    //       no longer use, and a task still waiting on it.
+    if (_linked(a, b))
+        return Ok();
+
+    auto ab = try$(Hj::Channel::create(Hj::Domain::self(), kib(16), 16));
+    try$(ab.label(Io::format("{}-{}", (*ea)->id(), (*eb)->id())));
+    auto ba = try$(Hj::Channel::create(Hj::Domain::self(), kib(16), 16));
+    try$(ba.label(Io::format("{}-{}", (*eb)->id(), (*ea)->id())));
+
+    // NOTE: Each side needs its own capability to both channels.
+    Hj::Channel abDup{try$(Hj::Domain::self().attach(ab))};
+    Hj::Channel baDup{try$(Hj::Domain::self().attach(ba))};
+
+    Rc<Sys::Fd> fda = makeRc<Skift::IpcFd>(std::move(ba), std::move(ab));
+    Rc<Sys::Fd> fdb = makeRc<Skift::IpcFd>(std::move(abDup), std::move(baDup));
+
+    try$(_sendPeer(**eb, a, fdb));
+    try$(_sendPeer(**ea, b, fda));
+
+    auto record = [&](Rpc::Port from, Rpc::Port to) {
+        if (not _links.has(from))
+            _links.put(from, {});
+        _links.get(from).pushBack(to);
+    };
+    record(a, b);
+    record(b, a);
+
     return Ok();
 }
 
+bool Bus::_linked(Rpc::Port a, Rpc::Port b) {
+    auto links = _links.access(a);
+    return links and contains(*links, b);
+}
+
 void Bus::_broadcast(Rpc::Message& msg) {
-    for (auto& endpoint : _endpoints) {
-        if (msg.header().from != endpoint->port() and endpoint->accept(msg)) {
-            auto res = endpoint->send(msg);
-            if (not res)
-                logError("{}: send failed: {}", endpoint->id(), res);
-        }
-    }
+    auto send = [&](Rpc::Port port) {
+        if (port == msg.header().from)
+            return;
+
+        auto endpoint = _ports.access(port);
+        if (not endpoint)
+            return;
+
+        auto res = (*endpoint)->send(msg);
+        if (not res)
+            logError("{}: send failed: {}", (*endpoint)->id(), res);
+    };
+
+    // NOTE: Only services subscribe, so no endpoint is in both lists.
+    for (auto port : _unfiltered)
+        send(port);
+
+    if (auto subscribers = _subscribers.access(msg.header().mid))
+        for (auto port : *subscribers)
+            send(port);
 }
 
 Res<> Bus::dispatch(Rpc::Message& msg) {
@@ -216,19 +292,17 @@ Res<> Bus::dispatch(Rpc::Message& msg) {
         return Ok();
     }
 
-    for (auto& endpoint : _endpoints) {
-        if (endpoint->port() == msg.header().to) {
-            auto res = endpoint->send(msg);
-            if (not res) {
-                logError("{}: send failed: {}", endpoint->id(), res);
-                return res;
-            }
+    auto endpoint = _ports.access(msg.header().to);
+    if (not endpoint)
+        return Error::notFound("service not found");
 
-            return Ok();
-        }
+    auto res = (*endpoint)->send(msg);
+    if (not res) {
+        logError("{}: send failed: {}", (*endpoint)->id(), res);
+        return res;
     }
 
-    return Error::notFound("service not found");
+    return Ok();
 }
 
 } // namespace Grund::Bus
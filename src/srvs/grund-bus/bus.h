@@ -2,6 +2,7 @@
 
 #include <hjert-api/api.h>
 #include <impl-skift/fd.h>
+#include <karm-base/hashmap.h>
 #include <karm-logger/logger.h>
 #include <karm-mime/url.h>
 #include <karm-rpc/base.h>
@@ -32,14 +33,15 @@ struct Endpoint : public Meta::Pinned {
 
     virtual Res<> send(Rpc::Message&) { return Ok(); }
 
-    virtual bool accept(Rpc::Message const&) { return true; }
+    // Whether the endpoint only gets the broadcasts it subscribed to with
+    // Api::Listen, rather than all of them.
+    virtual bool filtersBroadcasts() const { return false; }
 
     virtual Res<> activate(Sys::Context&) { return Ok(); }
 };
 
 struct Service : public Endpoint {
     String _id;
-    Vec<Meta::Id> _listen;
     Rc<Skift::IpcFd> _ipc;
     Sys::IpcConnection _con;
     Opt<Hj::Task> _task = NONE;
@@ -58,7 +60,7 @@ struct Service : public Endpoint {
 
     Res<> send(Rpc::Message& msg) override;
 
-    bool accept(Rpc::Message const& msg) override;
+    bool filtersBroadcasts() const override { return true; }
 };
 
 struct System : public Endpoint {
@@ -73,6 +75,11 @@ struct Bus : public Meta::Pinned {
     Sys::Context& _context;
 
     Vec<Rc<Endpoint>> _endpoints{};
+    HashMap<Rpc::Port, Rc<Endpoint>> _ports{};
+    HashMap<Meta::Id, Vec<Rpc::Port>> _subscribers{};
+    // Endpoints getting every broadcast, whatever they subscribed to.
+    Vec<Rpc::Port> _unfiltered{};
+    HashMap<Rpc::Port, Vec<Rpc::Port>> _links{};
 
     Bus(Sys::Context& ctx)
         : _context(ctx) {}
@@ -81,6 +88,17 @@ struct Bus : public Meta::Pinned {
 
     Res<> attach(Rc<Endpoint> endpoint);
 
+    Res<Rc<Endpoint>> locate(Str id);
+
+    void listen(Rpc::Port port, Meta::Id mid);
+
+    // Create a pair of channels between two endpoints and hand each of
+    // them its end, so they can talk without going through the bus. Linked
+    // endpoints keep their channels, linking them again does nothing.
+    Res<> link(Rpc::Port a, Rpc::Port b);
+
+    bool _linked(Rpc::Port a, Rpc::Port b);
+
     void _broadcast(Rpc::Message& msg);
 
     Res<> dispatch(Rpc::Message& msg);
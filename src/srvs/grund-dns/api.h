@@ -0,0 +1,38 @@
+#pragma once
+
+#include <karm-base/string.h>
+#include <karm-base/vec.h>
+#include <karm-io/pack.h>
+#include <karm-sys/addr.h>
+
+namespace Grund::Dns::Api {
+
+struct Resolve {
+    using Response = Vec<Sys::Ip>;
+    String host;
+};
+
+} // namespace Grund::Dns::Api
+
+// NOTE: Addresses have no default value to unpack into, so they go over the
+//       wire as their kind followed by their raw bytes.
+template <>
+struct Karm::Io::Packer<Karm::Sys::Ip> {
+    static Res<> pack(PackEmit& e, Karm::Sys::Ip const& val) {
+        if (auto ip4 = val.is<Karm::Sys::Ip4>()) {
+            try$(Io::pack<u8>(e, 4));
+            return Io::pack(e, ip4->bytes);
+        }
+        try$(Io::pack<u8>(e, 6));
+        return Io::pack(e, val.unwrap<Karm::Sys::Ip6>().words);
+    }
+
+    static Res<Karm::Sys::Ip> unpack(PackScan& s) {
+        auto kind = try$(Io::unpack<u8>(s));
+        if (kind == 4)
+            return Ok(Karm::Sys::Ip4{try$((Io::unpack<Array<u8, 4>>(s)))});
+        if (kind == 6)
+            return Ok(Karm::Sys::Ip6{try$((Io::unpack<Array<u16, 8>>(s)))});
+        return Error::invalidData("invalid ip address kind");
+    }
+};
@@ -1,26 +1,46 @@
+#include <karm-net/dns/resolver.h>
 #include <karm-rpc/base.h>
 #include <karm-sys/entry.h>
 
-#include "../grund-bus/api.h"
-#include "../grund-echo/api.h"
+#include "api.h"
 
 namespace Grund::Dns {
 
-Async::Task<> serv(Sys::Context& ctx) {
-    auto endpoint = Rpc::Endpoint::create(ctx);
-
-    logDebug("sending nonsens to system");
+Async::Task<> _resolveAsync(Rpc::Endpoint& endpoint, Rc<Net::Dns::Resolver> resolver, Rpc::Message msg) {
+    auto req = co_try$(msg.unpack<Api::Resolve>());
+    auto res = co_await resolver->resolveAsync(req.host);
+    co_return endpoint.resp<Api::Resolve>(msg, res);
+}
 
-    auto echoPort = co_trya$(endpoint.callAsync<Bus::Api::Locate>(Rpc::Port::BUS, "grund-echo"s));
-    logDebug("located echo service at port: {}", echoPort);
+// NOTE: The resolver is only created once a lookup comes in, and again on
+//       the next one if that failed, so the service keeps running and
+//       answers with the error where there is no network to resolve over.
+static Res<Rc<Net::Dns::Resolver>> _ensureResolver(Opt<Rc<Net::Dns::Resolver>>& resolver) {
+    if (not resolver)
+        resolver = try$(Net::Dns::Resolver::create());
+    return Ok(*resolver);
+}
 
-    auto res = co_trya$(endpoint.callAsync<Echo::Api::Request>(echoPort, "nonsens"s));
-    logDebug("received response from system: {}", res);
+Async::Task<> serv(Sys::Context& ctx) {
+    auto endpoint = Rpc::Endpoint::create(ctx);
+    Opt<Rc<Net::Dns::Resolver>> resolver;
 
     logInfo("service started");
     while (true) {
-        co_trya$(endpoint.recvAsync());
-        logDebug("received message from system");
+        auto msg = co_trya$(endpoint.recvAsync());
+        if (not msg.is<Api::Resolve>())
+            continue;
+
+        auto res = _ensureResolver(resolver);
+        if (not res) {
+            logError("could not create resolver: {}", res.none());
+            co_try$(endpoint.resp<Api::Resolve>(msg, res.none()));
+            continue;
+        }
+
+        // NOTE: Lookups are served concurrently, a slow name doesn't hold
+        //       back the others, and the same name is only asked once.
+        Async::detach(_resolveAsync(endpoint, res.take(), msg));
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/time.h>
 #include <karm-math/vec.h>
 #include <karm-rpc/base.h>
 
@@ -12,4 +13,17 @@ struct CreateInstance {
     Math::Vec2i size;
 };
 
+struct FrameStats {
+    usize frames;
+    Duration lastFrameTime;
+    Duration totalFrameTime;
+    usize lastCopiedBytes;
+    usize totalCopiedBytes;
+};
+
+// Query the compositor frame counters, used by hideo-sysmon.
+struct GetFrameStats {
+    using Response = FrameStats;
+};
+
 } // namespace Grund::Shell::Api
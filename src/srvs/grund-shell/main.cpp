@@ -1,6 +1,7 @@
 #include <hideo-shell/app.h>
 #include <hideo-shell/mock.h>
 #include <karm-app/host.h>
+#include <karm-async/queue.h>
 #include <karm-gfx/cpu/canvas.h>
 #include <karm-image/loader.h>
 #include <karm-rpc/base.h>
@@ -21,6 +22,14 @@ struct Root : public Ui::ProxyNode<Root> {
     Rc<Gfx::CpuSurface> _frontbuffer;
     Rc<Gfx::Surface> _backbuffer;
     bool _shouldLayout{};
+    bool _shouldAnimate{};
+
+    // Set while the frame loop is waiting for something to happen,
+    // `_wake()` pushes to `_wakeup` to get it going again.
+    bool _idle{};
+    Async::Queue<bool> _wakeup;
+
+    Api::FrameStats _stats{};
 
     Root(Ui::Child child, Rc<Gfx::CpuSurface> frontbuffer)
         : Ui::ProxyNode<Root>(std::move(child)),
@@ -29,6 +38,8 @@ struct Root : public Ui::ProxyNode<Root> {
     }
 
     void _repaint() {
+        auto start = Sys::instant();
+
         Gfx::CpuCanvas g;
         g.begin(*_backbuffer);
         for (auto& r : _dirty) {
@@ -38,24 +49,47 @@ struct Root : public Ui::ProxyNode<Root> {
             g.clip(r.cast<f64>());
             paint(g, r);
             g.pop();
-
-            Gfx::blitUnsafe(_frontbuffer->mutPixels(), _backbuffer->pixels());
         }
         g.end();
 
+        // Only present what was repainted.
+        usize copied = 0;
+        for (auto& r : _dirty) {
+            auto clipped = _backbuffer->bound().clipTo(r);
+            Gfx::blitUnsafe(
+                _frontbuffer->mutPixels().clip(clipped),
+                _backbuffer->pixels().clip(clipped)
+            );
+            copied += clipped.width * clipped.height * _backbuffer->_fmt.bpp();
+        }
+
         _dirty.clear();
+
+        auto elapsed = Sys::instant() - start;
+        _stats.frames++;
+        _stats.lastFrameTime = elapsed;
+        _stats.totalFrameTime += elapsed;
+        _stats.lastCopiedBytes = copied;
+        _stats.totalCopiedBytes += copied;
+    }
+
+    void _wake() {
+        if (not _idle)
+            return;
+        _idle = false;
+        _wakeup.enqueue(true);
     }
 
     Async::Task<> run() {
         _shouldLayout = true;
 
-        auto lastFrame = Sys::instant();
+        auto nextFrame = Sys::instant();
         while (true) {
-            auto frameStart = Sys::instant();
-            while (lastFrame < frameStart) {
+            if (_shouldAnimate and Sys::instant() >= nextFrame) {
+                _shouldAnimate = false;
                 auto e = App::makeEvent<Node::AnimateEvent>(Ui::FRAME_TIME);
                 event(*e);
-                lastFrame += 16_ms;
+                nextFrame = Sys::instant() + 16_ms;
             }
 
             if (_shouldLayout) {
@@ -69,7 +103,14 @@ struct Root : public Ui::ProxyNode<Root> {
                 _repaint();
             }
 
-            co_trya$(Sys::globalSched().sleepAsync(lastFrame + 16_ms));
+            if (_shouldAnimate) {
+                co_trya$(Sys::globalSched().sleepAsync(nextFrame));
+            } else if (not _shouldLayout and _dirty.len() == 0) {
+                // NOTE: Nothing is animating, sleep until an event
+                //       damages the screen or asks for a frame.
+                _idle = true;
+                co_await _wakeup.dequeueAsync();
+            }
         }
     }
 
@@ -91,11 +132,15 @@ struct Root : public Ui::ProxyNode<Root> {
     void bubble(App::Event& event) override {
         if (auto e = event.is<Node::PaintEvent>()) {
             _damage(e->bound);
+            _wake();
             event.accept();
         } else if (auto e = event.is<Node::LayoutEvent>()) {
             _shouldLayout = true;
+            _wake();
             event.accept();
         } else if (auto e = event.is<Node::AnimateEvent>()) {
+            _shouldAnimate = true;
+            _wake();
             event.accept();
         } else if (auto e = event.is<App::RequestExitEvent>()) {
             event.accept();
@@ -167,6 +212,8 @@ Async::Task<> servAsync(Sys::Context& ctx) {
             instance->bound = {100, call.size};
             Hideo::Shell::Model::event(*root, Hideo::Shell::AddInstance{instance});
             (void)msg.packResp<Api::CreateInstance>(0uz);
+        } else if (msg.is<Api::GetFrameStats>()) {
+            co_try$(endpoint.resp<Api::GetFrameStats>(msg, Ok(root->_stats)));
         } else {
             logWarn("unsupported event: {}", msg.header());
         }
@@ -15,10 +15,12 @@ struct CharacterData : public Node {
     }
 
     void appendData(String const& s) {
+        _generation++;
         _data.append(s);
     }
 
     void appendData(Rune rune) {
+        _generation++;
         _data.append(rune);
     }
 
@@ -55,6 +55,7 @@ struct Element : public Node {
     }
 
     void setAttribute(AttrName name, String value) {
+        _generation++;
         if (name == Html::CLASS_ATTR) {
             for (auto class_ : iterSplit(value, ' ')) {
                 this->classList.add(class_);
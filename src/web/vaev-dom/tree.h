@@ -13,6 +13,11 @@ enum struct Iter {
 
 template <typename Node>
 struct Tree : Meta::Pinned {
+    // NOTE: Bumped on every mutation of any tree, this is used to know when
+    //       cached style and layout results are stale. It's shared between
+    //       all documents, which is conservative but cheap to maintain.
+    static inline usize _generation = 0;
+
     Gc::Ptr<Node> _parent = nullptr;
     Gc::Ptr<Node> _firstChild = nullptr;
     Gc::Ptr<Node> _lastChild = nullptr;
@@ -21,6 +26,8 @@ struct Tree : Meta::Pinned {
 
     // Accessor ----------------------------------------------------------------
 
+    static usize generation() { return _generation; }
+
     usize index() const {
         usize index = 0;
         for (auto node = previousSibling();
@@ -58,6 +65,8 @@ struct Tree : Meta::Pinned {
     // Insertion & Deletion ----------------------------------------------------
 
     void appendChild(Gc::Ptr<Node> node) {
+        _generation++;
+
         if (node->_parent)
             panic("node already has a parent");
 
@@ -71,6 +80,8 @@ struct Tree : Meta::Pinned {
     }
 
     void prependChild(Gc::Ptr<Node> node) {
+        _generation++;
+
         if (node->_parent)
             panic("node already has a parent");
 
@@ -93,6 +104,8 @@ struct Tree : Meta::Pinned {
         if (node->_parent)
             panic("node already has a parent");
 
+        _generation++;
+
         node->_prevSibling = child->_prevSibling;
         node->_nextSibling = child;
 
@@ -114,6 +127,8 @@ struct Tree : Meta::Pinned {
         if (node->_parent)
             panic("node already has a parent");
 
+        _generation++;
+
         node->_prevSibling = child;
         node->_nextSibling = child->_nextSibling;
 
@@ -129,6 +144,8 @@ struct Tree : Meta::Pinned {
     }
 
     void removeChild(Node* node) {
+        _generation++;
+
         if (node->_parent != this)
             panic("node is not a child");
 
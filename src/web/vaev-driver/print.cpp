@@ -371,4 +371,11 @@ Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings const&
     }
 }
 
+Res<> print(Gc::Ref<Dom::Document> dom, Print::Settings const& settings, Print::FilePrinter& printer) {
+    auto pages = print(dom, settings);
+    while (auto page = pages.next())
+        page->print(printer, {.showBackgroundGraphics = settings.backgroundGraphics});
+    return printer.finish();
+}
+
 } // namespace Vaev::Driver
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-print/file-printer.h>
 #include <karm-print/page.h>
 #include <karm-print/printer.h>
 #include <vaev-dom/document.h>
@@ -8,4 +9,7 @@ namespace Vaev::Driver {
 
 Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings const& settings);
 
+// Print the document into `printer` a page at a time, and finish the file.
+Res<> print(Gc::Ref<Dom::Document> dom, Print::Settings const& settings, Print::FilePrinter& printer);
+
 } // namespace Vaev::Driver
@@ -14,25 +14,33 @@ namespace Vaev::Driver {
 
 static constexpr bool DEBUG_RENDER = false;
 
-RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport) {
-    Style::StyleBook stylebook;
-    stylebook.add(
+static Layout::Input _rootInput(Layout::Viewport viewport) {
+    return {
+        .knownSize = {viewport.small.width, NONE},
+        .availableSpace = {viewport.small.width, 0_au},
+        .containingBlock = {viewport.small.width, viewport.small.height},
+    };
+}
+
+LayoutResult layout(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport) {
+    auto stylebook = makeRc<Style::StyleBook>();
+    stylebook->add(
         fetchStylesheet("bundle://vaev-driver/html.css"_url, Style::Origin::USER_AGENT)
             .take("user agent stylesheet not available")
     );
 
     auto start = Sys::now();
-    fetchStylesheets(dom, stylebook);
+    fetchStylesheets(dom, *stylebook);
     auto elapsed = Sys::now() - start;
     logDebugIf(DEBUG_RENDER, "style collection time: {}", elapsed);
 
     start = Sys::now();
 
-    Style::Computer computer{media, stylebook};
-    Layout::Tree tree = {
+    Style::Computer computer{media, *stylebook};
+    auto tree = makeRc<Layout::Tree>(Layout::Tree{
         Layout::build(computer, dom),
         viewport,
-    };
+    });
 
     elapsed = Sys::now() - start;
 
@@ -40,33 +48,40 @@ RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layou
 
     start = Sys::now();
 
-    auto [outDiscovery, root] = Layout::layoutCreateFragment(
-        tree,
-        {
-            .knownSize = {viewport.small.width, NONE},
-            .availableSpace = {viewport.small.width, 0_au},
-            .containingBlock = {viewport.small.width, viewport.small.height},
-        }
-    );
-
-    auto sceneRoot = makeRc<Scene::Stack>();
+    auto [output, root] = Layout::layoutCreateFragment(*tree, _rootInput(viewport));
 
     elapsed = Sys::now() - start;
     logDebugIf(DEBUG_RENDER, "layout tree layout time: {}", elapsed);
 
-    auto paintStart = Sys::now();
-    Layout::paint(root, *sceneRoot);
+    return {
+        stylebook,
+        tree,
+        output,
+        makeRc<Layout::Frag>(std::move(root)),
+    };
+}
+
+RenderResult render(LayoutResult& layout) {
+    auto start = Sys::now();
+
+    auto sceneRoot = makeRc<Scene::Stack>();
+    Layout::paint(*layout.frag, *sceneRoot);
     sceneRoot->prepare();
 
-    elapsed = Sys::now() - paintStart;
+    auto elapsed = Sys::now() - start;
     logDebugIf(DEBUG_RENDER, "layout tree paint time: {}", elapsed);
 
     return {
-        std::move(stylebook),
-        makeRc<Layout::Box>(std::move(tree.root)),
+        layout.style,
+        layout.tree,
         sceneRoot,
-        makeRc<Layout::Frag>(std::move(root))
+        layout.frag,
     };
 }
 
+RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport) {
+    auto laidOut = layout(dom, media, viewport);
+    return render(laidOut);
+}
+
 } // namespace Vaev::Driver
@@ -8,13 +8,26 @@
 
 namespace Vaev::Driver {
 
+struct LayoutResult {
+    Rc<Style::StyleBook> style;
+    Rc<Layout::Tree> tree;
+    Layout::Output output;
+    Rc<Layout::Frag> frag;
+};
+
 struct RenderResult {
-    Style::StyleBook style;
-    Rc<Layout::Box> layout;
+    Rc<Style::StyleBook> style;
+    Rc<Layout::Tree> layout;
     Rc<Scene::Node> scenes;
     Rc<Layout::Frag> frag;
 };
 
+// Run the style and layout passes, stopping before the scene is painted.
+LayoutResult layout(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport);
+
+// Paint the scene of an already laid out document from its fragments.
+RenderResult render(LayoutResult& layout);
+
 RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media, Layout::Viewport viewport);
 
 } // namespace Vaev::Driver
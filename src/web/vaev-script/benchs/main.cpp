@@ -0,0 +1,98 @@
+#include <karm-base/map.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-script/properties.h>
+
+using namespace Vaev;
+
+// Every object gets the same properties in the same order, the way objects
+// built by a constructor or an object literal do, then one of them is read
+// back from all of them.
+
+static constexpr usize OBJECTS = 1'000'000;
+
+static Array<Script::PropertyKey, 5> _keys() {
+    return {
+        Script::PropertyKey::from(u"a"_s16),
+        Script::PropertyKey::from(u"b"_s16),
+        Script::PropertyKey::from(u"c"_s16),
+        Script::PropertyKey::from(u"d"_s16),
+        Script::PropertyKey::from(u"x"_s16),
+    };
+}
+
+static constexpr Script::PropertyAttributes ATTRS = {true, true, true};
+
+static void report(Str name, Duration elapsed, f64 sum) {
+    f64 ns = (elapsed.toUSecs() * 1000.0) / OBJECTS;
+    Sys::println("{}: {} ({} ns/access, sum {})", name, elapsed, ns, sum);
+}
+
+// The previous layout, every object carries its own list of keys.
+static void benchLinear() {
+    auto keys = _keys();
+    Vec<Map<Script::PropertyKey, Script::PropertyStorage::Property>> objects;
+    objects.ensure(OBJECTS);
+    for (usize i = 0; i < OBJECTS; i++) {
+        Map<Script::PropertyKey, Script::PropertyStorage::Property> props;
+        for (auto& key : keys)
+            props.put(key, {Script::Value{Script::Number{(f64)i}}, ATTRS});
+        objects.pushBack(std::move(props));
+    }
+
+    auto start = Sys::instant();
+    f64 sum = 0;
+    for (auto& props : objects)
+        sum += props.get(last(keys)).value.unwrap<Script::Value>().asNumber()._val;
+    report("linear map", Sys::instant() - start, sum);
+}
+
+static Vec<Script::PropertyStorage> _build() {
+    auto keys = _keys();
+    Vec<Script::PropertyStorage> objects;
+    objects.ensure(OBJECTS);
+    for (usize i = 0; i < OBJECTS; i++) {
+        Script::PropertyStorage storage;
+        for (auto& key : keys)
+            storage.set(key, {Script::Value{Script::Number{(f64)i}}, ATTRS});
+        objects.pushBack(std::move(storage));
+    }
+    return objects;
+}
+
+static void benchShape(Vec<Script::PropertyStorage>& objects) {
+    auto key = last(_keys());
+    auto start = Sys::instant();
+    f64 sum = 0;
+    for (auto& storage : objects)
+        sum += storage.get(key)->value.unwrap<Script::Value>().asNumber()._val;
+    report("shape lookup", Sys::instant() - start, sum);
+}
+
+static void benchInlineCache(Vec<Script::PropertyStorage>& objects) {
+    auto key = last(_keys());
+    Script::InlineCache cache;
+    auto start = Sys::instant();
+    f64 sum = 0;
+    for (auto& storage : objects)
+        sum += cache.get(storage, key)->asNumber()._val;
+    report("inline cache get", Sys::instant() - start, sum);
+
+    start = Sys::instant();
+    for (auto& storage : objects)
+        cache.set(storage, key, Script::Number{1.0});
+    report("inline cache set", Sys::instant() - start, OBJECTS);
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    benchLinear();
+
+    auto start = Sys::instant();
+    auto objects = _build();
+    Sys::println("built {} objects in {}, shared shape: {}", OBJECTS, Sys::instant() - start, first(objects).shape().id() == last(objects).shape().id());
+
+    benchShape(objects);
+    benchInlineCache(objects);
+
+    co_return Ok();
+}
@@ -0,0 +1,123 @@
+#include "bytecode.h"
+
+namespace Vaev::Script {
+
+// MARK: Instructions ----------------------------------------------------------
+
+Format formatOf(Opcode op) {
+    switch (op) {
+#define ITER(NAME, FORMAT) \
+    case Opcode::NAME:     \
+        return Format::FORMAT;
+        FOREACH_OPCODE(ITER)
+#undef ITER
+    default:
+        panic("invalid opcode");
+    }
+}
+
+Str nameOf(Opcode op) {
+    switch (op) {
+#define ITER(NAME, ...) \
+    case Opcode::NAME:  \
+        return #NAME;
+        FOREACH_OPCODE(ITER)
+#undef ITER
+    default:
+        panic("invalid opcode");
+    }
+}
+
+void Inst::repr(Io::Emit& e) const {
+    auto name = nameOf(op());
+    e(name);
+    for (usize i = name.len(); i < 18; i++)
+        e(" ");
+
+    switch (formatOf(op())) {
+    case Format::NONE:
+        break;
+
+    case Format::A:
+        e("r{}", a());
+        break;
+
+    case Format::AB:
+        e("r{}, r{}", a(), b());
+        break;
+
+    case Format::ABC:
+        e("r{}, r{}, r{}", a(), b(), c());
+        break;
+
+    case Format::ABX:
+        e("r{}, {}", a(), bx());
+        break;
+
+    case Format::ASBX:
+        e("r{}, {}", a(), sbx());
+        break;
+
+    case Format::SBX:
+        e("{}", sbx());
+        break;
+    }
+}
+
+// MARK: Functions -------------------------------------------------------------
+
+void Function::disassemble(Io::Emit& e) const {
+    e("function {} (params: {}, registers: {})\n", name, params, registers);
+
+    for (usize i = 0; i < constants.len(); i++)
+        e("    k{} = {}\n", i, constants[i]);
+
+    for (usize i = 0; i < sites.len(); i++)
+        e("    s{} = {}\n", i, sites[i].key.store);
+
+    for (usize pc = 0; pc < code.len(); pc++) {
+        auto inst = code[pc];
+        e("    {04}  {}", pc, inst);
+
+        // Annotate operands that refer to something other than a register.
+        switch (inst.op()) {
+        case Opcode::LOAD_CONST:
+            e("    ; {}", constants[inst.bx()]);
+            break;
+
+        case Opcode::GET_PROP:
+            e("    ; .{}", sites[inst.c()].key.store);
+            break;
+
+        case Opcode::SET_PROP:
+            e("    ; .{}", sites[inst.b()].key.store);
+            break;
+
+        case Opcode::JMP:
+        case Opcode::JMP_IF_TRUE:
+        case Opcode::JMP_IF_FALSE:
+            e("    ; -> {04}", (isize)pc + 1 + inst.sbx());
+            break;
+
+        default:
+            break;
+        }
+
+        e("\n");
+    }
+}
+
+void Module::disassemble(Io::Emit& e) const {
+    for (usize i = 0; i < globals.len(); i++)
+        e("global g{} = {}\n", i, globals[i]);
+
+    for (usize i = 0; i < functions.len(); i++) {
+        e("\n");
+        if (i == entry)
+            e("; entry\n");
+        e("fn{}: ", i);
+        functions[i]->disassemble(e);
+    }
+}
+
+} // namespace Vaev::Script
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <karm-base/rc.h>
+#include <karm-base/vec.h>
+#include <karm-io/emit.h>
+
+#include "properties.h"
+#include "value.h"
+
+namespace Vaev::Script {
+
+// MARK: Instructions ----------------------------------------------------------
+
+// Instructions are 32 bits wide, the opcode is in the low byte followed by
+// up to three 8 bits operands (A, B, C), or by A and a 16 bits operand (Bx)
+// which is signed (sBx) for jumps. Operands name registers of the current
+// frame, or indices in the function's constants, sites, globals or in the
+// module's functions.
+//
+//   ABC   [ op | A | B | C ]
+//   ABx   [ op | A | Bx    ]
+//   sBx   [ op | - | sBx   ]
+
+#define FOREACH_FORMAT(FORMAT) \
+    FORMAT(NONE)               \
+    FORMAT(A)                  \
+    FORMAT(AB)                 \
+    FORMAT(ABC)                \
+    FORMAT(ABX)                \
+    FORMAT(ASBX)               \
+    FORMAT(SBX)
+
+// OP(NAME, FORMAT)
+#define FOREACH_OPCODE(OP)                                         \
+    OP(NOP, NONE)              /* */                               \
+    OP(LOAD_UNDEFINED, A)      /* r[A] = undefined */              \
+    OP(LOAD_NULL, A)           /* r[A] = null */                   \
+    OP(LOAD_TRUE, A)           /* r[A] = true */                   \
+    OP(LOAD_FALSE, A)          /* r[A] = false */                  \
+    OP(LOAD_INT, ASBX)         /* r[A] = sBx */                    \
+    OP(LOAD_CONST, ABX)        /* r[A] = k[Bx] */                  \
+    OP(MOVE, AB)               /* r[A] = r[B] */                   \
+    OP(GET_GLOBAL, ABX)        /* r[A] = g[Bx] */                  \
+    OP(SET_GLOBAL, ABX)        /* g[Bx] = r[A] */                  \
+    OP(ADD, ABC)               /* r[A] = r[B] + r[C] */            \
+    OP(SUB, ABC)               /* r[A] = r[B] - r[C] */            \
+    OP(MUL, ABC)               /* r[A] = r[B] * r[C] */            \
+    OP(DIV, ABC)               /* r[A] = r[B] / r[C] */            \
+    OP(MOD, ABC)               /* r[A] = r[B] % r[C] */            \
+    OP(NEG, AB)                /* r[A] = -r[B] */                  \
+    OP(NOT, AB)                /* r[A] = !r[B] */                  \
+    OP(INC, A)                 /* r[A] = r[A] + 1 */               \
+    OP(LT, ABC)                /* r[A] = r[B] < r[C] */            \
+    OP(LE, ABC)                /* r[A] = r[B] <= r[C] */           \
+    OP(EQ, ABC)                /* r[A] = r[B] === r[C] */          \
+    OP(NE, ABC)                /* r[A] = r[B] !== r[C] */          \
+    OP(JMP, SBX)               /* pc += sBx */                     \
+    OP(JMP_IF_TRUE, ASBX)      /* if (r[A]) pc += sBx */           \
+    OP(JMP_IF_FALSE, ASBX)     /* if (!r[A]) pc += sBx */          \
+    OP(NEW_OBJECT, A)          /* r[A] = {} */                     \
+    OP(GET_PROP, ABC)          /* r[A] = r[B][site[C]] */          \
+    OP(SET_PROP, ABC)          /* r[A][site[B]] = r[C] */          \
+    OP(CALL, ABC)              /* r[A] = fn[B](r[A+1]..r[A+C]) */  \
+    OP(RETURN, A)              /* return r[A] */                   \
+    OP(RETURN_UNDEFINED, NONE) /* return undefined */
+
+enum struct Format : u8 {
+#define ITER(NAME) NAME,
+    FOREACH_FORMAT(ITER)
+#undef ITER
+};
+
+enum struct Opcode : u8 {
+#define ITER(NAME, ...) NAME,
+    FOREACH_OPCODE(ITER)
+#undef ITER
+
+    _LEN,
+};
+
+Format formatOf(Opcode op);
+
+Str nameOf(Opcode op);
+
+using Reg = u8;
+
+struct Inst {
+    static constexpr isize SBX_BIAS = 0x7fff;
+
+    u32 _raw;
+
+    static Inst abc(Opcode op, u8 a = 0, u8 b = 0, u8 c = 0) {
+        return {(u32)op | (u32)a << 8 | (u32)b << 16 | (u32)c << 24};
+    }
+
+    static Inst abx(Opcode op, u8 a, u16 bx) {
+        return {(u32)op | (u32)a << 8 | (u32)bx << 16};
+    }
+
+    static Inst asbx(Opcode op, u8 a, isize sbx) {
+        return abx(op, a, (u16)(sbx + SBX_BIAS));
+    }
+
+    always_inline Opcode op() const { return (Opcode)(_raw & 0xff); }
+
+    always_inline u8 a() const { return (_raw >> 8) & 0xff; }
+
+    always_inline u8 b() const { return (_raw >> 16) & 0xff; }
+
+    always_inline u8 c() const { return (_raw >> 24) & 0xff; }
+
+    always_inline u16 bx() const { return _raw >> 16; }
+
+    always_inline isize sbx() const { return (isize)bx() - SBX_BIAS; }
+
+    void repr(Io::Emit& e) const;
+};
+
+static_assert(sizeof(Inst) == 4);
+
+// MARK: Functions -------------------------------------------------------------
+
+// A property access site, the key is resolved at compile time, and the
+// cache remembers where it was found on the last shapes seen at that site.
+struct Site {
+    PropertyKey key;
+    InlineCache cache = {};
+};
+
+struct Function {
+    String name;
+    usize params = 0;
+    // Number of registers of a frame, parameters come first.
+    usize registers = 0;
+    Vec<Inst> code;
+    Vec<Value> constants;
+    Vec<Site> sites;
+
+    void disassemble(Io::Emit& e) const;
+};
+
+// A compilation unit, functions refer to each other and to globals by
+// index, names only exist at compile time.
+struct Module {
+    Vec<Rc<Function>> functions;
+    Vec<String> globals;
+
+    // The function run when the module is evaluated.
+    usize entry = 0;
+
+    void disassemble(Io::Emit& e) const;
+};
+
+} // namespace Vaev::Script
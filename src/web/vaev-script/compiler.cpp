@@ -0,0 +1,171 @@
+#include "compiler.h"
+
+namespace Vaev::Script {
+
+// MARK: Module Builder --------------------------------------------------------
+
+Res<u16> ModuleBuilder::global(String const& name) {
+    if (auto slot = _globals.tryGet(name))
+        return Ok((u16)*slot);
+
+    usize slot = _mod.globals.len();
+    if (slot > Limits<u16>::MAX)
+        return Error::invalidInput("too many globals");
+
+    _mod.globals.pushBack(name);
+    _globals.put(name, slot);
+    return Ok((u16)slot);
+}
+
+Res<u8> ModuleBuilder::declare(String const& name) {
+    if (_functions.has(name))
+        return Error::invalidInput("function already declared");
+
+    usize index = _mod.functions.len();
+    if (index > Limits<u8>::MAX)
+        return Error::invalidInput("too many functions");
+
+    _mod.functions.pushBack(makeRc<Function>(Function{.name = name}));
+    _functions.put(name, index);
+    return Ok((u8)index);
+}
+
+Opt<u8> ModuleBuilder::lookup(String const& name) const {
+    if (auto index = _functions.tryGet(name))
+        return (u8)*index;
+    return NONE;
+}
+
+// MARK: Function Builder ------------------------------------------------------
+
+Res<Reg> FunctionBuilder::_alloc() {
+    if (_top >= MAX_REGISTERS)
+        return Error::invalidInput("too many registers");
+
+    Reg reg = (Reg)_top++;
+    _fn->registers = max(_fn->registers, _top);
+    return Ok(reg);
+}
+
+Res<Reg> FunctionBuilder::param(String name) {
+    if (_top != _fn->params)
+        return Error::invalidInput("parameters must be declared first");
+
+    auto reg = try$(_alloc());
+    _locals.pushBack({name, reg});
+    _fn->params++;
+    return Ok(reg);
+}
+
+Res<Reg> FunctionBuilder::local(String name) {
+    auto reg = try$(_alloc());
+    _locals.pushBack({name, reg});
+    return Ok(reg);
+}
+
+void FunctionBuilder::endScope() {
+    auto start = _scopes.popBack();
+    if (start < _locals.len())
+        _top = _locals[start].reg;
+    _locals.trunc(start);
+}
+
+Opt<Reg> FunctionBuilder::resolve(String const& name) const {
+    for (usize i = _locals.len(); i > 0; i--)
+        if (_locals[i - 1].name == name)
+            return _locals[i - 1].reg;
+    return NONE;
+}
+
+Res<u16> FunctionBuilder::constant(Value value) {
+    auto& constants = _fn->constants;
+
+    // NOTE: Only numbers and strings are deduplicated, they are the
+    //       only constants that can be compared without side effects.
+    //       Numbers are compared bit for bit, -0 and +0 are equal but
+    //       not the same constant.
+    for (usize i = 0; i < constants.len(); i++) {
+        auto const& k = constants[i];
+        if (k.isNumber() and value.isNumber() and
+            __builtin_bit_cast(u64, k.asNumber()._val) == __builtin_bit_cast(u64, value.asNumber()._val))
+            return Ok((u16)i);
+
+        if (k.isString() and value.isString() and
+            k.asString() == value.asString())
+            return Ok((u16)i);
+    }
+
+    usize index = constants.len();
+    if (index > Limits<u16>::MAX)
+        return Error::invalidInput("too many constants");
+
+    constants.pushBack(value);
+    return Ok((u16)index);
+}
+
+Res<u8> FunctionBuilder::site(PropertyKey key) {
+    auto& sites = _fn->sites;
+    usize index = sites.len();
+    if (index > Limits<u8>::MAX)
+        return Error::invalidInput("too many property sites");
+
+    // NOTE: Sites are never shared, even for the same key, every access
+    //       gets its own cache so it only sees the shapes flowing through it.
+    sites.pushBack({key});
+    return Ok((u8)index);
+}
+
+Res<> FunctionBuilder::patch(Jump jump, Label target) {
+    isize offset = (isize)target.pc - (isize)(jump.pc + 1);
+    if (offset < -Inst::SBX_BIAS or offset > Inst::SBX_BIAS)
+        return Error::invalidInput("jump too far");
+
+    auto& inst = _fn->code[jump.pc];
+    inst = Inst::asbx(inst.op(), inst.a(), offset);
+    return Ok();
+}
+
+Res<> FunctionBuilder::loadNumber(Reg dst, f64 value) {
+    // NOTE: Converting a number that doesn't fit an integer is undefined,
+    //       the range is checked first, which NaN fails too.
+    if (value >= -Inst::SBX_BIAS and value <= Inst::SBX_BIAS) {
+        isize i = (isize)value;
+        if ((f64)i == value and not(value == 0 and __builtin_signbit(value))) {
+            emit(Inst::asbx(Opcode::LOAD_INT, dst, i));
+            return Ok();
+        }
+    }
+
+    emit(Inst::abx(Opcode::LOAD_CONST, dst, try$(constant(Number{value}))));
+    return Ok();
+}
+
+Res<> FunctionBuilder::load(Reg dst, String const& name) {
+    if (auto reg = resolve(name)) {
+        if (*reg != dst)
+            emit(Inst::abc(Opcode::MOVE, dst, *reg));
+        return Ok();
+    }
+
+    emit(Inst::abx(Opcode::GET_GLOBAL, dst, try$(_mod.global(name))));
+    return Ok();
+}
+
+Res<> FunctionBuilder::store(String const& name, Reg src) {
+    if (auto reg = resolve(name)) {
+        if (*reg != src)
+            emit(Inst::abc(Opcode::MOVE, *reg, src));
+        return Ok();
+    }
+
+    emit(Inst::abx(Opcode::SET_GLOBAL, src, try$(_mod.global(name))));
+    return Ok();
+}
+
+Rc<Function> FunctionBuilder::finish() {
+    // Falling off the end of a function returns undefined.
+    emit(Inst::abc(Opcode::RETURN_UNDEFINED));
+    return _fn;
+}
+
+} // namespace Vaev::Script
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <karm-base/map.h>
+#include <karm-base/res.h>
+
+#include "bytecode.h"
+
+namespace Vaev::Script {
+
+// MARK: Module Builder --------------------------------------------------------
+
+// Interns the globals and functions of a module, so they can be referenced
+// by index from the code.
+struct ModuleBuilder {
+    Module _mod;
+    Map<String, usize> _globals;
+    Map<String, usize> _functions;
+
+    // Resolve a global to its slot, declaring it on first use.
+    Res<u16> global(String const& name);
+
+    // Reserve an index for a function, so it can be called before, or while
+    // it's being built.
+    Res<u8> declare(String const& name);
+
+    Opt<u8> lookup(String const& name) const;
+
+    void define(u8 index, Rc<Function> fn) {
+        _mod.functions[index] = fn;
+    }
+
+    Module finish(u8 entry) {
+        _mod.entry = entry;
+        return std::move(_mod);
+    }
+};
+
+// MARK: Function Builder ------------------------------------------------------
+
+struct Label {
+    usize pc;
+};
+
+struct Jump {
+    usize pc;
+};
+
+// Lowers a function to bytecode, this is the back end of the compiler.
+//
+// Registers are allocated like a stack, locals are bound to a register
+// when they are declared and stay there until their scope ends, temporaries
+// are allocated on top of them. Names are resolved here, once, innermost
+// scope first then globals, the code only ever sees register and slot
+// indices.
+struct FunctionBuilder {
+    struct Local {
+        String name;
+        Reg reg;
+    };
+
+    static constexpr usize MAX_REGISTERS = 256;
+
+    ModuleBuilder& _mod;
+    Rc<Function> _fn;
+    Vec<Local> _locals;
+    Vec<usize> _scopes;
+    usize _top = 0;
+
+    FunctionBuilder(ModuleBuilder& mod, String name)
+        : _mod(mod), _fn(makeRc<Function>(Function{.name = name})) {}
+
+    // MARK: Registers & Scopes
+
+    Res<Reg> _alloc();
+
+    // Declare a parameter, must be done before anything else.
+    Res<Reg> param(String name);
+
+    // Declare a local in the innermost scope.
+    Res<Reg> local(String name);
+
+    // Allocate a temporary register, released with `release()`.
+    Res<Reg> temp() {
+        return _alloc();
+    }
+
+    // Release every register above `reg`, including it.
+    void release(Reg reg) {
+        _top = reg;
+    }
+
+    void beginScope() {
+        _scopes.pushBack(_locals.len());
+    }
+
+    void endScope();
+
+    Opt<Reg> resolve(String const& name) const;
+
+    // MARK: Pools
+
+    Res<u16> constant(Value value);
+
+    Res<u8> site(PropertyKey key);
+
+    // MARK: Code
+
+    void emit(Inst inst) {
+        _fn->code.pushBack(inst);
+    }
+
+    Label here() const {
+        return {_fn->code.len()};
+    }
+
+    // Emit a forward jump, to be patched once the target is known.
+    Jump jump(Opcode op, Reg cond = 0) {
+        auto pc = _fn->code.len();
+        emit(Inst::asbx(op, cond, 0));
+        return {pc};
+    }
+
+    Res<> patch(Jump jump, Label target);
+
+    Res<> patch(Jump jump) {
+        return patch(jump, here());
+    }
+
+    // Emit a jump to a known, usually backward, target.
+    Res<> jumpTo(Opcode op, Reg cond, Label target) {
+        return patch(jump(op, cond), target);
+    }
+
+    // MARK: Variables
+
+    // Emit the code to load a number, small integers are encoded inline.
+    Res<> loadNumber(Reg dst, f64 value);
+
+    // Emit the code to load a variable, a local or a global.
+    Res<> load(Reg dst, String const& name);
+
+    // Emit the code to store to a variable, a local or a global.
+    Res<> store(String const& name, Reg src);
+
+    Rc<Function> finish();
+};
+
+} // namespace Vaev::Script
@@ -1,10 +1,172 @@
+#include <karm-io/text.h>
 #include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-script/compiler.h>
 #include <vaev-script/object.h>
 #include <vaev-script/realm.h>
+#include <vaev-script/vm.h>
 
 using namespace Vaev;
 
-Async::Task<> entryPointAsync(Sys::Context&) {
+// MARK: Benchmarks ------------------------------------------------------------
+
+// NOTE: There is no parser yet, the kernels are lowered by hand through the
+//       same builder the compiler front end will use, the comments show the
+//       source they stand for.
+
+static constexpr usize ITERATIONS = 10'000'000;
+
+// Emit `for (let i = 0; i < n; i++) { body }`.
+static Res<> _emitLoop(Script::FunctionBuilder& b, f64 n, auto body) {
+    b.beginScope();
+    auto i = try$(b.local(u"i"_s16));
+    auto end = try$(b.local(u"n"_s16));
+    try$(b.loadNumber(i, 0));
+    try$(b.loadNumber(end, n));
+
+    auto cond = try$(b.temp());
+    auto loop = b.here();
+    b.emit(Script::Inst::abc(Script::Opcode::LT, cond, i, end));
+    auto exit = b.jump(Script::Opcode::JMP_IF_FALSE, cond);
+    b.release(cond);
+
+    try$(body(i));
+
+    b.emit(Script::Inst::abc(Script::Opcode::INC, i));
+    try$(b.jumpTo(Script::Opcode::JMP, 0, loop));
+    try$(b.patch(exit));
+    b.endScope();
+    return Ok();
+}
+
+// let s = 0;
+// for (let i = 0; i < n; i++) s = s + i;
+// result = s;
+static Res<Script::Module> _kernelLoop() {
+    Script::ModuleBuilder m;
+    auto entry = try$(m.declare(u"main"_s16));
+
+    Script::FunctionBuilder b{m, u"main"_s16};
+    auto s = try$(b.local(u"s"_s16));
+    try$(b.loadNumber(s, 0));
+    try$(_emitLoop(b, ITERATIONS, [&](Script::Reg i) -> Res<> {
+        b.emit(Script::Inst::abc(Script::Opcode::ADD, s, s, i));
+        return Ok();
+    }));
+    try$(b.store(u"result"_s16, s));
+    b.emit(Script::Inst::abc(Script::Opcode::RETURN, s));
+
+    m.define(entry, b.finish());
+    return Ok(m.finish(entry));
+}
+
+// let o = {};
+// o.x = 0;
+// for (let i = 0; i < n; i++) o.x = o.x + 1;
+// return o.x;
+static Res<Script::Module> _kernelProperty() {
+    Script::ModuleBuilder m;
+    auto entry = try$(m.declare(u"main"_s16));
+
+    Script::FunctionBuilder b{m, u"main"_s16};
+    auto o = try$(b.local(u"o"_s16));
+    auto one = try$(b.local(u"one"_s16));
+    b.emit(Script::Inst::abc(Script::Opcode::NEW_OBJECT, o));
+    try$(b.loadNumber(one, 1));
+
+    auto x = Script::PropertyKey::from(u"x"_s16);
+    auto t = try$(b.temp());
+    try$(b.loadNumber(t, 0));
+    b.emit(Script::Inst::abc(Script::Opcode::SET_PROP, o, try$(b.site(x)), t));
+    b.release(t);
+
+    try$(_emitLoop(b, ITERATIONS, [&](Script::Reg) -> Res<> {
+        auto v = try$(b.temp());
+        b.emit(Script::Inst::abc(Script::Opcode::GET_PROP, v, o, try$(b.site(x))));
+        b.emit(Script::Inst::abc(Script::Opcode::ADD, v, v, one));
+        b.emit(Script::Inst::abc(Script::Opcode::SET_PROP, o, try$(b.site(x)), v));
+        b.release(v);
+        return Ok();
+    }));
+
+    auto res = try$(b.temp());
+    b.emit(Script::Inst::abc(Script::Opcode::GET_PROP, res, o, try$(b.site(x))));
+    b.emit(Script::Inst::abc(Script::Opcode::RETURN, res));
+
+    m.define(entry, b.finish());
+    return Ok(m.finish(entry));
+}
+
+// function add(a, b) { return a + b; }
+// let s = 0;
+// for (let i = 0; i < n; i++) s = add(s, i);
+// return s;
+static Res<Script::Module> _kernelCall() {
+    Script::ModuleBuilder m;
+    auto entry = try$(m.declare(u"main"_s16));
+    auto add = try$(m.declare(u"add"_s16));
+
+    {
+        Script::FunctionBuilder b{m, u"add"_s16};
+        auto lhs = try$(b.param(u"a"_s16));
+        auto rhs = try$(b.param(u"b"_s16));
+        auto t = try$(b.temp());
+        b.emit(Script::Inst::abc(Script::Opcode::ADD, t, lhs, rhs));
+        b.emit(Script::Inst::abc(Script::Opcode::RETURN, t));
+        m.define(add, b.finish());
+    }
+
+    Script::FunctionBuilder b{m, u"main"_s16};
+    auto s = try$(b.local(u"s"_s16));
+    try$(b.loadNumber(s, 0));
+    try$(_emitLoop(b, ITERATIONS, [&](Script::Reg i) -> Res<> {
+        auto ret = try$(b.temp());
+        auto arg0 = try$(b.temp());
+        auto arg1 = try$(b.temp());
+        try$(b.load(arg0, u"s"_s16));
+        b.emit(Script::Inst::abc(Script::Opcode::MOVE, arg1, i));
+        b.emit(Script::Inst::abc(Script::Opcode::CALL, ret, add, 2));
+        try$(b.store(u"s"_s16, ret));
+        b.release(ret);
+        return Ok();
+    }));
+    b.emit(Script::Inst::abc(Script::Opcode::RETURN, s));
+
+    m.define(entry, b.finish());
+    return Ok(m.finish(entry));
+}
+
+static Res<> _bench(Gc::Ref<Script::Agent> agent, Str name, Script::Module mod, bool disassemble) {
+    if (disassemble) {
+        Io::StringWriter sw;
+        Io::Emit e{sw};
+        mod.disassemble(e);
+        Sys::println("{}", sw.take());
+    }
+
+    Script::Vm vm{*agent, mod};
+    auto start = Sys::instant();
+    auto res = vm.run();
+    auto elapsed = Sys::instant() - start;
+
+    if (not res)
+        return Error::other("script threw an exception");
+
+    f64 secs = elapsed.toUSecs() / 1e6;
+    Sys::println(
+        "{}: {} in {} ({} Mops/s, {} Miter/s), result {}",
+        name, vm.ops, elapsed,
+        vm.ops / secs / 1e6,
+        ITERATIONS / secs / 1e6,
+        res.unwrap()
+    );
+    return Ok();
+}
+
+// MARK: Entry Point -----------------------------------------------------------
+
+Async::Task<> entryPointAsync(Sys::Context& ctx) {
+    auto& args = Sys::useArgs(ctx);
     Gc::Heap heap;
 
     auto agent = heap.alloc<Script::Agent>(heap);
@@ -12,6 +174,14 @@ Async::Task<> entryPointAsync(Sys::Context&) {
 
     (void)realm->initializeHostDefinedRealm(agent);
 
+    if (args.has("--bench")) {
+        bool disassemble = args.has("--disassemble");
+        co_try$(_bench(agent, "loop", co_try$(_kernelLoop()), disassemble));
+        co_try$(_bench(agent, "property", co_try$(_kernelProperty()), disassemble));
+        co_try$(_bench(agent, "call", co_try$(_kernelCall()), disassemble));
+        co_return Ok();
+    }
+
     auto object1 = Script::Object::create(*agent);
     (void)object1->defineOwnProperty(
         Script::PropertyKey::from(u"foo"_s16),
@@ -7,6 +7,60 @@ namespace Vaev::Script {
 // MARK: Ordinary Object Ordinary Methods --------------------------------------
 // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots
 
+// https://tc39.es/ecma262/#sec-ordinarygetprototypeof
+Except<Gc::Ptr<Object>> ordinaryGetPrototypeOf(Object& self) {
+    // 1. Return O.[[Prototype]].
+    return Ok(self.prototype);
+}
+
+// https://tc39.es/ecma262/#sec-ordinaryisextensible
+Except<Boolean> ordinaryIsExtensible(Object& self) {
+    // 1. Return O.[[Extensible]].
+    return Ok(self.extensible);
+}
+
+// https://tc39.es/ecma262/#sec-ordinarygetownproperty
+Except<Opt<PropertyDescriptor>> ordinaryGetOwnProperty(Object& self, PropertyKey key) {
+    // 1. If O does not have an own property with key P, return undefined.
+    auto prop = self.propertyStorage.get(key);
+    if (not prop)
+        return Ok(NONE);
+
+    // 2. Let D be a newly created Property Descriptor with no fields.
+    PropertyDescriptor d;
+
+    // 3. Let X be O's own property whose key is P.
+    // 4. If X is a data property, then
+    if (auto value = prop->value.is<Value>()) {
+        //    a. Set D.[[Value]] to the value of X's [[Value]] attribute.
+        d.value = *value;
+
+        //    b. Set D.[[Writable]] to the value of X's [[Writable]] attribute.
+        d.writable = prop->attributes.writable;
+    }
+
+    // 5. Else,
+    else {
+        //    a. Assert: X is an accessor property.
+        auto& accessor = prop->value.unwrap<PropertyStorage::Accessor>();
+
+        //    b. Set D.[[Get]] to the value of X's [[Get]] attribute.
+        d.get = accessor.get;
+
+        //    c. Set D.[[Set]] to the value of X's [[Set]] attribute.
+        d.set = accessor.set;
+    }
+
+    // 6. Set D.[[Enumerable]] to the value of X's [[Enumerable]] attribute.
+    d.enumerable = prop->attributes.enumerable;
+
+    // 7. Set D.[[Configurable]] to the value of X's [[Configurable]] attribute.
+    d.configurable = prop->attributes.configurable;
+
+    // 8. Return D.
+    return Ok(d);
+}
+
 // https://tc39.es/ecma262/#sec-validateandapplypropertydescriptor
 static Except<Boolean> _validateAndApplyPropertyDescriptor(Gc::Ptr<Object> self, PropertyKey key, bool extensible, PropertyDescriptor desc, Opt<PropertyDescriptor> current) {
     // 1. Assert: P is a property key.
@@ -54,7 +108,7 @@ static Except<Boolean> _validateAndApplyPropertyDescriptor(Gc::Ptr<Object> self,
             object.propertyStorage.set(
                 key,
                 {
-                    .value = desc.value,
+                    .value = desc.value.unwrapOr(undefined),
                     .attributes = {
                         .writable = desc.writable.unwrapOr(false),
                         .enumerable = desc.enumerable.unwrapOr(false),
@@ -122,6 +176,25 @@ static Except<Boolean> _validateAndApplyPropertyDescriptor(Gc::Ptr<Object> self,
             //    c. Else,
         } else {
             //       i. For each field of Desc, set the corresponding attribute of the property named P of object O to the value of the field.
+            auto& object = *self;
+            auto prop = object.propertyStorage.get(key).unwrap();
+            if (auto accessor = prop.value.is<PropertyStorage::Accessor>()) {
+                if (desc.get)
+                    accessor->get = *desc.get;
+                if (desc.set)
+                    accessor->set = *desc.set;
+            } else if (desc.value) {
+                prop.value = *desc.value;
+            }
+
+            if (desc.writable)
+                prop.attributes.writable = *desc.writable;
+            if (desc.enumerable)
+                prop.attributes.enumerable = *desc.enumerable;
+            if (desc.configurable)
+                prop.attributes.configurable = *desc.configurable;
+
+            object.propertyStorage.set(key, prop);
         }
     }
     // 7. Return true.
@@ -146,7 +219,7 @@ Except<Value> ordinaryGet(Object& self, PropertyKey key, Value receiver) {
     auto maybeDesc = try$(self.getOwnProperty(key));
 
     // 2. If desc is undefined, then
-    if (maybeDesc == undefined) {
+    if (not maybeDesc) {
         //    a. Let parent be ? O.[[GetPrototypeOf]]().
         auto parent = try$(self.getPrototypeOf());
 
@@ -162,7 +235,7 @@ Except<Value> ordinaryGet(Object& self, PropertyKey key, Value receiver) {
 
     // 3. If IsDataDescriptor(desc) is true, return desc.[[Value]].
     if (desc.isDataDescriptor())
-        return Ok(desc.value);
+        return Ok(desc.value.unwrapOr(undefined));
 
     // 4. Assert: IsAccessorDescriptor(desc) is true.
     if (not desc.isAccessorDescriptor())
@@ -179,6 +252,93 @@ Except<Value> ordinaryGet(Object& self, PropertyKey key, Value receiver) {
     return Script::call(self.agent, *getter, receiver);
 }
 
+// https://tc39.es/ecma262/#sec-ordinaryset
+Except<Boolean> ordinarySet(Object& self, PropertyKey key, Value v, Value receiver) {
+    // 1. Let ownDesc be ? O.[[GetOwnProperty]](P).
+    auto ownDesc = try$(self.getOwnProperty(key));
+
+    // 2. Return ? OrdinarySetWithOwnDescriptor(O, P, V, Receiver, ownDesc).
+    return ordinarySetWithOwnDescriptor(self, key, v, receiver, ownDesc);
+}
+
+// https://tc39.es/ecma262/#sec-ordinarysetwithowndescriptor
+Except<Boolean> ordinarySetWithOwnDescriptor(Object& self, PropertyKey key, Value v, Value receiver, Opt<PropertyDescriptor> ownDesc) {
+    // 1. If ownDesc is undefined, then
+    if (not ownDesc) {
+        //    a. Let parent be ? O.[[GetPrototypeOf]]().
+        auto parent = try$(self.getPrototypeOf());
+
+        //    b. If parent is not null, return ? parent.[[Set]](P, V, Receiver).
+        if (parent != NONE)
+            return parent->set(key, v, receiver);
+
+        //    c. Set ownDesc to the PropertyDescriptor { [[Value]]: undefined, [[Writable]]: true, [[Enumerable]]: true, [[Configurable]]: true }.
+        ownDesc = PropertyDescriptor{
+            .value = undefined,
+            .writable = true,
+            .enumerable = true,
+            .configurable = true,
+        };
+    }
+
+    // 2. If IsDataDescriptor(ownDesc) is true, then
+    if (ownDesc->isDataDescriptor()) {
+        //    a. If ownDesc.[[Writable]] is false, return false.
+        if (not ownDesc->writable.unwrapOr(false))
+            return Ok(false);
+
+        //    b. If Receiver is not an Object, return false.
+        if (not receiver.isObject())
+            return Ok(false);
+        auto object = receiver.asObject();
+
+        //    c. Let existingDescriptor be ? Receiver.[[GetOwnProperty]](P).
+        auto existingDescriptor = try$(object->getOwnProperty(key));
+
+        //    d. If existingDescriptor is not undefined, then
+        if (existingDescriptor) {
+            //       i. If IsAccessorDescriptor(existingDescriptor) is true, return false.
+            if (existingDescriptor->isAccessorDescriptor())
+                return Ok(false);
+
+            //       ii. If existingDescriptor.[[Writable]] is false, return false.
+            if (not existingDescriptor->writable.unwrapOr(false))
+                return Ok(false);
+
+            //       iii. Let valueDesc be the PropertyDescriptor { [[Value]]: V }.
+            //       iv. Return ? Receiver.[[DefineOwnProperty]](P, valueDesc).
+            return object->defineOwnProperty(key, {.value = v});
+        }
+
+        //    e. Else,
+        //       i. Assert: Receiver does not currently have a property P.
+        //       ii. Return ? CreateDataProperty(Receiver, P, V).
+        return object->defineOwnProperty(
+            key,
+            {
+                .value = v,
+                .writable = true,
+                .enumerable = true,
+                .configurable = true,
+            }
+        );
+    }
+
+    // 3. Assert: IsAccessorDescriptor(ownDesc) is true.
+    // 4. Let setter be ownDesc.[[Set]].
+    auto setter = ownDesc->set;
+
+    // 5. If setter is undefined, return false.
+    if (setter == NONE or *setter == nullptr)
+        return Ok(false);
+
+    // 6. Perform ? Call(setter, Receiver, « V »).
+    try$(Script::call(self.agent, *setter, receiver, {&v, 1}));
+
+    // 7. Return true.
+    return Ok(true);
+}
+
 // MARK: The Object Type -------------------------------------------------------
 // https://tc39.es/ecma262/#sec-object-type
 
@@ -16,25 +16,35 @@ struct Object;
 // MARK: Ordinary Object Internal Methods and Internal Slots -------------------
 // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots
 
+Except<Gc::Ptr<Object>> ordinaryGetPrototypeOf(Object& self);
+
+Except<Boolean> ordinaryIsExtensible(Object& self);
+
+Except<Opt<PropertyDescriptor>> ordinaryGetOwnProperty(Object& self, PropertyKey key);
+
 Except<Boolean> ordinaryDefineOwnProperty(Object& self, PropertyKey key, PropertyDescriptor desc);
 
 Except<Value> ordinaryGet(Object& self, PropertyKey key, Value receiver);
 
+Except<Boolean> ordinarySet(Object& self, PropertyKey key, Value v, Value receiver);
+
+Except<Boolean> ordinarySetWithOwnDescriptor(Object& self, PropertyKey key, Value v, Value receiver, Opt<PropertyDescriptor> ownDesc);
+
 struct InternalMethods {
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-getprototypeof
-    Except<Gc::Ptr<Object>> (*getPrototypeOf)(Object& self) = nullptr;
+    Except<Gc::Ptr<Object>> (*getPrototypeOf)(Object& self) = ordinaryGetPrototypeOf;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-setprototypeof-v
     Except<Boolean> (*setPrototypeOf)(Object& self, Gc::Ptr<Object> v) = nullptr;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-isextensible
-    Except<Boolean> (*isExtensible)(Object& self) = nullptr;
+    Except<Boolean> (*isExtensible)(Object& self) = ordinaryIsExtensible;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-preventextensions
     Except<Boolean> (*preventExtensions)(Object& self) = nullptr;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-getownproperty-p
-    Except<Opt<PropertyDescriptor>> (*getOwnProperty)(Object& self, PropertyKey key) = nullptr;
+    Except<Opt<PropertyDescriptor>> (*getOwnProperty)(Object& self, PropertyKey key) = ordinaryGetOwnProperty;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-defineownproperty-p-desc
     Except<Boolean> (*defineOwnProperty)(Object& self, PropertyKey key, PropertyDescriptor desc) = ordinaryDefineOwnProperty;
@@ -46,7 +56,7 @@ struct InternalMethods {
     Except<Value> (*get)(Object& self, PropertyKey key, Value receiver) = ordinaryGet;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-set-p-v-receiver
-    Except<Boolean> (*set)(Object& self, PropertyKey key, Value v, Value receiver) = nullptr;
+    Except<Boolean> (*set)(Object& self, PropertyKey key, Value v, Value receiver) = ordinarySet;
 
     // https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-delete-p
     Except<Boolean> (*delete_)(Object& self, PropertyKey key) = nullptr;
@@ -74,6 +84,7 @@ struct Object {
     InternalMethods internalMethods = {};
     PropertyStorage propertyStorage = {};
     Gc::Ptr<Object> prototype = nullptr;
+    Boolean extensible = true;
 
     static Gc::Ref<Object> create(Agent& agent, _ObjectCreateArgs args = {});
 
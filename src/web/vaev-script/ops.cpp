@@ -133,8 +133,8 @@ bool sameValueNonNumber(Value x, Value y) {
     // 4. If x is a String, then
     //    a. If x and y have the same length and the same code units in the same positions, return true;
     //       otherwise, return false.
-    if (x.asString() == y.asString())
-        return true;
+    if (x.isString())
+        return x.asString() == y.asString();
 
     // 5. If x is a Boolean, then
     //    a. If x and y are both true or both false, return true; otherwise, return false.
@@ -0,0 +1,140 @@
+#include "properties.h"
+
+namespace Vaev::Script {
+
+// MARK: Shapes ----------------------------------------------------------------
+
+static u64 _nextShapeId = 0;
+
+Shape::Shape()
+    : _id(_nextShapeId++) {}
+
+Rc<Shape> Shape::root() {
+    static Rc<Shape> root = makeRc<Shape>();
+    return root;
+}
+
+Opt<usize> Shape::lookup(PropertyKey const& key) const {
+    auto const& descriptors = *_descriptors;
+    if (_len <= LINEAR_LOOKUP) {
+        for (usize i = 0; i < _len; i++)
+            if (descriptors.slots[i].key == key)
+                return i;
+        return NONE;
+    }
+
+    while (descriptors.indexed < _len) {
+        descriptors.index.put(descriptors.slots[descriptors.indexed].key, descriptors.indexed);
+        descriptors.indexed++;
+    }
+
+    // NOTE: The index is shared with the shapes further down the path,
+    //       their keys are past the end of this one.
+    auto index = descriptors.index.tryGet(key);
+    if (index and *index < _len)
+        return index;
+    return NONE;
+}
+
+Rc<Shape> Shape::withProperty(Rc<Shape> self, PropertyKey key, PropertyAttributes attributes) {
+    auto& transitions = self->_transitions;
+    for (usize i = 0; i < transitions.len(); i++) {
+        auto& t = transitions[i];
+        if (t.key != key or t.attributes != attributes)
+            continue;
+
+        if (auto shape = t.shape.upgrade())
+            return *shape;
+
+        // Every object that had this shape is gone, build it again.
+        transitions.removeAt(i);
+        break;
+    }
+
+    Slot slot = {key, attributes};
+    auto descriptors = self->_descriptors;
+    auto& slots = descriptors->slots;
+    if (slots.len() == self->_len) {
+        slots.pushBack(slot);
+    } else if (slots[self->_len] != slot) {
+        // Another path already continues from here, it keeps the shared
+        // descriptors and this one gets a copy.
+        descriptors = makeRc<Descriptors>();
+        for (usize i = 0; i < self->_len; i++)
+            descriptors->slots.pushBack(slots[i]);
+        descriptors->slots.pushBack(slot);
+    }
+
+    auto shape = makeRc<Shape>();
+    shape->_descriptors = descriptors;
+    shape->_len = self->_len + 1;
+
+    transitions.pushBack({key, attributes, shape});
+    shape->_parent = std::move(self);
+    return shape;
+}
+
+Rc<Shape> Shape::withAttributes(Rc<Shape> const& self, usize slot, PropertyAttributes attributes) {
+    auto shape = makeRc<Shape>();
+    for (usize i = 0; i < self->_len; i++)
+        shape->_descriptors->slots.pushBack(self->slot(i));
+    shape->_descriptors->slots[slot].attributes = attributes;
+    shape->_len = self->_len;
+    return shape;
+}
+
+Rc<Shape> Shape::withoutProperty(Rc<Shape> const& self, usize slot) {
+    auto shape = makeRc<Shape>();
+    for (usize i = 0; i < self->_len; i++) {
+        if (i == slot)
+            continue;
+        shape->_descriptors->slots.pushBack(self->slot(i));
+    }
+    shape->_len = self->_len - 1;
+    return shape;
+}
+
+// MARK: Property Storage ------------------------------------------------------
+
+void PropertyStorage::set(PropertyKey key, Property prop) {
+    auto index = _shape->lookup(key);
+    if (not index) {
+        _shape = Shape::withProperty(_shape, key, prop.attributes);
+        _slots.pushBack(std::move(prop.value));
+        return;
+    }
+
+    if (_shape->slot(*index).attributes != prop.attributes)
+        _shape = Shape::withAttributes(_shape, *index, prop.attributes);
+    _slots[*index] = std::move(prop.value);
+}
+
+Opt<PropertyStorage::Property> PropertyStorage::get(PropertyKey const& key) const {
+    auto index = _shape->lookup(key);
+    if (not index)
+        return NONE;
+
+    return Property{
+        _slots[*index],
+        _shape->slot(*index).attributes,
+    };
+}
+
+bool PropertyStorage::del(PropertyKey const& key) {
+    auto index = _shape->lookup(key);
+    if (not index)
+        return false;
+
+    _shape = Shape::withoutProperty(_shape, *index);
+    _slots.removeAt(*index);
+    return true;
+}
+
+Vec<PropertyKey> PropertyStorage::keys() const {
+    Vec<PropertyKey> res;
+    for (usize i = 0; i < _shape->len(); i++)
+        res.pushBack(_shape->slot(i).key);
+    return res;
+}
+
+} // namespace Vaev::Script
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <karm-base/array.h>
+#include <karm-base/hashmap.h>
+#include <karm-base/rc.h>
+
 #include "value.h"
 
 namespace Vaev::Script {
@@ -29,7 +33,7 @@ struct PropertyKey {
 
 // https://tc39.es/ecma262/#sec-property-attributes
 struct PropertyDescriptor {
-    Value value = undefined;
+    Opt<Value> value = NONE;
     Opt<Boolean> writable = NONE;
     Opt<Gc::Ptr<Object>> get = NONE;
     Opt<Gc::Ptr<Object>> set = NONE;
@@ -37,7 +41,7 @@ struct PropertyDescriptor {
     Opt<Boolean> configurable = NONE;
 
     bool empty() const {
-        return value == undefined and
+        return value == NONE and
                writable == NONE and
                get == NONE and
                set == NONE and
@@ -62,7 +66,7 @@ struct PropertyDescriptor {
         // 1. If Desc is undefined, return false.
 
         // 2. If Desc has a [[Value]] field, return true.
-        if (value != undefined)
+        if (value)
             return true;
 
         // 3. If Desc has a [[Writable]] field, return true.
@@ -87,31 +91,234 @@ struct PropertyDescriptor {
     }
 };
 
+// MARK: Shapes ----------------------------------------------------------------
+
+struct PropertyAttributes {
+    bool writable;
+    bool enumerable;
+    bool configurable;
+
+    bool operator==(PropertyAttributes const&) const = default;
+};
+
+} // namespace Vaev::Script
+
+template <>
+struct Karm::Hasher<Vaev::Script::PropertyKey> {
+    static Hash _hashStr(Vaev::Script::String const& str) {
+        return Karm::hash(Bytes{
+            reinterpret_cast<Byte const*>(str.buf()),
+            str.len() * sizeof(Vaev::Script::String::Unit),
+        });
+    }
+
+    static Hash hash(Vaev::Script::PropertyKey const& key) {
+        return key.store.visit(Visitor{
+            [](Vaev::Script::String const& str) {
+                return _hashStr(str);
+            },
+            [](Vaev::Script::Symbol const& sym) {
+                return _hashStr(sym._desc) * 31 + 1;
+            },
+            [](u64 index) {
+                return Karm::hash(index) * 31 + 2;
+            },
+        });
+    }
+};
+
+namespace Vaev::Script {
+
+// The layout of an object's own properties, aka hidden class.
+//
+// Objects that got the same properties, with the same attributes, in the
+// same order share a shape. The shape maps keys to indices in the object's
+// slot array, so objects only carry their values. Shapes form a transition
+// tree rooted at `Shape::root()`, adding a property to an object moves it to
+// the child shape for that key, which is created the first time it's needed
+// and reused by every object that follows the same path.
+//
+// Shapes along a path share one descriptor array, each only sees the first
+// `len()` slots of it, so a transition appends a single slot instead of
+// copying all of them. Small shapes are searched linearly, larger ones
+// through an index that's built lazily and shared the same way.
+//
+// Deleting a property or changing its attributes can't be expressed as a
+// transition, the object is moved to a fresh unshared shape instead.
+struct Shape {
+    static constexpr usize LINEAR_LOOKUP = 8;
+
+    struct Slot {
+        PropertyKey key;
+        PropertyAttributes attributes;
+
+        bool operator==(Slot const&) const = default;
+    };
+
+    struct Transition {
+        PropertyKey key;
+        PropertyAttributes attributes;
+        Weak<Shape> shape;
+    };
+
+    struct Descriptors {
+        Vec<Slot> slots = {};
+        // Index of the first `indexed` slots.
+        mutable HashMap<PropertyKey, usize> index = {};
+        mutable usize indexed = 0;
+    };
+
+    // NOTE: Shapes are compared by id rather than by address, so that an
+    //       inline cache never mistakes a new shape for a dead one that
+    //       happened to live at the same address.
+    u64 _id;
+    // NOTE: Transitions only hold weak references, the parent is kept
+    //       alive by its children so that the path stays there for the
+    //       next object following it.
+    Opt<Rc<Shape>> _parent = NONE;
+    Rc<Descriptors> _descriptors = makeRc<Descriptors>();
+    usize _len = 0;
+    Vec<Transition> _transitions = {};
+
+    Shape();
+
+    // The empty shape every object starts with.
+    static Rc<Shape> root();
+
+    u64 id() const {
+        return _id;
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    Slot const& slot(usize index) const {
+        return _descriptors->slots[index];
+    }
+
+    Opt<usize> lookup(PropertyKey const& key) const;
+
+    // Returns the shape of an object with `self` properties followed by `key`.
+    static Rc<Shape> withProperty(Rc<Shape> self, PropertyKey key, PropertyAttributes attributes);
+
+    // Returns an unshared copy of `self` where `slot` has different attributes.
+    static Rc<Shape> withAttributes(Rc<Shape> const& self, usize slot, PropertyAttributes attributes);
+
+    // Returns an unshared copy of `self` without `slot`, the slots after it
+    // are shifted down by one.
+    static Rc<Shape> withoutProperty(Rc<Shape> const& self, usize slot);
+};
+
+// MARK: Property Storage ------------------------------------------------------
+
 struct PropertyStorage {
     struct Accessor {
         Gc::Ptr<Object> get;
         Gc::Ptr<Object> set;
     };
 
-    struct Attributes {
-        bool writable;
-        bool enumerable;
-        bool configurable;
-    };
+    using Attributes = PropertyAttributes;
+
+    using Slot = Union<Value, Accessor>;
 
     struct Property {
-        Union<Value, Accessor> value;
+        Slot value;
         Attributes attributes;
     };
 
-    Map<PropertyKey, Property> _props;
+    Rc<Shape> _shape = Shape::root();
+    Vec<Slot> _slots = {};
+
+    Shape const& shape() const {
+        return *_shape;
+    }
 
-    void set(PropertyKey key, Property prop) {
-        _props.put(key, prop);
+    Slot& slot(usize index) {
+        return _slots[index];
     }
 
-    Opt<Property> get(PropertyKey key) {
-        return _props.tryGet(key);
+    Slot const& slot(usize index) const {
+        return _slots[index];
+    }
+
+    void set(PropertyKey key, Property prop);
+
+    Opt<Property> get(PropertyKey const& key) const;
+
+    bool del(PropertyKey const& key);
+
+    Vec<PropertyKey> keys() const;
+};
+
+// MARK: Inline Caches ---------------------------------------------------------
+
+// A per-site cache of where a property lives for the last few shapes seen
+// at that site, so repeated `o.x` on objects of the same shape skip the
+// shape lookup. Only own data properties are cached, anything else misses
+// and must go through the object's internal methods.
+struct InlineCache {
+    static constexpr usize WAYS = 4;
+
+    struct Entry {
+        u64 shape;
+        usize slot;
+    };
+
+    Array<Entry, WAYS> _entries = {};
+    usize _len = 0;
+    usize _next = 0;
+
+    Opt<usize> _probe(Shape const& shape) const {
+        for (usize i = 0; i < _len; i++)
+            if (_entries[i].shape == shape.id())
+                return _entries[i].slot;
+        return NONE;
+    }
+
+    void _fill(Shape const& shape, usize slot) {
+        // NOTE: Once every way is used, entries are replaced round robin,
+        //       megamorphic sites keep missing but stay correct.
+        _entries[_next] = {shape.id(), slot};
+        _next = (_next + 1) % WAYS;
+        _len = min(_len + 1, WAYS);
+    }
+
+    // Returns the value of an own data property, or NONE on a miss.
+    Opt<Value> get(PropertyStorage const& storage, PropertyKey const& key) {
+        auto slot = _probe(storage.shape());
+        if (not slot) {
+            slot = storage.shape().lookup(key);
+            if (not slot)
+                return NONE;
+            _fill(storage.shape(), *slot);
+        }
+
+        if (auto value = storage.slot(*slot).is<Value>())
+            return *value;
+        return NONE;
+    }
+
+    // Overwrite an existing own writable data property, returns false on
+    // a miss, in which case nothing was written.
+    bool set(PropertyStorage& storage, PropertyKey const& key, Value value) {
+        auto slot = _probe(storage.shape());
+        if (not slot) {
+            slot = storage.shape().lookup(key);
+            if (not slot)
+                return false;
+            _fill(storage.shape(), *slot);
+        }
+
+        if (not storage.shape().slot(*slot).attributes.writable)
+            return false;
+
+        auto& dest = storage.slot(*slot);
+        if (not dest.is<Value>())
+            return false;
+
+        dest = value;
+        return true;
     }
 };
 
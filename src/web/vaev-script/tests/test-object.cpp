@@ -0,0 +1,31 @@
+#include <karm-test/macros.h>
+#include <vaev-script/object.h>
+
+namespace Vaev::Script::Tests {
+
+static bool _isNumber(Value const& value, f64 expected) {
+    return value.isNumber() and value.asNumber()._val == expected;
+}
+
+test$("define-own-property-undefined-value") {
+    Gc::Heap heap;
+    auto agent = heap.alloc<Agent>(heap);
+    auto object = Object::create(*agent);
+    auto key = PropertyKey::from(u"x"_s16);
+
+    expect$(object->defineOwnProperty(key, {.value = Number{1.}, .writable = true, .configurable = true}).unwrap());
+    expect$(_isNumber(object->get(key, object).unwrap(), 1.));
+
+    // Desc has a [[Value]] field, even if it's undefined
+    expect$(object->defineOwnProperty(key, {.value = undefined}).unwrap());
+    expect$(object->get(key, object).unwrap() == undefined);
+
+    // Desc has no [[Value]] field, the value is left alone
+    expect$(object->defineOwnProperty(key, {.value = Number{2.}}).unwrap());
+    expect$(object->defineOwnProperty(key, {.writable = false}).unwrap());
+    expect$(_isNumber(object->get(key, object).unwrap(), 2.));
+
+    return Ok();
+}
+
+} // namespace Vaev::Script::Tests
@@ -0,0 +1,120 @@
+#include <karm-test/macros.h>
+#include <vaev-script/properties.h>
+
+namespace Vaev::Script::Tests {
+
+static constexpr PropertyAttributes DEFAULT = {true, true, true};
+
+static void _put(PropertyStorage& storage, u64 key, f64 value, PropertyAttributes attributes = DEFAULT) {
+    storage.set(PropertyKey::from(key), {Value{Number{value}}, attributes});
+}
+
+static Opt<f64> _get(PropertyStorage const& storage, u64 key) {
+    auto prop = storage.get(PropertyKey::from(key));
+    if (not prop)
+        return NONE;
+    return prop->value.unwrap<Value>().asNumber()._val;
+}
+
+test$("shape-transitions-shared") {
+    PropertyStorage a, b, c;
+    _put(a, 1, 1);
+    auto afterOne = a._shape;
+    _put(a, 2, 2);
+
+    // Same keys, same order, same attributes
+    _put(b, 1, 10);
+    _put(b, 2, 20);
+    expectEq$(a.shape().id(), b.shape().id());
+
+    // The whole path shares one descriptor array
+    expect$(&*afterOne->_descriptors == &*a._shape->_descriptors);
+    expectEq$(afterOne->len(), 1uz);
+    expectNot$(afterOne->lookup(PropertyKey::from(2)).has());
+
+    // A different path forks off, without disturbing the first one
+    _put(c, 1, 100);
+    _put(c, 3, 300);
+    expectNe$(c.shape().id(), a.shape().id());
+    expect$(&*c._shape->_descriptors != &*a._shape->_descriptors);
+    expectEq$(c.shape().lookup(PropertyKey::from(3)), Opt<usize>{1uz});
+    expectNot$(c.shape().lookup(PropertyKey::from(2)).has());
+    expectEq$(a.shape().lookup(PropertyKey::from(2)), Opt<usize>{1uz});
+    expectNot$(a.shape().lookup(PropertyKey::from(3)).has());
+
+    // Different attributes are a different transition
+    PropertyStorage d;
+    _put(d, 1, 1, {false, true, true});
+    expectNe$(d.shape().id(), afterOne->id());
+
+    return Ok();
+}
+
+test$("shape-slot-lookup") {
+    static constexpr usize COUNT = Shape::LINEAR_LOOKUP * 4;
+
+    PropertyStorage storage;
+    Vec<Rc<Shape>> path;
+    for (usize i = 0; i < COUNT; i++) {
+        _put(storage, i, i * 2);
+        path.pushBack(storage._shape);
+    }
+
+    for (usize i = 0; i < COUNT; i++) {
+        expectEq$(storage.shape().lookup(PropertyKey::from(i)), Opt<usize>{i});
+        expectEq$(_get(storage, i), Opt<f64>{i * 2.0});
+    }
+    expectNot$(storage.shape().lookup(PropertyKey::from(COUNT)).has());
+
+    // Shapes earlier on the path, on both sides of the linear lookup
+    // threshold, don't see the keys added after them.
+    for (usize len : {Shape::LINEAR_LOOKUP, Shape::LINEAR_LOOKUP + 3}) {
+        auto& shape = *path[len - 1];
+        expectEq$(shape.len(), len);
+        expectEq$(shape.lookup(PropertyKey::from(len - 1)), Opt<usize>{len - 1});
+        expectNot$(shape.lookup(PropertyKey::from(len)).has());
+        expectNot$(shape.lookup(PropertyKey::from(COUNT - 1)).has());
+    }
+
+    return Ok();
+}
+
+test$("shape-delete") {
+    PropertyStorage storage;
+    for (usize i = 0; i < Shape::LINEAR_LOOKUP + 4; i++)
+        _put(storage, i, i);
+
+    auto before = storage._shape;
+    expect$(storage.del(PropertyKey::from(3)));
+    expectNot$(storage.del(PropertyKey::from(3)));
+    expectNe$(storage.shape().id(), before->id());
+
+    // Slots after the deleted one move down
+    expectEq$(storage.shape().len(), Shape::LINEAR_LOOKUP + 3);
+    expectNot$(_get(storage, 3).has());
+    expectEq$(storage.shape().lookup(PropertyKey::from(4)), Opt<usize>{3uz});
+    for (usize i = 0; i < Shape::LINEAR_LOOKUP + 4; i++)
+        if (i != 3)
+            expectEq$(_get(storage, i), Opt<f64>{(f64)i});
+
+    auto keys = storage.keys();
+    expectEq$(keys.len(), Shape::LINEAR_LOOKUP + 3);
+    expect$(keys[3] == PropertyKey::from(4));
+
+    // The key can be added again, at the end
+    _put(storage, 3, 33);
+    expectEq$(storage.shape().lookup(PropertyKey::from(3)), Opt<usize>{Shape::LINEAR_LOOKUP + 3});
+    expectEq$(_get(storage, 3), Opt<f64>{33.0});
+
+    // Other objects on the original path are left alone, it's still
+    // there even if no object has the shapes along it anymore
+    PropertyStorage other;
+    for (usize i = 0; i < Shape::LINEAR_LOOKUP + 4; i++)
+        _put(other, i, i);
+    expectEq$(other.shape().id(), before->id());
+    expectEq$(other.shape().lookup(PropertyKey::from(3)), Opt<usize>{3uz});
+
+    return Ok();
+}
+
+} // namespace Vaev::Script::Tests
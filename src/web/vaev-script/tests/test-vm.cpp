@@ -0,0 +1,417 @@
+#include <karm-test/macros.h>
+#include <vaev-script/compiler.h>
+#include <vaev-script/object.h>
+#include <vaev-script/vm.h>
+
+namespace Vaev::Script::Tests {
+
+static bool _isNumber(Value const& value, f64 expected) {
+    return value.isNumber() and value.asNumber()._val == expected;
+}
+
+// Build a module with a single function, `body` emits its code.
+static Res<Module> _module(auto body) {
+    ModuleBuilder m;
+    auto entry = try$(m.declare(u"main"_s16));
+    FunctionBuilder b{m, u"main"_s16};
+    try$(body(b));
+    m.define(entry, b.finish());
+    return Ok(m.finish(entry));
+}
+
+static Opt<f64> _runNumber(Gc::Ref<Agent> agent, Module& mod) {
+    Vm vm{*agent, mod};
+    auto res = vm.run();
+    if (not res or not res.unwrap().isNumber())
+        return NONE;
+    return res.unwrap().asNumber()._val;
+}
+
+// MARK: Builder ---------------------------------------------------------------
+
+test$("builder-load-number") {
+    ModuleBuilder m;
+    FunctionBuilder b{m, u"main"_s16};
+    auto r = try$(b.temp());
+
+    try$(b.loadNumber(r, 42));
+    try$(b.loadNumber(r, -7));
+    try$(b.loadNumber(r, 1.5));
+    try$(b.loadNumber(r, -0.0));
+    try$(b.loadNumber(r, 1.5));
+
+    auto& code = b._fn->code;
+    expectEq$(code[0].op(), Opcode::LOAD_INT);
+    expectEq$(code[0].sbx(), 42);
+    expectEq$(code[1].op(), Opcode::LOAD_INT);
+    expectEq$(code[1].sbx(), -7);
+
+    // Fractions and negative zero don't fit an integer, constants are shared
+    expectEq$(code[2].op(), Opcode::LOAD_CONST);
+    expectEq$(code[3].op(), Opcode::LOAD_CONST);
+    expectEq$(code[4].bx(), code[2].bx());
+    expectEq$(b._fn->constants.len(), 2uz);
+
+    return Ok();
+}
+
+test$("builder-load-number-out-of-range") {
+    ModuleBuilder m;
+    FunctionBuilder b{m, u"main"_s16};
+    auto r = try$(b.temp());
+
+    // Too large for an integer operand, or not a number at all
+    Array<f64, 6> values = {
+        Inst::SBX_BIAS + 1.0,
+        -Inst::SBX_BIAS - 1.0,
+        1e300,
+        -1e300,
+        __builtin_inf(),
+        __builtin_nan(""),
+    };
+    for (auto v : values)
+        try$(b.loadNumber(r, v));
+
+    auto& code = b._fn->code;
+    for (usize i = 0; i < values.len(); i++)
+        expectEq$(code[i].op(), Opcode::LOAD_CONST);
+    expectEq$(b._fn->constants.len(), values.len());
+
+    // The bounds themselves still fit
+    try$(b.loadNumber(r, Inst::SBX_BIAS));
+    try$(b.loadNumber(r, -Inst::SBX_BIAS));
+    expectEq$(code[6].op(), Opcode::LOAD_INT);
+    expectEq$(code[6].sbx(), Inst::SBX_BIAS);
+    expectEq$(code[7].op(), Opcode::LOAD_INT);
+    expectEq$(code[7].sbx(), -Inst::SBX_BIAS);
+
+    return Ok();
+}
+
+test$("builder-constant-signed-zero") {
+    ModuleBuilder m;
+    FunctionBuilder b{m, u"main"_s16};
+
+    auto pos = try$(b.constant(Number{0.0}));
+    auto neg = try$(b.constant(Number{-0.0}));
+    expectNe$(pos, neg);
+    expect$(__builtin_signbit(b._fn->constants[neg].asNumber()._val));
+
+    // The same bits are still shared
+    expectEq$(try$(b.constant(Number{-0.0})), neg);
+    expectEq$(try$(b.constant(Number{0.0})), pos);
+
+    return Ok();
+}
+
+test$("builder-registers") {
+    ModuleBuilder m;
+    FunctionBuilder b{m, u"main"_s16};
+
+    auto p = try$(b.param(u"p"_s16));
+    expectEq$(p, 0);
+
+    b.beginScope();
+    auto x = try$(b.local(u"x"_s16));
+    auto t = try$(b.temp());
+    expectEq$(x, 1);
+    expectEq$(t, 2);
+    expectEq$(b.resolve(u"x"_s16), Opt<Reg>{x});
+    b.endScope();
+
+    // Leaving the scope releases its locals and what was above them
+    expectNot$(b.resolve(u"x"_s16).has());
+    expectEq$(try$(b.temp()), 1);
+    expectEq$(b._fn->registers, 3uz);
+
+    expectNot$(b.param(u"q"_s16).has());
+
+    // Unknown names are globals, interned once
+    try$(b.load(0, u"g"_s16));
+    try$(b.store(u"g"_s16, 0));
+    expectEq$(m._mod.globals.len(), 1uz);
+    expectEq$(b._fn->code[0].op(), Opcode::GET_GLOBAL);
+    expectEq$(b._fn->code[1].op(), Opcode::SET_GLOBAL);
+
+    return Ok();
+}
+
+// MARK: Execution -------------------------------------------------------------
+
+test$("vm-arithmetic") {
+    Gc::Heap heap;
+    auto agent = heap.alloc<Agent>(heap);
+
+    // ((7 + 3) * 4 - 2) / 2 % 7, negated
+    auto mod = try$(_module([](FunctionBuilder& b) -> Res<> {
+        auto x = try$(b.temp());
+        auto y = try$(b.temp());
+        try$(b.loadNumber(x, 7));
+        try$(b.loadNumber(y, 3));
+        b.emit(Inst::abc(Opcode::ADD, x, x, y));
+        try$(b.loadNumber(y, 4));
+        b.emit(Inst::abc(Opcode::MUL, x, x, y));
+        try$(b.loadNumber(y, 2));
+        b.emit(Inst::abc(Opcode::SUB, x, x, y));
+        b.emit(Inst::abc(Opcode::DIV, x, x, y));
+        try$(b.loadNumber(y, 7));
+        b.emit(Inst::abc(Opcode::MOD, x, x, y));
+        b.emit(Inst::abc(Opcode::NEG, x, x));
+        b.emit(Inst::abc(Opcode::RETURN, x));
+        return Ok();
+    }));
+    expectEq$(_runNumber(agent, mod), Opt<f64>{-5.});
+
+    // Anything but numbers is a type error for now
+    auto bad = try$(_module([](FunctionBuilder& b) -> Res<> {
+        auto x = try$(b.temp());
+        auto y = try$(b.temp());
+        b.emit(Inst::abc(Opcode::LOAD_UNDEFINED, x));
+        try$(b.loadNumber(y, 1));
+        b.emit(Inst::abc(Opcode::ADD, x, x, y));
+        b.emit(Inst::abc(Opcode::RETURN, x));
+        return Ok();
+    }));
+    Vm vm{*agent, bad};
+    expectNot$(vm.run().has());
+
+    return Ok();
+}
+
+test$("vm-compare-and-jump") {
+    Gc::Heap heap;
+    auto agent = heap.alloc<Agent>(heap);
+
+    // let s = 0;
+    // for (let i = 0; i < 100; i++) if (i % 2 !== 0) s = s + i;
+    // total = s;
+    auto mod = try$(_module([](FunctionBuilder& b) -> Res<> {
+        auto s = try$(b.local(u"s"_s16));
+        auto i = try$(b.local(u"i"_s16));
+        auto n = try$(b.local(u"n"_s16));
+        auto two = try$(b.local(u"two"_s16));
+        auto zero = try$(b.local(u"zero"_s16));
+        try$(b.loadNumber(s, 0));
+        try$(b.loadNumber(i, 0));
+        try$(b.loadNumber(n, 100));
+        try$(b.loadNumber(two, 2));
+        try$(b.loadNumber(zero, 0));
+
+        auto t = try$(b.temp());
+        auto loop = b.here();
+        b.emit(Inst::abc(Opcode::LT, t, i, n));
+        auto exit = b.jump(Opcode::JMP_IF_FALSE, t);
+        b.emit(Inst::abc(Opcode::MOD, t, i, two));
+        b.emit(Inst::abc(Opcode::NE, t, t, zero));
+        b.emit(Inst::abc(Opcode::NOT, t, t));
+        auto skip = b.jump(Opcode::JMP_IF_TRUE, t);
+        b.emit(Inst::abc(Opcode::ADD, s, s, i));
+        try$(b.patch(skip));
+        b.emit(Inst::abc(Opcode::INC, i));
+        try$(b.jumpTo(Opcode::JMP, 0, loop));
+        try$(b.patch(exit));
+
+        try$(b.store(u"total"_s16, s));
+        b.emit(Inst::abc(Opcode::RETURN, s));
+        return Ok();
+    }));
+
+    Vm vm{*agent, mod};
+    auto res = vm.run();
+    expect$(res.has());
+    expect$(_isNumber(res.unwrap(), 2500.));
+    expectEq$(vm.globals.len(), 1uz);
+    expect$(_isNumber(vm.globals[0], 2500.));
+
+    return Ok();
+}
+
+test$("vm-call") {
+    Gc::Heap heap;
+    auto agent = heap.alloc<Agent>(heap);
+
+    ModuleBuilder m;
+    auto entry = try$(m.declare(u"main"_s16));
+    auto second = try$(m.declare(u"second"_s16));
+    auto forever = try$(m.declare(u"forever"_s16));
+
+    // function second(a, b) { return b; }
+    {
+        FunctionBuilder b{m, u"second"_s16};
+        try$(b.param(u"a"_s16));
+        auto rhs = try$(b.param(u"b"_s16));
+        b.emit(Inst::abc(Opcode::RETURN, rhs));
+        m.define(second, b.finish());
+    }
+
+    // function forever() { return forever(); }
+    {
+        FunctionBuilder b{m, u"forever"_s16};
+        auto ret = try$(b.temp());
+        b.emit(Inst::abc(Opcode::CALL, ret, forever, 0));
+        b.emit(Inst::abc(Opcode::RETURN, ret));
+        m.define(forever, b.finish());
+    }
+
+    // second(1, 2);
+    // return second(3) === undefined;
+    {
+        FunctionBuilder b{m, u"main"_s16};
+        auto ret = try$(b.temp());
+        auto arg0 = try$(b.temp());
+        auto arg1 = try$(b.temp());
+        try$(b.loadNumber(arg0, 1));
+        try$(b.loadNumber(arg1, 2));
+        b.emit(Inst::abc(Opcode::CALL, ret, second, 2));
+        b.release(arg0);
+
+        auto other = try$(b.temp());
+        arg0 = try$(b.temp());
+        arg1 = try$(b.temp());
+        try$(b.loadNumber(arg0, 3));
+        // Stale value from a previous frame, must not leak into the callee
+        try$(b.loadNumber(arg1, 99));
+        b.emit(Inst::abc(Opcode::CALL, other, second, 1));
+        b.emit(Inst::abc(Opcode::LOAD_UNDEFINED, arg0));
+        b.emit(Inst::abc(Opcode::EQ, other, other, arg0));
+        b.emit(Inst::abc(Opcode::RETURN, other));
+        m.define(entry, b.finish());
+    }
+
+    auto mod = m.finish(entry);
+    Vm vm{*agent, mod};
+    auto res = vm.run();
+    expect$(res.has());
+    expect$(res.unwrap() == true);
+
+    Array<Value, 2> args = {Number{1.}, Number{2.}};
+    res = vm.call(second, args);
+    expect$(res.has());
+    expect$(_isNumber(res.unwrap(), 2.));
+    expectEq$(vm._stack.len(), 0uz);
+
+    // Unbounded recursion throws instead of overflowing
+    expectNot$(vm.call(forever, {}).has());
+
+    return Ok();
+}
+
+// MARK: Inline Caches ---------------------------------------------------------
+
+// function get(o) { return o.x; }
+// function put(o, v) { o.x = v; }
+static Res<Module> _accessors() {
+    ModuleBuilder m;
+    auto get = try$(m.declare(u"get"_s16));
+    auto put = try$(m.declare(u"put"_s16));
+    auto x = PropertyKey::from(u"x"_s16);
+
+    {
+        FunctionBuilder b{m, u"get"_s16};
+        auto o = try$(b.param(u"o"_s16));
+        auto t = try$(b.temp());
+        b.emit(Inst::abc(Opcode::GET_PROP, t, o, try$(b.site(x))));
+        b.emit(Inst::abc(Opcode::RETURN, t));
+        m.define(get, b.finish());
+    }
+
+    {
+        FunctionBuilder b{m, u"put"_s16};
+        auto o = try$(b.param(u"o"_s16));
+        auto v = try$(b.param(u"v"_s16));
+        b.emit(Inst::abc(Opcode::SET_PROP, o, try$(b.site(x)), v));
+        m.define(put, b.finish());
+    }
+
+    return Ok(m.finish(get));
+}
+
+static Gc::Ref<Object> _object(Agent& agent, Slice<_Str<Utf16>> keys, Gc::Ptr<Object> prototype = nullptr) {
+    auto object = Object::create(agent, {.prototype = prototype});
+    for (usize i = 0; i < keys.len(); i++)
+        object->propertyStorage.set(
+            PropertyKey::from(keys[i]),
+            {Value{Number{(f64)i}}, {true, true, true}}
+        );
+    return object;
+}
+
+test$("vm-inline-cache-get") {
+    Gc::Heap heap;
+    auto agent = heap.alloc<Agent>(heap);
+    auto mod = try$(_accessors());
+    auto& site = mod.functions[0]->sites[0];
+    Vm vm{*agent, mod};
+
+    auto get = [&](Gc::Ref<Object> o) {
+        Array<Value, 1> args = {o};
+        return vm.call(0, args).unwrap();
+    };
+
+    // Miss, then hit on the same shape
+    auto a = _object(*agent, Array{u"x"_s16});
+    auto b = _object(*agent, Array{u"x"_s16});
+    expect$(_isNumber(get(a), 0.));
+    expectEq$(site.cache._len, 1uz);
+    expect$(_isNumber(get(b), 0.));
+    expectEq$(site.cache._len, 1uz);
+
+    // A different shape gets its own entry
+    auto c = _object(*agent, Array{u"y"_s16, u"x"_s16});
+    expect$(_isNumber(get(c), 1.));
+    expectEq$(site.cache._len, 2uz);
+
+    // Properties on the prototype miss and go through [[Get]]
+    auto d = _object(*agent, Array{u"z"_s16}, c);
+    expect$(_isNumber(get(d), 1.));
+    auto e = _object(*agent, Array<_Str<Utf16>, 0>{});
+    expect$(get(e) == undefined);
+    expectEq$(site.cache._len, 2uz);
+
+    // Megamorphic sites keep working
+    for (auto keys : {Array{u"a"_s16, u"x"_s16}, Array{u"b"_s16, u"x"_s16}, Array{u"c"_s16, u"x"_s16}, Array{u"d"_s16, u"x"_s16}}) {
+        expect$(_isNumber(get(_object(*agent, keys)), 1.));
+    }
+    expectEq$(site.cache._len, InlineCache::WAYS);
+    expect$(_isNumber(get(a), 0.));
+
+    return Ok();
+}
+
+test$("vm-inline-cache-set") {
+    Gc::Heap heap;
+    auto agent = heap.alloc<Agent>(heap);
+    auto mod = try$(_accessors());
+    auto& site = mod.functions[1]->sites[0];
+    Vm vm{*agent, mod};
+    auto x = PropertyKey::from(u"x"_s16);
+
+    auto put = [&](Gc::Ref<Object> o, f64 v) {
+        Array<Value, 2> args = {o, Number{v}};
+        return vm.call(1, args).has();
+    };
+
+    // Existing writable property, hit after the first miss
+    auto a = _object(*agent, Array{u"x"_s16});
+    auto b = _object(*agent, Array{u"x"_s16});
+    expect$(put(a, 10));
+    expect$(put(b, 20));
+    expectEq$(site.cache._len, 1uz);
+    expect$(_isNumber(a->get(x, a).unwrap(), 10.));
+    expect$(_isNumber(b->get(x, b).unwrap(), 20.));
+
+    // Missing property, goes through [[Set]] which adds it
+    auto c = _object(*agent, Array{u"y"_s16});
+    expect$(put(c, 30));
+    expect$(_isNumber(c->get(x, c).unwrap(), 30.));
+
+    // Read-only property, the cached slot must not be written
+    auto d = _object(*agent, Array{u"x"_s16});
+    expect$(d->defineOwnProperty(x, {.writable = false}).unwrap());
+    expect$(put(d, 40));
+    expect$(_isNumber(d->get(x, d).unwrap(), 0.));
+
+    return Ok();
+}
+
+} // namespace Vaev::Script::Tests
@@ -0,0 +1,300 @@
+#include <karm-math/funcs.h>
+
+#include "object.h"
+#include "ops.h"
+#include "vm.h"
+
+namespace Vaev::Script {
+
+static Completion _typeError(Agent& agent) {
+    return throwException(createException(agent, ExceptionType::TYPE_ERROR));
+}
+
+// https://tc39.es/ecma262/#sec-toboolean
+static Boolean _toBoolean(Value const& v) {
+    // 1. If argument is a Boolean, return argument.
+    if (auto b = v.store.is<Boolean>())
+        return *b;
+
+    // 2. If argument is one of undefined, null, +0𝔽, -0𝔽, NaN, 0ℤ, or the empty String, return false.
+    if (auto n = v.store.is<Number>())
+        return n->_val != 0 and not Math::isNan(n->_val);
+
+    if (auto s = v.store.is<String>())
+        return s->len() > 0;
+
+    if (v.store.is<Undefined>() or v.store.is<Null>())
+        return false;
+
+    // 3. NOTE: This step is replaced in section B.3.6.1.
+    // 4. Return true.
+    return true;
+}
+
+// https://tc39.es/ecma262/#sec-isstrictlyequal
+static Boolean _isStrictlyEqual(Value const& x, Value const& y) {
+    // 1. If SameType(x, y) is false, return false.
+    if (not sameType(x, y))
+        return false;
+
+    // 2. If x is a Number, then
+    //    a. Return Number::equal(x, y).
+    if (x.isNumber())
+        return x.asNumber()._val == y.asNumber()._val;
+
+    // 3. Return SameValueNonNumber(x, y).
+    return sameValueNonNumber(x, y);
+}
+
+// The inline caches read and write the property storage directly, which is
+// only allowed when the object behaves like an ordinary one.
+static bool _hasOrdinaryGet(Object const& o) {
+    return o.internalMethods.get == ordinaryGet and
+           o.internalMethods.getOwnProperty == ordinaryGetOwnProperty;
+}
+
+static bool _hasOrdinarySet(Object const& o) {
+    return o.internalMethods.set == ordinarySet and
+           o.internalMethods.getOwnProperty == ordinaryGetOwnProperty and
+           o.internalMethods.defineOwnProperty == ordinaryDefineOwnProperty;
+}
+
+Except<Value> Vm::call(usize index, Slice<Value> args) {
+    auto& fn = mod.functions[index].unwrap();
+    usize base = _stack.len();
+    _stack.resize(base + max(fn.registers, args.len()));
+    for (usize i = 0; i < args.len(); i++)
+        _stack[base + i] = args[i];
+
+    auto res = _exec(fn, base, 0);
+    _stack.trunc(base);
+    return res;
+}
+
+Except<Value> Vm::_exec(Function& fn, usize base, usize depth) {
+    if (depth > MAX_DEPTH)
+        return throwException(createException(agent, ExceptionType::RANGE_ERROR));
+
+    if (_stack.len() < base + fn.registers)
+        _stack.resize(base + fn.registers);
+
+    // NOTE: Handlers are reached through computed gotos rather than a
+    //       switch, each handler ends with its own indirect jump, so the
+    //       branch predictor keeps a history per opcode.
+    static void* const dispatch[] = {
+#define ITER(NAME, ...) &&op_##NAME,
+        FOREACH_OPCODE(ITER)
+#undef ITER
+    };
+
+    static_assert(sizeof(dispatch) / sizeof(*dispatch) == (usize)Opcode::_LEN);
+
+    Inst const* ip = fn.code.buf();
+    Value const* k = fn.constants.buf();
+    Value* r = _stack.buf() + base;
+    Inst inst;
+
+#define DISPATCH()    \
+    inst = *ip++;     \
+    ops++;            \
+    goto* dispatch[(u8)inst.op()]
+
+// Anything that can run script code can grow the stack, and move the frame.
+#define RELOAD() \
+    r = _stack.buf() + base
+
+#define ARITH(NAME, EXPR)                                     \
+    op_##NAME : {                                             \
+        auto x = r[inst.b()].store.is<Number>();              \
+        auto y = r[inst.c()].store.is<Number>();              \
+        /* FIXME: ToNumeric, and string concatenation. */     \
+        if (not x or not y) [[unlikely]]                      \
+            return _typeError(agent);                         \
+        f64 lhs = x->_val;                                    \
+        f64 rhs = y->_val;                                    \
+        r[inst.a()] = Number{EXPR};                           \
+        DISPATCH();                                           \
+    }
+
+#define COMPARE(NAME, EXPR)                                   \
+    op_##NAME : {                                             \
+        auto x = r[inst.b()].store.is<Number>();              \
+        auto y = r[inst.c()].store.is<Number>();              \
+        /* FIXME: IsLessThan on strings and objects. */       \
+        if (not x or not y) [[unlikely]]                      \
+            return _typeError(agent);                         \
+        f64 lhs = x->_val;                                    \
+        f64 rhs = y->_val;                                    \
+        r[inst.a()] = Boolean{EXPR};                          \
+        DISPATCH();                                           \
+    }
+
+    DISPATCH();
+
+op_NOP:
+    DISPATCH();
+
+op_LOAD_UNDEFINED:
+    r[inst.a()] = undefined;
+    DISPATCH();
+
+op_LOAD_NULL:
+    r[inst.a()] = null;
+    DISPATCH();
+
+op_LOAD_TRUE:
+    r[inst.a()] = true;
+    DISPATCH();
+
+op_LOAD_FALSE:
+    r[inst.a()] = false;
+    DISPATCH();
+
+op_LOAD_INT:
+    r[inst.a()] = Number{(f64)inst.sbx()};
+    DISPATCH();
+
+op_LOAD_CONST:
+    r[inst.a()] = k[inst.bx()];
+    DISPATCH();
+
+op_MOVE:
+    r[inst.a()] = r[inst.b()];
+    DISPATCH();
+
+op_GET_GLOBAL:
+    r[inst.a()] = globals[inst.bx()];
+    DISPATCH();
+
+op_SET_GLOBAL:
+    globals[inst.bx()] = r[inst.a()];
+    DISPATCH();
+
+    ARITH(ADD, lhs + rhs)
+    ARITH(SUB, lhs - rhs)
+    ARITH(MUL, lhs * rhs)
+    ARITH(DIV, lhs / rhs)
+    ARITH(MOD, __builtin_fmod(lhs, rhs))
+
+op_NEG: {
+    auto x = r[inst.b()].store.is<Number>();
+    if (not x) [[unlikely]]
+        return _typeError(agent);
+    r[inst.a()] = Number{-x->_val};
+    DISPATCH();
+}
+
+op_NOT:
+    r[inst.a()] = Boolean{not _toBoolean(r[inst.b()])};
+    DISPATCH();
+
+op_INC: {
+    auto x = r[inst.a()].store.is<Number>();
+    if (not x) [[unlikely]]
+        return _typeError(agent);
+    x->_val += 1;
+    DISPATCH();
+}
+
+    COMPARE(LT, lhs < rhs)
+    COMPARE(LE, lhs <= rhs)
+
+op_EQ:
+    r[inst.a()] = Boolean{_isStrictlyEqual(r[inst.b()], r[inst.c()])};
+    DISPATCH();
+
+op_NE:
+    r[inst.a()] = Boolean{not _isStrictlyEqual(r[inst.b()], r[inst.c()])};
+    DISPATCH();
+
+op_JMP:
+    ip += inst.sbx();
+    DISPATCH();
+
+op_JMP_IF_TRUE:
+    if (_toBoolean(r[inst.a()]))
+        ip += inst.sbx();
+    DISPATCH();
+
+op_JMP_IF_FALSE:
+    if (not _toBoolean(r[inst.a()]))
+        ip += inst.sbx();
+    DISPATCH();
+
+op_NEW_OBJECT:
+    r[inst.a()] = Object::create(agent);
+    DISPATCH();
+
+op_GET_PROP: {
+    auto& site = fn.sites[inst.c()];
+    auto obj = r[inst.b()].store.is<Gc::Ref<Object>>();
+    // FIXME: ToObject for primitives.
+    if (not obj) [[unlikely]]
+        return _typeError(agent);
+
+    auto& object = **obj;
+    if (_hasOrdinaryGet(object)) {
+        if (auto value = site.cache.get(object.propertyStorage, site.key)) {
+            r[inst.a()] = *value;
+            DISPATCH();
+        }
+    }
+
+    auto receiver = r[inst.b()];
+    auto value = try$(object.get(site.key, receiver));
+    RELOAD();
+    r[inst.a()] = value;
+    DISPATCH();
+}
+
+op_SET_PROP: {
+    auto& site = fn.sites[inst.b()];
+    auto obj = r[inst.a()].store.is<Gc::Ref<Object>>();
+    if (not obj) [[unlikely]]
+        return _typeError(agent);
+
+    auto& object = **obj;
+    if (_hasOrdinarySet(object) and
+        site.cache.set(object.propertyStorage, site.key, r[inst.c()])) {
+        DISPATCH();
+    }
+
+    auto receiver = r[inst.a()];
+    try$(object.set(site.key, r[inst.c()], receiver));
+    RELOAD();
+    DISPATCH();
+}
+
+op_CALL: {
+    auto& callee = mod.functions[inst.b()].unwrap();
+    usize argc = inst.c();
+    usize calleeBase = base + inst.a() + 1;
+
+    if (_stack.len() < calleeBase + max(callee.registers, argc)) {
+        _stack.resize(calleeBase + max(callee.registers, argc));
+        RELOAD();
+    }
+
+    // Parameters that weren't passed are undefined.
+    for (usize i = argc; i < callee.params; i++)
+        _stack[calleeBase + i] = undefined;
+
+    auto result = try$(_exec(callee, calleeBase, depth + 1));
+    RELOAD();
+    r[inst.a()] = result;
+    DISPATCH();
+}
+
+op_RETURN:
+    return Ok(r[inst.a()]);
+
+op_RETURN_UNDEFINED:
+    return Ok(undefined);
+
+#undef COMPARE
+#undef ARITH
+#undef RELOAD
+#undef DISPATCH
+}
+
+} // namespace Vaev::Script
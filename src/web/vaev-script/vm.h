@@ -0,0 +1,39 @@
+#pragma once
+
+#include "agent.h"
+#include "bytecode.h"
+#include "completion.h"
+
+namespace Vaev::Script {
+
+// A register based interpreter for bytecode modules.
+//
+// Frames are windows on a single value stack, a call places its arguments
+// right after the register that receives the result, so they end up in the
+// first registers of the callee frame without being copied.
+struct Vm {
+    static constexpr usize MAX_DEPTH = 512;
+
+    Agent& agent;
+    Module& mod;
+    Vec<Value> globals;
+    Vec<Value> _stack;
+    // Number of instructions executed so far.
+    usize ops = 0;
+
+    Vm(Agent& agent, Module& mod)
+        : agent(agent), mod(mod) {
+        globals.resize(mod.globals.len());
+    }
+
+    // Evaluate the entry function of the module.
+    Except<Value> run() {
+        return call(mod.entry, {});
+    }
+
+    Except<Value> call(usize fn, Slice<Value> args);
+
+    Except<Value> _exec(Function& fn, usize base, usize depth);
+};
+
+} // namespace Vaev::Script
@@ -1,3 +1,5 @@
+#include <karm-base/lru.h>
+#include <karm-gfx/cpu/tiles.h>
 #include <karm-ui/view.h>
 #include <vaev-driver/render.h>
 #include <vaev-layout/paint.h>
@@ -7,9 +9,18 @@
 namespace Vaev::View {
 
 struct View : public Ui::View<View> {
+    struct LayoutKey {
+        usize generation;
+        Math::Vec2i viewport;
+
+        bool operator==(LayoutKey const&) const = default;
+    };
+
     Gc::Root<Dom::Document> _dom;
     ViewProps _props;
+    Lru<LayoutKey, Driver::LayoutResult> _layouts{8};
     Opt<Driver::RenderResult> _renderResult;
+    Gfx::CpuTiles _tiles;
 
     View(Gc::Root<Dom::Document> dom, ViewProps props)
         : _dom(dom), _props(props) {}
@@ -56,14 +67,26 @@ struct View : public Ui::View<View> {
     void reconcile(View& o) override {
         _dom = o._dom;
         _props = o._props;
+        _layouts.clear();
         _renderResult = NONE;
     }
 
+    // Style and layout the document for the given viewport, the result is
+    // cached so that measuring and painting the same viewport share one
+    // layout, as long as the document is not mutated.
+    Driver::LayoutResult& _layout(Math::Vec2i viewport) {
+        LayoutKey key = {_dom->generation(), viewport};
+        return _layouts.access(key, [&] {
+            auto media = _constructMedia(viewport);
+            return Driver::layout(*_dom, media, {.small = viewport.cast<Au>()});
+        });
+    }
+
     void paint(Gfx::Canvas& g, Math::Recti rect) override {
         auto viewport = bound().size();
         if (not _renderResult) {
-            auto media = _constructMedia(viewport);
-            _renderResult = Driver::render(*_dom, media, {.small = viewport.cast<Au>()});
+            _renderResult = Driver::render(_layout(viewport));
+            _tiles.invalidate();
         }
 
         g.push();
@@ -72,11 +95,16 @@ struct View : public Ui::View<View> {
         g.clip(viewport);
 
         auto [_, layout, paint, frag] = *_renderResult;
-        g.clear(rect, Gfx::WHITE);
 
-        paint->paint(g, rect.offset(-bound().xy).cast<f64>());
-        if (_props.wireframe)
-            Layout::wireframe(*frag, g);
+        // NOTE: The document is rasterized into a tile cache, so scrolling
+        //       only has to blit the tiles that were already rendered.
+        auto visible = rect.offset(-bound().xy).clipTo(Math::Recti{viewport});
+        _tiles.paint(g, visible, dpi(), [&](Gfx::Canvas& tg, Math::Recti tr) {
+            tg.clear(tr, Gfx::WHITE);
+            paint->paint(tg, tr.cast<f64>());
+            if (_props.wireframe)
+                Layout::wireframe(*frag, tg);
+        });
 
         g.pop();
     }
@@ -87,13 +115,10 @@ struct View : public Ui::View<View> {
     }
 
     Math::Vec2i size(Math::Vec2i size, Ui::Hint) override {
-        // FIXME: This is wasteful, we should cache the result
-        auto media = _constructMedia(size);
-        auto [_, layout, _, frag] = Driver::render(*_dom, media, {.small = size.cast<Au>()});
-
+        auto& result = _layout(size);
         return {
-            frag->metrics.borderBox().width.cast<isize>(),
-            frag->metrics.borderBox().height.cast<isize>(),
+            result.output.width().cast<isize>(),
+            result.output.height().cast<isize>(),
         };
     }
 };